@@ -3,6 +3,7 @@
 ********************************************************************************
 * modification history:                                                        *
 *   31.01.24 bf, created                                                       *
+*   14.10.26 , 64 devices, device mask iteration, SPI bus grouping             *
 *******************************************************************************/
 
 #ifndef _ckdstif_h_
@@ -13,13 +14,47 @@
 
 typedef unsigned CKDST_DEV;
 
-#define CKDST_MAX_NDEV	10      /* arbitrary */
+#define CKDST_MAX_NDEV	64      /* one CKDST_DEV_MASK bit per device */
 
-typedef UINT32 CKDST_DEV_MASK;  /* one bit per channel */
+typedef UINT64 CKDST_DEV_MASK;  /* one bit per device */
+
+#define CKDST_DEV_BIT(dev)  ((CKDST_DEV_MASK) 1 << (dev))
+
+/* devices 0 .. nDev - 1 (nDev <= CKDST_MAX_NDEV) */
+#define CKDST_DEV_MASK_OF(nDev)                                               \
+    ((nDev) >= CKDST_MAX_NDEV ? ~(CKDST_DEV_MASK) 0 : CKDST_DEV_BIT(nDev) - 1)
+
+/* lowest / highest device in (a non-empty) mask, number of devices in mask */
+INLINE CKDST_DEV ckdstDevFirst(CKDST_DEV_MASK mask)
+{
+    return (CKDST_DEV) __builtin_ctzll(mask);
+}
+
+INLINE CKDST_DEV ckdstDevLast(CKDST_DEV_MASK mask)
+{
+    return (CKDST_DEV) (63 - __builtin_clzll(mask));
+}
+
+INLINE unsigned ckdstDevCount(CKDST_DEV_MASK mask)
+{
+    return (unsigned) __builtin_popcountll(mask);
+}
+
+/* iterates dev (an lvalue of type CKDST_DEV) over the devices in mask, in
+   ascending order, only visiting the devices actually set (mask is evaluated
+   once, before the first iteration) */
+#define CKDST_FOR_EACH_DEV(dev, mask)                                         \
+    for (CKDST_DEV_MASK _ckdstRem_##dev = (mask);                             \
+         _ckdstRem_##dev && ((dev) = ckdstDevFirst(_ckdstRem_##dev),          \
+                             _ckdstRem_##dev &= _ckdstRem_##dev - 1, TRUE);)
+
+/* devices sharing an SPI bus (i.e. whose transfers are serialized anyway) */
+typedef unsigned CKDST_BUS;
+
+#define CKDST_MAX_NBUS  8       /* arbitrary */
 
 typedef UINT64 CKDST_FREQ_HZ;
 
 
 
 #endif /* _ckdstif_h_ */
-
@@ -6,8 +6,16 @@
 *******************************************************************************/
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <stdarg.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "sysutil.h"
+#include "utlring.h"
 #include "hmc7043.h"
 
 
@@ -36,16 +44,149 @@
 #define HMC7043_MSB_BIT_VAL(val) (val >> 8)
 #define HMC7043_ADLY_MAX_STEPS 23
 #define HMC7043_ADLY_STEP_SIZE 25
+#define HMC7043_DDLY_MAX_STEPS 15      /* (cdDelay field width) */
+#define HMC7043_FADLY_MAX_STEPS 15     /* (faDelay field width) */
+#define HMC7043_DLY_TOLERANCE_FS 100   /* delays must be multiples of the step */
+#define HMC7043_MSLIP_MAX 0xfff        /* (msDelay field width) */
+#define HMC7043_CH_DIV_MAX 0xfff       /* (chDiv field width) */
+#define HMC7043_FS_PER_PS 1000
+#define HMC7043_FS_PER_SEC 1000000000000000ull
+#define HMC7043_TIMING_MAX_PS 1e9      /* bound on any duration in the params */
 
 typedef struct {
     Bool initDone;
     HUTL_MUTEX hMutex;
+    /* critical section owner and nesting depth (ref. hmc7043CsEnter); these
+       are only modified by the owner while holding hMutex */
+    HSYS_THREAD csOwner;
+    unsigned csDepth;
+    const char *csContext;  /* of the outermost hmc7043CsEnter */
+    HMC7043_BUS_PRI busPri; /* of the owner's transfers (hmc7043CsSetBusPri) */
 } Hmc7043_dev_ctl;
 
 typedef struct {
     Hmc7043_dev_io_if ioIf;
 } Hmc7043_lli_dev_ctl;
 
+/* start-up synchronization of concurrently initialized devices (ref.
+   hmc7043InitDevMulti): the last device to reach the barrier releases the
+   others, each of which waits for a message of the release queue */
+typedef struct {
+    unsigned nDevs;
+    UINT32_ATOMIC nArrived;
+    HUTL_QUEUE hRelease;
+} Hmc7043_start_barrier;
+
+typedef struct {
+    Hmc7043_start_barrier *pBarrier;  /* shared by all the devices */
+    Bool waited;                      /* whether this device reached it */
+} Hmc7043_start_sync;
+
+typedef struct {  /* hmc7043InitDevMulti worker thread data */
+    const Hmc7043_dev_io_if *ifs;
+    const Hmc7043_app_dev_params *params;
+    Bool warmInit;
+    Bool noBarrier;  /* barrier setup failed: the threads just exit */
+    Hmc7043_start_barrier barrier;
+} Hmc7043_init_multi_ctl;
+
+/* precompiled configuration blob (ref. hmc7043CompileParams) header, followed
+   by the Hmc7043_app_dev_params and then by nRegs 3-byte register entries
+   (register index LSB, MSB and data); the CRC covers everything following the
+   header */
+typedef struct {
+    UINT32 magic;       /* HMC7043_CFG_BLOB_MAGIC */
+    UINT16 version;     /* HMC7043_CFG_BLOB_VERSION */
+    UINT16 nRegs;
+    UINT32 paramsSize;  /* sizeof(Hmc7043_app_dev_params) when compiled */
+    UINT32 crc;         /* CRC-32 (IEEE 802.3) */
+} Hmc7043_cfg_blob_hdr;
+
+#define HMC7043_CFG_BLOB_MAGIC    0x37303433  /* "7043" */
+#define HMC7043_CFG_BLOB_VERSION  1  /* to be bumped on any layout change */
+#define HMC7043_CFG_BLOB_REG_SIZE 3
+#define HMC7043_CFG_BLOB_SIZE                                                \
+    (sizeof(Hmc7043_cfg_blob_hdr) + sizeof(Hmc7043_app_dev_params) +         \
+     HMC7043_CFG_BLOB_REG_SIZE * HMC7043_APP_NREG_DESCS)
+
+
+/* debug builds check that the inner (*InCs) register access path is only used
+   while holding the device critical section */
+#ifndef NDEBUG
+#define HMC7043_CS_ASSERT_HELD(dev)                                           \
+    do {                                                                      \
+        if (!hmc7043CsHeld(dev))                                              \
+            sysCodeError(CODE_ERR_STATE, hmc7043CsHeld, __FUNCTION__, dev,   \
+                         -1);                                                 \
+    } while (0)
+#else
+#define HMC7043_CS_ASSERT_HELD(dev)  ((void) 0)
+#endif
+
+
+/* driver log messages of the hot paths (ref. hmc7043StartDeferredLog): the
+   hmc7043Log / hmc7043LogInfo / hmc7043LogLong call sites (the string arguments
+   of the latter having to be static) each get a static descriptor, its format
+   string serving as the message id, and are routed via hmc7043LogPost for
+   per-site rate limiting and deferred formatting; sites of a level above
+   HMC7043_LOG_LEVEL_MAX (by default SYS_LOG_LEVEL_INFO) are compiled out (the
+   sysLog*Fun call only checking the arguments against the format), and a site
+   with more than SYS_LOG_MAX_NARGS arguments fails to compile. The rest of
+   the driver logs directly via sysLog / sysLogInfo / sysLogLong. */
+#ifndef HMC7043_LOG_LEVEL_MAX
+#define HMC7043_LOG_LEVEL_MAX  SYS_LOG_LEVEL_INFO
+#endif
+
+#define HMC7043_LOG_RATE_NSEC  1000000000  /* rate limiting window */
+
+typedef struct {
+    const char *format, *context;
+    unsigned level;
+    Bool isLong;                /* sysLogLongFun rather than sysLogIntFun */
+    UINT64_ATOMIC windowStart;  /* rate limiting window start (sysTimeNsec) */
+    UINT32_ATOMIC nInWindow, nSuppressed;
+} Hmc7043_log_site;
+
+typedef struct {  /* deferred message */
+    const Hmc7043_log_site *pSite;
+    UINT32 nSuppressed;  /* messages of the site suppressed right before */
+    long args[SYS_LOG_MAX_NARGS];
+} Hmc7043_log_rec;
+
+/* counting up to 12 arguments, so that the check in HMC7043_LOG_SITE catches
+   any beyond SYS_LOG_MAX_NARGS */
+#define HMC7043_LOG_NARGS(...)                                                \
+    HMC7043_LOG_NARGS_(0, ##__VA_ARGS__, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2,  \
+                       1, 0)
+#define HMC7043_LOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11,  \
+                           _12, n, ...)  n
+
+#define HMC7043_LOG_SITE(lvl, lng, checkFun, f, ...)                          \
+    do {                                                                      \
+        static Hmc7043_log_site _site = {                                     \
+            .format = (f), .context = __FUNCTION__, .level = (lvl),           \
+            .isLong = (lng)                                                   \
+        };                                                                    \
+                                                                              \
+        (void)sizeof(char[HMC7043_LOG_NARGS(__VA_ARGS__) <=                   \
+                          SYS_LOG_MAX_NARGS ? 1 : -1]);                       \
+        if (0)                                                                \
+            checkFun((lvl), NULL, (f), ##__VA_ARGS__);                        \
+        if ((lvl) <= HMC7043_LOG_LEVEL_MAX)                                   \
+            hmc7043LogPost(&_site, HMC7043_LOG_NARGS(__VA_ARGS__),            \
+                           ##__VA_ARGS__);                                    \
+    } while (0)
+
+#define hmc7043Log(f, ...)                                                    \
+    HMC7043_LOG_SITE(SYS_LOG_LEVEL_UNCOND, FALSE, sysLogIntFun, f,            \
+                     ##__VA_ARGS__)
+#define hmc7043LogInfo(f, ...)                                                \
+    HMC7043_LOG_SITE(SYS_LOG_LEVEL_INFO, FALSE, sysLogIntFun, f,              \
+                     ##__VA_ARGS__)
+#define hmc7043LogLong(f, ...)                                                \
+    HMC7043_LOG_SITE(SYS_LOG_LEVEL_UNCOND, TRUE, sysLogLongFun, f,            \
+                     ##__VA_ARGS__)
+
 
 /* Control Data */
 LOCAL struct {
@@ -56,41 +197,287 @@ LOCAL struct {
 
 LOCAL struct {
     Bool initDone;  /* relying on static initialization of this to FALSE */
-    CKDST_DEV_MASK devMask;
+    CKDST_DEV_MASK devMask;  /* devices with allocated state (hmc7043IfInit) */
+    UINT64_ATOMIC liveMask;  /* devices last initialized OK */
+    UINT64_ATOMIC busDevMask[CKDST_MAX_NBUS];  /* per Hmc7043_dev_io_if.bus */
+    UINT32_ATOMIC bgStarted; /* a background thread (using the device pool) has
+                                been started, ref. hmc7043IfInit */
     Hmc7043_dev_ctl devCtl[CKDST_MAX_NDEV];
 } hmc7043IfCtl;
 
+/* shared SPI bus arbitration (ref. hmc7043SetBusArbitration): the bus is
+   granted per transfer chunk, to the highest priority class waiting, the
+   releasing transfer handing it over via the class's grant queue (i.e. the bus
+   stays busy while any transfer is waiting); the mutex is created by the
+   first hmc7043LliInit, the grant queues on first enabling the arbitration */
+#define HMC7043_BUS_CHUNK_NREGS  16  /* longest burst per grant */
+
+typedef struct {
+    HUTL_MUTEX hMutex;
+    /* per waiting class (holding at most one grant per device on the bus) */
+    HUTL_QUEUE hGrant[HMC7043_BPRI_NPRIS];
+    UINT32_ATOMIC enabled;
+    /* the rest being protected by hMutex */
+    Bool busy;
+    unsigned nWaiting[HMC7043_BPRI_NPRIS];
+    SYS_TIME_NS grantedAt;    /* of the current grant (if busy) */
+    Hmc7043_bus_stats stats;  /* (but .atNsec) */
+} Hmc7043_bus_ctl;
+
+LOCAL struct {
+    Bool initDone;
+    Hmc7043_bus_ctl busCtl[CKDST_MAX_NBUS];
+} hmc7043BusCtl;
+
+/* whether the device's state is allocated (i.e. dev is valid to operate on) */
+INLINE Bool hmc7043DevPresent(CKDST_DEV dev)
+{
+    return inEnumRange(dev, CKDST_MAX_NDEV) &&
+           (hmc7043IfCtl.devMask & CKDST_DEV_BIT(dev));
+}
+
+/* fixed-point timing model of a clock plan (ref. hmc7043AppTimingInit): each
+   step is an exact fraction of femtoseconds, so that durations (converted to
+   femtoseconds once) are checked against these with integer arithmetic only,
+   i.e. exactly and the same way on any target */
+typedef struct {
+    UINT64 num, den;  /* num / den fs */
+} Hmc7043_step;
+
 typedef struct {
-    Bool initDone;   /* relying on static initialization of this to FALSE */
+    CKDST_FREQ_HZ clkInpFreq;  /* internal clock, after the CLKIN divider */
+    Hmc7043_step clkStep;      /* internal clock cycle (multislip quantum) */
+    Hmc7043_step dDlyStep;     /* coarse digital delay (half a CLKIN cycle) */
+    Hmc7043_step aDlyStep;     /* fine analog delay */
+} Hmc7043_timing;
+
+typedef struct {  /* a channel's timing register values (ref. hmc7043AppPlanTiming) */
+    UINT16 divider;            /* 0 if the channel is unused */
+    UINT16 msDelay;            /* multislip delay, 0 if not multislipped */
+    UINT8 dDlySteps, aDlySteps;
+    Bool slip;                 /* single slip */
+} Hmc7043_ch_timing;
+
+typedef struct {
+    Bool initDone;   /* relying on the pool being cleared on allocation */
     Hmc7043_app_dev_params params;
+    /* whether *hmc7043AppCache.pDevCache[dev] holds the register image built
+       for the params with paramsHash (ref. hmc7043AppParamsHash) */
+    Bool imageCached;
+    UINT64 paramsHash;
+    Hmc7043_timing timing;  /* of the params' clock plan */
 } Hmc7043_app_dev_ctl;
 
 LOCAL struct {
     Bool initDone;  /* relying on static init. of this to FALSE */
     CKDST_FREQ_HZ lwstOutFreq;  /* Lowest output frequency in clock network*/
-    Hmc7043_app_dev_ctl devCtl[CKDST_MAX_NDEV];
+    Hmc7043_app_dev_ctl *pDevCtl[CKDST_MAX_NDEV];  /* ref. hmc7043PoolCtl */
 } hmc7043AppCtl;
 
+/* whether both the subsystem and the device are initialized, i.e. services may
+   act on the device (acquire loads, pairing with the release stores of the
+   initialization, so that the device setup is visible as well) */
+INLINE Bool hmc7043AppDevReady(const Hmc7043_app_dev_ctl *pCtl)
+{
+    return sysAtomicLoadAcq(&hmc7043IfCtl.initDone) &&
+           sysAtomicLoadAcq(&hmc7043AppCtl.initDone) &&
+           sysAtomicLoadAcq(&pCtl->initDone);
+}
+
+/* driver statistics (ref. hmc7043GetStats): same layout as Hmc7043_dev_stats,
+   but collected lock-free (using the relaxed sysAtomic* services, since the
+   counters do not order anything) */
+typedef struct {
+    UINT64_ATOMIC nCalls, nErrors, totalNsec, maxNsec;
+    UINT64_ATOMIC hist[HMC7043_STATS_NBINS];
+} Hmc7043_op_stats_ctl;
+
+typedef struct {
+    UINT64_ATOMIC nReads, nWrites, nRegsRead, nRegsWritten, nXferErrors,
+                  xferNsec;
+    UINT64_ATOMIC nCsEnters, csWaitNsec, csMaxWaitNsec;
+    UINT64_ATOMIC nShadowReads, nScrubMismatches;
+    Hmc7043_op_stats_ctl ops[HMC7043_SOP_NOPS];
+} Hmc7043_dev_stats_ctl;
+
+typedef char Hmc7043_dev_stats_chk[sizeof(Hmc7043_dev_stats_ctl) ==
+                                   sizeof(Hmc7043_dev_stats) ? 1 : -1];
+
+LOCAL struct {
+    Hmc7043_dev_stats_ctl *pDevStats[CKDST_MAX_NDEV];  /* ref. hmc7043PoolCtl */
+} hmc7043StatsCtl;
+
+LOCAL struct {
+    UINT32_ATOMIC maxPerSec;  /* per site and window, 0 for no limit */
+    UINT32_ATOMIC deferred;   /* set once the drain thread is started */
+    UINT32_ATOMIC nDropped;   /* deferred messages not fitting in the ring */
+    UINT32 periodUsec;        /* drain period */
+    Utl_ring ring;            /* of Hmc7043_log_rec (if deferred) */
+} hmc7043LogCtl;
+
+INLINE void hmc7043StatsMax(UINT64_ATOMIC *pMax, UINT64 val)
+{
+    UINT64 cur = sysAtomicLoadRelaxed(pMax);
+
+    while (val > cur && !sysAtomicCasRelaxed((UINT64 *) pMax, &cur, val))
+        ;
+}
+
+/* register access trace (ref. hmc7043GetTrace): a ring per device, written
+   only by the device's critical section owner and read lock-free */
+typedef struct {
+    UINT32_ATOMIC head;  /* number of entries written so far */
+    Hmc7043_trace_entry entries[HMC7043_TRACE_NENTRIES];
+} ALIGN(64) Hmc7043_trace_ring;
+
+typedef char Hmc7043_trace_nentries_chk[
+    !(HMC7043_TRACE_NENTRIES & (HMC7043_TRACE_NENTRIES - 1)) ? 1 : -1];
+
+LOCAL struct {
+    Hmc7043_trace_ring *pDevRing[CKDST_MAX_NDEV];  /* ref. hmc7043PoolCtl */
+} hmc7043TraceCtl;
+
+/* (a handful of plain stores, the release store of head only ordering these
+   for the readers) */
+INLINE void hmc7043TraceRec(CKDST_DEV dev, Bool doRead, unsigned regInx,
+                            const HMC7043_REG *pData, unsigned nRegs,
+                            STATUS status, SYS_TIME_NS nsecAt)
+{
+    Hmc7043_trace_ring *pRing = hmc7043TraceCtl.pDevRing[dev];
+    UINT32 head = sysAtomicLoadRelaxed(&pRing->head);
+    Hmc7043_trace_entry *pEntry =
+        pRing->entries + (head & (HMC7043_TRACE_NENTRIES - 1));
+
+    pEntry->nsecAt  = nsecAt;
+    pEntry->context = hmc7043IfCtl.devCtl[dev].csContext;
+    pEntry->regInx  = regInx;
+    pEntry->nRegs   = min(nRegs, 0xff);
+    pEntry->data    = pData[0];
+    pEntry->flags   = (doRead ? HMC7043_TRF_READ : 0) |
+                      (status != OK ? HMC7043_TRF_ERROR : 0);
+
+    sysAtomicStoreRel(&pRing->head, head + 1);
+}
+
+/* initialization profile (ref. hmc7043GetInitProfile), recorded and read
+   within the device's critical section; the phases do not nest, so a single
+   pair of transfer counter snapshots will do */
+typedef struct {
+    Hmc7043_init_profile prof;
+    UINT64 xfersAt, regsAt;  /* as of the start of the current phase */
+} Hmc7043_init_prof_ctl;
+
+LOCAL struct {
+    Hmc7043_init_prof_ctl *pDevProf[CKDST_MAX_NDEV];  /* ref. hmc7043PoolCtl */
+} hmc7043ProfCtl;
+
+INLINE void hmc7043ProfStart(CKDST_DEV dev, Bool warmInit)
+{
+    Hmc7043_init_prof_ctl *pProf = hmc7043ProfCtl.pDevProf[dev];
+
+    memset(&pProf->prof, 0, sizeof(pProf->prof));
+    pProf->prof.startNsec = sysTimeNsec();
+    pProf->prof.status    = ERROR;  /* until finished */
+    pProf->prof.warmInit  = warmInit;
+}
+
+INLINE void hmc7043ProfFinish(CKDST_DEV dev, STATUS status)
+{
+    Hmc7043_init_prof_ctl *pProf = hmc7043ProfCtl.pDevProf[dev];
+
+    pProf->prof.endNsec = sysTimeNsec();
+    pProf->prof.status  = status;
+}
+
+INLINE void hmc7043ProfBegin(CKDST_DEV dev, HMC7043_INIT_PHASE phase)
+{
+    Hmc7043_init_prof_ctl *pProf = hmc7043ProfCtl.pDevProf[dev];
+    const Hmc7043_dev_stats_ctl *pStats = hmc7043StatsCtl.pDevStats[dev];
+
+    pProf->xfersAt = sysAtomicLoadRelaxed(&pStats->nReads) +
+                     sysAtomicLoadRelaxed(&pStats->nWrites);
+    pProf->regsAt  = sysAtomicLoadRelaxed(&pStats->nRegsRead) +
+                     sysAtomicLoadRelaxed(&pStats->nRegsWritten);
+    pProf->prof.phases[phase].startNsec = sysTimeNsec();
+}
+
+/* (not called if the phase failed, its endNsec remaining 0) */
+INLINE void hmc7043ProfEnd(CKDST_DEV dev, HMC7043_INIT_PHASE phase)
+{
+    Hmc7043_init_prof_ctl *pProf = hmc7043ProfCtl.pDevProf[dev];
+    const Hmc7043_dev_stats_ctl *pStats = hmc7043StatsCtl.pDevStats[dev];
+    Hmc7043_init_phase_prof *pPhase = pProf->prof.phases + phase;
+
+    pPhase->endNsec = sysTimeNsec();
+    pPhase->nXfers  = sysAtomicLoadRelaxed(&pStats->nReads) +
+                      sysAtomicLoadRelaxed(&pStats->nWrites) - pProf->xfersAt;
+    pPhase->nRegs   = sysAtomicLoadRelaxed(&pStats->nRegsRead) +
+                      sysAtomicLoadRelaxed(&pStats->nRegsWritten) -
+                      pProf->regsAt;
+}
+
 /* forward references */
+LOCAL STATUS hmc7043PoolInit(CKDST_DEV_MASK devMask);
 LOCAL STATUS hmc7043LliInit(CKDST_DEV_MASK devMask);
 LOCAL STATUS hmc7043LliInitDev(CKDST_DEV dev, const Hmc7043_dev_io_if *pIf,
                                Bool warmInit);
 LOCAL STATUS hmc7043LliRegRead(CKDST_DEV dev, unsigned regInx,
                                HMC7043_REG *pData);
-LOCAL STATUS hmc7043LliRegWrite(CKDST_DEV dev, unsigned regInx,
-                                HMC7043_REG regData);
+LOCAL STATUS hmc7043LliRegReadInCs(CKDST_DEV dev, unsigned regInx,
+                                   HMC7043_REG *pData);
+LOCAL STATUS hmc7043LliRegWriteInCs(CKDST_DEV dev, unsigned regInx,
+                                    HMC7043_REG regData);
+LOCAL STATUS hmc7043LliRegReadBurstInCs(CKDST_DEV dev, unsigned regInx,
+                                        HMC7043_REG *pData, unsigned nRegs);
+LOCAL STATUS hmc7043LliRegWriteBurstInCs(CKDST_DEV dev, unsigned regInx,
+                                         const HMC7043_REG *pData,
+                                         unsigned nRegs);
 LOCAL STATUS hmc7043CsEnter(CKDST_DEV dev, const char *context);
 LOCAL STATUS hmc7043CsExit(CKDST_DEV dev, const char *context);
+LOCAL Bool hmc7043CsHeld(CKDST_DEV dev);
+LOCAL HMC7043_BUS_PRI hmc7043CsSetBusPri(CKDST_DEV dev, HMC7043_BUS_PRI pri);
+LOCAL Bool hmc7043BusAcquire(CKDST_BUS bus, HMC7043_BUS_PRI pri);
+LOCAL void hmc7043BusRelease(CKDST_BUS bus);
 LOCAL STATUS hmc7043AppIfInit(void);
 LOCAL STATUS hmc7043AppSetUpDevCtl(CKDST_DEV dev,
-                                   const Hmc7043_app_dev_params *pParams);
+                                   const Hmc7043_app_dev_params *pParams,
+                                   Bool validate);
+LOCAL CKDST_FREQ_HZ hmc7043AppClkInpFreq(const Hmc7043_app_dev_params *pParams);
+LOCAL STATUS hmc7043AppTimingInit(const Hmc7043_app_dev_params *pParams,
+                                  Hmc7043_timing *pTiming);
+LOCAL STATUS hmc7043AppPlanTiming(const Hmc7043_app_dev_params *pParams,
+                                  Hmc7043_ch_timing chTiming[]);
+LOCAL STATUS hmc7043InitDevAct(CKDST_DEV dev, const Hmc7043_dev_io_if *pIf,
+                               const Hmc7043_app_dev_params *pParams,
+                               Bool warmInit, Hmc7043_start_sync *pSync,
+                               const Hmc7043_cfg_blob_hdr *pBlob);
+LOCAL UINT64 hmc7043InitDevThread(const Sys_thread_args *pArgs);
+LOCAL STATUS hmc7043StartBarrierInit(Hmc7043_start_barrier *pBarrier,
+                                     unsigned nDevs);
+LOCAL void hmc7043StartBarrierWait(Hmc7043_start_barrier *pBarrier);
 STATUS hmc7043AppInitDev(CKDST_DEV dev, const Hmc7043_app_dev_params *pParams,
-		                       Bool warmInit);
+		                       Bool warmInit, Hmc7043_start_sync *pSync,
+		                       const Hmc7043_cfg_blob_hdr *pBlob);
+LOCAL STATUS hmc7043AppChkBlob(const Hmc7043_cfg_blob_hdr *pBlob, unsigned size);
 LOCAL STATUS hmc7043AppChkProdId(CKDST_DEV dev);
-LOCAL STATUS hmc7043LoadConfigUpd(CKDST_DEV dev);
-
-
-/* Dummy function for compilation: to be removed */
+LOCAL STATUS hmc7043AppInitStartUp(CKDST_DEV dev,
+                                   const Hmc7043_app_dev_params *pParams);
+LOCAL STATUS hmc7043AppWaitDone(CKDST_DEV dev, HMC7043_WAIT_OP op);
+LOCAL STATUS hmc7043AppChSyncDis(CKDST_DEV dev, HMC7043_CH_MASK chMask);
+LOCAL void hmc7043AppPersistImage(CKDST_DEV dev);
+LOCAL Bool hmc7043AppShadowRead(CKDST_DEV dev, unsigned regInx,
+                                HMC7043_REG *pData, unsigned nRegs,
+                                Bool selfClr);
+LOCAL void hmc7043AppShadowWrite(CKDST_DEV dev, unsigned regInx,
+                                 const HMC7043_REG *pData, unsigned nRegs);
+LOCAL void hmc7043StatsOp(CKDST_DEV dev, HMC7043_SERV_OP op, SYS_TIME_NS t0,
+                          STATUS status);
+LOCAL void hmc7043LogPost(Hmc7043_log_site *pSite, unsigned nArgs, ...);
+
+
+/* Dummy function for compilation: to be removed (the benchmark harness,
+   hmc7043bench.c, provides working versions of these) */
+#ifndef HMC7043_BENCH
 STATUS sysLogIntFun (unsigned, const char *, const char *, ...)
 {
 	return OK;
@@ -123,6 +510,69 @@ void sysDelayUsec(UINT64)
 {
     return;
 }
+void sysDelayUsecBusy(unsigned)
+{
+    return;
+}
+SYS_TIME_NS sysTimeNsec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * (SYS_TIME_NS) 1000000000 + ts.tv_nsec;
+}
+STATUS sysThreadCreateEx(unsigned, unsigned, SYS_THREAD_FUNC *, UINT32,
+                         const Sys_thread_args *, SYS_THREAD_OPTS)
+{
+    return ERROR;
+}
+STATUS sysThreadStart(unsigned, unsigned)
+{
+    return OK;
+}
+STATUS sysThreadWait4Exit(unsigned, unsigned, SYS_TIME, UINT64 *)
+{
+    return ERROR;
+}
+STATUS sysRegisterAutoDelResource(const char *, Bool, SYS_RESOURCE_DELETE_FUNC *)
+{
+    return OK;
+}
+STATUS utlByteDump(const void *, size_t, unsigned)
+{
+    return OK;
+}
+HUTL_QUEUE utlQueueCreate(size_t, size_t, UTL_Q_STAT *)
+{
+    return UTL_QUEUE_BAD_HQUEUE;
+}
+STATUS utlQueueDelete(HUTL_QUEUE, UTL_Q_STAT *)
+{
+    return ERROR;
+}
+STATUS utlQueuePut(HUTL_QUEUE, const void *, size_t, UTL_Q_STAT *)
+{
+    return ERROR;
+}
+STATUS utlQueueGet(HUTL_QUEUE, void *, size_t *, SYS_TIME, UTL_Q_STAT *)
+{
+    return ERROR;
+}
+void sysCodeErrSetAppHook(SYS_CODE_ERR_APP_HOOK *)
+{
+    return;
+}
+STATUS sysThreadCreatePerServ(unsigned, unsigned,
+                              const Sys_thread_per_serv_args *)
+{
+    return ERROR;
+}
+STATUS sysThreadCreate(unsigned, unsigned, SYS_THREAD_FUNC *, UINT32,
+                       const Sys_thread_args *)
+{
+    return ERROR;
+}
+#endif /* HMC7043_BENCH */
 /*#############################################################################*
 *    I N I T I A L I Z A T I O N    A N D    O V E R A L L    C O N T R O L    *
 *#############################################################################*/
@@ -134,23 +584,43 @@ void sysDelayUsec(UINT64)
 *
 * - input: devMask   - specifies the CLKDST device(s) that will be used
 *
-* - output: hmc7043IfCtl
+* - output: hmc7043IfCtl, hmc7043PoolCtl
 *
 * - returns: OK or ERROR if detected an error
 *
-* - description: as above
+* - description: as above, the per-device state only being allocated for the
+*                devices in devMask (ref. hmc7043PoolInit)
 *
-* - notes: this routine can be called more than once
+* - notes: this routine can be called more than once (the state of all the
+*          devices being discarded then), but only until any of the background
+*          services using the per-device state (the monitor, alarm GPIO,
+*          deferred commit, asynchronous executor or statistics dump threads)
+*          has been started, since these are not stopped here
 *******************************************************************************/
 STATUS hmc7043IfInit(CKDST_DEV_MASK devMask)
 {
     unsigned i = 0;
 
-    if (!devMask || devMask >= 1 << NELEMENTS(hmc7043IfCtl.devCtl)) {
-        sysLog("bad argument(s) (devMask 0x%x)", &devMask != NULL);
+    if (!devMask) {
+        sysLog("bad argument(s) (devMask 0x%08x%08x)", SL64(devMask));
+        return ERROR;
+    }
+
+    if (sysAtomicLoadAcq(&hmc7043IfCtl.bgStarted)) {
+        sysLog("background services running, cannot reinitialize (devMask "
+               "0x%08x%08x)", SL64(devMask));
         return ERROR;
     }
 
+    hmc7043IfCtl.devMask  = 0;  /* (until the pool is set up) */
+    hmc7043IfCtl.liveMask = 0;
+
+    for (i = 0; i < NELEMENTS(hmc7043IfCtl.busDevMask); ++i)
+        hmc7043IfCtl.busDevMask[i] = 0;
+
+    if (hmc7043PoolInit(devMask) != OK)
+        return ERROR;
+
     hmc7043IfCtl.devMask  = devMask;
 
     for (i = 0; i < NELEMENTS(hmc7043IfCtl.devCtl); ++i) {
@@ -158,9 +628,10 @@ STATUS hmc7043IfInit(CKDST_DEV_MASK devMask)
 
         pDev->initDone = FALSE;
         pDev->hMutex   = UTL_MUTEX_BAD_HMUTEX;
+        pDev->csDepth  = 0;
     }
 
-    hmc7043IfCtl.initDone = TRUE;
+    sysAtomicStoreRel(&hmc7043IfCtl.initDone, TRUE);
 
     if (hmc7043LliInit(devMask) != OK)
         return ERROR;
@@ -171,6 +642,35 @@ STATUS hmc7043IfInit(CKDST_DEV_MASK devMask)
 
     return OK;
 }
+
+/*******************************************************************************
+* - name: hmc7043GetDevMask
+*
+* - title: get the devices that are up
+*
+* - input: bus - SPI bus (ref. Hmc7043_dev_io_if), or CKDST_BUS_ANY
+*
+* - returns: the devices on the bus (or on any bus) last initialized OK, or 0 if
+*            detected an error
+*
+* - description: as above (meant for multi-device operations to only iterate
+*                over the devices actually up, e.g. using CKDST_FOR_EACH_DEV)
+*******************************************************************************/
+EXPORT CKDST_DEV_MASK hmc7043GetDevMask(CKDST_BUS bus)
+{
+    CKDST_DEV_MASK liveMask = sysAtomicLoadRelaxed(&hmc7043IfCtl.liveMask);
+
+    if (bus == CKDST_BUS_ANY)
+        return liveMask;
+
+    if (!inEnumRange(bus, NELEMENTS(hmc7043IfCtl.busDevMask))) {
+        sysLog("bad argument (bus %u)", bus);
+        return 0;
+    }
+
+    return liveMask & sysAtomicLoadRelaxed(hmc7043IfCtl.busDevMask + bus);
+}
+
 /*******************************************************************************
 * - name: hmc7043InitDev
 *
@@ -187,10 +687,262 @@ STATUS hmc7043IfInit(CKDST_DEV_MASK devMask)
 *******************************************************************************/
 STATUS hmc7043InitDev(CKDST_DEV dev, const Hmc7043_dev_io_if *pIf,
                       const Hmc7043_app_dev_params *pParams, Bool warmInit)
+{
+    return hmc7043InitDevAct(dev, pIf, pParams, warmInit, NULL, NULL);
+}
+
+/*******************************************************************************
+* - name: hmc7043InitDevFromBlob
+*
+* - title: initialize the specific CLKDST device from a precompiled configuration
+*
+* - input: dev   - CLKDST to be initialized
+*          pIf   - pointer to low-level interface access-related parameters
+*          pBlob - configuration blob (as returned from hmc7043CompileParams)
+*          size  - size of the blob (bytes)
+*
+* - returns: OK or ERROR if detected an error (if at all)
+*
+* - description: same as a (cold) hmc7043InitDev with the parameters the blob
+*                was compiled from, except that the parameters are not validated
+*                again nor converted to register settings (the blob's register
+*                image being written to the device as is)
+*
+* - notes: the blob must be aligned as Hmc7043_app_dev_params would be and
+*          compiled by the same build of this module (which is verified as far
+*          as the blob version and sizes go)
+*******************************************************************************/
+STATUS hmc7043InitDevFromBlob(CKDST_DEV dev, const Hmc7043_dev_io_if *pIf,
+                              const void *pBlob, unsigned size)
+{
+    const Hmc7043_cfg_blob_hdr *pHdr = (const Hmc7043_cfg_blob_hdr *) pBlob;
+
+    if (hmc7043AppChkBlob(pHdr, size) != OK)
+        return ERROR;
+
+    return hmc7043InitDevAct(dev, pIf, (const Hmc7043_app_dev_params *)
+                             (pHdr + 1), FALSE, NULL, pHdr);
+}
+
+/*******************************************************************************
+* - name: hmc7043InitDevMulti
+*
+* - title: initialize multiple CLKDST devices concurrently
+*
+* - input: devMask   - specifies the CLKDST device(s) to be initialized
+*          ifs       - low-level interface access-related parameters (indexed by
+*                      device; only entries in devMask are used)
+*          params    - application-level device setup parameters (as above)
+*          warmInit  - if set, will skip actual device initialization
+*          thrCode   - thread code for the worker threads (must support multiple
+*                      threads, with the device as the subcode)
+*          devStatus - where to return per-device status (as above; may be NULL)
+*
+* - output: devStatus[] (only entries in devMask)
+*
+* - returns: OK or ERROR if detected an error (for any of the devices)
+*
+* - description: initializes each device on its own worker thread (i.e. the
+*                programming sequence waits overlap), all of the devices being
+*                synchronized right before their final start-up step (reseed
+*                and initial pulse generator stream, ref. hmc7043AppInitStartUp)
+*
+* - notes: 1) Same as hmc7043InitDev for each of the devices otherwise.
+*          2) A device that fails before reaching the start-up step still
+*             releases the others.
+*******************************************************************************/
+STATUS hmc7043InitDevMulti(CKDST_DEV_MASK devMask, const Hmc7043_dev_io_if ifs[],
+                           const Hmc7043_app_dev_params params[], Bool warmInit,
+                           unsigned thrCode, STATUS devStatus[])
+{
+    static const UINT32 STACK_SIZE = 0x10000;  /* more than enough */
+
+    Hmc7043_init_multi_ctl ctl;
+    CKDST_DEV_MASK thrMask = 0;
+    unsigned nThreads = 0;
+    STATUS status = OK;  /* initial assumption */
+    CKDST_DEV dev;
+
+    /* initialize */
+    if (!devMask || devMask & ~hmc7043IfCtl.devMask || !ifs || !params) {
+        sysLog("bad argument(s) (devMask 0x%08x%08x, ifs %d, params %d)",
+               SL64(devMask), ifs != NULL, params != NULL);
+        return ERROR;
+    }
+
+    ctl.ifs      = ifs;
+    ctl.params   = params;
+    ctl.warmInit  = warmInit;
+    ctl.noBarrier = FALSE;
+
+    /* create the worker threads (initially suspended, so that the barrier is
+       only set up for those that were actually created) */
+    CKDST_FOR_EACH_DEV(dev, devMask) {
+        Sys_thread_args args = {dev, (UINT64) &ctl, 0};
+
+        if (sysThreadCreateEx(thrCode, dev, hmc7043InitDevThread, STACK_SIZE,
+                              &args, SYS_THREAD_OPTS_WAITABLE |
+                              SYS_THREAD_OPTS_SUSPENDED) != OK) {
+            sysLog("worker thread creation failed (dev %d)", dev);
+            continue;
+        }
+
+        thrMask |= CKDST_DEV_BIT(dev);
+        ++nThreads;
+    }
+
+    if (nThreads && hmc7043StartBarrierInit(&ctl.barrier, nThreads) != OK)
+        ctl.noBarrier = TRUE;  /* (the threads still run, failing at once) */
+
+    /* run the worker threads and collect the results */
+    CKDST_FOR_EACH_DEV(dev, thrMask)
+        if (sysThreadStart(thrCode, dev) != OK) {
+            /* can only happen due to a code error: no way to recover */
+            sysCodeError(CODE_ERR_STATE, hmc7043InitDevMulti, thrCode, dev, -1);
+            return ERROR;
+        }
+
+    CKDST_FOR_EACH_DEV(dev, devMask) {
+        STATUS devStat = ERROR;  /* initial assumption */
+        UINT64 exitCode;
+
+        if (thrMask & CKDST_DEV_BIT(dev) &&
+            sysThreadWait4Exit(thrCode, dev, SYS_TIME_INFINITE, &exitCode) == OK)
+            devStat = (STATUS) exitCode;
+
+        if (devStat != OK)
+            status = ERROR;
+
+        if (devStatus)
+            devStatus[dev] = devStat;
+    }
+
+    if (thrMask && !ctl.noBarrier)
+        utlQueueDelete(ctl.barrier.hRelease, NULL);
+
+    return status;
+}
+
+/*******************************************************************************
+* - name: hmc7043InitDevThread
+*
+* - title: hmc7043InitDevMulti worker thread
+*
+* - input: pArgs->arg1 - CLKDST device to be initialized
+*          pArgs->arg2 - pointer to the associated Hmc7043_init_multi_ctl
+*
+* - returns: status returned from hmc7043InitDevAct (ERROR if the barrier could
+*            not be set up)
+*
+* - description: as above
+*******************************************************************************/
+LOCAL UINT64 hmc7043InitDevThread(const Sys_thread_args *pArgs)
+{
+    CKDST_DEV dev = (CKDST_DEV) pArgs->arg1;
+    Hmc7043_init_multi_ctl *pCtl = (Hmc7043_init_multi_ctl *) pArgs->arg2;
+    Hmc7043_start_sync sync = {&pCtl->barrier, FALSE};
+    STATUS status;
+
+    if (pCtl->noBarrier)
+        return (UINT64) ERROR;
+
+    status = hmc7043InitDevAct(dev, pCtl->ifs + dev, pCtl->params + dev,
+                               pCtl->warmInit, &sync, NULL);
+
+    /* release the other devices if this one never got to the barrier */
+    if (!sync.waited)
+        hmc7043StartBarrierWait(sync.pBarrier);
+
+    return (UINT64) status;
+}
+
+/*******************************************************************************
+* - name: hmc7043StartBarrierInit
+*
+* - title: set up the start-up barrier of concurrently initialized devices
+*
+* - input: pBarrier - the barrier
+*          nDevs    - number of devices to synchronize
+*
+* - output: *pBarrier
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above (ref. Hmc7043_start_barrier), the release queue to
+*                be deleted once all of the devices are past the barrier
+*******************************************************************************/
+LOCAL STATUS hmc7043StartBarrierInit(Hmc7043_start_barrier *pBarrier,
+                                     unsigned nDevs)
+{
+    pBarrier->nDevs = nDevs;
+    sysAtomicStoreRelaxed(&pBarrier->nArrived, 0);
+
+    /* (a message for each of the devices but the last one) */
+    if ((pBarrier->hRelease = utlQueueCreate(max(nDevs, 2) - 1, sizeof(UINT8),
+                                             NULL)) == UTL_QUEUE_BAD_HQUEUE) {
+        sysLog("release queue creation failed (nDevs %u)", nDevs);
+        return ERROR;
+    }
+
+    return OK;
+}
+
+/*******************************************************************************
+* - name: hmc7043StartBarrierWait
+*
+* - title: wait at the start-up barrier of concurrently initialized devices
+*
+* - input: pBarrier - the barrier (ref. hmc7043StartBarrierInit)
+*
+* - description: waits until all of the devices have reached the barrier (each
+*                reaching it exactly once)
+*******************************************************************************/
+LOCAL void hmc7043StartBarrierWait(Hmc7043_start_barrier *pBarrier)
+{
+    UINT8 release = 0;
+    size_t nBytes = sizeof(release);
+    unsigned i;
+
+    if (sysAtomicAdd(&pBarrier->nArrived, 1) + 1 == pBarrier->nDevs) {
+        for (i = 1; i < pBarrier->nDevs; ++i)
+            if (utlQueuePut(pBarrier->hRelease, &release, sizeof(release),
+                            NULL) != OK)
+                sysCodeError(CODE_ERR_STATE, hmc7043StartBarrierWait, i,
+                             pBarrier->nDevs, -1);
+    } else if (utlQueueGet(pBarrier->hRelease, &release, &nBytes,
+                           UTL_Q_TO_INFINITE, NULL) != OK)
+        sysCodeError(CODE_ERR_STATE, hmc7043StartBarrierWait,
+                     pBarrier->nDevs, -1, -1);
+}
+
+/*******************************************************************************
+* - name: hmc7043InitDevAct
+*
+* - title: actually initialize the specific CLKDST device
+*
+* - input: dev      - CLKDST to be initialized
+*          pIf      - pointer to low-level interface access-related parameters
+*          pParams  - application-level device setup parameters
+*          warminit - if set, will skip actual device initialization
+*          pSync    - start-up synchronization data (NULL if not applicable)
+*          pBlob    - precompiled configuration (NULL if not applicable, else
+*                     pParams must be the blob's parameters)
+*
+* - output: *pSync (indirectly), *hmc7043ProfCtl.pDevProf[dev]
+*
+* - returns: OK or ERROR if detected an error (if at all)
+*
+* - description: as above
+*******************************************************************************/
+LOCAL STATUS hmc7043InitDevAct(CKDST_DEV dev, const Hmc7043_dev_io_if *pIf,
+                               const Hmc7043_app_dev_params *pParams,
+                               Bool warmInit, Hmc7043_start_sync *pSync,
+                               const Hmc7043_cfg_blob_hdr *pBlob)
 {
     static const SYS_TIME MUTEX_TIMEOUT = 200;  /* msec; adequately large */
 
     Hmc7043_dev_ctl *pCtl;
+    SYS_TIME_NS t0;
 
     /* initialize */
     STATUS status = OK;  /* initial assumption */
@@ -206,6 +958,11 @@ STATUS hmc7043InitDev(CKDST_DEV dev, const Hmc7043_dev_io_if *pIf,
         return ERROR;
     }
 
+    if (!hmc7043DevPresent(dev)) {
+        sysLog("device not in the interface device mask (dev %d)", dev);
+        return ERROR;
+    }
+
     pCtl = hmc7043IfCtl.devCtl + dev;
 
     if (pCtl->initDone && pCtl->hMutex == UTL_MUTEX_BAD_HMUTEX) {
@@ -226,15 +983,31 @@ STATUS hmc7043InitDev(CKDST_DEV dev, const Hmc7043_dev_io_if *pIf,
     pCtl->initDone = TRUE;  /* must be done before the subsequent code */
 
     /* perform actual initialization */
+    t0 = sysTimeNsec();
     hmc7043CsEnter(dev, __FUNCTION__);
+    hmc7043ProfStart(dev, warmInit);
+
+    hmc7043ProfBegin(dev, HMC7043_IPH_LLI_INIT);
 
     if (hmc7043LliInitDev(dev, pIf, warmInit) != OK)
         status = ERROR;
-    else if (hmc7043AppInitDev(dev, pParams, warmInit) != OK)
-        status = ERROR;
+    else {
+        hmc7043ProfEnd(dev, HMC7043_IPH_LLI_INIT);
 
+        if (hmc7043AppInitDev(dev, pParams, warmInit, pSync, pBlob) != OK)
+            status = ERROR;
+    }
+
+    if (status == OK)
+        sysAtomicOr(&hmc7043IfCtl.liveMask, CKDST_DEV_BIT(dev));
+    else
+        sysAtomicAnd(&hmc7043IfCtl.liveMask, ~CKDST_DEV_BIT(dev));
+
+    hmc7043ProfFinish(dev, status);
     hmc7043CsExit(dev, __FUNCTION__);
 
+    hmc7043StatsOp(dev, HMC7043_SOP_INIT_DEV, t0, status);
+
     return status;
 }
 
@@ -244,7 +1017,8 @@ STATUS hmc7043InitDev(CKDST_DEV dev, const Hmc7043_dev_io_if *pIf,
 * - title: enter critical section
 *
 * - input: dev     - CLKDST device for which to perform the operation
-*          context - caller context (only used for debugging)
+*          context - caller context (a static string, only used for
+*                    debugging)
 *
 * - returns: OK or ERROR if detected an error (if at all)
 *
@@ -252,31 +1026,49 @@ STATUS hmc7043InitDev(CKDST_DEV dev, const Hmc7043_dev_io_if *pIf,
 *******************************************************************************/
 LOCAL STATUS hmc7043CsEnter(CKDST_DEV dev, const char *context)
 {
-    const Hmc7043_dev_ctl *pCtl;
+    Hmc7043_dev_ctl *pCtl;
+    SYS_TIME_NS t0;
 
     /* initialize */
     context = context ? context : "???";
 
     if (!inEnumRange(dev, NELEMENTS(hmc7043IfCtl.devCtl))) {
-        sysLogLong(" (from '%s'): bad argument(s) (dev %ld)", context,
-                   (long) dev);
+        hmc7043LogLong(" (from '%s'): bad argument(s) (dev %ld)", context,
+                       (long) dev);
         return ERROR;
     }
 
     pCtl = hmc7043IfCtl.devCtl + dev;
 
     if (!pCtl->initDone || pCtl->hMutex == UTL_MUTEX_BAD_HMUTEX) {
-        sysLogLong(" (from '%s'): bad state for dev %ld (initDone %ld, "
-                   "hMutex %ld)", context, (long) dev, (long) pCtl->initDone,
-                   (long) (pCtl->hMutex != UTL_MUTEX_BAD_HMUTEX));
+        hmc7043LogLong(" (from '%s'): bad state for dev %ld (initDone %ld, "
+                       "hMutex %ld)", context, (long) dev,
+                       (long) pCtl->initDone,
+                       (long) (pCtl->hMutex != UTL_MUTEX_BAD_HMUTEX));
         return ERROR;
     }
 
+    t0 = sysTimeNsec();
+
     if (utlMutexTake(pCtl->hMutex, context) != OK) {
         sysCodeError(CODE_ERR_STATE, hmc7043CsEnter, context, dev, -1);
         return ERROR;
     }
 
+    /* (the mutex is recursive, so the critical section may be nested) */
+    if (!pCtl->csDepth++) {
+        Hmc7043_dev_stats_ctl *pStats = hmc7043StatsCtl.pDevStats[dev];
+        UINT64 waitNsec = sysTimeNsec() - t0;
+
+        pCtl->csOwner   = pthread_self();
+        pCtl->csContext = context;
+        pCtl->busPri    = HMC7043_BPRI_NORMAL;
+
+        sysAtomicAddRelaxed(&pStats->nCsEnters, 1);
+        sysAtomicAddRelaxed(&pStats->csWaitNsec, waitNsec);
+        hmc7043StatsMax(&pStats->csMaxWaitNsec, waitNsec);
+    }
+
     return OK;
 }
 
@@ -286,7 +1078,8 @@ LOCAL STATUS hmc7043CsEnter(CKDST_DEV dev, const char *context)
 * - title: exit critical section
 *
 * - input: dev     - CLKDST device for which to perform the operation
-*          context - caller context (only used for debugging)
+*          context - caller context (a static string, only used for
+*                    debugging)
 *
 * - returns: ERROR if detected an error or the status returned from utlMutexRelease
 *
@@ -294,43 +1087,104 @@ LOCAL STATUS hmc7043CsEnter(CKDST_DEV dev, const char *context)
 *******************************************************************************/
 LOCAL STATUS hmc7043CsExit(CKDST_DEV dev, const char *context)
 {
-    const Hmc7043_dev_ctl *pCtl;
+    Hmc7043_dev_ctl *pCtl;
 
     /* initialize */
     context = context ? context : "???";
 
     if (!inEnumRange(dev, NELEMENTS(hmc7043IfCtl.devCtl))) {
-        sysLogLong(" (from '%s'): bad argument(s) (dev %ld)", context,
-                   (long) dev);
+        hmc7043LogLong(" (from '%s'): bad argument(s) (dev %ld)", context,
+                       (long) dev);
         return ERROR;
     }
 
     pCtl = hmc7043IfCtl.devCtl + dev;
 
     if (!pCtl->initDone || pCtl->hMutex == UTL_MUTEX_BAD_HMUTEX) {
-        sysLogLong(" (from '%s'): bad state for dev %ld (initDone %ld, "
-                   "hMutex %ld)", context, (long) dev, (long) pCtl->initDone,
-                   (long) (pCtl->hMutex != UTL_MUTEX_BAD_HMUTEX));
+        hmc7043LogLong(" (from '%s'): bad state for dev %ld (initDone %ld, "
+                       "hMutex %ld)", context, (long) dev,
+                       (long) pCtl->initDone,
+                       (long) (pCtl->hMutex != UTL_MUTEX_BAD_HMUTEX));
+        return ERROR;
+    }
+
+    if (!hmc7043CsHeld(dev)) {
+        sysCodeError(CODE_ERR_STATE, hmc7043CsExit, context, dev,
+                     pCtl->csDepth);
         return ERROR;
     }
 
+    --pCtl->csDepth;
+
     return utlMutexRelease(pCtl->hMutex, context);
 }
 
 /*******************************************************************************
-* - name: hmc7043RegRead
+* - name: hmc7043CsHeld
 *
-* - title: read a CLKDST register
+* - title: check whether the calling thread holds the critical section
 *
-* - input: dev    - CLKDST device for which to perform the operation
-*          regInx - CLKDST register to read
-*          pData  - pointer to where to return read data
+* - input: dev - CLKDST device for which to perform the operation
+*
+* - returns: TRUE if so, FALSE otherwise (or if detected an error)
+*
+* - description: as above
+*
+* - notes: the owner is only valid while the depth is non-zero, but a thread can
+*          only find itself to be the owner if it actually holds the mutex
+*******************************************************************************/
+LOCAL Bool hmc7043CsHeld(CKDST_DEV dev)
+{
+    const Hmc7043_dev_ctl *pCtl;
+
+    if (!inEnumRange(dev, NELEMENTS(hmc7043IfCtl.devCtl)))
+        return FALSE;
+
+    pCtl = hmc7043IfCtl.devCtl + dev;
+
+    return pCtl->csDepth && pthread_equal(pCtl->csOwner, pthread_self());
+}
+
+/*******************************************************************************
+* - name: hmc7043CsSetBusPri
+*
+* - title: set the bus priority class of the critical section owner's transfers
+*
+* - input: dev - CLKDST device for which to perform the operation
+*          pri - the priority class
+*
+* - returns: the previous priority class (to be restored if applicable)
+*
+* - description: as above (ref. hmc7043SetBusArbitration), the class being
+*                reset to HMC7043_BPRI_NORMAL by the outermost hmc7043CsEnter
+*
+* - notes: the caller must hold the associated critical section
+*******************************************************************************/
+LOCAL HMC7043_BUS_PRI hmc7043CsSetBusPri(CKDST_DEV dev, HMC7043_BUS_PRI pri)
+{
+    Hmc7043_dev_ctl *pCtl = hmc7043IfCtl.devCtl + dev;
+    HMC7043_BUS_PRI prev = pCtl->busPri;
+
+    HMC7043_CS_ASSERT_HELD(dev);
+
+    pCtl->busPri = pri;
+    return prev;
+}
+
+/*******************************************************************************
+* - name: hmc7043RegRead
+*
+* - title: read a CLKDST register
+*
+* - input: dev    - CLKDST device for which to perform the operation
+*          regInx - CLKDST register to read
+*          pData  - pointer to where to return read data
 *
 * - output: *pData (indirectly)
 *
 * - returns: OK or ERROR if detected an error
 *
-* - description: as above
+* - description: as hmc7043RegReadBurst (for a single register)
 *
 * - notes: HMC7043 registers are 8-bit wide
 *******************************************************************************/
@@ -338,7 +1192,7 @@ EXPORT STATUS hmc7043RegRead(CKDST_DEV dev, unsigned regInx, HMC7043_REG *pData)
 {
     HMC7043_REG regData;
 
-    if (hmc7043LliRegRead(dev, regInx, &regData) != OK)
+    if (hmc7043RegReadBurst(dev, regInx, &regData, 1) != OK)
         return ERROR;
 
     *pData = regData;
@@ -357,13 +1211,85 @@ EXPORT STATUS hmc7043RegRead(CKDST_DEV dev, unsigned regInx, HMC7043_REG *pData)
 *
 * - returns: OK or ERROR if detected an error
 *
-* - description: as above
+* - description: as hmc7043RegWriteBurst (for a single register)
 *
 * - notes: HMC7043 registers are 8-bit wide
 *******************************************************************************/
 EXPORT STATUS hmc7043RegWrite(CKDST_DEV dev, unsigned regInx, HMC7043_REG regData)
 {
-    return hmc7043LliRegWrite(dev, regInx, regData);
+    return hmc7043RegWriteBurst(dev, regInx, &regData, 1);
+}
+
+/*******************************************************************************
+* - name: hmc7043RegReadBurst
+*
+* - title: read a run of contiguous CLKDST registers
+*
+* - input: dev    - CLKDST device for which to perform the operation
+*          regInx - first CLKDST register to read
+*          pData  - pointer to where to return read data (nRegs entries)
+*          nRegs  - number of registers to read
+*
+* - output: pData[0 .. nRegs - 1] (indirectly)
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: served from the device image if all the registers are control
+*                registers whose device value is known (ref.
+*                hmc7043AppShadowRead), otherwise read from the device
+*
+* - notes: HMC7043 registers are 8-bit wide
+*******************************************************************************/
+EXPORT STATUS hmc7043RegReadBurst(CKDST_DEV dev, unsigned regInx,
+                                  HMC7043_REG *pData, unsigned nRegs)
+{
+    STATUS status = OK;
+
+    if (hmc7043CsEnter(dev, __FUNCTION__) != OK)
+        return ERROR;
+
+    if (!hmc7043AppShadowRead(dev, regInx, pData, nRegs, FALSE))
+        status = hmc7043LliRegReadBurstInCs(dev, regInx, pData, nRegs);
+
+    hmc7043CsExit(dev, __FUNCTION__);
+
+    return status;
+}
+
+/*******************************************************************************
+* - name: hmc7043RegWriteBurst
+*
+* - title: write a run of contiguous CLKDST registers
+*
+* - input: dev     - CLKDST device for which to perform the operation
+*          regInx  - first CLKDST register to write
+*          pData   - raw data to write to the registers (nRegs entries)
+*          nRegs   - number of registers to write
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above, keeping the device image up to date (ref.
+*                hmc7043AppShadowWrite)
+*
+* - notes: 1) HMC7043 registers are 8-bit wide.
+*          2) Control registers written this way are restored to their
+*             register image setup by the next flush of the device.
+*******************************************************************************/
+EXPORT STATUS hmc7043RegWriteBurst(CKDST_DEV dev, unsigned regInx,
+                                   const HMC7043_REG *pData, unsigned nRegs)
+{
+    STATUS status;
+
+    if (hmc7043CsEnter(dev, __FUNCTION__) != OK)
+        return ERROR;
+
+    status = hmc7043LliRegWriteBurstInCs(dev, regInx, pData, nRegs);
+
+    hmc7043AppShadowWrite(dev, regInx, status == OK ? pData : NULL, nRegs);
+
+    hmc7043CsExit(dev, __FUNCTION__);
+
+    return status;
 }
 
 
@@ -390,8 +1316,8 @@ LOCAL STATUS hmc7043LliInit(CKDST_DEV_MASK devMask)
 {
     unsigned i;
 
-    if (!devMask || devMask >= 1 << NELEMENTS(hmc7043LliCtl.devCtl)) {
-        sysLog("bad argument (devMask 0x%x)", devMask);
+    if (!devMask) {
+        sysLog("bad argument (devMask 0x%08x%08x)", SL64(devMask));
         return ERROR;
     }
 
@@ -401,6 +1327,26 @@ LOCAL STATUS hmc7043LliInit(CKDST_DEV_MASK devMask)
     for (i = 0; i < NELEMENTS(hmc7043LliCtl.devCtl); ++i)
         memset(&hmc7043LliCtl.devCtl[i], 0, sizeof(hmc7043LliCtl.devCtl[i]));
 
+    /* (all buses unarbitrated; the mutex is only held for the bookkeeping,
+       hence taken without a timeout) */
+    for (i = 0; i < NELEMENTS(hmc7043BusCtl.busCtl); ++i) {
+        Hmc7043_bus_ctl *pBus = hmc7043BusCtl.busCtl + i;
+
+        if (pBus->hMutex == UTL_MUTEX_BAD_HMUTEX &&
+            (pBus->hMutex = utlMutexCreate(SYS_TIME_INFINITE)) ==
+            UTL_MUTEX_BAD_HMUTEX) {
+            sysLog("bus mutex creation failed (bus %u)", i);
+            return ERROR;
+        }
+
+        sysAtomicStoreRelaxed(&pBus->enabled, FALSE);
+        pBus->busy = FALSE;
+        memset(pBus->nWaiting, 0, sizeof(pBus->nWaiting));
+        memset(&pBus->stats, 0, sizeof(pBus->stats));
+    }
+
+    hmc7043BusCtl.initDone = TRUE;
+
     hmc7043LliCtl.initDone = TRUE;
 
     return OK;
@@ -426,6 +1372,8 @@ LOCAL STATUS hmc7043LliInit(CKDST_DEV_MASK devMask)
 LOCAL STATUS hmc7043LliInitDev(CKDST_DEV dev, const Hmc7043_dev_io_if *pIf,
                                Bool warmInit)
 {
+    unsigned i;
+
     UNREFERENCED_PARAMETER(warmInit);
 
     /* validate arguments and initialize */
@@ -448,80 +1396,176 @@ LOCAL STATUS hmc7043LliInitDev(CKDST_DEV dev, const Hmc7043_dev_io_if *pIf,
         return ERROR;
     }
 
-    if (!((1 << dev) & hmc7043LliCtl.devMask)) {
-        sysLog("unexpected device (%d; devMask 0x%08x)", dev,
-               hmc7043LliCtl.devMask);
+    if (!(CKDST_DEV_BIT(dev) & hmc7043LliCtl.devMask)) {
+        sysLog("unexpected device (%d; devMask 0x%08x%08x)", dev,
+               SL64(hmc7043LliCtl.devMask));
+        return ERROR;
+    }
+
+    if (!inEnumRange(pIf->bus, NELEMENTS(hmc7043IfCtl.busDevMask))) {
+        sysLog("bad argument(s) (3, dev %d, bus %u)", dev, pIf->bus);
         return ERROR;
     }
 
     /* set up control data */
     hmc7043LliCtl.devCtl[dev].ioIf = *pIf;
 
+    for (i = 0; i < NELEMENTS(hmc7043IfCtl.busDevMask); ++i)
+        if (i == pIf->bus)
+            sysAtomicOr(hmc7043IfCtl.busDevMask + i, CKDST_DEV_BIT(dev));
+        else
+            sysAtomicAnd(hmc7043IfCtl.busDevMask + i, ~CKDST_DEV_BIT(dev));
+
     return OK;
 }
 
 /*******************************************************************************
-* - name: hmc7043LliRegIoAct
+* - name: hmc7043LliRegXferInCs
 *
-* - title: rad/write a device register via SPI
+* - title: read/write a run of contiguous device registers via SPI (within the
+*          associated critical section)
 *
 * - input: doRead - TRUE / FALSE to perform read / write, respectively
 *          dev    - CLKDST device for which to perform the operation
-*          regInx - CLKDST register to read / write
-*          pData  - pointer to register data
-*
-* - output: *pData (only for a read operation)
-*
-* - returns: OK or ERROR if detected an error (in which case *pData is unusable)
-*
-* - description: as above
-*
-* - notes: 1) The operation is interlocked via the associated critical section.
+*          regInx - first CLKDST register to read / write
+*          pData  - pointer to register data (nRegs entries)
+*          nRegs  - number of registers to read / write
+*
+* - output: pData[0 .. nRegs - 1] (only for a read operation)
+*
+* - returns: OK or ERROR if detected an error (in which case pData is unusable)
+*
+* - description: uses the backend's burst (auto-increment) callback for more
+*                than a single register if one is provided, otherwise falls back
+*                to per-register transfers; on an arbitrated bus (ref.
+*                hmc7043SetBusArbitration) the run is split into chunks of up
+*                to HMC7043_BUS_CHUNK_NREGS registers, each being granted the
+*                bus at the critical section owner's priority class; every
+*                transfer (chunk) is accounted for in the statistics, and the
+*                run recorded in the device's trace ring (ref. hmc7043GetTrace)
+*
+* - notes: 1) This is the inner (lock-free) path - the caller must hold the
+*             associated critical section (ref. hmc7043CsEnter), which is
+*             checked in debug builds.
 *          2) It is assumed that hmc7043LliInit has already been invoked.
 *******************************************************************************/
-LOCAL STATUS hmc7043LliRegIoAct(Bool doRead, CKDST_DEV dev, unsigned regInx,
-                                HMC7043_REG *pData)
+LOCAL STATUS hmc7043LliRegXferInCs(Bool doRead, CKDST_DEV dev, unsigned regInx,
+                                   HMC7043_REG *pData, unsigned nRegs)
 {
-    STATUS status;
+    STATUS status = OK;  /* initial assumption */
     const Hmc7043_dev_io_if *pCtl;
+    Hmc7043_dev_stats_ctl *pStats;
+    HMC7043_BUS_PRI pri;
+    SYS_TIME_NS t0, t1 = 0;
+    unsigned i, done, n, nXfers = 0;
+    Bool arbitrated;
 
     /* validate arguments and initialize */
-    if (!inEnumRange(dev, NELEMENTS(hmc7043LliCtl.devCtl)) ||
-        regInx < HMC7043_REG_INX_MIN || regInx > HMC7043_REG_INX_MAX || !pData) {
-        sysLog("invalid argument(s) (doRead %d, dev %d, regInx %u, pData %d)",
-               doRead, dev, regInx, pData != NULL);
+    if (!inEnumRange(dev, NELEMENTS(hmc7043LliCtl.devCtl)) || !nRegs ||
+        regInx < HMC7043_REG_INX_MIN || regInx + nRegs - 1 > HMC7043_REG_INX_MAX ||
+        !pData) {
+        hmc7043Log("invalid argument(s) (doRead %d, dev %d, regInx %u, "
+                   "nRegs %u, pData %d)", doRead, dev, regInx, nRegs,
+                   pData != NULL);
         return ERROR;
     }
 
     pCtl = &hmc7043LliCtl.devCtl[dev].ioIf;
 
     if (!hmc7043IfCtl.initDone || !hmc7043LliCtl.initDone || !pCtl->pRegRead ||
-            !pCtl->pRegWrite) {
-            sysLog("subsystem initialization not done yet (initDone %d,"
-            		" pRegRead %d, pRegWrite %d, doRead %d, dev %d, regInx %u)",
+        !pCtl->pRegWrite) {
+        hmc7043Log("subsystem initialization not done yet (initDone %d, "
+                   "pRegRead %d, pRegWrite %d, doRead %d, dev %d, regInx %u)",
                    hmc7043LliCtl.initDone, pCtl->pRegRead != NULL,
                    pCtl->pRegWrite != NULL, doRead, dev, regInx);
-
-            return ERROR;
+        return ERROR;
     }
 
-    hmc7043CsEnter(dev, __FUNCTION__);
+    HMC7043_CS_ASSERT_HELD(dev);
+
+    pStats = hmc7043StatsCtl.pDevStats[dev];
+    pri    = hmc7043IfCtl.devCtl[dev].busPri;
+
+    /* perform the operation (a single chunk unless arbitrated) */
+    for (done = 0; done < nRegs && status == OK; done += n, ++nXfers) {
+        arbitrated = hmc7043BusAcquire(pCtl->bus, pri);
+        n = arbitrated ? min(nRegs - done, HMC7043_BUS_CHUNK_NREGS) :
+                         nRegs - done;
+        t0 = sysTimeNsec();
+
+        if (n > 1 && doRead && pCtl->pRegReadBurst)
+            status = pCtl->pRegReadBurst(dev, regInx + done, pData + done, n);
+        else if (n > 1 && !doRead && pCtl->pRegWriteBurst)
+            status = pCtl->pRegWriteBurst(dev, regInx + done, pData + done, n);
+        else {
+            for (i = done; i < done + n && status == OK; ++i)
+                status = doRead ? pCtl->pRegRead (dev, regInx + i, pData + i) :
+                                  pCtl->pRegWrite(dev, regInx + i, pData[i]);
+        }
 
-    status = doRead ? pCtl->pRegRead (dev, regInx, pData) :
-                          pCtl->pRegWrite(dev, regInx, *pData);
+        t1 = sysTimeNsec();
 
-    hmc7043CsExit(dev, __FUNCTION__);
+        if (arbitrated)
+            hmc7043BusRelease(pCtl->bus);
+
+        sysAtomicAddRelaxed(&pStats->xferNsec, t1 - t0);
+    }
+
+    sysAtomicAddRelaxed(doRead ? &pStats->nReads : &pStats->nWrites, nXfers);
+    sysAtomicAddRelaxed(doRead ? &pStats->nRegsRead : &pStats->nRegsWritten, nRegs);
+
+    hmc7043TraceRec(dev, doRead, regInx, pData, nRegs, status, t1);
 
     /* analyze results */
     if (status != OK) {
-        sysLog("operation failed (doRead %d, dev %d, regInx 0x%02x, "
-                "regData 0x%02x)", doRead, dev, regInx, *pData);
+        sysAtomicAddRelaxed(&pStats->nXferErrors, 1);
+        hmc7043Log("operation failed (doRead %d, dev %d, regInx 0x%02x, "
+                   "nRegs %u, regData[0] 0x%02x)", doRead, dev, regInx, nRegs,
+                   *pData);
         return ERROR;
     }
 
     return OK;
 }
 
+/*******************************************************************************
+* - name: hmc7043LliRegIoAct
+*
+* - title: read/write a run of contiguous device registers via SPI
+*
+* - input: doRead - TRUE / FALSE to perform read / write, respectively
+*          dev    - CLKDST device for which to perform the operation
+*          regInx - first CLKDST register to read / write
+*          pData  - pointer to register data (nRegs entries)
+*          nRegs  - number of registers to read / write
+*
+* - output: pData[0 .. nRegs - 1] (only for a read operation)
+*
+* - returns: OK or ERROR if detected an error (in which case pData is unusable)
+*
+* - description: hmc7043LliRegXferInCs wrapped in the associated critical
+*                section
+*
+* - notes: 1) The whole run is interlocked via the associated critical section
+*             (i.e. it is taken once rather than per register).
+*          2) Sequences of register operations should rather take the critical
+*             section once and use the *InCs routines.
+*******************************************************************************/
+LOCAL STATUS hmc7043LliRegIoAct(Bool doRead, CKDST_DEV dev, unsigned regInx,
+                                HMC7043_REG *pData, unsigned nRegs)
+{
+    STATUS status;
+
+    if (hmc7043CsEnter(dev, __FUNCTION__) != OK)
+        return ERROR;
+
+    status = hmc7043LliRegXferInCs(doRead, dev, regInx, pData, nRegs);
+
+    hmc7043CsExit(dev, __FUNCTION__);
+
+    return status;
+}
+
 /*******************************************************************************
 * - name: hmc7043LliRegRead
 *
@@ -534,7 +1578,7 @@ LOCAL STATUS hmc7043LliRegIoAct(Bool doRead, CKDST_DEV dev, unsigned regInx,
 * - output: *pData (indirectly)
 *
 * - returns: status returned from the call
-*            hmc7043LliRegIoAct(TRUE, dev, regInx, pData)
+*            hmc7043LliRegIoAct(TRUE, dev, regInx, pData, 1)
 *
 * - description: as above
 *
@@ -542,32 +1586,286 @@ LOCAL STATUS hmc7043LliRegIoAct(Bool doRead, CKDST_DEV dev, unsigned regInx,
 *******************************************************************************/
 LOCAL STATUS hmc7043LliRegRead(CKDST_DEV dev, unsigned regInx, HMC7043_REG *pData)
 {
-    return hmc7043LliRegIoAct(TRUE, dev, regInx, pData);
+    return hmc7043LliRegIoAct(TRUE, dev, regInx, pData, 1);
 }
 
 /*******************************************************************************
-* - name: hmc7043LliRegWrite
+* - name: hmc7043LliRegReadInCs / hmc7043LliRegWriteInCs /
+*         hmc7043LliRegReadBurstInCs / hmc7043LliRegWriteBurstInCs
 *
-* - title: perform a direct write to a device register via SPI
+* - title: read / write a single device register or a run of contiguous ones
+*          via SPI, without interlocking
 *
-* - input: dev     - CLKDST device for which to perform the operation
-*          regInx  - CLKDST register to write
-*          regData - raw data to write to the register
+* - input: as for hmc7043LliRegXferInCs (nRegs being 1 for the single register
+*          routines)
 *
-* - returns: status returned from the call
-*            hmc7043LliRegIoAct(FALSE, dev, regInx, &regData)
+* - output: as for hmc7043LliRegXferInCs
+*
+* - returns: status returned from the call hmc7043LliRegXferInCs(...)
 *
 * - description: as above
 *
-* - notes: see notes in the header of hmc7043LliRegIoAct
+* - notes: see notes in the header of hmc7043LliRegXferInCs
+*******************************************************************************/
+LOCAL STATUS hmc7043LliRegReadInCs(CKDST_DEV dev, unsigned regInx,
+                                   HMC7043_REG *pData)
+{
+    return hmc7043LliRegXferInCs(TRUE, dev, regInx, pData, 1);
+}
+
+LOCAL STATUS hmc7043LliRegWriteInCs(CKDST_DEV dev, unsigned regInx,
+                                    HMC7043_REG regData)
+{
+    return hmc7043LliRegXferInCs(FALSE, dev, regInx, &regData, 1);
+}
+
+LOCAL STATUS hmc7043LliRegReadBurstInCs(CKDST_DEV dev, unsigned regInx,
+                                        HMC7043_REG *pData, unsigned nRegs)
+{
+    return hmc7043LliRegXferInCs(TRUE, dev, regInx, pData, nRegs);
+}
+
+LOCAL STATUS hmc7043LliRegWriteBurstInCs(CKDST_DEV dev, unsigned regInx,
+                                         const HMC7043_REG *pData,
+                                         unsigned nRegs)
+{
+    /* (the data is not modified for a write operation) */
+    return hmc7043LliRegXferInCs(FALSE, dev, regInx, (HMC7043_REG *) pData,
+                                 nRegs);
+}
+
+
+
+/*#############################################################################*
+*                S P I    B U S    A R B I T R A T I O N                       *
+*#############################################################################*/
+/*******************************************************************************
+* - name: hmc7043BusAcquire
+*
+* - title: wait for a transfer to be granted an arbitrated bus
+*
+* - input: bus - the device's bus
+*          pri - priority class of the transfer
+*
+* - output: hmc7043BusCtl.busCtl[bus]
+*
+* - returns: TRUE if granted (to be released via hmc7043BusRelease), FALSE if
+*            the bus is not arbitrated
+*
+* - description: waits while the bus is granted, for hmc7043BusRelease to
+*                hand it over, which it does to the highest class waiting,
+*                i.e. an urgent transfer is delayed by at most the chunk in
+*                progress and the urgent ones ahead of it (while a lower class
+*                may be starved by a higher one)
+*******************************************************************************/
+LOCAL Bool hmc7043BusAcquire(CKDST_BUS bus, HMC7043_BUS_PRI pri)
+{
+    Hmc7043_bus_ctl *pBus;
+    SYS_TIME_NS t0, waitNsec;
+    size_t nBytes;
+    UINT8 grant;
+
+    /* (the bus is validated by hmc7043LliInitDev) */
+    pBus = hmc7043BusCtl.busCtl + bus;
+
+    if (!sysAtomicLoadRelaxed(&pBus->enabled))
+        return FALSE;
+
+    t0 = sysTimeNsec();
+    utlMutexTake(pBus->hMutex, __FUNCTION__);
+
+    if (pBus->busy) {
+        ++pBus->nWaiting[pri];
+        utlMutexRelease(pBus->hMutex, __FUNCTION__);
+
+        /* (busy being left set by hmc7043BusRelease) */
+        nBytes = sizeof(grant);
+
+        if (utlQueueGet(pBus->hGrant[pri], &grant, &nBytes, UTL_Q_TO_INFINITE,
+                        NULL) != OK) {
+            /* can only happen due to a code error: no way to recover */
+            sysCodeError(CODE_ERR_STATE, hmc7043BusAcquire, bus, pri, -1);
+            return FALSE;
+        }
+
+        utlMutexTake(pBus->hMutex, __FUNCTION__);
+    }
+
+    pBus->busy      = TRUE;
+    pBus->grantedAt = sysTimeNsec();
+    waitNsec        = pBus->grantedAt - t0;
+
+    ++pBus->stats.nGrants[pri];
+    pBus->stats.waitNsec[pri] += waitNsec;
+    pBus->stats.maxWaitNsec[pri] = max(pBus->stats.maxWaitNsec[pri], waitNsec);
+
+    utlMutexRelease(pBus->hMutex, __FUNCTION__);
+    return TRUE;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043BusRelease
+*
+* - title: release an arbitrated bus granted by hmc7043BusAcquire
+*
+* - input: bus - the device's bus
+*
+* - output: hmc7043BusCtl.busCtl[bus]
+*
+* - description: as above, handing the bus over to a waiter of the highest
+*                class waiting (also if arbitration has been disabled
+*                meanwhile), else leaving it free
+*******************************************************************************/
+LOCAL void hmc7043BusRelease(CKDST_BUS bus)
+{
+    Hmc7043_bus_ctl *pBus = hmc7043BusCtl.busCtl + bus;
+    UINT8 grant = 0;
+    unsigned p;
+
+    utlMutexTake(pBus->hMutex, __FUNCTION__);
+
+    pBus->stats.busyNsec += sysTimeNsec() - pBus->grantedAt;
+
+    for (p = 0; p < HMC7043_BPRI_NPRIS && !pBus->nWaiting[p]; ++p)
+        ;
+
+    if (p == HMC7043_BPRI_NPRIS)
+        pBus->busy = FALSE;
+    else {
+        --pBus->nWaiting[p];
+
+        /* (the queue cannot be full, ref. Hmc7043_bus_ctl) */
+        if (utlQueuePut(pBus->hGrant[p], &grant, sizeof(grant), NULL) != OK)
+            sysCodeError(CODE_ERR_STATE, hmc7043BusRelease, bus, p, -1);
+    }
+
+    utlMutexRelease(pBus->hMutex, __FUNCTION__);
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043SetBusArbitration
+*
+* - title: enable / disable the arbitration of a shared SPI bus
+*
+* - input: bus    - the bus (as per Hmc7043_dev_io_if.bus)
+*          enable - whether to arbitrate the transfers of the bus's devices
+*
+* - output: hmc7043BusCtl.busCtl[bus]
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: once enabled, each register transfer (chunk) of the devices
+*                on the bus waits for the bus to be granted, in the order of
+*                the priority classes of the calling services (ref.
+*                HMC7043_BUS_PRI, hmc7043CsSetBusPri), the bus statistics
+*                being reset; disabling takes effect for the transfers not
+*                waiting yet
+*
+* - notes: 1) To be called after hmc7043IfInit (which disables arbitration on
+*             all buses).
+*          2) Meant for buses whose devices are accessed by multiple threads
+*             concurrently, as it costs a pair of mutex operations per chunk
+*             (and a grant queue transfer per chunk that had to wait).
+*          3) Fails if the grant queues cannot be created (on first enabling).
+*******************************************************************************/
+EXPORT STATUS hmc7043SetBusArbitration(CKDST_BUS bus, Bool enable)
+{
+    Hmc7043_bus_ctl *pBus;
+    unsigned pri;
+
+    if (!inEnumRange(bus, NELEMENTS(hmc7043BusCtl.busCtl))) {
+        sysLog("bad argument (bus %u)", bus);
+        return ERROR;
+    }
+
+    if (!hmc7043BusCtl.initDone) {
+        sysLog("interface not initialized yet (bus %u)", bus);
+        return ERROR;
+    }
+
+    pBus = hmc7043BusCtl.busCtl + bus;
+
+    utlMutexTake(pBus->hMutex, __FUNCTION__);
+
+    /* create the grant queues (if first time here) */
+    for (pri = 0; enable && pri < HMC7043_BPRI_NPRIS; ++pri)
+        if (pBus->hGrant[pri] == UTL_QUEUE_BAD_HQUEUE &&
+            (pBus->hGrant[pri] = utlQueueCreate(CKDST_MAX_NDEV, sizeof(UINT8),
+                                                NULL)) ==
+            UTL_QUEUE_BAD_HQUEUE) {
+            sysLog("grant queue creation failed (bus %u, pri %u)", bus, pri);
+            utlMutexRelease(pBus->hMutex, __FUNCTION__);
+            return ERROR;
+        }
+
+    if (enable && !sysAtomicLoadRelaxed(&pBus->enabled)) {
+        memset(&pBus->stats, 0, sizeof(pBus->stats));
+        pBus->stats.sinceNsec = sysTimeNsec();
+    }
+
+    sysAtomicStoreRelaxed(&pBus->enabled, enable);
+
+    utlMutexRelease(pBus->hMutex, __FUNCTION__);
+    return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043GetBusStats
+*
+* - title: get the statistics of an arbitrated bus
+*
+* - input: bus - the bus (as per Hmc7043_dev_io_if.bus)
+*
+* - output: *pStats
+*
+* - returns: OK or ERROR if detected an error (in particular if the bus has
+*            never been arbitrated)
+*
+* - description: returns the bus statistics as of now (pStats->atNsec), the
+*                bus utilization being busyNsec / (atNsec - sinceNsec)
 *******************************************************************************/
-LOCAL STATUS hmc7043LliRegWrite(CKDST_DEV dev, unsigned regInx, HMC7043_REG regData)
+EXPORT STATUS hmc7043GetBusStats(CKDST_BUS bus, Hmc7043_bus_stats *pStats)
 {
-    return hmc7043LliRegIoAct(FALSE, dev, regInx, &regData);
+    Hmc7043_bus_ctl *pBus;
+
+    if (!inEnumRange(bus, NELEMENTS(hmc7043BusCtl.busCtl)) || !pStats) {
+        sysLog("bad argument(s) (bus %u, pStats %d)", bus, pStats != NULL);
+        return ERROR;
+    }
+
+    if (!hmc7043BusCtl.initDone) {
+        sysLog("interface not initialized yet (bus %u)", bus);
+        return ERROR;
+    }
+
+    pBus = hmc7043BusCtl.busCtl + bus;
+
+    utlMutexTake(pBus->hMutex, __FUNCTION__);
+    *pStats = pBus->stats;
+    utlMutexRelease(pBus->hMutex, __FUNCTION__);
+
+    if (!pStats->sinceNsec) {
+        sysLog("bus never arbitrated (bus %u)", bus);
+        return ERROR;
+    }
+
+    pStats->atNsec = sysTimeNsec();
+
+    return OK;
 }
 
 
 
+
 /*#############################################################################*
 *             R E G I S T E R    L A Y O U T    D E F I N I T I O N            *
 *                                                                              *
@@ -2188,16 +3486,439 @@ typedef struct {
 	Hmc7043_reg_x0150 r150; Hmc7043_reg_x0151 r151;	Hmc7043_reg_x0152 r152;
 } Hmc7043_reg_image;
 
+/* generic overlay of an output channel's control registers in the register
+   image (ref. hmc7043AppChRegs), i.e. 0xc8 - 0xd0 for channel 0, etc. */
+typedef struct {
+    union {
+        struct {
+                HMC7043_REG chEn      : 1;  /* Channel Enable */
+                HMC7043_REG multSlpEn : 1;  /* MultiSlip Enable */
+                HMC7043_REG stMod     : 2;  /* Start-up mode */
+                HMC7043_REG reserved  : 1;
+                HMC7043_REG slipEn    : 1;  /* Slip Enable */
+                HMC7043_REG syncEn    : 1;  /* SYNC Enable */
+                HMC7043_REG hpMode    : 1;  /* High Performance mode */
+        }fields;
+        HMC7043_REG all;
+    } ctl;
+    union {
+        struct {
+                HMC7043_REG chDivLsb : 8;  /* Channel Divider[7:0] LSB */
+        }fields;
+        HMC7043_REG all;
+    } divLsb;
+    union {
+        struct {
+                HMC7043_REG chDivMsb : 4;  /* Channel Divider[11:8] MSB */
+                HMC7043_REG reserved : 4;
+        }fields;
+        HMC7043_REG all;
+    } divMsb;
+    union {
+        struct {
+                HMC7043_REG faDelay  : 4;  /* Fine analog Delay */
+                HMC7043_REG reserved : 4;
+        }fields;
+        HMC7043_REG all;
+    } faDelay;
+    union {
+        struct {
+                HMC7043_REG cdDelay  : 4;  /* Coarse Digital Delay */
+                HMC7043_REG reserved : 4;
+        }fields;
+        HMC7043_REG all;
+    } cdDelay;
+    union {
+        struct {
+                HMC7043_REG msDelayLsb : 8;  /* MultiSlip Digital Delay[7:0] */
+        }fields;
+        HMC7043_REG all;
+    } msDelayLsb;
+    union {
+        struct {
+                HMC7043_REG msDelayMsb : 4;  /* MultiSlip Digital Delay[11:8] */
+                HMC7043_REG reserved   : 4;
+        }fields;
+        HMC7043_REG all;
+    } msDelayMsb;
+    union {
+        struct {
+                HMC7043_REG outMuxSel : 2;  /* Output Mux Selection */
+                HMC7043_REG reserved  : 6;
+        }fields;
+        HMC7043_REG all;
+    } outMuxSel;
+    union {
+        struct {
+                HMC7043_REG drvImp    : 2;  /* Driver Impedance */
+                HMC7043_REG reserved  : 1;
+                HMC7043_REG drvMod    : 2;  /* Driver mode */
+                HMC7043_REG dyDrvEn   : 1;  /* Dynamic Driver Enable */
+                HMC7043_REG idlAtZero : 2;  /* Idle at Zero */
+        }fields;
+        HMC7043_REG all;
+    } drv;
+} Hmc7043_ch_regs;
+
+#define HMC7043_CH_NREGS  9  /* per output channel (the 10th one is unused) */
+
+/* the channels' registers must be contiguous in the register image */
+typedef char Hmc7043_ch_regs_chk[sizeof(Hmc7043_ch_regs) == HMC7043_CH_NREGS &&
+                                 offsetof(Hmc7043_reg_image, r152) -
+                                 offsetof(Hmc7043_reg_image, rc8) ==
+                                 HMC7043_OUT_NCHAN * HMC7043_CH_NREGS - 1 ?
+                                 1 : -1];
+
+/* registers maintained in the register image that are transferred to / from the
+   device (in ascending register index order, which is what allows runs of
+   contiguous registers to be transferred as bursts) */
+typedef struct {unsigned regInx, dataOffs;} Hmc7043_reg_desc;
+
+#define HMC7043_APP_NREG_DESCS  161  /* must match NELEMENTS(hmc7043AppRegDescs) */
+
 typedef struct {
     Hmc7043_reg_image regImage;  /* last setup of (most) control registers */
+    Hmc7043_reg_image devImage;  /* register values last written to the device */
+    /* one bit per hmc7043AppRegDescs entry: set when devImage is known to
+       reflect the device register (relying on memset to clear all of these) */
+    UINT32 devKnown[(HMC7043_APP_NREG_DESCS + 31) / 32];
+    UINT64 paramsHash;  /* of the params set up (ref. hmc7043AppParamsHash) */
 } Hmc7043_app_dev_state;
 
 LOCAL struct {
-    Hmc7043_app_dev_state devState[CKDST_MAX_NDEV];  /* per last command */
+    Hmc7043_app_dev_state *pDevState[CKDST_MAX_NDEV];  /* per last command */
 } hmc7043AppState;
 
-/*******************************************************************************
-* - name: hmc7043AppIfInit
+/* register images as last built by (cold) initialization, for reuse when a
+   device is reinitialized with the same parameters (ref. hmc7043AppInitDev) */
+typedef struct {
+    Hmc7043_app_dev_params params;  /* the image was built from */
+    Hmc7043_reg_image regImage;
+} Hmc7043_app_cache_dev;
+
+LOCAL struct {
+    Hmc7043_app_cache_dev *pDevCache[CKDST_MAX_NDEV];
+} hmc7043AppCache;
+
+/* persisted device register images (ref. hmc7043SetPersistence), kept in a
+   shared memory segment so that these survive a process restart */
+typedef struct {
+    UINT32_ATOMIC gen;   /* odd while being updated, 0 if never written */
+    UINT64 paramsHash;   /* Hmc7043_app_dev_state.paramsHash */
+    Hmc7043_reg_image devImage;
+    UINT32 devKnown[(HMC7043_APP_NREG_DESCS + 31) / 32];
+} Hmc7043_persist_dev;
+
+typedef struct {
+    UINT32 magic, version, size;  /* as below (else reset) */
+    Hmc7043_persist_dev devRec[CKDST_MAX_NDEV];
+} Hmc7043_persist_seg;
+
+#define HMC7043_PERSIST_MAGIC    0x37303450  /* "704P" */
+#define HMC7043_PERSIST_VERSION  2  /* to be bumped on any layout change */
+
+LOCAL struct {
+    Hmc7043_persist_seg *pSeg;  /* NULL if not persisting */
+    unsigned nVerifyRegs;
+    unsigned verifyRegs[HMC7043_PERSIST_MAX_VERIFY_REGS];
+} hmc7043PersistCtl;
+
+/* alarm / status register snapshots published by the background monitor (ref.
+   hmc7043StartMonitor), updated as a sequence lock: seq is odd while the rest
+   is being updated, so readers retry until they get an even unchanged seq */
+#define HMC7043_MON_REG_INX   0x7b  /* alarm readback */
+#define HMC7043_MON_NREGS     3     /* 0x7b - 0x7d */
+#define HMC7043_MON_DATA_OK   0x80000000  /* the registers were read OK */
+
+typedef struct {
+    UINT32_ATOMIC seq;
+    UINT32_ATOMIC data;      /* register i at bits 8*i.., | _MON_DATA_OK */
+    UINT64_ATOMIC nsecAt;    /* sysTimeNsec at the read */
+} ALIGN(64) Hmc7043_mon_snap;  /* one cache line per device */
+
+LOCAL struct {
+    CKDST_DEV_MASK devMask;  /* devices monitored (0 if not started) */
+    Hmc7043_mon_snap *pDevSnap[CKDST_MAX_NDEV];  /* ref. hmc7043PoolCtl */
+} hmc7043MonCtl;
+
+/* alarm notification (ref. hmc7043SetAlarmHandler): the handler and its arg
+   are set / picked up under the device critical section */
+typedef struct {
+    HMC7043_ALARM_HANDLER *pHandler;  /* NULL if none */
+    UINT64 arg;
+    /* edge waiting thread (ref. hmc7043AttachAlarmGpio) */
+    Bool gpioAttached;
+    unsigned gpioThrCode;
+    int stopFds[2];  /* stop pipe (read, write end) */
+} Hmc7043_alarm_dev_ctl;
+
+LOCAL struct {
+    Hmc7043_alarm_dev_ctl *pDevCtl[CKDST_MAX_NDEV];  /* ref. hmc7043PoolCtl */
+} hmc7043AlarmCtl;
+
+/* asynchronous service requests (ref. hmc7043PostAsync): each is built in place
+   in the device's urgent or normal request ring (lock-free, multiple posters)
+   and followed by a doorbell message, the executor thread taking one request
+   per doorbell - the urgent one if any (i.e. a doorbell is only ever taken
+   with a request posted, if possibly not yet committed) */
+typedef struct {
+    Hmc7043_async_req req;
+    HMC7043_ASYNC_DONE *pDone;
+    UINT64 arg;
+    Hmc7043_async_token *pToken;
+} Hmc7043_async_msg;
+
+typedef struct {
+    Utl_ring urgent, normal;  /* set up if started */
+    HUTL_QUEUE hBell;         /* set if started */
+} Hmc7043_async_dev_ctl;
+
+LOCAL struct {
+    Hmc7043_async_dev_ctl *pDevCtl[CKDST_MAX_NDEV];  /* ref. hmc7043PoolCtl */
+} hmc7043AsyncCtl;
+
+/* deferred commit of register image changes (ref. hmc7043SetDeferredCommit),
+   modified only within the associated critical section */
+typedef struct {
+    Bool deferred;
+    UINT32 windowUsec;         /* 0 if only committed explicitly */
+    SYS_TIME_NS pendingSince;  /* 0 if no changes deferred */
+    HUTL_QUEUE hBell;          /* window expiry thread wake-ups (if started) */
+} Hmc7043_commit_dev_ctl;
+
+LOCAL struct {
+    Hmc7043_commit_dev_ctl *pDevCtl[CKDST_MAX_NDEV];  /* ref. hmc7043PoolCtl */
+} hmc7043CommitCtl;
+
+/* register classes (ref. hmc7043AppRegClass): only control register reads are
+   served from the device image (ref. hmc7043AppShadowRead) */
+typedef enum {
+    HMC7043_RCL_CTL,       /* static control (as last written by the driver) */
+    HMC7043_RCL_STATUS,    /* volatile status / readback */
+    HMC7043_RCL_SELF_CLR   /* self-clearing request bits / write side effects */
+} HMC7043_REG_CLASS;
+
+typedef struct {
+    unsigned first, last;  /* register index range */
+    HMC7043_REG_CLASS cls;
+} Hmc7043_reg_class_range;
+
+/* the registers not covered being control registers if maintained in the
+   register image (i.e. in hmc7043AppRegDescs), else status ones */
+LOCAL const Hmc7043_reg_class_range hmc7043RegClassRanges[] = {
+    {0x00, 0x02, HMC7043_RCL_SELF_CLR},  /* soft reset, request bits, slip */
+    {0x06, 0x06, HMC7043_RCL_SELF_CLR},  /* alarm clearing */
+    {0x78, 0x91, HMC7043_RCL_STATUS}     /* alarm / status readbacks */
+};
+
+LOCAL struct {
+    Bool readThrough;      /* if set, all reads go to the device */
+    unsigned scrubPeriod;  /* in monitor iterations (0 if not scrubbing) */
+    unsigned monIter;      /* monitor iterations so far (ref. hmc7043MonIter) */
+} hmc7043ShadowCtl;
+
+/* registers read back for verifying a persisted register image by default (in
+   addition to the product id): mostly ones whose value after a device reset
+   differs from their usual setting */
+LOCAL const unsigned hmc7043PersistDfltVerifyRegs[] = {
+    0x03, 0x04, 0x0a, 0x5c, 0x5d, 0x9d, 0xc8
+};
+
+/* completion polling of toggled request bits (ref. hmc7043AppWaitDone) */
+#define HMC7043_WAIT_POLL_USEC  5  /* interval between the polls */
+
+typedef struct {
+    unsigned regInx;
+    HMC7043_REG mask, value;  /* done when (reg & mask) == value */
+} Hmc7043_wait_cond;
+
+LOCAL const Hmc7043_wait_cond hmc7043WaitConds[HMC7043_WOP_NOPS] = {
+    /* the device is accessible again once the product id reads back (the
+       product id being in ROM, the reset itself is covered by the settle
+       delay preceding the polling, ref. hmc7043WaitCtl.settleUsec) */
+    [HMC7043_WOP_SOFT_RESET]   = {0x78, 0xff, HMC7043_PRD_ID & 0xff},
+    /* the channel output FSMs are idle (again: these only leave the idle state
+       some time after the request, which is covered by the settle delay) */
+    [HMC7043_WOP_RESTART]      = {0x91, 0x08, 0x00},
+    [HMC7043_WOP_RESEED]       = {0x91, 0x08, 0x00},
+    [HMC7043_WOP_PULSE_GEN]    = {0x91, 0x08, 0x00},
+    [HMC7043_WOP_SLIP]         = {0x91, 0x08, 0x00},
+    /* all the clock outputs reached their phases */
+    [HMC7043_WOP_CKOUT_PHASE]  = {0x7d, 0x04, 0x04}
+};
+
+LOCAL struct {
+    UINT32 timeoutUsec[HMC7043_WOP_NOPS];  /* upper bound per operation */
+    UINT32 settleUsec[HMC7043_WOP_NOPS];   /* minimum wait before polling */
+    /* [HMC7043_WOP_NOPS] each, ref. hmc7043PoolCtl */
+    Hmc7043_wait_stats *pDevStats[CKDST_MAX_NDEV];
+} hmc7043WaitCtl = {
+    .settleUsec = {
+        [HMC7043_WOP_SOFT_RESET]  = 200, [HMC7043_WOP_RESTART]   = 20,
+        [HMC7043_WOP_RESEED]      = 20,  [HMC7043_WOP_PULSE_GEN] = 20,
+        [HMC7043_WOP_SLIP]        = 20
+    },
+    .timeoutUsec = {
+        [HMC7043_WOP_SOFT_RESET]  = 2000, [HMC7043_WOP_RESTART]   = 1000,
+        [HMC7043_WOP_RESEED]      = 1000, [HMC7043_WOP_PULSE_GEN] = 1000,
+        [HMC7043_WOP_SLIP]        = 1000, [HMC7043_WOP_CKOUT_PHASE] = 10000
+    }
+};
+
+/* the per-device state, only allocated for the devices in the hmc7043IfInit
+   mask: one contiguous pool of cache line aligned slots (in device order),
+   pointed to by the pDev* tables of the modules above (NULL for the devices
+   not in the mask, ref. hmc7043DevPresent) */
+typedef struct {
+    Hmc7043_app_dev_ctl appCtl;
+    Hmc7043_app_dev_state appState;
+    Hmc7043_app_cache_dev appCache;
+    Hmc7043_trace_ring traceRing;
+    Hmc7043_init_prof_ctl initProf;
+    Hmc7043_dev_stats_ctl devStats;
+    Hmc7043_wait_stats waitStats[HMC7043_WOP_NOPS];
+    Hmc7043_mon_snap monSnap;
+    Hmc7043_alarm_dev_ctl alarmCtl;
+    Hmc7043_async_dev_ctl asyncCtl;
+    Hmc7043_commit_dev_ctl commitCtl;
+} ALIGN(64) Hmc7043_dev_slot;
+
+LOCAL struct {
+    Hmc7043_dev_slot *pSlots;  /* NULL if not allocated */
+    unsigned nSlots;
+} hmc7043PoolCtl;
+
+LOCAL const Hmc7043_reg_desc hmc7043AppRegDescs[] = {
+#   define RDESC(reg)  {0x##reg, offsetof(Hmc7043_reg_image, r##reg.all)}
+
+    RDESC(01),   RDESC(02),   RDESC(03),   RDESC(04),   RDESC(05),   RDESC(06),
+    RDESC(07),   RDESC(08),   RDESC(09),   RDESC(0a),   RDESC(0b),   RDESC(46),
+    RDESC(50),   RDESC(54),   RDESC(5a),   RDESC(5b),   RDESC(5c),   RDESC(5d),
+    RDESC(64),   RDESC(65),   RDESC(71),   RDESC(98),   RDESC(99),   RDESC(9d),
+    RDESC(9e),   RDESC(9f),   RDESC(a0),   RDESC(a2),   RDESC(a3),   RDESC(a4),
+    RDESC(ad),   RDESC(b5),   RDESC(b6),   RDESC(b7),   RDESC(b8),   RDESC(c8),
+    RDESC(c9),   RDESC(ca),   RDESC(cb),   RDESC(cc),   RDESC(cd),   RDESC(ce),
+    RDESC(cf),   RDESC(d0),   RDESC(d2),   RDESC(d3),   RDESC(d4),   RDESC(d5),
+    RDESC(d6),   RDESC(d7),   RDESC(d8),   RDESC(d9),   RDESC(da),   RDESC(dc),
+    RDESC(dd),   RDESC(de),   RDESC(df),   RDESC(e0),   RDESC(e1),   RDESC(e2),
+    RDESC(e3),   RDESC(e4),   RDESC(e6),   RDESC(e7),   RDESC(e8),   RDESC(e9),
+    RDESC(ea),   RDESC(eb),   RDESC(ec),   RDESC(ed),   RDESC(ee),   RDESC(f0),
+    RDESC(f1),   RDESC(f2),   RDESC(f3),   RDESC(f4),   RDESC(f5),   RDESC(f6),
+    RDESC(f7),   RDESC(f8),   RDESC(fa),   RDESC(fb),   RDESC(fc),   RDESC(fd),
+    RDESC(fe),   RDESC(ff),   RDESC(100),  RDESC(101),  RDESC(102),  RDESC(104),
+    RDESC(105),  RDESC(106),  RDESC(107),  RDESC(108),  RDESC(109),  RDESC(10a),
+    RDESC(10b),  RDESC(10c),  RDESC(10e),  RDESC(10f),  RDESC(110),  RDESC(111),
+    RDESC(112),  RDESC(113),  RDESC(114),  RDESC(115),  RDESC(116),  RDESC(118),
+    RDESC(119),  RDESC(11a),  RDESC(11b),  RDESC(11c),  RDESC(11d),  RDESC(11e),
+    RDESC(11f),  RDESC(120),  RDESC(122),  RDESC(123),  RDESC(124),  RDESC(125),
+    RDESC(126),  RDESC(127),  RDESC(128),  RDESC(129),  RDESC(12a),  RDESC(12c),
+    RDESC(12d),  RDESC(12e),  RDESC(12f),  RDESC(130),  RDESC(131),  RDESC(132),
+    RDESC(133),  RDESC(134),  RDESC(136),  RDESC(137),  RDESC(138),  RDESC(139),
+    RDESC(13a),  RDESC(13b),  RDESC(13c),  RDESC(13d),  RDESC(13e),  RDESC(140),
+    RDESC(141),  RDESC(142),  RDESC(143),  RDESC(144),  RDESC(145),  RDESC(146),
+    RDESC(147),  RDESC(148),  RDESC(14a),  RDESC(14b),  RDESC(14c),  RDESC(14d),
+    RDESC(14e),  RDESC(14f),  RDESC(150),  RDESC(151),  RDESC(152)
+
+#   undef RDESC
+};
+
+typedef char Hmc7043_app_reg_descs_chk[NELEMENTS(hmc7043AppRegDescs) ==
+                                       HMC7043_APP_NREG_DESCS ? 1 : -1];
+typedef char Hmc7043_cfg_blob_size_chk[HMC7043_CFG_BLOB_SIZE <=
+                                       HMC7043_CFG_BLOB_MAX_SIZE ? 1 : -1];
+
+/* first control register of each output channel (ref. Hmc7043_ch_regs) */
+LOCAL const Hmc7043_reg_desc hmc7043ChRegDescs[HMC7043_OUT_NCHAN] = {
+#   define CHDESC(reg)  {0x##reg, offsetof(Hmc7043_reg_image, r##reg.all)}
+
+    CHDESC(c8),  CHDESC(d2),  CHDESC(dc),  CHDESC(e6),  CHDESC(f0),
+    CHDESC(fa),  CHDESC(104), CHDESC(10e), CHDESC(118), CHDESC(122),
+    CHDESC(12c), CHDESC(136), CHDESC(140), CHDESC(14a)
+
+#   undef CHDESC
+};
+
+/*******************************************************************************
+* - name: hmc7043PoolInit
+*
+* - title: allocate the per-device state pool
+*
+* - input: devMask - specifies the CLKDST device(s) that will be used
+*
+* - output: hmc7043PoolCtl, hmc7043AppCtl.pDevCtl[],
+*           hmc7043AppState.pDevState[], hmc7043AppCache.pDevCache[],
+*           hmc7043TraceCtl.pDevRing[], hmc7043ProfCtl.pDevProf[],
+*           hmc7043StatsCtl.pDevStats[], hmc7043WaitCtl.pDevStats[],
+*           hmc7043MonCtl.pDevSnap[], hmc7043AlarmCtl.pDevCtl[],
+*           hmc7043AsyncCtl.pDevCtl[], hmc7043CommitCtl.pDevCtl[]
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: allocates a (cleared) Hmc7043_dev_slot per device in devMask,
+*                all in one contiguous block, and points the per-device tables
+*                of the devices in devMask at their slot (NULL for the rest),
+*                releasing the previously allocated pool if any
+*
+* - notes: not attempting to interlock this operation (i.e. no services may be
+*          in progress for any of the devices)
+*******************************************************************************/
+LOCAL STATUS hmc7043PoolInit(CKDST_DEV_MASK devMask)
+{
+    unsigned nSlots = ckdstDevCount(devMask);
+    Hmc7043_dev_slot *pSlot;
+    CKDST_DEV dev;
+
+    /* release the previous pool */
+    memset(hmc7043AppCtl.pDevCtl, 0, sizeof(hmc7043AppCtl.pDevCtl));
+    memset(hmc7043AppState.pDevState, 0, sizeof(hmc7043AppState.pDevState));
+    memset(hmc7043AppCache.pDevCache, 0, sizeof(hmc7043AppCache.pDevCache));
+    memset(hmc7043TraceCtl.pDevRing, 0, sizeof(hmc7043TraceCtl.pDevRing));
+    memset(hmc7043ProfCtl.pDevProf, 0, sizeof(hmc7043ProfCtl.pDevProf));
+    memset(hmc7043StatsCtl.pDevStats, 0, sizeof(hmc7043StatsCtl.pDevStats));
+    memset(hmc7043WaitCtl.pDevStats, 0, sizeof(hmc7043WaitCtl.pDevStats));
+    memset(hmc7043MonCtl.pDevSnap, 0, sizeof(hmc7043MonCtl.pDevSnap));
+    memset(hmc7043AlarmCtl.pDevCtl, 0, sizeof(hmc7043AlarmCtl.pDevCtl));
+    memset(hmc7043AsyncCtl.pDevCtl, 0, sizeof(hmc7043AsyncCtl.pDevCtl));
+    memset(hmc7043CommitCtl.pDevCtl, 0, sizeof(hmc7043CommitCtl.pDevCtl));
+
+    free(hmc7043PoolCtl.pSlots);
+    hmc7043PoolCtl.pSlots = NULL;
+    hmc7043PoolCtl.nSlots = 0;
+
+    /* allocate and distribute the new one (the slot size being a multiple of
+       its alignment) */
+    if (!(pSlot = aligned_alloc(_Alignof(Hmc7043_dev_slot),
+                                nSlots * sizeof(*pSlot)))) {
+        sysLog("pool allocation failed (nSlots %u, slot size %u)", nSlots,
+               (unsigned) sizeof(*pSlot));
+        return ERROR;
+    }
+
+    memset(pSlot, 0, nSlots * sizeof(*pSlot));
+
+    hmc7043PoolCtl.pSlots = pSlot;
+    hmc7043PoolCtl.nSlots = nSlots;
+
+    CKDST_FOR_EACH_DEV(dev, devMask) {
+        hmc7043AppCtl.pDevCtl[dev]     = &pSlot->appCtl;
+        hmc7043AppState.pDevState[dev] = &pSlot->appState;
+        hmc7043AppCache.pDevCache[dev] = &pSlot->appCache;
+        hmc7043TraceCtl.pDevRing[dev]  = &pSlot->traceRing;
+        hmc7043ProfCtl.pDevProf[dev]   = &pSlot->initProf;
+        hmc7043StatsCtl.pDevStats[dev] = &pSlot->devStats;
+        hmc7043WaitCtl.pDevStats[dev]  = pSlot->waitStats;
+        hmc7043MonCtl.pDevSnap[dev]    = &pSlot->monSnap;
+        hmc7043AlarmCtl.pDevCtl[dev]   = &pSlot->alarmCtl;
+        hmc7043AsyncCtl.pDevCtl[dev]   = &pSlot->asyncCtl;
+        hmc7043CommitCtl.pDevCtl[dev]  = &pSlot->commitCtl;
+        ++pSlot;
+    }
+
+    return OK;
+}
+
+/*******************************************************************************
+* - name: hmc7043AppIfInit
 *
 * - title: initialize application-level interface
 *
@@ -2213,7 +3934,7 @@ LOCAL STATUS hmc7043AppIfInit(void)
 {
     hmc7043AppCtl.lwstOutFreq = 0;
 
-    hmc7043AppCtl.initDone = TRUE;
+    sysAtomicStoreRel(&hmc7043AppCtl.initDone, TRUE);
 
     return OK;
 }
@@ -2222,106 +3943,120 @@ LOCAL STATUS hmc7043AppIfInit(void)
 
 
 /*******************************************************************************
-* - name: hmc7043AppSetUpDevCtl
-*
-* - title: set up control parameters for a PLL device
+* - name: hmc7043AppChkParams
 *
-* - input: dev     - CLKDST device for which to perform the operation
-*          pParams - pointer to device setup parameters
+* - title: validate device setup parameters
 *
-* - output: hmc7043AppCtl.devCtl[dev]
+* - input: pParams - pointer to device setup parameters
 *
 * - returns: OK or ERROR if detected an error
 *
-* - description: sets up CLKDST device control parameters per the application's
-*                requirements
-*
-* - notes: not attempting to interlock the sequence here - if such interlocking
-*          is necessary, it must be provided by the caller
+* - description: as above
 *******************************************************************************/
-LOCAL STATUS hmc7043AppSetUpDevCtl(CKDST_DEV dev,
-                                   const Hmc7043_app_dev_params *pParams)
+LOCAL STATUS hmc7043AppChkParams(const Hmc7043_app_dev_params *pParams)
 {
-    Hmc7043_app_dev_ctl *pCtl;
-    CKDST_FREQ_HZ clkInpFreq;
+    Hmc7043_ch_timing chTiming[HMC7043_OUT_NCHAN];
     unsigned i, chDivider = 0;
 
     /* initialize */
-    if(!inEnumRange(dev, NELEMENTS(hmc7043AppCtl.devCtl)) || !pParams) {
-        sysLog("bad argument(s) (dev %d, pParams %d)", dev, pParams != NULL);
+    if (!pParams) {
+        sysLog("bad argument (pParams %d)", pParams != NULL);
         return ERROR;
     }
 
-    pCtl = hmc7043AppCtl.devCtl + dev;
-
-    /* set up device control parameters */
-    pCtl->params = *pParams;
-
     /* In fundamental mode, min frequency is 200Mhz and max frequency is 3200MHz*/
-    if(pCtl->params.clkInDiv == HMC7043_CID_1 &&
-    		(pCtl->params.clkInFreq < HMC7043_CID1_MIN_FREQ ||
-    		 pCtl->params.clkInFreq > HMC7043_CID1_MAX_FREQ) ) {
-    	sysLogFpa("CLKIN frequency (%.0f) outside limits for device %.0f",
-    	                  (double) pCtl->params.clkInDiv, (double) dev);
+    if(pParams->clkInDiv == HMC7043_CID_1 &&
+    		(pParams->clkInFreq < HMC7043_CID1_MIN_FREQ ||
+    		 pParams->clkInFreq > HMC7043_CID1_MAX_FREQ) ) {
+    	sysLogFpa("CLKIN frequency (%.0f) outside limits (clkInDiv %.0f)",
+    	                  (double) pParams->clkInFreq, (double) pParams->clkInDiv);
     	return ERROR;
     }
 
     /* In divide by 2 mode, min frequency is 200Mhz and max frequency is 6000MHz*/
-    if(pCtl->params.clkInDiv == HMC7043_CID_2 &&
-        		(pCtl->params.clkInFreq < HMC7043_CID2_MIN_FREQ ||
-        		 pCtl->params.clkInFreq > HMC7043_CID2_MAX_FREQ) ) {
-        	sysLogFpa("CLKIN frequency (%.0f) outside limits for device %.0f",
-        	                  (double) pCtl->params.clkInDiv, (double) dev);
+    if(pParams->clkInDiv == HMC7043_CID_2 &&
+        		(pParams->clkInFreq < HMC7043_CID2_MIN_FREQ ||
+        		 pParams->clkInFreq > HMC7043_CID2_MAX_FREQ) ) {
+        	sysLogFpa("CLKIN frequency (%.0f) outside limits (clkInDiv %.0f)",
+        	                  (double) pParams->clkInFreq, (double) pParams->clkInDiv);
         	return ERROR;
         }
 
+    /* Verify the channels' dividers, delays and slip quanta against the
+     * clock plan (exactly, ref. hmc7043AppPlanTiming) */
+    if (hmc7043AppPlanTiming(pParams, chTiming) != OK)
+        return ERROR;
 
     /* Verify that if the start-up mode of a SYSREF output channel is
      * configured to be in pulse generator mode, its divide ratio
      * should be > 31 */
-    if(pParams->clkInDiv == HMC7043_CID_2) {
-		clkInpFreq = pParams->clkInFreq/2;
-	}
-	else if(pParams->clkInDiv == HMC7043_CID_1){
-		clkInpFreq = pParams->clkInFreq;
-	}
-
     for(i = 0; i < HMC7043_OUT_NCHAN; i++) {
-        if(pCtl->params.chSup[i].chMode == HMC7043_CHM_SYSREF){
-        	if(pCtl->params.chSup[i].dynDriverEn) {
-        		chDivider = clkInpFreq/pParams->chSup[i].freq;
+        if(pParams->chSup[i].chMode == HMC7043_CHM_SYSREF){
+        	if(pParams->chSup[i].dynDriverEn) {
+        		chDivider = chTiming[i].divider;
         		if(chDivider < 31) {
-        			sysLogFpa("SYSREF channel configured in pulse generator mode"
-							  "should have divide ratio (%d) greater than 31.",
-							  chDivider);
+        			sysLog("SYSREF channel configured in pulse generator mode "
+        			       "should have divide ratio (%u) greater than 31.",
+        			       chDivider);
 					return ERROR;
         		}
         	}
         }
     }
 
-    /* Verify that a channel's slipQuantumPs is a multiple of the input
-     *  clock period (after taking input divisor into account). */
-    if(pParams->clkInDiv == HMC7043_CID_2) {
-		clkInpFreq = pParams->clkInFreq/2;
-	}
-	else if(pParams->clkInDiv == HMC7043_CID_1){
-		clkInpFreq = pParams->clkInFreq;
-	}
-	else {
-		sysLog("bad argument (clkInDiv %d)", pParams->clkInDiv);
-		        return ERROR;
-	}
-    for(i = 0; i < HMC7043_OUT_NCHAN; i++) {
-    	if(clkInpFreq % (CKDST_FREQ_HZ)pParams->chSup[i].slipQuantumPs != 0) {
-    		sysLogFpa("Channel's slipQuantumPs is not a multiple of the input"
-                      "clock period.Clock period (%.0f), Slip (%.0f)",
-					   (double)clkInpFreq, pParams->chSup[i].slipQuantumPs);
-    		return ERROR;
-    	}
+    return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AppSetUpDevCtl
+*
+* - title: set up control parameters for a PLL device
+*
+* - input: dev      - CLKDST device for which to perform the operation
+*          pParams  - pointer to device setup parameters
+*          validate - whether to validate the parameters (not necessary if
+*                     already done, e.g. by hmc7043CompileParams)
+*
+* - output: *hmc7043AppCtl.pDevCtl[dev]
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: sets up CLKDST device control parameters per the application's
+*                requirements
+*
+* - notes: not attempting to interlock the sequence here - if such interlocking
+*          is necessary, it must be provided by the caller
+*******************************************************************************/
+LOCAL STATUS hmc7043AppSetUpDevCtl(CKDST_DEV dev,
+                                   const Hmc7043_app_dev_params *pParams,
+                                   Bool validate)
+{
+    Hmc7043_app_dev_ctl *pCtl;
+
+    /* initialize */
+    if(!hmc7043DevPresent(dev) || !pParams) {
+        sysLog("bad argument(s) (dev %d, pParams %d)", dev, pParams != NULL);
+        return ERROR;
     }
 
-    pCtl->initDone = TRUE;
+    pCtl = hmc7043AppCtl.pDevCtl[dev];
+
+    if (validate && hmc7043AppChkParams(pParams) != OK) {
+        sysLog("bad device setup parameters (dev %d)", dev);
+        return ERROR;
+    }
+
+    /* set up device control parameters (the timing model being derived once
+       per clock plan, for the run-time services) */
+    if (hmc7043AppTimingInit(pParams, &pCtl->timing) != OK)
+        return ERROR;
+
+    pCtl->params = *pParams;
+
+    sysAtomicStoreRel(&pCtl->initDone, TRUE);
 
     return OK;
 }
@@ -2342,12 +4077,13 @@ LOCAL STATUS hmc7043AppSetUpDevCtl(CKDST_DEV dev,
 *******************************************************************************/
 LOCAL STATUS hmc7043AppChkProdId(CKDST_DEV dev)
 {
+	HMC7043_REG id[3];  /* 0x78 .. 0x7a */
 	Hmc7043_reg_x0078 r78;
 	Hmc7043_reg_x0079 r79;
 	Hmc7043_reg_x007a r7a;
 
 	/* initialize */
-	if (!inEnumRange(dev, NELEMENTS(hmc7043AppCtl.devCtl))) {
+	if (!hmc7043DevPresent(dev)) {
 	    sysLog("bad dev (%d)", dev);
 	    return ERROR;
 	}
@@ -2358,11 +4094,13 @@ LOCAL STATUS hmc7043AppChkProdId(CKDST_DEV dev)
 	}
 
 	/* read device id and compare to the expected */
-	if (hmc7043LliRegRead(dev, 0x0078, &r78.all) != OK ||
-	    hmc7043LliRegRead(dev, 0x0079, &r79.all) != OK ||
-	    hmc7043LliRegRead(dev, 0x007a, &r7a.all) != OK)
+	if (hmc7043LliRegReadBurstInCs(dev, 0x0078, id, NELEMENTS(id)) != OK)
 	    return ERROR;
 
+	r78.all = id[0];
+	r79.all = id[1];
+	r7a.all = id[2];
+
 	if (r78.fields.pIdLsb != (HMC7043_PRD_ID & 0xff) ||
 		r79.fields.pIdMid != ((HMC7043_PRD_ID >> 8) & 0xff) ||
 		r7a.fields.pIdMsb != HMC7043_PRD_ID >> 16) {
@@ -2381,29 +4119,19 @@ LOCAL STATUS hmc7043AppChkProdId(CKDST_DEV dev)
 *
 * - title: Set default values to reserved registers as in Table-40.
 *
-* - input: dev - CLKDST device for which to perform the operation
+* - input: pImg - pointer to the register image to set up
 *
 * - returns: OK or ERROR if detected an error
 *
 * - description: as above
 *******************************************************************************/
-LOCAL STATUS hmc7043LoadConfigUpd(CKDST_DEV dev)
+LOCAL STATUS hmc7043LoadConfigUpd(Hmc7043_reg_image *pImg)
 {
-	Hmc7043_reg_image *pImg;
-
-	/* initialize */
-	if (!inEnumRange(dev, NELEMENTS(hmc7043AppState.devState))) {
-	     sysLog("bad argument (dev %d)", dev);
-	     return ERROR;
-	}
-
-	if (!hmc7043IfCtl.initDone) {
-	    sysLog("interface initialization not done yet (dev %d)", dev);
-	    return ERROR;
+	if (!pImg) {
+		sysLog("bad argument (pImg %d)", pImg != NULL);
+		return ERROR;
 	}
 
-	 pImg = &hmc7043AppState.devState[dev].regImage;
-
 	 /* Set reserved registers as per table-40 */
 	 pImg->r98.all = 0x00; pImg->r99.all = 0x00; pImg->r9d.all = 0xAA;
 	 pImg->r9e.all = 0xAA; pImg->r9f.all = 0x4D; pImg->ra0.all = 0xDF;
@@ -2423,29 +4151,19 @@ LOCAL STATUS hmc7043LoadConfigUpd(CKDST_DEV dev)
 * - title: Set default values for all other reserved
 * 		   registers(other than the ones in table-40)
 *
-* - input: dev - CLKDST device for which to perform the operation
+* - input: pImg - pointer to the register image to set up
 *
 * - returns: OK or ERROR if detected an error
 *
 * - description: as above
 *******************************************************************************/
-LOCAL STATUS hmc7043AppInitReservedReg(CKDST_DEV dev)
+LOCAL STATUS hmc7043AppInitReservedReg(Hmc7043_reg_image *pImg)
 {
-	Hmc7043_reg_image *pImg;
-
-    /* initialize */
-	if (!inEnumRange(dev, NELEMENTS(hmc7043AppState.devState))) {
-	     sysLog("bad argument (dev %d)", dev);
-	     return ERROR;
-	}
-
-	if (!hmc7043IfCtl.initDone) {
-	    sysLog("interface initialization not done yet (dev %d)", dev);
-	    return ERROR;
+	if (!pImg) {
+		sysLog("bad argument (pImg %d)", pImg != NULL);
+		return ERROR;
 	}
 
-	pImg = &hmc7043AppState.devState[dev].regImage;
-
 	/* Initializing reserved registers(excluded from table-40) */
 	pImg->r05.all = 0x0F;
 	pImg->r07.all = 0x00;
@@ -2463,29 +4181,19 @@ LOCAL STATUS hmc7043AppInitReservedReg(CKDST_DEV dev)
 *
 * - title: Set default values for all reserved fields
 *
-* - input: dev - CLKDST device for which to perform the operation
+* - input: pImg - pointer to the register image to set up
 *
 * - returns: OK or ERROR if detected an error
 *
 * - description: as above
 *******************************************************************************/
-LOCAL STATUS hmc7043AppInitReservdFields(CKDST_DEV dev)
+LOCAL STATUS hmc7043AppInitReservdFields(Hmc7043_reg_image *pImg)
 {
-	Hmc7043_reg_image *pImg;
-
-	/* initialize */
-	if (!inEnumRange(dev, NELEMENTS(hmc7043AppState.devState))) {
-		 sysLog("bad argument (dev %d)", dev);
-		 return ERROR;
-	}
-
-	if (!hmc7043IfCtl.initDone) {
-		sysLog("interface initialization not done yet (dev %d)", dev);
+	if (!pImg) {
+		sysLog("bad argument (pImg %d)", pImg != NULL);
 		return ERROR;
 	}
 
-	pImg = &hmc7043AppState.devState[dev].regImage;
-
 	pImg->r00.fields.reserved = HMC7043_RSVD_VAL1;
 	pImg->r01.fields.reserved = HMC7043_RSVD_VAL2;
 	pImg->r02.fields.reserved1 = HMC7043_RSVD_VAL2;
@@ -2563,244 +4271,179 @@ LOCAL STATUS hmc7043AppInitReservdFields(CKDST_DEV dev)
 
 
 /*******************************************************************************
-* - name: hmc7043AppInitRdRegs
-*
-* - title: read CLKDST registers and set up register image data
+* - name: hmc7043AppRegRunLen
 *
-* - input: dev - CLKDST device for which to perform the operation
-*
-* - output: hmc7043AppState.devState[dev].regImage
+* - title: determine length of a run of contiguous registers in hmc7043AppRegDescs
 *
-* - returns: OK or ERROR if detected an error
+* - input: iDesc  - index of the first hmc7043AppRegDescs entry of the run
+*          nDescs - index of the hmc7043AppRegDescs entry beyond the last one
+*                   that may be included in the run
 *
-* - description: as above
+* - returns: number of entries in the run (at least 1)
 *
-* - notes: 1) Not attempting to reset the device here (that is up to the caller).
+* - description: a run consists of consecutive table entries whose register
+*                indices as well as register image offsets are contiguous, so
+*                that it can be transferred as a single burst directly to / from
+*                the register image
 *******************************************************************************/
-LOCAL STATUS hmc7043AppInitRdRegs(CKDST_DEV dev)
+LOCAL unsigned hmc7043AppRegRunLen(unsigned iDesc, unsigned nDescs)
 {
-    typedef struct {unsigned regInx, dataOffs;} Reg_desc;
-
-    static const Reg_desc regDescs[] = {
-#       define RDESC(reg)  {0x##reg, offsetof(Hmc7043_reg_image, r##reg.all)}
-
-		RDESC(01), RDESC(02), RDESC(03), RDESC(04), RDESC(05), RDESC(06),
-		RDESC(07), RDESC(08), RDESC(09), RDESC(0a), RDESC(0b), RDESC(46),
-		RDESC(50), RDESC(54),RDESC(5a), RDESC(5b), RDESC(5c), RDESC(5d),
-		RDESC(64), RDESC(65), RDESC(71),RDESC(98), RDESC(99), RDESC(9d),
-		RDESC(9e), RDESC(9f), RDESC(a0), RDESC(a2),	RDESC(a3), RDESC(a4),
-		RDESC(ad), RDESC(b5), RDESC(b6), RDESC(b7), RDESC(b8),RDESC(c8),
-		RDESC(c9), RDESC(ca), RDESC(cb), RDESC(cc), RDESC(cd), RDESC(ce),
-		RDESC(cf), RDESC(d0), RDESC(d2), RDESC(d3), RDESC(d5), RDESC(d6),
-		RDESC(d7), RDESC(d8), RDESC(d9), RDESC(da), RDESC(dc), RDESC(dd),
-		RDESC(de), RDESC(df), RDESC(e0), RDESC(e1), RDESC(e2), RDESC(e3),
-		RDESC(e4), RDESC(e6), RDESC(e7), RDESC(e8), RDESC(e9), RDESC(ea),
-		RDESC(eb), RDESC(ec), RDESC(ed), RDESC(ee),	RDESC(f0), RDESC(f1),
-		RDESC(f2), RDESC(f3), RDESC(f4), RDESC(f5), RDESC(f6), RDESC(f7),
-		RDESC(f8), RDESC(fa), RDESC(fb), RDESC(fc), RDESC(fd), RDESC(fe),
-		RDESC(ff), RDESC(100), RDESC(101), RDESC(102), RDESC(104), RDESC(105),
-		RDESC(106),	RDESC(107), RDESC(108), RDESC(109), RDESC(10a), RDESC(10b),
-		RDESC(10c), RDESC(10e),	RDESC(10f), RDESC(110), RDESC(111), RDESC(112),
-		RDESC(113), RDESC(114), RDESC(115),	RDESC(116), RDESC(118), RDESC(119),
-		RDESC(11a), RDESC(11b), RDESC(11c), RDESC(11e),	RDESC(11f), RDESC(120),
-		RDESC(122), RDESC(123), RDESC(124), RDESC(125), RDESC(126),	RDESC(127),
-		RDESC(128), RDESC(129), RDESC(12a), RDESC(12c), RDESC(12d), RDESC(12e),
-		RDESC(12f), RDESC(130), RDESC(131), RDESC(132), RDESC(133), RDESC(134),
-		RDESC(136),	RDESC(137), RDESC(138), RDESC(139), RDESC(13a), RDESC(13b),
-		RDESC(13c), RDESC(13e),	RDESC(140), RDESC(141), RDESC(142), RDESC(143),
-		RDESC(144), RDESC(145), RDESC(146),	RDESC(147), RDESC(148), RDESC(14a),
-		RDESC(14b), RDESC(14c), RDESC(14d), RDESC(14e),	RDESC(14f), RDESC(150),
-		RDESC(151), RDESC(152)
-#       undef RDESC
-    };
-
-    unsigned i;
-    Hmc7043_reg_image *pImg;
-
-    /* initialize */
-    if (!inEnumRange(dev, NELEMENTS(hmc7043AppState.devState))) {
-        sysLog("bad argument (dev %d)", dev);
-        return ERROR;
-    }
+    const Hmc7043_reg_desc *pDesc = hmc7043AppRegDescs + iDesc;
+    unsigned n = 1;
 
-    pImg = &hmc7043AppState.devState[dev].regImage;
+    while (iDesc + n < nDescs &&
+           pDesc[n].regInx == pDesc->regInx + n &&
+           pDesc[n].dataOffs == pDesc->dataOffs + n)
+        ++n;
 
-    /* perform the operation */
-    for (i = 0; i < NELEMENTS(regDescs); ++i) {
-        const Reg_desc *pDesc = regDescs + i;
+    return n;
+}
 
-        UINT8 *pData = (UINT8 *) pImg + pDesc->dataOffs;
 
-        if (hmc7043LliRegRead(dev, pDesc->regInx, pData) != OK)
-            return ERROR;
-    }
 
-    pImg->initDone = TRUE;
 
-    return OK;
+/*******************************************************************************
+* - name: hmc7043AppChRegs
+*
+* - title: get an output channel's control registers in a register image
+*
+* - input: pImg - pointer to the register image
+*          ch   - output channel (assumed to be valid)
+*
+* - returns: pointer to the channel's registers
+*
+* - description: as above (ref. hmc7043ChRegDescs)
+*******************************************************************************/
+INLINE Hmc7043_ch_regs *hmc7043AppChRegs(Hmc7043_reg_image *pImg, unsigned ch)
+{
+    return (Hmc7043_ch_regs *) ((UINT8 *) pImg +
+                                hmc7043ChRegDescs[ch].dataOffs);
 }
 
 
 
 
-
 /*******************************************************************************
-* - name: hmc7043AppInitWrRegs
+* - name: hmc7043AppXferRegs
 *
-* - title: write initialization register image data to CLKDST registers
+* - title: transfer register image data from / to CLKDST registers
 *
-* - input: dev - CLKDST device for which to perform the operation
+* - input: dev    - CLKDST device for which to perform the operation
+*          doRead - TRUE / FALSE to read / write the registers, respectively
+*
+* - output: hmc7043AppState.pDevState[dev]->regImage (only for a read operation),
+*           hmc7043AppState.pDevState[dev]->devImage, .devKnown
 *
 * - returns: OK or ERROR if detected an error
 *
-* - description: as above
+* - description: transfers all hmc7043AppRegDescs registers, one burst per run of
+*                contiguous registers (ref. hmc7043LliRegXferInCs)
+*
+* - notes: must be called within the associated critical section (ref.
+*          hmc7043CsEnter)
 *******************************************************************************/
-LOCAL STATUS hmc7043AppInitWrRegs(CKDST_DEV dev)
+LOCAL STATUS hmc7043AppXferRegs(CKDST_DEV dev, Bool doRead)
 {
-	typedef struct {unsigned regInx, dataOffs;} Reg_desc;
-
-	static const Reg_desc regDescs[] = {
-#       define RDESC(reg)  {0x##reg, offsetof(Hmc7043_reg_image, r##reg.all)}
-
-		RDESC(01), RDESC(02), RDESC(03), RDESC(04), RDESC(05), RDESC(06),
-		RDESC(07), RDESC(08), RDESC(09), RDESC(0a), RDESC(0b), RDESC(46),
-		RDESC(50), RDESC(54),RDESC(5a), RDESC(5b), RDESC(5c), RDESC(5d),
-		RDESC(64), RDESC(65), RDESC(71),RDESC(98), RDESC(99), RDESC(9d),
-		RDESC(9e), RDESC(9f), RDESC(a0), RDESC(a2),	RDESC(a3), RDESC(a4),
-		RDESC(ad), RDESC(b5), RDESC(b6), RDESC(b7), RDESC(b8),RDESC(c8),
-		RDESC(c9), RDESC(ca), RDESC(cb), RDESC(cc), RDESC(cd), RDESC(ce),
-		RDESC(cf), RDESC(d0), RDESC(d2), RDESC(d3), RDESC(d5), RDESC(d6),
-		RDESC(d7), RDESC(d8), RDESC(d9), RDESC(da), RDESC(dc), RDESC(dd),
-		RDESC(de), RDESC(df), RDESC(e0), RDESC(e1), RDESC(e2), RDESC(e3),
-		RDESC(e4), RDESC(e6), RDESC(e7), RDESC(e8), RDESC(e9), RDESC(ea),
-		RDESC(eb), RDESC(ec), RDESC(ed), RDESC(ee),	RDESC(f0), RDESC(f1),
-		RDESC(f2), RDESC(f3), RDESC(f4), RDESC(f5), RDESC(f6), RDESC(f7),
-		RDESC(f8), RDESC(fa), RDESC(fb), RDESC(fc), RDESC(fd), RDESC(fe),
-		RDESC(ff), RDESC(100), RDESC(101), RDESC(102), RDESC(104), RDESC(105),
-		RDESC(106),	RDESC(107), RDESC(108), RDESC(109), RDESC(10a), RDESC(10b),
-		RDESC(10c), RDESC(10e),	RDESC(10f), RDESC(110), RDESC(111), RDESC(112),
-		RDESC(113), RDESC(114), RDESC(115),	RDESC(116), RDESC(118), RDESC(119),
-		RDESC(11a), RDESC(11b), RDESC(11c), RDESC(11e),	RDESC(11f), RDESC(120),
-		RDESC(122), RDESC(123), RDESC(124), RDESC(125), RDESC(126),	RDESC(127),
-		RDESC(128), RDESC(129), RDESC(12a), RDESC(12c), RDESC(12d), RDESC(12e),
-		RDESC(12f), RDESC(130), RDESC(131), RDESC(132), RDESC(133), RDESC(134),
-		RDESC(136),	RDESC(137), RDESC(138), RDESC(139), RDESC(13a), RDESC(13b),
-		RDESC(13c), RDESC(13e),	RDESC(140), RDESC(141), RDESC(142), RDESC(143),
-		RDESC(144), RDESC(145), RDESC(146),	RDESC(147), RDESC(148), RDESC(14a),
-		RDESC(14b), RDESC(14c), RDESC(14d), RDESC(14e),	RDESC(14f), RDESC(150),
-		RDESC(151), RDESC(152)
-
-#       undef RDESC
-	};
+    Hmc7043_app_dev_state *pState;
+    unsigned i, n;
+    UINT8 *pImg;
+
+    /* initialize */
+    if (!hmc7043DevPresent(dev)) {
+        hmc7043Log("bad argument (dev %d)", dev);
+        return ERROR;
+    }
 
-	    unsigned i;
-	    const Hmc7043_reg_image *pImg;
+    pState = hmc7043AppState.pDevState[dev];
+    pImg = (UINT8 *) &pState->regImage;
 
-	    /* initialize */
-	    if (!inEnumRange(dev, NELEMENTS(hmc7043AppState.devState))) {
-	        sysLog("bad argument (dev %d)", dev);
-	        return ERROR;
-	    }
+    /* perform the operation */
+    for (i = 0; i < NELEMENTS(hmc7043AppRegDescs); i += n) {
+        const Hmc7043_reg_desc *pDesc = hmc7043AppRegDescs + i;
 
-	    pImg = &hmc7043AppState.devState[dev].regImage;
+        n = hmc7043AppRegRunLen(i, NELEMENTS(hmc7043AppRegDescs));
 
-	    /* perform the operation */
-	    for (i = 0; i < NELEMENTS(regDescs); ++i) {
-	        const Reg_desc *pDesc = regDescs + i;
+        if ((doRead ?
+             hmc7043LliRegReadBurstInCs (dev, pDesc->regInx,
+                                         pImg + pDesc->dataOffs, n) :
+             hmc7043LliRegWriteBurstInCs(dev, pDesc->regInx,
+                                         pImg + pDesc->dataOffs, n)) != OK)
+            return ERROR;
+    }
 
-	        UINT8 regData = *((UINT8 *) pImg + pDesc->dataOffs);
+    /* the device registers are now known to match the register image */
+    pState->devImage = pState->regImage;
+    memset(pState->devKnown, 0xff, sizeof(pState->devKnown));
 
-	        if (hmc7043LliRegWrite(dev, pDesc->regInx, regData) != OK)
-	            return ERROR;
-	    }
+    hmc7043AppPersistImage(dev);
 
-	    return OK;
+    return OK;
 }
 
 
 
 
 /*******************************************************************************
-* - name: hmc7043ToggleBit
+* - name: hmc7043AppRegDescInx
 *
-* - title: Toggle the register bit mentioned in 'fieldBit' parameter at register
-*          address- regIdx.
+* - title: find the hmc7043AppRegDescs entry of a register
 *
-* - input: dev - CLKDST device for which to perform the operation
-*          pParams - pointer to device setup parameters
-*          regIdx - register address where to bit to be toggled is present.
-*          field - the bit to be toggled.
+* - input: regInx - CLKDST register index
 *
-* - returns: OK or ERROR if detected an error
+* - returns: index of the hmc7043AppRegDescs entry or -1 if the register is not
+*            maintained in the register image
 *
-* - description: as above
+* - description: as above (binary search, relying on the table ordering)
 *******************************************************************************/
-LOCAL STATUS hmc7043ToggleBit(CKDST_DEV dev, unsigned regIdx,
-		                          HMC7043_REG fieldBit,unsigned delay)
+LOCAL int hmc7043AppRegDescInx(unsigned regInx)
 {
-	HMC7043_REG data;
-
-	if (!inEnumRange(dev, NELEMENTS(hmc7043AppState.devState))) {
-		sysLog("bad argument (dev %d)", dev);
-		return ERROR;
-	}
-
-	if (!hmc7043IfCtl.initDone) {
-		sysLog("interface initialization not done yet (dev %d)", dev);
-		return ERROR;
-	}
+    int lo = 0, hi = NELEMENTS(hmc7043AppRegDescs) - 1;
 
-	if(hmc7043LliRegRead(dev, regIdx, &data) != OK)
-		return ERROR;
-
-	if(hmc7043LliRegWrite(dev, regIdx, (data | (1 << fieldBit))) != OK)
-		return ERROR;
-
-	data &= ~fieldBit;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
 
-	if(hmc7043LliRegWrite(dev, regIdx, data) != OK)
-			return ERROR;
+        if (hmc7043AppRegDescs[mid].regInx == regInx)
+            return mid;
 
-	sysDelayUsec(delay);
+        if (hmc7043AppRegDescs[mid].regInx < regInx)
+            lo = mid + 1;
+        else
+            hi = mid - 1;
+    }
 
-	return OK;
+    return -1;
 }
 
 
 
 
-
 /*******************************************************************************
-* - name: hmc7043WaitSysrefPeriod
+* - name: hmc7043AppRegForceWr
 *
-* - title: Find the GCD of sysref frequencies
+* - title: force a register to be written by the next register image flush
 *
-* - input: dev - CLKDST device for which to perform the operation
-*          times - multiplication factor for wait period
+* - input: dev    - CLKDST device for which to perform the operation
+*          regInx - CLKDST register index
+*
+* - output: hmc7043AppState.pDevState[dev]->devKnown
 *
 * - returns: OK or ERROR if detected an error
 *
-* - description: as above
+* - description: needed for registers with side effects on write (e.g. alarm
+*                clearing), which must be written even if their value did not
+*                change since they were last written
 *******************************************************************************/
-LOCAL STATUS hmc7043WaitSysrefPeriod(CKDST_DEV dev, unsigned times)
+LOCAL STATUS hmc7043AppRegForceWr(CKDST_DEV dev, unsigned regInx)
 {
-	UINT64 sysrefPeriod;
-	Hmc7043_reg_x005c r5c;
-	Hmc7043_reg_x005d r5d;
-
+    int iDesc = hmc7043AppRegDescInx(regInx);
 
-	if (!inEnumRange(dev, NELEMENTS(hmc7043AppState.devState))) {
-		sysLog("bad argument (dev %d)", dev);
-		return ERROR;
-	}
-
-	if((hmc7043LliRegRead(dev, 0x005c, &r5c.all) != OK) ||
-	   (hmc7043LliRegRead(dev, 0x005d, &r5d.all) != OK) )
-		return ERROR;
+    if (!hmc7043DevPresent(dev) || iDesc < 0) {
+        hmc7043Log("bad argument(s) (dev %d, regInx 0x%02x)", dev, regInx);
+        return ERROR;
+    }
 
-    sysrefPeriod = r5d.fields.timer << 0xf;
-    sysrefPeriod = sysrefPeriod | r5c.fields.timer;
-	sysDelayUsec((sysrefPeriod * times));
+    hmc7043AppState.pDevState[dev]->devKnown[iDesc / 32] &=
+        ~(1U << (iDesc % 32));
 
     return OK;
 }
@@ -2809,1657 +4452,5144 @@ LOCAL STATUS hmc7043WaitSysrefPeriod(CKDST_DEV dev, unsigned times)
 
 
 /*******************************************************************************
-* - name: hmc7043AppInitPgmSysrefTimer
+* - name: hmc7043AppRegClass
 *
-* - title: Program the SYSREF timer with submultiple of lowest
-*          output sysref frequency, not greater than 4MHz.
-*
-* - input: dev - CLKDST device for which to perform the operation
-*          pParams - pointer to device setup parameters
+* - title: classify a CLKDST register
 *
-* - output: hmc7043AppState.devState[dev].regImage
+* - input: regInx - CLKDST register index
 *
-* - returns: OK or ERROR if detected an error
+* - returns: the register class
 *
-* - description: as above
+* - description: as per hmc7043RegClassRanges, else as per whether the register
+*                is maintained in the register image
 *******************************************************************************/
-LOCAL STATUS hmc7043AppInitPgmSysrefTimer(CKDST_DEV dev,
-		                          const Hmc7043_app_dev_params *pParams)
+LOCAL HMC7043_REG_CLASS hmc7043AppRegClass(unsigned regInx)
 {
-	Hmc7043_reg_image *pImg;
-	unsigned ch;
-	CKDST_FREQ_HZ minFreq = 0;
+    unsigned i;
 
-	if (!inEnumRange(dev, NELEMENTS(hmc7043AppState.devState)) || !pParams ||
-			(pParams->clkInFreq == 0) ) {
-		sysLog("bad argument(s) (dev %d, pParams %d)", dev, pParams != NULL);
-		return ERROR;
-	}
+    for (i = 0; i < NELEMENTS(hmc7043RegClassRanges); ++i)
+        if (regInx >= hmc7043RegClassRanges[i].first &&
+            regInx <= hmc7043RegClassRanges[i].last)
+            return hmc7043RegClassRanges[i].cls;
 
-	pImg = &hmc7043AppState.devState[dev].regImage;
+    return hmc7043AppRegDescInx(regInx) >= 0 ? HMC7043_RCL_CTL :
+                                               HMC7043_RCL_STATUS;
+}
 
-	/* Find lowest output(SYSREF) frequency */
-	for (ch = 0; ch < HMC7043_OUT_NCHAN; ch++) {
-		if(pParams->chSup[ch].chMode == HMC7043_CHM_SYSREF) {
-			if(minFreq == 0) {
-				minFreq = pParams->chSup[ch].freq;
-			}
-			else {
-				if(pParams->chSup[ch].freq < minFreq)
-					minFreq = pParams->chSup[ch].freq;
-			}
-		}
-	}
 
-	/* Check if SYSREF Timer count is multiple of lowest output(SYSREF)
-	 * frequency and not greater than 4MHz*/
-	if(pParams->sysref.freq >= 4000000U ||
-			(pParams->sysref.freq % minFreq != 0)) {
-		sysLog("SYSREF frequency is not an integer multiple of all channel "
-				"dividers (lowest output(SYSREF) frequency %lu, sysref "
-				"frequency %lu)", minFreq, pParams->sysref.freq);
-		return ERROR;
-	}
 
-    pImg->r5c.all = (pParams->sysref.freq & 0xff);
-    pImg->r5d.fields.timer = pParams->sysref.freq >> 8;
 
-	return OK;
+/*******************************************************************************
+* - name: hmc7043AppShadowRead
+*
+* - title: serve a register read from the device image
+*
+* - input: dev     - CLKDST device for which to perform the operation
+*          regInx  - first CLKDST register to read
+*          pData   - pointer to where to return read data (nRegs entries)
+*          nRegs   - number of registers to read
+*          selfClr - if set, self-clearing registers may be served as well
+*                    (i.e. their value as last written)
+*
+* - output: pData[0 .. nRegs - 1]
+*
+* - returns: TRUE if served, else FALSE (the registers then having to be read
+*            from the device)
+*
+* - description: serves the read only if all the registers are control
+*                registers (ref. hmc7043AppRegClass) whose device value is
+*                known, and not in read-through mode (ref.
+*                hmc7043SetRegReadThrough)
+*
+* - notes: must be called within the associated critical section
+*******************************************************************************/
+LOCAL Bool hmc7043AppShadowRead(CKDST_DEV dev, unsigned regInx,
+                                HMC7043_REG *pData, unsigned nRegs,
+                                Bool selfClr)
+{
+    const Hmc7043_app_dev_state *pState;
+    unsigned i;
+    int iDesc;
+
+    if (hmc7043ShadowCtl.readThrough || !hmc7043DevPresent(dev) || !pData ||
+        !nRegs || nRegs > HMC7043_APP_NREG_DESCS)
+        return FALSE;
+
+    pState = hmc7043AppState.pDevState[dev];
+
+    for (i = 0; i < nRegs; ++i) {
+        HMC7043_REG_CLASS cls = hmc7043AppRegClass(regInx + i);
+
+        iDesc = hmc7043AppRegDescInx(regInx + i);
+
+        if (iDesc < 0 ||
+            !(cls == HMC7043_RCL_CTL || (selfClr && cls == HMC7043_RCL_SELF_CLR)) ||
+            !(pState->devKnown[iDesc / 32] & 1U << iDesc % 32))
+            return FALSE;
+    }
+
+    for (i = 0; i < nRegs; ++i)
+        pData[i] = ((const UINT8 *) &pState->devImage)
+                   [hmc7043AppRegDescs[hmc7043AppRegDescInx(regInx + i)].dataOffs];
+
+    sysAtomicAddRelaxed(&hmc7043StatsCtl.pDevStats[dev]->nShadowReads, nRegs);
+
+    return TRUE;
 }
 
 
 
 
 /*******************************************************************************
-* - name: hmc7043AppInitPgmOutCh
+* - name: hmc7043AppShadowWrite
 *
-* - title: Program the output used channels
+* - title: record a direct register write in the device image
 *
-* - input: dev - CLKDST device for which to perform the operation
-*          pParams - pointer to device setup parameters
+* - input: dev    - CLKDST device for which to perform the operation
+*          regInx - first CLKDST register written
+*          pData  - data written (nRegs entries), NULL if the write failed
+*          nRegs  - number of registers written
 *
-* - output: hmc7043AppState.devState[dev].regImage
+* - output: hmc7043AppState.pDevState[dev]->devImage, .devKnown
 *
-* - returns: OK or ERROR if detected an error
+* - description: for the registers maintained in the register image, updates
+*                their device image value (or, if the write failed, marks it as
+*                not known), so that shadow reads and flushes stay consistent
+*                with the device
 *
-* - description: as above
+* - notes: must be called within the associated critical section
 *******************************************************************************/
-LOCAL STATUS hmc7043AppInitPgmOutCh(CKDST_DEV dev,
-		                          const Hmc7043_app_dev_params *pParams)
+LOCAL void hmc7043AppShadowWrite(CKDST_DEV dev, unsigned regInx,
+                                 const HMC7043_REG *pData, unsigned nRegs)
 {
-	Hmc7043_reg_image *pImg;
-	unsigned ch;
-	CKDST_FREQ_HZ clkInpFreq = 0;
-	unsigned chDivider = 0, addMultislip = 0, multiSlip = 0;
-	double mDelay, slQuPs, halfFreq, remSlip, numDigSteps;
-	double numAnlgSteps, remaDly, remdDly;
+    Hmc7043_app_dev_state *pState;
+    Bool changed = FALSE;
+    unsigned i;
 
-	if (!inEnumRange(dev, NELEMENTS(hmc7043AppState.devState)) || !pParams) {
-		sysLog("bad argument(s) (dev %d, pParams %d)", dev, pParams != NULL);
-		return ERROR;
-	}
+    if (!hmc7043DevPresent(dev))
+        return;
 
-	pImg = &hmc7043AppState.devState[dev].regImage;
+    pState = hmc7043AppState.pDevState[dev];
 
-	if(pParams->clkInDiv == HMC7043_CID_2) {
-		clkInpFreq = pParams->clkInFreq/2;
-	}
-	else if(pParams->clkInDiv == HMC7043_CID_1){
-		clkInpFreq = pParams->clkInFreq;
-	}
+    for (i = 0; i < nRegs; ++i) {
+        int iDesc = hmc7043AppRegDescInx(regInx + i);
 
-	for (ch = 0; ch < HMC7043_OUT_NCHAN; ch++) {
-		if(pParams->chSup[ch].chMode != HMC7043_CHM_UNUSED)
-		{
-			chDivider = clkInpFreq/pParams->chSup[ch].freq;
-
-			/* Validating Coarse Digital Delay */
-			halfFreq = 0.5 * pParams->clkInFreq;
-			remdDly = remainder(pParams->chSup[ch].dDlyPs, halfFreq);
-			numDigSteps = pParams->chSup[ch].dDlyPs/halfFreq;
-			if(fabs(remdDly) > 0.1) {
-				sysLog("dDlyPs (pParams->chSup[%u].dDlyPs %f) "
-						"should be a multiple to 0.1ps "
-						"accuracy.",ch,
-						pParams->chSup[ch].dDlyPs);
-				return ERROR;
+        if (iDesc < 0)
+            continue;
 
-			}
-			if(pParams->chSup[ch].dDlyPs > (17*halfFreq)) {
-				sysLog("dDlyPs (pParams->chSup[ch].dDlyPs %f)should"
-						"be less than or equal to 17 half clocks",
-						pParams->chSup[ch].dDlyPs);
-				return ERROR;
-			}
+        if (pData) {
+            ((UINT8 *) &pState->devImage)[hmc7043AppRegDescs[iDesc].dataOffs] =
+                pData[i];
+            pState->devKnown[iDesc / 32] |= 1U << iDesc % 32;
+        } else
+            pState->devKnown[iDesc / 32] &= ~(1U << iDesc % 32);
 
-			/* MultiSlip delay validation */
-			if(pParams->chSup[ch].slipQuantumPs >1) {
-				remSlip = fmod(pParams->chSup[ch].slipQuantumPs, clkInpFreq);
-				slQuPs = pParams->chSup[ch].slipQuantumPs/clkInpFreq;
-				if(fabs(remSlip) > 0.1) {
-					sysLog("slipQuantumPs ( pParams->chSup[%u]."
-							"slipQuantumPs %f) should"
-							"be an integral multiple of input "
-							"clock cycle",ch,
-							pParams->chSup[ch].slipQuantumPs);
-					return ERROR;
-				}
-			}
+        changed = TRUE;
+    }
 
-			/* Validating Analog Delay */
-			remaDly = fmod(pParams->chSup[ch].aDlyPs, 25);
-			numAnlgSteps = pParams->chSup[ch].aDlyPs/25;
-			if(remaDly > 0.1) {
-				sysLog("aDlyPs(pParams->chSup[%d].aDlyPs %f) should"
-						"be a multiple to 0.1ps accuracy.",ch,
-						pParams->chSup[ch].aDlyPs);
-				return ERROR;
-			}
-			if (pParams->chSup[ch].aDlyPs >
-	                (HMC7043_ADLY_MAX_STEPS *
-	                		HMC7043_ADLY_STEP_SIZE)) {
-				sysLog("aDlyPs(pParams->chSup[%d].aDlyPs %f) should"
-						"be less than or equal to 23*25.",ch,
-						pParams->chSup[ch].aDlyPs);
-				return ERROR;
-			}
+    if (changed)
+        hmc7043AppPersistImage(dev);
+}
 
-			/* Verify that analog delay is not configured as output MUX
-			 * for a DCLK channel */
-			if((pParams->chSup[ch].chMode == HMC7043_CHM_CLK) &&
-				(pParams->chSup[ch].outSel == HMC7043_COS_DIV_ADLY)){
-				sysLog("Exposing analog delay on output MUX for "
-						"DCLK channels causes phase noise "
-						"degradation.");
-				return ERROR;
-			}
 
-			switch(ch){
-				case 0: {
-					pImg->rc8.fields.chEn_0 = 0x1;
-					pImg->rc8.fields.hpMode_0 =
-							pParams->chSup[ch].highPerfMode? 1 : 0;
-					pImg->rc8.fields.syncEn_0 = 0x1;
-					pImg->rd0.fields.drvMod_0 = pParams->chSup[ch].drvMode;
-
-					/* Configure channel divider */
-					pImg->rc9.fields.chDivLsb_0 =
-							HMC7043_LSB_BIT_VAL(chDivider);
-					pImg->rca.fields.chDivMsb_0 =
-							HMC7043_MSB_BIT_VAL(chDivider);
-					/* MultiSlip delay configuration */
-					if(pParams->chSup[ch].slipQuantumPs >1) {
-						pImg->rc8.fields.multSlpEn_0 = 1;
-						addMultislip = chDivider/2;
-						multiSlip = slQuPs + addMultislip;
-
-						pImg->rcd.fields.msDelayLsb_0 =
-								HMC7043_LSB_BIT_VAL(multiSlip);
-						pImg->rce.fields.msDelayMsb_0 =
-								HMC7043_LSB_BIT_VAL(multiSlip);
-					} else if(pParams->chSup[ch].slipQuantumPs  == 1) {
-						pImg->rc8.fields.slipEn_0 = 0x1;
-					}
-					/* Configuring Coarse Digital Delay */
-					pImg->rcc.fields.cdDelay_0 = (unsigned)numDigSteps;
-					/* Configuring  Fine Analog Delay */
-					pImg->rcb.fields.faDelay_0 = (unsigned)numAnlgSteps;
-					/* Configuring Driver Impedance*/
-					if(pParams->chSup[ch].drvMode == HMC7043_CDM_CML) {
-						if(pParams->chSup[ch].cmlTerm == HMC7043_CCIT_NONE)
-							pImg->rd0.fields.drvImp_0 = 0x0;
-						else if(pParams->chSup[ch].cmlTerm == HMC7043_CCIT_100)
-							pImg->rd0.fields.drvImp_0 = 0x1;
-						else if(pParams->chSup[ch].cmlTerm == HMC7043_CCIT_50)
-							pImg->rd0.fields.drvImp_0 = 0x3;
-					}
-
-					if(pParams->chSup[ch].chMode == HMC7043_CHM_CLK) {
-						pImg->rd0.fields.idlAtZero_0 = 0x0;
-					} else if(pParams->chSup[ch].chMode == HMC7043_CHM_SYSREF) {
-						pImg->rd0.fields.dyDrvEn_0 =
-								pParams->chSup[ch].dynDriverEn? 1 : 0;
-					}
-
-					/* Configure start-up mode */
-					if(pParams->chSup[ch].dynDriverEn)
-						pImg->rc8.fields.stMod_0 = 0x3;
-					else
-						pImg->rc8.fields.stMod_0 = 0x0;
-
-					/* Configure output MUX selection */
-					if(pParams->chSup[ch].outSel ==
-							HMC7043_COS_FUNDAMENTAL)
-						pImg->rcf.fields.outMuxSel_0 = 0x3;
-					else if(pParams->chSup[ch].outSel ==
-							HMC7043_COS_DIVIDER)
-						pImg->rcf.fields.outMuxSel_0 = 0x0;
-					else if(pParams->chSup[ch].outSel ==
-							HMC7043_COS_DIV_ADLY)
-						pImg->rcf.fields.outMuxSel_0 = 0x1;
-					else if(pParams->chSup[ch].outSel ==
-							HMC7043_COS_DIV_NEIGHBOR)
-						pImg->rcf.fields.outMuxSel_0 = 0x2;
 
-					break;
-				}
-				case 1: {
-					    pImg->rd3.fields.chDivLsb_1 =
-					    		HMC7043_LSB_BIT_VAL(chDivider);
-					    pImg->rd4.fields.chDivMsb_1 =
-					    		HMC7043_LSB_BIT_VAL(chDivider);
-						pImg->rd2.fields.hpMode_1 =
-								pParams->chSup[ch].highPerfMode;
-						pImg->rd2.fields.syncEn_1 = 0x1;
-						//pImg->rd2.fields.slipEn_1 = 0x1;
-						mDelay = pParams->chSup[ch].slipQuantumPs/clkInpFreq;
-						if(mDelay > 1) {
-							pImg->rd2.fields.multSlpEn_1 = 0x1;
-							//pImg->rd7.fields.msDelayLsb_1 = ;TBD
-						   // pImg->rd8.fields.msDelayMsb_1 = ;
-						}
-						//pImg->rd5.fields.faDelay_1 = pParams->chSup[ch].aDlyPs;
-						//pImg->rd6.fields.cdDelay_1 = pParams->chSup[ch].dDlyPs;
-						pImg->rda.fields.drvMod_1 = pParams->chSup[ch].drvMode;
-
-						/* MultiSlip delay configuration */
-						if(pParams->chSup[ch].slipQuantumPs >1) {
-							pImg->rc8.fields.multSlpEn_0 = 1;
-							addMultislip = chDivider/2;
-							multiSlip = slQuPs + addMultislip;
-
-							pImg->rcd.fields.msDelayLsb_0 =
-									HMC7043_LSB_BIT_VAL(multiSlip);
-							pImg->rce.fields.msDelayMsb_0 =
-									HMC7043_LSB_BIT_VAL(multiSlip);
-						} else if(pParams->chSup[ch].slipQuantumPs  == 1) {
-							pImg->rc8.fields.slipEn_0 = 0x1;
-						}
-						/* Configuring Coarse Digital Delay */
-						pImg->rcc.fields.cdDelay_0 = (unsigned)numDigSteps;
-						/* Configuring  Fine Analog Delay */
-						pImg->rcb.fields.faDelay_0 = (unsigned)numAnlgSteps;
-						if(pParams->chSup[ch].drvMode == HMC7043_CDM_CML) {
-							if(pParams->chSup[ch].cmlTerm == HMC7043_CCIT_NONE)
-								pImg->rda.fields.drvImp_1 = 0x0;
-							else if(pParams->chSup[ch].cmlTerm ==
-									HMC7043_CCIT_100)
-								pImg->rda.fields.drvImp_1 = 0x1;
-							else if(pParams->chSup[ch].cmlTerm ==
-									HMC7043_CCIT_50)
-								pImg->rda.fields.drvImp_1 = 0x3;
-						}
-						if(pParams->chSup[ch].chMode == HMC7043_CHM_CLK) {
-							pImg->rda.fields.idlAtZero_1 = 0x00;
-						}
-						else if(pParams->chSup[ch].chMode ==
-								HMC7043_CHM_SYSREF) {
-							pImg->rda.fields.dyDrvEn_1 =
-									pParams->chSup[ch].dynDriverEn? 1 : 0;
-						}
-						pImg->rd2.fields.chEn_1 = 0x1;
-						if(pParams->chSup[ch].dynDriverEn)
-							pImg->rd2.fields.stMod_1 = 0x3;
-						else
-							pImg->rd2.fields.stMod_1 = 0x0;
-
-						if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_FUNDAMENTAL)
-							pImg->rd9.fields.outMuxSel_1 = 0x3;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIVIDER)
-							pImg->rd9.fields.outMuxSel_1 = 0x0;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIV_ADLY)
-							pImg->rd9.fields.outMuxSel_1 = 0x1;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIV_NEIGHBOR)
-							pImg->rd9.fields.outMuxSel_1 = 0x2;
-						break;
-			    }
-
-				case 2: {
-					    pImg->rdd.fields.chDivLsb_2 =
-					    		HMC7043_LSB_BIT_VAL(chDivider);
-					    pImg->rde.fields.chDivMsb_2 =
-					    		HMC7043_MSB_BIT_VAL(chDivider);
-						pImg->rdc.fields.hpMode_2 =
-								pParams->chSup[ch].highPerfMode;
-						pImg->rdc.fields.syncEn_2 = 0x1;
-						pImg->rdc.fields.slipEn_2 = 0x1;
-						pImg->rdf.fields.faDelay_2 = pParams->chSup[ch].aDlyPs;
-						pImg->re0.fields.cdDelay_2 = pParams->chSup[ch].dDlyPs;
-						pImg->re4.fields.drvMod_2 = pParams->chSup[ch].drvMode;
-						if(pParams->chSup[ch].drvMode == HMC7043_CDM_CML) {
-							if(pParams->chSup[ch].cmlTerm == HMC7043_CCIT_NONE)
-								pImg->re4.fields.drvImp_2 = 0x0;
-							else if(pParams->chSup[ch].cmlTerm ==
-									HMC7043_CCIT_100)
-								pImg->re4.fields.drvImp_2 = 0x1;
-							else if(pParams->chSup[ch].cmlTerm ==
-									HMC7043_CCIT_50)
-								pImg->re4.fields.drvImp_2 = 0x3;
-						}
-						if(pParams->chSup[ch].chMode == HMC7043_CHM_CLK) {
-							pImg->re4.fields.idlAtZero_2 = 0x00;
-						}
-						else if(pParams->chSup[ch].chMode ==
-								HMC7043_CHM_SYSREF) {
-							pImg->re4.fields.dyDrvEn_2 =
-									pParams->chSup[ch].dynDriverEn? 1 : 0;
-						}
-						pImg->rdc.fields.chEn_2 = 0x1;
-						if(pParams->chSup[ch].dynDriverEn)
-							pImg->rdc.fields.stMod_2 = 0x3;
-						else
-							pImg->rdc.fields.stMod_2 = 0x0;
-
-						if(pParams->chSup[ch].outSel == HMC7043_COS_FUNDAMENTAL)
-							pImg->re3.fields.outMuxSel_2 = 0x3;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIVIDER)
-							pImg->re3.fields.outMuxSel_2 = 0x0;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIV_ADLY)
-							pImg->re3.fields.outMuxSel_2 = 0x1;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIV_NEIGHBOR)
-							pImg->re3.fields.outMuxSel_2 = 0x2;
-						break;
-			    }
-				case 3: {
-					    pImg->re7.fields.chDivLsb_3 =
-					    		HMC7043_LSB_BIT_VAL(chDivider);
-					    pImg->re8.fields.chDivMsb_3 =
-					    		HMC7043_MSB_BIT_VAL(chDivider);
-						pImg->re6.fields.hpMode_3 =
-								pParams->chSup[ch].highPerfMode;
-						pImg->re6.fields.syncEn_3 = 0x1;
-						pImg->re6.fields.slipEn_3 = 0x1;
-						pImg->re9.fields.faDelay_3 = pParams->chSup[ch].aDlyPs;
-						pImg->rea.fields.cdDelay_3 = pParams->chSup[ch].dDlyPs;
-						pImg->ree.fields.drvMod_3 = pParams->chSup[ch].drvMode;
-						if(pParams->chSup[ch].drvMode == HMC7043_CDM_CMOS) {
-							pImg->re6.fields.multSlpEn_3 = 1;
-							addMultislip = chDivider/2;
-							mDelay = pParams->chSup[ch].slipQuantumPs/clkInpFreq;
-							multiSlip = mDelay + addMultislip;
-							pImg->reb.fields.msDelayLsb_3 = (multiSlip & 0xff);
-							pImg->rec.fields.msDelayMsb_3 = multiSlip >> 8;
-
-						}
-						if(pParams->chSup[ch].drvMode == HMC7043_CDM_CML) {
-						    if(pParams->chSup[ch].cmlTerm == HMC7043_CCIT_NONE)
-								pImg->ree.fields.drvImp_3 = 0x0;
-							else if(pParams->chSup[ch].cmlTerm ==
-									HMC7043_CCIT_100)
-								pImg->ree.fields.drvImp_3 = 0x1;
-							else if(pParams->chSup[ch].cmlTerm ==
-									HMC7043_CCIT_50)
-								pImg->ree.fields.drvImp_3 = 0x3;
-						}
-						if(pParams->chSup[ch].chMode == HMC7043_CHM_CLK) {
-							pImg->ree.fields.idlAtZero_3 = 0x00;
-						}
-						else if(pParams->chSup[ch].chMode ==
-								HMC7043_CHM_SYSREF) {
-							pImg->ree.fields.dyDrvEn_3 =
-									pParams->chSup[ch].dynDriverEn? 1 : 0;
-						}
-						pImg->re6.fields.chEn_3 = 0x1;
-						if(pParams->chSup[ch].dynDriverEn)
-							pImg->re6.fields.stMod_3 = 0x3;
-						else
-							pImg->re6.fields.stMod_3 = 0x0;
-
-						if(pParams->chSup[ch].outSel == HMC7043_COS_FUNDAMENTAL)
-							pImg->red.fields.outMuxSel_3 = 0x3;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIVIDER)
-							pImg->red.fields.outMuxSel_3 = 0x0;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIV_ADLY)
-							pImg->red.fields.outMuxSel_3 = 0x1;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIV_NEIGHBOR)
-							pImg->red.fields.outMuxSel_3 = 0x2;
-						break;
-				}
-				case 4: {
-					    pImg->rf1.fields.chDivLsb_4 =
-					    		HMC7043_LSB_BIT_VAL(chDivider);
-					    pImg->rf2.fields.chDivMsb_4 =
-					    		HMC7043_MSB_BIT_VAL(chDivider);
-						pImg->rf0.fields.hpMode_4 =
-								pParams->chSup[ch].highPerfMode;
-						pImg->rf0.fields.syncEn_4 = 0x1;
-						pImg->rf0.fields.slipEn_4 = 0x1;
-						pImg->rf3.fields.faDelay_4 = pParams->chSup[ch].aDlyPs;
-						pImg->rf4.fields.cdDelay_4 = pParams->chSup[ch].dDlyPs;
-						pImg->rf8.fields.drvMod_4 = pParams->chSup[ch].drvMode;
-						if(pParams->chSup[ch].drvMode == HMC7043_CDM_CML) {
-							if(pParams->chSup[ch].cmlTerm == HMC7043_CCIT_NONE)
-								pImg->rf8.fields.drvImp_4 = 0x0;
-							else if(pParams->chSup[ch].cmlTerm ==
-									HMC7043_CCIT_100)
-								pImg->rf8.fields.drvImp_4 = 0x1;
-							else if(pParams->chSup[ch].cmlTerm ==
-									HMC7043_CCIT_50)
-								pImg->rf8.fields.drvImp_4 = 0x3;
-						}
-						if(pParams->chSup[ch].chMode == HMC7043_CHM_CLK) {
-							pImg->rf8.fields.idlAtZero_4 = 0x00;
-						}
-						else if(pParams->chSup[ch].chMode == HMC7043_CHM_SYSREF) {
-							pImg->rf8.fields.dyDrvEn_4 =
-									pParams->chSup[ch].dynDriverEn? 1 : 0;
-						}
-						pImg->rf0.fields.chEn_4 = 0x1;
-						if(pParams->chSup[ch].dynDriverEn)
-							pImg->rf0.fields.stMod_4 = 0x3;
-						else
-							pImg->rf0.fields.stMod_4 = 0x0;
-
-						if(pParams->chSup[ch].outSel == HMC7043_COS_FUNDAMENTAL)
-							pImg->rf7.fields.outMuxSel_4 = 0x3;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIVIDER)
-							pImg->rf7.fields.outMuxSel_4 = 0x0;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIV_ADLY)
-							pImg->rf7.fields.outMuxSel_4 = 0x1;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIV_NEIGHBOR)
-							pImg->rf7.fields.outMuxSel_4 = 0x2;
-						break;
-				}
-				case 5: {
-					    pImg->rfb.fields.chDivLsb_5 =
-					    		HMC7043_LSB_BIT_VAL(chDivider);
-					    pImg->rfc.fields.chDivMsb_5 =
-					    		HMC7043_MSB_BIT_VAL(chDivider);
-						pImg->rfa.fields.hpMode_5 =
-								pParams->chSup[ch].highPerfMode;
-						pImg->rfa.fields.syncEn_5 = 0x1;
-						pImg->rfa.fields.slipEn_5 = 0x1;
-						pImg->rfd.fields.faDelay_5 = pParams->chSup[ch].aDlyPs;
-						pImg->rfe.fields.cdDelay_5 = pParams->chSup[ch].dDlyPs;
-						pImg->r102.fields.drvMod_5 = pParams->chSup[ch].drvMode;
-						if(pParams->chSup[ch].drvMode == HMC7043_CDM_CMOS) {
-							pImg->rfa.fields.multSlpEn_5 = 1;
-							addMultislip = chDivider/2;
-							mDelay = pParams->chSup[ch].slipQuantumPs/clkInpFreq;
-							multiSlip = mDelay + addMultislip;
-							pImg->rff.fields.msDelayLsb_5 = (multiSlip & 0xff);
-							pImg->r100.fields.msDelayMsb_5 = multiSlip >> 8;
-
-						}
-						if(pParams->chSup[ch].drvMode == HMC7043_CDM_CML) {
-							if(pParams->chSup[ch].cmlTerm == HMC7043_CCIT_NONE)
-								pImg->r102.fields.drvImp_5 = 0x0;
-							else if(pParams->chSup[ch].cmlTerm ==
-									HMC7043_CCIT_100)
-								pImg->r102.fields.drvImp_5 = 0x1;
-							else if(pParams->chSup[ch].cmlTerm ==
-									HMC7043_CCIT_50)
-								pImg->r102.fields.drvImp_5 = 0x3;
-						}
-						if(pParams->chSup[ch].chMode == HMC7043_CHM_CLK) {
-							pImg->r102.fields.idlAtZero_5 = 0x00;
-						}
-						else if(pParams->chSup[ch].chMode ==
-								HMC7043_CHM_SYSREF) {
-							pImg->r102.fields.dyDrvEn_5 =
-									pParams->chSup[ch].dynDriverEn? 1 : 0;
-						}
-						pImg->rfa.fields.chEn_5 = 0x1;
-						if(pParams->chSup[ch].dynDriverEn)
-							pImg->rfa.fields.stMod_5 = 0x3;
-						else
-							pImg->rfa.fields.stMod_5 = 0x0;
-
-						if(pParams->chSup[ch].outSel == HMC7043_COS_FUNDAMENTAL)
-							pImg->r101.fields.outMuxSel_5 = 0x3;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIVIDER)
-							pImg->r101.fields.outMuxSel_5 = 0x0;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIV_ADLY)
-							pImg->r101.fields.outMuxSel_5 = 0x1;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIV_NEIGHBOR)
-							pImg->r101.fields.outMuxSel_5 = 0x2;
-						break;
-				}
-				case 6: {
-					    pImg->r105.fields.chDivLsb_6 =
-					    		HMC7043_LSB_BIT_VAL(chDivider);
-					    pImg->r106.fields.chDivMsb_6 =
-					    		HMC7043_MSB_BIT_VAL(chDivider);
-						pImg->r104.fields.hpMode_6 =
-								pParams->chSup[ch].highPerfMode;
-						pImg->r104.fields.syncEn_6 = 0x1;
-						pImg->r104.fields.slipEn_6 = 0x1;
-						pImg->r107.fields.faDelay_6 = pParams->chSup[ch].aDlyPs;
-						pImg->r108.fields.cdDelay_6 = pParams->chSup[ch].dDlyPs;
-						pImg->r10c.fields.drvMod_6 = pParams->chSup[ch].drvMode;
-						if(pParams->chSup[ch].drvMode == HMC7043_CDM_CMOS) {
-							pImg->r104.fields.multSlpEn_6 = 1;
-							addMultislip = chDivider/2;
-							mDelay = pParams->chSup[ch].slipQuantumPs/clkInpFreq;
-							multiSlip = mDelay + addMultislip;
-							pImg->r109.fields.msDelayLsb_6 = (multiSlip & 0xff);
-							pImg->r10a.fields.msDelayMsb_6 = multiSlip >> 8;
-
-						}
-						if(pParams->chSup[ch].drvMode == HMC7043_CDM_CML) {
-							if(pParams->chSup[ch].cmlTerm == HMC7043_CCIT_NONE)
-								pImg->r10c.fields.drvImp_6 = 0x0;
-							else if(pParams->chSup[ch].cmlTerm ==
-									HMC7043_CCIT_100)
-								pImg->r10c.fields.drvImp_6 = 0x1;
-							else if(pParams->chSup[ch].cmlTerm ==
-									HMC7043_CCIT_50)
-								pImg->r10c.fields.drvImp_6 = 0x3;
-						}
-						if(pParams->chSup[ch].chMode == HMC7043_CHM_CLK) {
-							pImg->r10c.fields.idlAtZero_6 = 0x00;
-						}
-						else if(pParams->chSup[ch].chMode ==
-								HMC7043_CHM_SYSREF) {
-							pImg->r10c.fields.dyDrvEn_6 =
-									pParams->chSup[ch].dynDriverEn? 1 : 0;
-						}
-						pImg->r104.fields.chEn_6 = 0x1;
-						if(pParams->chSup[ch].dynDriverEn)
-							pImg->r104.fields.stMod_6 = 0x3;
-						else
-							pImg->r104.fields.stMod_6 = 0x0;
-
-						if(pParams->chSup[ch].outSel == HMC7043_COS_FUNDAMENTAL)
-							pImg->r10b.fields.outMuxSel_6 = 0x3;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIVIDER)
-							pImg->r10b.fields.outMuxSel_6 = 0x0;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIV_ADLY)
-							pImg->r10b.fields.outMuxSel_6 = 0x1;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIV_NEIGHBOR)
-							pImg->r10b.fields.outMuxSel_6 = 0x2;
-						break;
-				}
-				case 7: {
-					    pImg->r10f.fields.chDivLsb_7 =
-					    		HMC7043_LSB_BIT_VAL(chDivider);
-					    pImg->r110.fields.chDivMsb_7 =
-					    		HMC7043_MSB_BIT_VAL(chDivider);
-					    pImg->r10e.fields.hpMode_7 =
-					    		pParams->chSup[ch].highPerfMode;
-						pImg->r10e.fields.syncEn_7 = 0x1;
-						pImg->r10e.fields.slipEn_7 = 0x1;
-						pImg->r111.fields.faDelay_7 = pParams->chSup[ch].aDlyPs;
-						pImg->r112.fields.cdDelay_7 = pParams->chSup[ch].dDlyPs;
-						pImg->r116.fields.drvMod_7 = pParams->chSup[ch].drvMode;
-						if(pParams->chSup[ch].drvMode == HMC7043_CDM_CML) {
-							if(pParams->chSup[ch].cmlTerm == HMC7043_CCIT_NONE)
-								pImg->r116.fields.drvImp_7 = 0x0;
-							else if(pParams->chSup[ch].cmlTerm ==
-									HMC7043_CCIT_100)
-								pImg->r116.fields.drvImp_7 = 0x1;
-							else if(pParams->chSup[ch].cmlTerm ==
-									HMC7043_CCIT_50)
-								pImg->r116.fields.drvImp_7 = 0x3;
-						}
-						if(pParams->chSup[ch].chMode == HMC7043_CHM_CLK) {
-							pImg->r116.fields.idlAtZero_7 = 0x00;
-						}
-						else if(pParams->chSup[ch].chMode == HMC7043_CHM_SYSREF) {
-							pImg->r116.fields.dyDrvEn_7 =
-									pParams->chSup[ch].dynDriverEn? 1 : 0;
-						}
-						pImg->r10e.fields.chEn_7 = 0x1;
-						if(pParams->chSup[ch].dynDriverEn)
-							pImg->r10e.fields.stMod_7 = 0x3;
-						else
-							pImg->r10e.fields.stMod_7 = 0x0;
-
-						if(pParams->chSup[ch].outSel == HMC7043_COS_FUNDAMENTAL)
-							pImg->r115.fields.outMuxSel_7 = 0x3;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIVIDER)
-							pImg->r115.fields.outMuxSel_7 = 0x0;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIV_ADLY)
-							pImg->r115.fields.outMuxSel_7 = 0x1;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIV_NEIGHBOR)
-							pImg->r115.fields.outMuxSel_7 = 0x2;
-						break;
-				}
-				case 8: {
-					    pImg->r119.fields.chDivLsb_8 =
-					    		HMC7043_LSB_BIT_VAL(chDivider);
-					    pImg->r11a.fields.chDivMsb_8 =
-					    		HMC7043_MSB_BIT_VAL(chDivider);
-						pImg->r118.fields.hpMode_8 =
-								pParams->chSup[ch].highPerfMode;
-						pImg->r118.fields.syncEn_8 = 0x1;
-						pImg->r118.fields.slipEn_8 = 0x1;
-						pImg->r11b.fields.faDelay_8 = pParams->chSup[ch].aDlyPs;
-						pImg->r11c.fields.cdDelay_8 = pParams->chSup[ch].dDlyPs;
-						pImg->r120.fields.drvMod_8 = pParams->chSup[ch].drvMode;
-						if(pParams->chSup[ch].drvMode == HMC7043_CDM_CML) {
-							if(pParams->chSup[ch].cmlTerm == HMC7043_CCIT_NONE)
-								pImg->r120.fields.drvImp_8 = 0x0;
-							else if(pParams->chSup[ch].cmlTerm ==
-									HMC7043_CCIT_100)
-								pImg->r120.fields.drvImp_8 = 0x1;
-							else if(pParams->chSup[ch].cmlTerm ==
-									HMC7043_CCIT_50)
-								pImg->r120.fields.drvImp_8 = 0x3;
-						}
-						if(pParams->chSup[ch].chMode == HMC7043_CHM_CLK) {
-							pImg->r120.fields.idlAtZero_8 = 0x00;
-						}
-						else if(pParams->chSup[ch].chMode ==
-								HMC7043_CHM_SYSREF) {
-							pImg->r120.fields.dyDrvEn_8 =
-									pParams->chSup[ch].dynDriverEn? 1 : 0;
-						}
-						pImg->r118.fields.chEn_8 = 0x1;
-						if(pParams->chSup[ch].dynDriverEn)
-							pImg->r118.fields.stMod_8 = 0x3;
-						else
-							pImg->r118.fields.stMod_8 = 0x0;
-
-						if(pParams->chSup[ch].outSel == HMC7043_COS_FUNDAMENTAL)
-							pImg->r11f.fields.outMuxSel_8 = 0x3;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIVIDER)
-							pImg->r11f.fields.outMuxSel_8 = 0x0;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIV_ADLY)
-							pImg->r11f.fields.outMuxSel_8 = 0x1;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIV_NEIGHBOR)
-							pImg->r11f.fields.outMuxSel_8 = 0x2;
-						break;
-				}
-				case 9: {
-					    pImg->r123.fields.chDivLsb_9 =
-					    		HMC7043_LSB_BIT_VAL(chDivider);
-					    pImg->r124.fields.chDivMsb_9 =
-					    		HMC7043_MSB_BIT_VAL(chDivider);
-						pImg->r122.fields.hpMode_9 =
-								pParams->chSup[ch].highPerfMode;
-						pImg->r122.fields.syncEn_9 = 0x1;
-						pImg->r122.fields.slipEn_9 = 0x1;
-						pImg->r125.fields.faDelay_9 = pParams->chSup[ch].aDlyPs;
-						pImg->r126.fields.cdDelay_9 = pParams->chSup[ch].dDlyPs;
-						pImg->r12a.fields.drvMod_9 = pParams->chSup[ch].drvMode;
-						if(pParams->chSup[ch].drvMode == HMC7043_CDM_CMOS) {
-							pImg->r122.fields.multSlpEn_9 = 1;
-							addMultislip = chDivider/2;
-							mDelay = pParams->chSup[ch].slipQuantumPs/clkInpFreq;
-							multiSlip = mDelay + addMultislip;
-							pImg->r127.fields.msDelayLsb_9 = (multiSlip & 0xff);
-							pImg->r128.fields.msDelayMsb_9 = multiSlip >> 8;
-						}
-						if(pParams->chSup[ch].drvMode == HMC7043_CDM_CML) {
-							if(pParams->chSup[ch].cmlTerm == HMC7043_CCIT_NONE)
-								pImg->r12a.fields.drvImp_9 = 0x0;
-							else if(pParams->chSup[ch].cmlTerm ==
-									HMC7043_CCIT_100)
-								pImg->r12a.fields.drvImp_9 = 0x1;
-							else if(pParams->chSup[ch].cmlTerm ==
-									HMC7043_CCIT_50)
-								pImg->r12a.fields.drvImp_9 = 0x3;
-						}
-						if(pParams->chSup[ch].chMode == HMC7043_CHM_CLK) {
-							pImg->r12a.fields.idlAtZero_9 = 0x00;
-						}
-						else if(pParams->chSup[ch].chMode ==
-								HMC7043_CHM_SYSREF) {
-							pImg->r12a.fields.dyDrvEn_9 =
-									pParams->chSup[ch].dynDriverEn? 1 : 0;
-						}
-						pImg->r122.fields.chEn_9 = 0x1;
-						if(pParams->chSup[ch].dynDriverEn)
-							pImg->r122.fields.stMod_9 = 0x3;
-						else
-							pImg->r122.fields.stMod_9 = 0x0;
-
-						if(pParams->chSup[ch].outSel == HMC7043_COS_FUNDAMENTAL)
-							pImg->r129.fields.outMuxSel_9 = 0x3;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIVIDER)
-							pImg->r129.fields.outMuxSel_9 = 0x0;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIV_ADLY)
-							pImg->r129.fields.outMuxSel_9 = 0x1;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIV_NEIGHBOR)
-							pImg->r129.fields.outMuxSel_9 = 0x2;
-						break;
-				}
-				case 10: {
-					     pImg->r12d.fields.chDivLsb_10 =
-					    		 HMC7043_LSB_BIT_VAL(chDivider);
-                         pImg->r12e.fields.chDivMsb_10 =
-                        		 HMC7043_MSB_BIT_VAL(chDivider);
-						 pImg->r12c.fields.hpMode_10 =
-								 pParams->chSup[ch].highPerfMode;
-						 pImg->r12c.fields.syncEn_10 = 0x1;
-						 pImg->r12c.fields.slipEn_10 = 0x1;
-						 pImg->r12f.fields.faDelay_10 = pParams->chSup[ch].aDlyPs;
-						 pImg->r130.fields.cdDelay_10 = pParams->chSup[ch].dDlyPs;
-						 pImg->r134.fields.drvMod_10 = pParams->chSup[ch].drvMode;
-						 if(pParams->chSup[ch].drvMode == HMC7043_CDM_CMOS) {
-							pImg->r12c.fields.multSlpEn_10 = 1;
-							addMultislip = chDivider/2;
-							mDelay = pParams->chSup[ch].slipQuantumPs/clkInpFreq;
-							multiSlip = mDelay + addMultislip;
-							pImg->r131.fields.msDelayLsb_10 = (multiSlip & 0xff);
-							pImg->r132.fields.msDelayMsb_10 = multiSlip >> 8;
-						 }
-						 if(pParams->chSup[ch].drvMode == HMC7043_CDM_CML) {
-							if(pParams->chSup[ch].cmlTerm == HMC7043_CCIT_NONE)
-								pImg->r134.fields.drvImp_10 = 0x0;
-							else if(pParams->chSup[ch].cmlTerm ==
-									HMC7043_CCIT_100)
-								pImg->r134.fields.drvImp_10 = 0x1;
-							else if(pParams->chSup[ch].cmlTerm ==
-									HMC7043_CCIT_50)
-								pImg->r134.fields.drvImp_10 = 0x3;
-						 }
-						 if(pParams->chSup[ch].chMode == HMC7043_CHM_CLK) {
-						 	pImg->r134.fields.idlAtZero_10 = 0x00;
-						 }
-						 else if(pParams->chSup[ch].chMode ==
-								 HMC7043_CHM_SYSREF) {
-						 	pImg->r134.fields.dyDrvEn_10 =
-						 			pParams->chSup[ch].dynDriverEn? 1 : 0;
-						 }
-						 pImg->r12c.fields.chEn_10 = 0x1;
-						if(pParams->chSup[ch].dynDriverEn)
-							pImg->r12c.fields.stMod_10 = 0x3;
-						else
-							pImg->r12c.fields.stMod_10 = 0x0;
-
-						if(pParams->chSup[ch].outSel == HMC7043_COS_FUNDAMENTAL)
-							pImg->r133.fields.outMuxSel_10 = 0x3;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIVIDER)
-							pImg->r133.fields.outMuxSel_10 = 0x0;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIV_ADLY)
-							pImg->r133.fields.outMuxSel_10 = 0x1;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIV_NEIGHBOR)
-							pImg->r133.fields.outMuxSel_10 = 0x2;
-						 break;
-				}
-				case 11: {
-					     pImg->r137.fields.chDivLsb_11 =
-					    		 HMC7043_LSB_BIT_VAL(chDivider);
-					     pImg->r138.fields.chDivMsb_11 =
-					    		 HMC7043_MSB_BIT_VAL(chDivider);
-						 pImg->r136.fields.hpMode_11 =
-								 pParams->chSup[ch].highPerfMode;
-						 pImg->r136.fields.syncEn_11 = 0x1;
-						 pImg->r136.fields.slipEn_11 = 0x1;
-						 pImg->r139.fields.faDelay_11 = pParams->chSup[ch].aDlyPs;
-						 pImg->r13a.fields.cdDelay_11 = pParams->chSup[ch].dDlyPs;
-						 pImg->r13e.fields.drvMod_11 = pParams->chSup[ch].drvMode;
-						if(pParams->chSup[ch].drvMode == HMC7043_CDM_CML) {
-							if(pParams->chSup[ch].cmlTerm == HMC7043_CCIT_NONE)
-								pImg->r13e.fields.drvImp_11 = 0x0;
-							else if(pParams->chSup[ch].cmlTerm ==
-									HMC7043_CCIT_100)
-								pImg->r13e.fields.drvImp_11 = 0x1;
-							else if(pParams->chSup[ch].cmlTerm ==
-									HMC7043_CCIT_50)
-								pImg->r13e.fields.drvImp_11 = 0x3;
-						}
-						 if(pParams->chSup[ch].chMode == HMC7043_CHM_CLK) {
-						 	pImg->r13e.fields.idlAtZero_11 = 0x00;
-						 }
-						 else if(pParams->chSup[ch].chMode == HMC7043_CHM_SYSREF) {
-						 	pImg->r13e.fields.dyDrvEn_11 =
-						 			pParams->chSup[ch].dynDriverEn? 1 : 0;
-						 }
-						 pImg->r136.fields.chEn_11 = 0x1;
-						if(pParams->chSup[ch].dynDriverEn)
-							pImg->r136.fields.stMod_11 = 0x3;
-						else
-							pImg->r136.fields.stMod_11 = 0x0;
-
-						if(pParams->chSup[ch].outSel == HMC7043_COS_FUNDAMENTAL)
-							pImg->r13d.fields.outMuxSel_11 = 0x3;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIVIDER)
-							pImg->r13d.fields.outMuxSel_11 = 0x0;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIV_ADLY)
-							pImg->r13d.fields.outMuxSel_11 = 0x1;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIV_NEIGHBOR)
-							pImg->r13d.fields.outMuxSel_11 = 0x2;
-						 break;
-				}
-				case 12: {
-					     pImg->r141.fields.chDivLsb_12 =
-					    		 HMC7043_LSB_BIT_VAL(chDivider);
-					     pImg->r142.fields.chDivMsb_12 =
-					    		 HMC7043_MSB_BIT_VAL(chDivider);
-						 pImg->r140.fields.hpMode_12 =
-								 pParams->chSup[ch].highPerfMode;
-						 pImg->r140.fields.syncEn_12 = 0x1;
-						 pImg->r140.fields.slipEn_12 = 0x1;
-						 pImg->r143.fields.faDelay_12 = pParams->chSup[ch].aDlyPs;
-						 pImg->r144.fields.cdDelay_12 = pParams->chSup[ch].dDlyPs;
-						 pImg->r148.fields.drvMod_12 = pParams->chSup[ch].drvMode;
-						if(pParams->chSup[ch].drvMode == HMC7043_CDM_CML) {
-							if(pParams->chSup[ch].cmlTerm == HMC7043_CCIT_NONE)
-								pImg->r148.fields.drvImp_12 = 0x0;
-							else if(pParams->chSup[ch].cmlTerm ==
-									HMC7043_CCIT_100)
-								pImg->r148.fields.drvImp_12 = 0x1;
-							else if(pParams->chSup[ch].cmlTerm ==
-									HMC7043_CCIT_50)
-								pImg->r148.fields.drvImp_12 = 0x3;
-						}
-						 if(pParams->chSup[ch].chMode == HMC7043_CHM_CLK) {
-						 	pImg->r148.fields.idlAtZero_12 = 0x00;
-						 }
-						 else if(pParams->chSup[ch].chMode == HMC7043_CHM_SYSREF) {
-						 	pImg->r148.fields.dyDrvEn_12 =
-						 			pParams->chSup[ch].dynDriverEn? 1 : 0;
-						 }
-						 pImg->r140.fields.chEn_12 = 0x1;
-						if(pParams->chSup[ch].dynDriverEn)
-							pImg->r140.fields.stMod_12 = 0x3;
-						else
-							pImg->r140.fields.stMod_12 = 0x0;
-
-						if(pParams->chSup[ch].outSel == HMC7043_COS_FUNDAMENTAL)
-							pImg->r147.fields.outMuxSel_12 = 0x3;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIVIDER)
-							pImg->r147.fields.outMuxSel_12 = 0x0;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIV_ADLY)
-							pImg->r147.fields.outMuxSel_12 = 0x1;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIV_NEIGHBOR)
-							pImg->r147.fields.outMuxSel_12 = 0x2;
-						 break;
-				}
-				case 13: {
-					     pImg->r14b.fields.chDivLsb_13 =
-					    		 HMC7043_LSB_BIT_VAL(chDivider);
-					     pImg->r14c.fields.chDivMsb_13 =
-					    		 HMC7043_MSB_BIT_VAL(chDivider);
-						 pImg->r14a.fields.hpMode_13 =
-								 pParams->chSup[ch].highPerfMode;
-						 pImg->r14a.fields.syncEn_13 = 0x1;
-						 pImg->r14a.fields.slipEn_13 = 0x1;
-						 pImg->r14d.fields.faDelay_13 = pParams->chSup[ch].aDlyPs;
-						 pImg->r14e.fields.cdDelay_13 = pParams->chSup[ch].dDlyPs;
-						 pImg->r152.fields.drvMod_13 = pParams->chSup[ch].drvMode;
-						 if(pParams->chSup[ch].drvMode == HMC7043_CDM_CMOS) {
-							pImg->r14a.fields.multSlpEn_13 = 1;
-							addMultislip = chDivider/2;
-							mDelay = pParams->chSup[ch].slipQuantumPs/clkInpFreq;
-							multiSlip = mDelay + addMultislip;
-							pImg->r14f.fields.msDelayLsb_13 = (multiSlip & 0xff);
-							pImg->r150.fields.msDelayMsb_13 = multiSlip >> 8;
-						 }
-						 if(pParams->chSup[ch].drvMode == HMC7043_CDM_CML) {
-							if(pParams->chSup[ch].cmlTerm == HMC7043_CCIT_NONE)
-								pImg->r152.fields.drvImp_13 = 0x0;
-							else if(pParams->chSup[ch].cmlTerm ==
-									HMC7043_CCIT_100)
-								pImg->r152.fields.drvImp_13 = 0x1;
-							else if(pParams->chSup[ch].cmlTerm ==
-									HMC7043_CCIT_50)
-								pImg->r152.fields.drvImp_13 = 0x3;
-						 }
-						 if(pParams->chSup[ch].chMode == HMC7043_CHM_CLK) {
-						 	pImg->r152.fields.idlAtZero_13 = 0x00;
-						 }
-						 else if(pParams->chSup[ch].chMode ==
-								 HMC7043_CHM_SYSREF) {
-						 	pImg->r152.fields.dyDrvEn_13 =
-						 			pParams->chSup[ch].dynDriverEn? 1 : 0;
-						 }
-						 pImg->r14a.fields.chEn_13 = 0x1;
-						if(pParams->chSup[ch].dynDriverEn)
-							pImg->r14a.fields.stMod_13 = 0x3;
-						else
-							pImg->r14a.fields.stMod_13 = 0x0;
-
-						if(pParams->chSup[ch].outSel == HMC7043_COS_FUNDAMENTAL)
-							pImg->r151.fields.outMuxSel_13 = 0x3;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIVIDER)
-							pImg->r151.fields.outMuxSel_13 = 0x0;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIV_ADLY)
-							pImg->r151.fields.outMuxSel_13 = 0x1;
-						else if(pParams->chSup[ch].outSel ==
-								HMC7043_COS_DIV_NEIGHBOR)
-							pImg->r151.fields.outMuxSel_13 = 0x2;
-						 break;
-				}
-			}
-		}  else {/* Unused channel */
-		/*	set start-up mode to 00 */
-		    switch(ch){
-		    	case 0: {
-		    		pImg->rc8.fields.stMod_0 = 0x0;
-		    		break;
-		    	}
-		    	case 1: {
-		    		pImg->rd2.fields.stMod_1 = 0x0;
-		    		break;
-		    	}
-		    	case 2: {
-		    		pImg->rdc.fields.stMod_2 = 0x0;
-		    		break;
-		    	}
-		    	case 3: {
-		    		pImg->re6.fields.stMod_3 = 0x0;
-		    		break;
-		    	}
-		    	case 4: {
-		    		pImg->rf0.fields.stMod_4 = 0x0;
-		    		break;
-		    	}
-		    	case 5: {
-		    		pImg->rfa.fields.stMod_5 = 0x0;
-		    		break;
-		    	}
-		    	case 6: {
-		    		pImg->r104.fields.stMod_6 = 0x0;
-		    		break;
-		    	}
-		    	case 7: {
-		    		pImg->r10e.fields.stMod_7 = 0x0;
-		    		break;
-		    	}
-		    	case 8: {
-		    		pImg->r118.fields.stMod_8 = 0x0;
-		    		break;
-		    	}
-		    	case 9: {
-		    		pImg->r122.fields.stMod_9 = 0x0;
-		    		break;
-		    	}
-		    	case 10: {
-		    		pImg->r12c.fields.stMod_10 = 0x0;
-		    		break;
-		    	}
-		    	case 11: {
-		    		pImg->r136.fields.stMod_11 = 0x0;
-		    		break;
-		    	}
-		    	case 12: {
-		    		pImg->r140.fields.stMod_12 = 0x0;
-		    		break;
-		    	}
-		    	case 13: {
-		    		pImg->r14a.fields.stMod_13 = 0x0;
-		    		break;
-		    	}
-		    }
 
-		}
-	}
+/*******************************************************************************
+* - name: hmc7043AppScrubRegs
+*
+* - title: check the device image against the device registers
+*
+* - input: dev - CLKDST device for which to perform the operation
+*
+* - output: hmc7043AppState.pDevState[dev]->devKnown (on a read failure)
+*
+* - returns: number of mismatching registers or -1 if detected an error
+*
+* - description: reads back the register image registers (one burst per run of
+*                contiguous registers, ref. hmc7043AppRegRunLen) and compares
+*                the known control registers with the device image, rewriting
+*                any that differ with their device image value (i.e. leaving
+*                any deferred changes pending)
+*
+* - notes: must be called within the associated critical section
+*******************************************************************************/
+LOCAL int hmc7043AppScrubRegs(CKDST_DEV dev)
+{
+    HMC7043_REG data[HMC7043_APP_NREG_DESCS];
+    const Hmc7043_app_dev_state *pState;
+    const UINT8 *pDevImg;
+    unsigned i, j, n;
+    int nMismatches = 0;
+
+    if (!hmc7043DevPresent(dev)) {
+        hmc7043Log("bad argument (dev %d)", dev);
+        return -1;
+    }
 
-	return OK;
+    pState = hmc7043AppState.pDevState[dev];
+    pDevImg = (const UINT8 *) &pState->devImage;
+
+    for (i = 0; i < NELEMENTS(hmc7043AppRegDescs); i += n) {
+        const Hmc7043_reg_desc *pDesc = hmc7043AppRegDescs + i;
+
+        n = hmc7043AppRegRunLen(i, NELEMENTS(hmc7043AppRegDescs));
+
+        if (hmc7043LliRegReadBurstInCs(dev, pDesc->regInx, data, n) != OK)
+            return -1;
+
+        for (j = 0; j < n; ++j) {
+            unsigned regInx = pDesc[j].regInx;
+            HMC7043_REG devData = pDevImg[pDesc[j].dataOffs];
+
+            if (hmc7043AppRegClass(regInx) != HMC7043_RCL_CTL ||
+                !(pState->devKnown[(i + j) / 32] & 1U << (i + j) % 32) ||
+                data[j] == devData)
+                continue;
+
+            hmc7043Log("register mismatch (dev %d, regInx 0x%02x, "
+                       "regData 0x%02x, expected 0x%02x)", dev, regInx, data[j],
+                       devData);
+            ++nMismatches;
+
+            if (hmc7043LliRegWriteInCs(dev, regInx, devData) != OK)
+                return -1;
+        }
+    }
+
+    sysAtomicAddRelaxed(&hmc7043StatsCtl.pDevStats[dev]->nScrubMismatches, nMismatches);
+
+    return nMismatches;
 }
 
 
 
 
 /*******************************************************************************
-* - name: hmc7043AppInitPgmInCh
+* - name: hmc7043AppFlushRegs
 *
-* - title: Program the Input CLK/RFSYNC
+* - title: write modified register image data to CLKDST registers
 *
 * - input: dev - CLKDST device for which to perform the operation
-*          pParams - pointer to device setup parameters
 *
-* - output: hmc7043AppState.devState[dev].regImage
+* - output: hmc7043AppState.pDevState[dev]->devImage, .devKnown
 *
 * - returns: OK or ERROR if detected an error
 *
-* - description: as above
+* - description: writes only those registers whose register image value differs
+*                from what was last written to the device (or for which the
+*                device register value is not known), one burst per run of
+*                contiguous such registers
+*
+* - notes: 1) This is the standard way to commit register image changes.
+*          2) Must be called within the associated critical section (ref.
+*             hmc7043CsEnter).
 *******************************************************************************/
-LOCAL STATUS hmc7043AppInitPgmInCh(CKDST_DEV dev,
-		                          const Hmc7043_app_dev_params *pParams)
+LOCAL STATUS hmc7043AppFlushRegs(CKDST_DEV dev)
 {
-	Hmc7043_reg_image *pImg;
+    Hmc7043_app_dev_state *pState;
+    const UINT8 *pImg;
+    UINT8 *pDevImg;
+    unsigned i, n;
 
-	if (!inEnumRange(dev, NELEMENTS(hmc7043AppState.devState)) || !pParams) {
-		sysLog("bad argument(s) (dev %d, pParams %d)", dev, pParams != NULL);
-		return ERROR;
-	}
+    /* initialize */
+    if (!hmc7043DevPresent(dev)) {
+        hmc7043Log("bad argument (dev %d)", dev);
+        return ERROR;
+    }
 
-	pImg = &hmc7043AppState.devState[dev].regImage;
+    pState = hmc7043AppState.pDevState[dev];
+    pImg = (const UINT8 *) &pState->regImage;
+    pDevImg = (UINT8 *) &pState->devImage;
 
-    if(pParams->clkIn.used) {
-    	pImg->r0a.fields.enBuff = 0x1;
-        if(pParams->clkIn.term100Ohm)
-        	pImg->r0a.fields.inBufMod |= 0x0;
-        if(pParams->clkIn.acCoupled)
-        	pImg->r0a.fields.inBufMod |= 0x1;
-        if(pParams->clkIn.lvpecl)
-        	pImg->r0a.fields.inBufMod |= 0x2;
-        if(pParams->clkIn.highZ)
-        	pImg->r0a.fields.inBufMod |= 0x3;
-    } else { //TBD need to check if this should be in else or separate if
-    	pImg->r0a.fields.enBuff = 0x0;
-    	if(pParams->syncIn.used){
-    		pImg->r0b.fields.enBuff = 0x1;
-    		if(pParams->syncIn.term100Ohm)
-    			pImg->r0b.fields.inBufMod |= 0x0;
-            if(pParams->clkIn.acCoupled)
-            	pImg->r0b.fields.inBufMod |= 0x1;
-            if(pParams->clkIn.lvpecl)
-            	pImg->r0b.fields.inBufMod |= 0x2;
-            if(pParams->clkIn.highZ)
-            	pImg->r0b.fields.inBufMod |= 0x3;
+#   define IS_DIRTY(i)                                                        \
+        (!(pState->devKnown[(i) / 32] & 1U << (i) % 32) ||                   \
+         pImg[hmc7043AppRegDescs[i].dataOffs] !=                              \
+         pDevImg[hmc7043AppRegDescs[i].dataOffs])
+
+    /* perform the operation */
+    for (i = 0; i < NELEMENTS(hmc7043AppRegDescs); i += n) {
+        const Hmc7043_reg_desc *pDesc = hmc7043AppRegDescs + i;
+        unsigned j;
+
+        if (!IS_DIRTY(i)) {
+            n = 1;
+            continue;
         }
-    	else
-        	pImg->r0b.fields.enBuff = 0x0;
+
+        /* extend the run over the subsequent contiguous modified registers */
+        for (n = 1; i + n < NELEMENTS(hmc7043AppRegDescs) &&
+                    pDesc[n].regInx == pDesc->regInx + n &&
+                    pDesc[n].dataOffs == pDesc->dataOffs + n && IS_DIRTY(i + n);
+             ++n)
+            ;
+
+        if (hmc7043LliRegWriteBurstInCs(dev, pDesc->regInx,
+                                        pImg + pDesc->dataOffs, n) != OK)
+            return ERROR;
+
+        memcpy(pDevImg + pDesc->dataOffs, pImg + pDesc->dataOffs, n);
+
+        for (j = i; j < i + n; ++j)
+            pState->devKnown[j / 32] |= 1U << j % 32;
     }
 
-	return OK;
+#   undef IS_DIRTY
+
+    hmc7043AppPersistImage(dev);
+
+    return OK;
 }
 
 
 
 
 /*******************************************************************************
-* - name: hmc7043GetClkOutPhase
+* - name: hmc7043AppCommitRegs
 *
-* - title: Get the clock output phase alarm status.
+* - title: commit register image changes made by a service
 *
-* - input: dev         - CLKDST device for which to perform the operation
-*          clkOutPhase - out parameter containing alram status
+* - input: dev - CLKDST device for which to perform the operation
+*          now - if set, will commit regardless of the deferred commit mode
 *
-* - output: clkOutPhase
+* - output: hmc7043CommitCtl.pDevCtl[dev]->pendingSince
 *
 * - returns: OK or ERROR if detected an error
 *
-* - description: as above
+* - description: flushes the register image (ref. hmc7043AppFlushRegs) unless
+*                in deferred commit mode, in which case the changes are left
+*                pending until committed explicitly, by a service that must
+*                commit now, or once the commit window expires (checked here
+*                as well as by hmc7043CommitThread)
+*
+* - notes: must be called within the associated critical section
 *******************************************************************************/
-LOCAL STATUS hmc7043GetClkOutPhase(CKDST_DEV dev, Bool *clkOutPhase)
+LOCAL STATUS hmc7043AppCommitRegs(CKDST_DEV dev, Bool now)
 {
-	Hmc7043_reg_x007d r7d;
+    Hmc7043_commit_dev_ctl *pCtl;
+    SYS_TIME_NS nsec;
+    const UINT8 bell = 0;
 
-	if (!inEnumRange(dev, NELEMENTS(hmc7043AppState.devState))) {
-		sysLog("bad argument (dev %d)", dev);
-		return ERROR;
-	}
+    if (!hmc7043DevPresent(dev)) {
+        hmc7043Log("bad argument (dev %d)", dev);
+        return ERROR;
+    }
 
-	if(hmc7043LliRegRead(dev, 0x007d, &r7d.all) != OK)
-		return ERROR;
+    pCtl = hmc7043CommitCtl.pDevCtl[dev];
 
-    if(r7d.fields.ckOutPhSt == 1)
-    	*clkOutPhase = TRUE;
-    else
-    	*clkOutPhase = FALSE;
+    if (pCtl->deferred && !now) {
+        nsec = sysTimeNsec();
 
-    return OK;
+        if (!pCtl->pendingSince) {
+            pCtl->pendingSince = nsec;
+
+            /* (a full queue meaning that a wake-up is pending anyway) */
+            if (pCtl->hBell != UTL_QUEUE_BAD_HQUEUE)
+                utlQueuePut(pCtl->hBell, &bell, sizeof(bell), NULL);
+        }
+
+        if (!pCtl->windowUsec ||
+            nsec - pCtl->pendingSince < pCtl->windowUsec * (SYS_TIME_NS) 1000)
+            return OK;
+    }
+
+    pCtl->pendingSince = 0;
+
+    return hmc7043AppFlushRegs(dev);
 }
 
 
 
 
 /*******************************************************************************
-* - name: hmc7043CfgSdataMode
+* - name: hmc7043AppInitRdRegs
 *
-* - title: Configure SDATA mode for a particular device.
+* - title: read CLKDST registers and set up register image data
 *
-* - input: dev      - CLKDST device on which operation is performed.
-*          pParams  - pointer to device setup parameters
+* - input: dev - CLKDST device for which to perform the operation
 *
-* - output: hmc7043AppState.devState[dev].regImage
+* - output: hmc7043AppState.pDevState[dev]->regImage
 *
 * - returns: OK or ERROR if detected an error
 *
 * - description: as above
+*
+* - notes: 1) Not attempting to reset the device here (that is up to the caller).
 *******************************************************************************/
-LOCAL STATUS hmc7043CfgSdataMode(CKDST_DEV dev,
-		                         const Hmc7043_app_dev_params *pParams)
+LOCAL STATUS hmc7043AppInitRdRegs(CKDST_DEV dev)
 {
-	Hmc7043_reg_image *pImg;
-
-	if (!inEnumRange(dev, NELEMENTS(hmc7043AppState.devState)) || !pParams) {
-		sysLog("bad argument(s) (dev %d, pParams %d)", dev, pParams != NULL);
-		return ERROR;
-	}
-
-	pImg = &hmc7043AppState.devState[dev].regImage;
+    if (hmc7043AppXferRegs(dev, TRUE) != OK)
+        return ERROR;
 
-	switch(pParams->sdataMode) {
-		case HMC7043_OM_OD: {
-			pImg->r54.fields.sdataMod = 0x0;
-			pImg->r54.fields.enSdata = 0x1;
-			break;
-		}
-		case HMC7032_OM_CMOS: {
-			pImg->r54.fields.sdataMod = 0x1;
-			pImg->r54.fields.enSdata = 0x1;
-			break;
-		}
-	}
+    hmc7043AppState.pDevState[dev]->regImage.initDone = TRUE;
 
-	return OK;
+    return OK;
 }
 
 
 
 
 /*******************************************************************************
-* - name: hmc7043CfgGpio
-*
-* - title: Configure GPIO setup for a particular device.
+* - name: hmc7043AppInitWrRegs
 *
-* - input: dev     - CLKDST device on which operation is performed.
-*          pParams - pointer to device setup parameters
+* - title: write initialization register image data to CLKDST registers
 *
-* - output: hmc7043AppState.devState[dev].regImage
+* - input: dev - CLKDST device for which to perform the operation
 *
 * - returns: OK or ERROR if detected an error
 *
 * - description: as above
-*
-* - notes: the operation is interlocked via the associated critical section
 *******************************************************************************/
-LOCAL STATUS hmc7043CfgGpio(CKDST_DEV dev,
-		                    const Hmc7043_app_dev_params *pParams)
+LOCAL STATUS hmc7043AppInitWrRegs(CKDST_DEV dev)
 {
-	Hmc7043_reg_image *pImg;
+    return hmc7043AppXferRegs(dev, FALSE);
+}
 
-	if (!inEnumRange(dev, NELEMENTS(hmc7043AppState.devState)) || !pParams) {
-		sysLog("bad argument(s) (dev %d, pParams %d)", dev, pParams != NULL);
-		return ERROR;
-	}
 
-	pImg = &hmc7043AppState.devState[dev].regImage;
 
-	switch(pParams->gpiSup) {
-		case HMC7043_GPIS_NONE: {
-			/*  If application configures the GPI line to HMC7043_GPIS_NONE,
-			 *  software shall disable the GPI function in register 0x0046.
-			 *  Disabled  before switch case.
-			 */
-			break;
-		}
-		case HMC7043_GPIS_SLEEP: {
-			pImg->r46.fields.selGpi = 0x2;
-			pImg->r46.fields.enGpi = 0x1;
-			break;
-		}
-		case HMC7043_GPIS_MUTE: {
-			pImg->r46.fields.selGpi = 0x3;
-			pImg->r46.fields.enGpi = 0x1;
-			break;
-		}
-		case HMC7043_GPIS_PULSE_GEN: {
-			pImg->r46.fields.selGpi = 0x4;
-			pImg->r46.fields.enGpi = 0x1;
-			break;
-		}
-		case HMC7043_GPIS_RESEED: {
-			pImg->r46.fields.selGpi = 0x5;
-			pImg->r46.fields.enGpi = 0x1;
-			break;
-		}
-		case HMC7043_GPIS_RESTART: {
-			pImg->r46.fields.selGpi = 0x6;
-			pImg->r46.fields.enGpi = 0x1;
-			break;
-		}
-		case HMC7043_GPIS_SLIP: {
-			pImg->r46.fields.selGpi = 0x8;
-			pImg->r46.fields.enGpi = 0x1;
-		    break;
-		}
-		default: {
-			sysLog("Bad value ( GPI setup %d)", pParams->gpiSup);
-			return ERROR;
-		}
+
+/*******************************************************************************
+* - name: hmc7043ToggleBit
+*
+* - title: Toggle the register bit mentioned in 'fieldBit' parameter at register
+*          address- regIdx.
+*
+* - input: dev - CLKDST device for which to perform the operation
+*          regIdx - register address where to bit to be toggled is present.
+*          fieldBit - the bit to be toggled.
+*          op - the requested operation (determines how to wait for its
+*               completion)
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above (taking the other bits of the register from the device
+*                image if known, ref. hmc7043AppShadowRead), then waits for the
+*                operation to complete (ref. hmc7043AppWaitDone)
+*
+* - notes: must be called within the associated critical section
+*******************************************************************************/
+LOCAL STATUS hmc7043ToggleBit(CKDST_DEV dev, unsigned regIdx,
+		                          HMC7043_REG fieldBit, HMC7043_WAIT_OP op)
+{
+	HMC7043_REG data;
+
+	if (!hmc7043DevPresent(dev)) {
+		hmc7043Log("bad argument (dev %d)", dev);
+		return ERROR;
 	}
 
-	switch(pParams->gpoMode) {
-		case HMC7043_OM_OD: {
-			pImg->r50.fields.gpoMod = 0x0;
-			break;
-		}
-		case HMC7032_OM_CMOS: {
-			pImg->r50.fields.gpoMod = 0x1;
-			break;
-		}
+	if (!hmc7043IfCtl.initDone) {
+		hmc7043Log("interface initialization not done yet (dev %d)", dev);
+		return ERROR;
 	}
 
-	switch(pParams->gpoSup) {
-		case HNC7043_GPOS_NONE: {
-			/*  If application configures the GPO line to HMC7043_GPOS_NONE,
-			 *  software shall disable the GPO function in register 0x0046.
-			 */
-			pImg->r50.fields.enGp0 = 0x0;
-			break;
-		}
-		case HMC7043_GPOS_ALARM: {
-			pImg->r50.fields.selGpo = 0x0;
-			pImg->r50.fields.enGp0 = 0x1;
-			break;
-		}
-		case HMC7043_GPOS_SDATA: {
-			pImg->r50.fields.selGpo = 0x1;
-			pImg->r50.fields.enGp0 = 0x1;
-			break;
-		}
-		case HMC7043_GPOS_SREF_NSYNC: {
-			pImg->r50.fields.selGpo = 0x2;
-			pImg->r50.fields.enGp0 = 0x1;
-			break;
-		}
-		case HMC7043_GPOS_CKOUTS_PHASE: {
-			pImg->r50.fields.selGpo = 0x3;
-			pImg->r50.fields.enGp0 = 0x1;
-			break;
-		}
-		case HMC7043_GPOS_SYNC_REQ_ST: {
-			pImg->r50.fields.selGpo = 0x4;
-			pImg->r50.fields.enGp0 = 0x1;
-			break;
-		}
-		case HMC7043_GPOS_CH_FSM_BUSY: {
-			pImg->r50.fields.selGpo = 0x5;
-			pImg->r50.fields.enGp0 = 0x1;
-			break;
-		}
-		case HMC7043_GPOS_SREF_FSM_ST0: {
-			pImg->r50.fields.selGpo = 0x6;
-			pImg->r50.fields.enGp0 = 0x1;
-			break;
-		}
-		case HMC7043_GPOS_SREF_FSM_ST1: {
-			pImg->r50.fields.selGpo = 0x7;
-			pImg->r50.fields.enGp0 = 0x1;
-			break;
-		}
-		case HMC7043_GPOS_SREF_FSM_ST2: {
-			pImg->r50.fields.selGpo = 0x8;
-			pImg->r50.fields.enGp0 = 0x1;
-			break;
-		}
-		case HMC7043_GPOS_SREF_FSM_ST3: {
-			pImg->r50.fields.selGpo = 0x9;
-			pImg->r50.fields.enGp0 = 0x1;
-			break;
-		}
-		case HMC7043_GPOS_FORCE_1: {
-			pImg->r50.fields.selGpo = 0xa;
-			pImg->r50.fields.enGp0 = 0x1;
-			break;
-		}
-		case HMC7043_GPOS_FORCE_0: {
-			pImg->r50.fields.selGpo = 0xb;
-			pImg->r50.fields.enGp0 = 0x1;
-			break;
-		}
-		case HMC7043_GPOS_PLS_GEN_REQ: {
-			pImg->r50.fields.selGpo = 0x19;
-			pImg->r50.fields.enGp0 = 0x1;
-			break;
-		}
-		default: {
-			sysLog("Bad value ( GPO setup %d)", pParams->gpoSup);
+	/* (the other bits as last written, if known) */
+	if(!hmc7043AppShadowRead(dev, regIdx, &data, 1, TRUE) &&
+	   hmc7043LliRegReadInCs(dev, regIdx, &data) != OK)
+		return ERROR;
+
+	if(hmc7043LliRegWriteInCs(dev, regIdx, (data | (1 << fieldBit))) != OK)
+		return ERROR;
+
+	data &= ~(1 << fieldBit);
+
+	if(hmc7043LliRegWriteInCs(dev, regIdx, data) != OK)
 			return ERROR;
-		}
+
+	hmc7043AppShadowWrite(dev, regIdx, &data, 1);
+
+	return hmc7043AppWaitDone(dev, op);
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AppWaitDone
+*
+* - title: wait for completion of a device operation
+*
+* - input: dev - CLKDST device for which to perform the operation
+*          op  - the operation to wait for
+*
+* - output: hmc7043WaitCtl.pDevStats[dev][op]
+*
+* - returns: OK or ERROR if detected an error (including timeout)
+*
+* - description: waits for the settle time of the operation (if any), then
+*                polls the readback / status register associated with the
+*                operation until it indicates completion, the time this took
+*                (settle time included) being accumulated in the statistics
+*                (ref. hmc7043GetWaitStats)
+*
+* - notes: 1) Must be called within the associated critical section.
+*          2) The device is polled every HMC7043_WAIT_POLL_USEC (each poll
+*             being an SPI transfer, so as not to load a shared bus with
+*             back-to-back ones), busy waiting in between since the expected
+*             waits are much shorter than the sleep granularity.
+*          3) The settle time is for operations whose completion the polled
+*             register does not reflect on its own: the soft reset, and the
+*             ones polling for the FSMs being idle, which they still are
+*             right after the request.
+*******************************************************************************/
+LOCAL STATUS hmc7043AppWaitDone(CKDST_DEV dev, HMC7043_WAIT_OP op)
+{
+    const Hmc7043_wait_cond *pCond;
+    Hmc7043_wait_stats *pStats;
+    SYS_TIME_NS startAt, waitNsec;
+    STATUS status = OK;  /* initial assumption */
+    HMC7043_REG data;
+
+    /* initialize */
+    if (!hmc7043DevPresent(dev) || !inEnumRange(op, HMC7043_WOP_NOPS)) {
+        hmc7043Log("bad argument(s) (dev %d, op %d)", dev, op);
+        return ERROR;
+    }
+
+    pCond = hmc7043WaitConds + op;
+    pStats = hmc7043WaitCtl.pDevStats[dev] + op;
+
+    /* perform the operation */
+    startAt = sysTimeNsec();
+
+    if (hmc7043WaitCtl.settleUsec[op])
+        sysDelayUsec(hmc7043WaitCtl.settleUsec[op]);
+
+    for (;;) {
+        if (hmc7043LliRegReadInCs(dev, pCond->regInx, &data) != OK) {
+            status = ERROR;
+            break;
+        }
+
+        waitNsec = sysTimeNsec() - startAt;
+
+        if ((data & pCond->mask) == pCond->value)
+            break;
+
+        if (waitNsec > hmc7043WaitCtl.timeoutUsec[op] * (SYS_TIME_NS) 1000) {
+            hmc7043Log("timeout (dev %d, op %d, regInx 0x%02x, regData 0x%02x)",
+                       dev, op, pCond->regInx, data);
+            ++pStats->nTimeouts;
+            status = ERROR;
+            break;
+        }
+
+        sysDelayUsecBusy(HMC7043_WAIT_POLL_USEC);
+    }
+
+    /* update statistics */
+    waitNsec = sysTimeNsec() - startAt;
+
+    ++pStats->nWaits;
+    pStats->lastNsec   = waitNsec;
+    pStats->maxNsec    = max(pStats->maxNsec, waitNsec);
+    pStats->totalNsec += waitNsec;
+
+    return status;
+}
+
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AppClkInpFreq
+*
+* - title: get the (internal) input clock frequency, after the CLKIN divider
+*
+* - input: pParams - pointer to device setup parameters
+*
+* - returns: the frequency or 0 if detected an error
+*
+* - description: as above
+*******************************************************************************/
+LOCAL CKDST_FREQ_HZ hmc7043AppClkInpFreq(const Hmc7043_app_dev_params *pParams)
+{
+	switch (pParams->clkInDiv) {
+		case HMC7043_CID_1:
+			return pParams->clkInFreq;
+		case HMC7043_CID_2:
+			return pParams->clkInFreq / 2;
+		default:
+			sysLog("bad argument (clkInDiv %d)", pParams->clkInDiv);
+			return 0;
 	}
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AppTimingInit
+*
+* - title: derive the fixed-point timing model of a clock plan
+*
+* - input: pParams - pointer to device setup parameters
+*
+* - output: *pTiming
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: sets up the clock cycle and delay steps as exact fractions of
+*                femtoseconds (ref. Hmc7043_timing)
+*******************************************************************************/
+LOCAL STATUS hmc7043AppTimingInit(const Hmc7043_app_dev_params *pParams,
+                                  Hmc7043_timing *pTiming)
+{
+    if ((pTiming->clkInpFreq = hmc7043AppClkInpFreq(pParams)) == 0)
+        return ERROR;
+
+    pTiming->clkStep.num  = HMC7043_FS_PER_SEC;
+    pTiming->clkStep.den  = pTiming->clkInpFreq;
+    pTiming->dDlyStep.num = HMC7043_FS_PER_SEC;
+    pTiming->dDlyStep.den = 2 * (UINT64) pParams->clkInFreq;
+    pTiming->aDlyStep.num = HMC7043_ADLY_STEP_SIZE * HMC7043_FS_PER_PS;
+    pTiming->aDlyStep.den = 1;
+
+    return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AppTimingSteps
+*
+* - title: convert a duration to a number of timing steps
+*
+* - input: pStep    - the step (ref. Hmc7043_timing)
+*          durPs    - the duration (ps)
+*          maxSteps - maximum number of steps
+*
+* - output: *pNSteps
+*
+* - returns: TRUE if durPs is a multiple of the step (to within
+*            HMC7043_DLY_TOLERANCE_FS) of up to maxSteps steps, else FALSE
+*
+* - description: rounds durPs to femtoseconds (the only floating point
+*                operation) and compares it with the nearest multiple of the
+*                step in units of 1 / den fs, i.e. exactly
+*
+* - notes: maxSteps * pStep->num must fit 64 bits (i.e. maxSteps up to a few
+*          thousand for steps of a second / den)
+*******************************************************************************/
+LOCAL Bool hmc7043AppTimingSteps(const Hmc7043_step *pStep, double durPs,
+                                 unsigned maxSteps, unsigned *pNSteps)
+{
+    UINT64 durFs, scaled, nSteps, nearest;
+
+    if (!(durPs >= 0 && durPs <= HMC7043_TIMING_MAX_PS))
+        return FALSE;
+
+    durFs = llround(durPs * HMC7043_FS_PER_PS);
+
+    /* (bounding durFs first, so that durFs * den cannot overflow) */
+    if (durFs > maxSteps * pStep->num / pStep->den + HMC7043_DLY_TOLERANCE_FS)
+        return FALSE;
+
+    scaled  = durFs * pStep->den;
+    nSteps  = (scaled + pStep->num / 2) / pStep->num;
+    nearest = nSteps * pStep->num;
+
+    if (nSteps > maxSteps ||
+        (scaled > nearest ? scaled - nearest : nearest - scaled) >
+        HMC7043_DLY_TOLERANCE_FS * pStep->den)
+        return FALSE;
+
+    *pNSteps = (unsigned) nSteps;
+    return TRUE;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AppPlanTiming
+*
+* - title: validate and convert the channels' timing parameters
+*
+* - input: pParams - pointer to device setup parameters
+*
+* - output: chTiming[0 .. HMC7043_OUT_NCHAN - 1]
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: for each used channel, derives the divider (which must be
+*                exact), the coarse / fine delay steps and the slip setup
+*                from the clock plan's timing model, checking these against
+*                the register fields
+*
+* - notes: a slipQuantumPs of 1 stands for a single slip, any other non-zero
+*          one for a multislip by that many ps (a multiple of the internal
+*          clock cycle)
+*******************************************************************************/
+LOCAL STATUS hmc7043AppPlanTiming(const Hmc7043_app_dev_params *pParams,
+                                  Hmc7043_ch_timing chTiming[])
+{
+    Hmc7043_timing timing;
+    unsigned ch, dSteps, aSteps, nSlips;
+
+    if (hmc7043AppTimingInit(pParams, &timing) != OK)
+        return ERROR;
+
+    memset(chTiming, 0, HMC7043_OUT_NCHAN * sizeof(chTiming[0]));
+
+    for (ch = 0; ch < HMC7043_OUT_NCHAN; ch++) {
+        const Hmc7043_ch_sup *pChSup = pParams->chSup + ch;
+        Hmc7043_ch_timing *pChTiming = chTiming + ch;
+
+        if (pChSup->chMode == HMC7043_CHM_UNUSED)
+            continue;
+
+        if (!pChSup->freq || timing.clkInpFreq % pChSup->freq ||
+            !inEnumRange(timing.clkInpFreq / pChSup->freq - 1,
+                         HMC7043_CH_DIV_MAX)) {
+            sysLogLong("channel frequency not an applicable divisor of the "
+                       "input clock (ch %lu, freq %lu, input clock %lu)",
+                       (long) ch, (long) pChSup->freq,
+                       (long) timing.clkInpFreq);
+            return ERROR;
+        }
+
+        pChTiming->divider = timing.clkInpFreq / pChSup->freq;
+
+        if (!hmc7043AppTimingSteps(&timing.dDlyStep, pChSup->dDlyPs,
+                                   HMC7043_DDLY_MAX_STEPS, &dSteps) ||
+            !hmc7043AppTimingSteps(&timing.aDlyStep, pChSup->aDlyPs,
+                                   min(HMC7043_ADLY_MAX_STEPS,
+                                       HMC7043_FADLY_MAX_STEPS), &aSteps)) {
+            sysLogFpa("delay(s) not a multiple of the step within range "
+                      "(ch %.0f, dDlyPs %.1f, aDlyPs %.1f)", (double) ch,
+                      pChSup->dDlyPs, pChSup->aDlyPs);
+            return ERROR;
+        }
+
+        pChTiming->dDlySteps = dSteps;
+        pChTiming->aDlySteps = aSteps;
+
+        if (pChSup->slipQuantumPs == 1) {
+            pChTiming->slip = TRUE;
+        } else if (pChSup->slipQuantumPs != 0) {
+            /* (offset by half the divider) */
+            if (!hmc7043AppTimingSteps(&timing.clkStep, pChSup->slipQuantumPs,
+                                       HMC7043_MSLIP_MAX, &nSlips) ||
+                !nSlips || nSlips + pChTiming->divider / 2 > HMC7043_MSLIP_MAX) {
+                sysLogFpa("slipQuantumPs not an applicable multiple of the "
+                          "input clock cycle (ch %.0f, slipQuantumPs %.1f)",
+                          (double) ch, pChSup->slipQuantumPs);
+                return ERROR;
+            }
+
+            pChTiming->msDelay = nSlips + pChTiming->divider / 2;
+        }
+    }
+
+    return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043WaitSysrefPeriod
+*
+* - title: wait for a number of SYSREF (timer) periods
+*
+* - input: dev - CLKDST device for which to perform the operation
+*          times - multiplication factor for wait period
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: the period is derived from the device's clock plan, i.e. from
+*                the SYSREF timer count in the register image and the
+*                (internal) input clock frequency (rounding the total wait
+*                up to a whole microsecond)
+*
+* - notes: sub-millisecond waits are busy waits, since sleeping could
+*          overshoot them by far
+*******************************************************************************/
+LOCAL STATUS hmc7043WaitSysrefPeriod(CKDST_DEV dev, unsigned times)
+{
+	static const UINT64 BUSY_WAIT_MAX_USEC = 1000;
+
+	const Hmc7043_reg_image *pImg;
+	CKDST_FREQ_HZ clkInpFreq;
+	unsigned timer;
+	UINT64 waitUsec;
+
+	if (!hmc7043DevPresent(dev)) {
+		hmc7043Log("bad argument (dev %d)", dev);
+		return ERROR;
+	}
+
+	pImg = &hmc7043AppState.pDevState[dev]->regImage;
+
+	timer = pImg->r5d.fields.timer << 8 | pImg->r5c.fields.timer;
+
+	if (!timer ||
+	    !(clkInpFreq = hmc7043AppClkInpFreq(&hmc7043AppCtl.pDevCtl[dev]->params))) {
+		hmc7043Log("SYSREF timer not set up (dev %d, timer %u)", dev, timer);
+		return ERROR;
+	}
+
+	/* wait = times * timer / clkInpFreq */
+	waitUsec = ((UINT64) times * timer * 1000000 + clkInpFreq - 1) / clkInpFreq;
+
+	if (waitUsec < BUSY_WAIT_MAX_USEC)
+		sysDelayUsecBusy((unsigned) waitUsec);
+	else
+		sysDelayUsec(waitUsec);
+
+	return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AppInitPgmSysrefTimer
+*
+* - title: Program the SYSREF timer with submultiple of lowest
+*          output sysref frequency, not greater than 4MHz.
+*
+* - input: pImg    - pointer to the register image to set up
+*          pParams - pointer to device setup parameters
+*
+* - output: *pImg
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above
+*******************************************************************************/
+LOCAL STATUS hmc7043AppInitPgmSysrefTimer(Hmc7043_reg_image *pImg,
+		                          const Hmc7043_app_dev_params *pParams)
+{
+	unsigned ch, timer;
+	CKDST_FREQ_HZ minFreq = 0, clkInpFreq;
+
+	if (!pImg || !pParams ||
+			(pParams->clkInFreq == 0) ) {
+		sysLog("bad argument(s) (pImg %d, pParams %d)", pImg != NULL,
+		       pParams != NULL);
+		return ERROR;
+	}
+
+	/* Find lowest output(SYSREF) frequency */
+	for (ch = 0; ch < HMC7043_OUT_NCHAN; ch++) {
+		if(pParams->chSup[ch].chMode == HMC7043_CHM_SYSREF) {
+			if(minFreq == 0) {
+				minFreq = pParams->chSup[ch].freq;
+			}
+			else {
+				if(pParams->chSup[ch].freq < minFreq)
+					minFreq = pParams->chSup[ch].freq;
+			}
+		}
+	}
+
+	/* Check if SYSREF Timer count is multiple of lowest output(SYSREF)
+	 * frequency and not greater than 4MHz*/
+	if(pParams->sysref.freq >= 4000000U ||
+			(minFreq && pParams->sysref.freq % minFreq != 0)) {
+		sysLog("SYSREF frequency is not an integer multiple of all channel "
+				"dividers (lowest output(SYSREF) frequency %lu, sysref "
+				"frequency %lu)", minFreq, pParams->sysref.freq);
+		return ERROR;
+	}
+
+	/* the timer counts (internal) input clock cycles and is 12-bit wide */
+	if ((clkInpFreq = hmc7043AppClkInpFreq(pParams)) == 0)
+		return ERROR;
+
+	if (!pParams->sysref.freq || clkInpFreq % pParams->sysref.freq != 0 ||
+	    (timer = clkInpFreq / pParams->sysref.freq) > 0xfff) {
+		sysLog("SYSREF timer frequency not applicable (input clock frequency "
+		       "%lu, sysref frequency %lu)", clkInpFreq, pParams->sysref.freq);
+		return ERROR;
+	}
+
+    pImg->r5c.fields.timer = timer & 0xff;
+    pImg->r5d.fields.timer = timer >> 8;
+
+	return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AppInitPgmOutCh
+*
+* - title: Program the output used channels
+*
+* - input: pImg     - pointer to the register image to set up
+*          pParams  - pointer to device setup parameters
+*          chTiming - the channels' timing register values (ref.
+*                     hmc7043AppPlanTiming)
+*
+* - output: *pImg
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above
+*******************************************************************************/
+LOCAL STATUS hmc7043AppInitPgmOutCh(Hmc7043_reg_image *pImg,
+		                          const Hmc7043_app_dev_params *pParams,
+		                          const Hmc7043_ch_timing chTiming[])
+{
+	Hmc7043_ch_regs *pChRegs;
+	unsigned ch;
+
+	if (!pImg || !pParams || !chTiming) {
+		sysLog("bad argument(s) (pImg %d, pParams %d, chTiming %d)",
+		       pImg != NULL, pParams != NULL, chTiming != NULL);
+		return ERROR;
+	}
+
+	for (ch = 0; ch < HMC7043_OUT_NCHAN; ch++) {
+		if(pParams->chSup[ch].chMode != HMC7043_CHM_UNUSED)
+		{
+			const Hmc7043_ch_timing *pChTiming = chTiming + ch;
+
+			/* Verify that analog delay is not configured as output MUX
+			 * for a DCLK channel */
+			if((pParams->chSup[ch].chMode == HMC7043_CHM_CLK) &&
+				(pParams->chSup[ch].outSel == HMC7043_COS_DIV_ADLY)){
+				sysLog("Exposing analog delay on output MUX for "
+						"DCLK channels causes phase noise "
+						"degradation.");
+				return ERROR;
+			}
+
+			pChRegs = hmc7043AppChRegs(pImg, ch);
+
+			pChRegs->ctl.fields.chEn = 0x1;
+			pChRegs->ctl.fields.hpMode =
+					pParams->chSup[ch].highPerfMode? 1 : 0;
+			pChRegs->ctl.fields.syncEn = 0x1;
+			pChRegs->drv.fields.drvMod = pParams->chSup[ch].drvMode;
+
+			/* Configure channel divider */
+			pChRegs->divLsb.fields.chDivLsb =
+					HMC7043_LSB_BIT_VAL(pChTiming->divider);
+			pChRegs->divMsb.fields.chDivMsb =
+					HMC7043_MSB_BIT_VAL(pChTiming->divider);
+			/* MultiSlip delay configuration */
+			if(pChTiming->msDelay) {
+				pChRegs->ctl.fields.multSlpEn = 1;
+				pChRegs->msDelayLsb.fields.msDelayLsb =
+						HMC7043_LSB_BIT_VAL(pChTiming->msDelay);
+				pChRegs->msDelayMsb.fields.msDelayMsb =
+						HMC7043_MSB_BIT_VAL(pChTiming->msDelay);
+			} else if(pChTiming->slip) {
+				pChRegs->ctl.fields.slipEn = 0x1;
+			}
+			/* Configuring Coarse Digital Delay */
+			pChRegs->cdDelay.fields.cdDelay = pChTiming->dDlySteps;
+			/* Configuring  Fine Analog Delay */
+			pChRegs->faDelay.fields.faDelay = pChTiming->aDlySteps;
+			/* Configuring Driver Impedance*/
+			if(pParams->chSup[ch].drvMode == HMC7043_CDM_CML) {
+				if(pParams->chSup[ch].cmlTerm == HMC7043_CCIT_NONE)
+					pChRegs->drv.fields.drvImp = 0x0;
+				else if(pParams->chSup[ch].cmlTerm == HMC7043_CCIT_100)
+					pChRegs->drv.fields.drvImp = 0x1;
+				else if(pParams->chSup[ch].cmlTerm == HMC7043_CCIT_50)
+					pChRegs->drv.fields.drvImp = 0x3;
+			}
+
+			if(pParams->chSup[ch].chMode == HMC7043_CHM_CLK) {
+				pChRegs->drv.fields.idlAtZero = 0x0;
+			} else if(pParams->chSup[ch].chMode == HMC7043_CHM_SYSREF) {
+				pChRegs->drv.fields.dyDrvEn =
+						pParams->chSup[ch].dynDriverEn? 1 : 0;
+			}
+
+			/* Configure start-up mode */
+			if(pParams->chSup[ch].dynDriverEn)
+				pChRegs->ctl.fields.stMod = 0x3;
+			else
+				pChRegs->ctl.fields.stMod = 0x0;
+
+			/* Configure output MUX selection */
+			if(pParams->chSup[ch].outSel == HMC7043_COS_FUNDAMENTAL)
+				pChRegs->outMuxSel.fields.outMuxSel = 0x3;
+			else if(pParams->chSup[ch].outSel == HMC7043_COS_DIVIDER)
+				pChRegs->outMuxSel.fields.outMuxSel = 0x0;
+			else if(pParams->chSup[ch].outSel == HMC7043_COS_DIV_ADLY)
+				pChRegs->outMuxSel.fields.outMuxSel = 0x1;
+			else if(pParams->chSup[ch].outSel == HMC7043_COS_DIV_NEIGHBOR)
+				pChRegs->outMuxSel.fields.outMuxSel = 0x2;
+		}  else {/* Unused channel */
+			/*	set start-up mode to 00 */
+			hmc7043AppChRegs(pImg, ch)->ctl.fields.stMod = 0x0;
+		}
+	}
+
+	return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AppInitPgmInCh
+*
+* - title: Program the Input CLK/RFSYNC
+*
+* - input: pImg    - pointer to the register image to set up
+*          pParams - pointer to device setup parameters
+*
+* - output: *pImg
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above
+*******************************************************************************/
+LOCAL STATUS hmc7043AppInitPgmInCh(Hmc7043_reg_image *pImg,
+		                          const Hmc7043_app_dev_params *pParams)
+{
+
+	if (!pImg || !pParams) {
+		sysLog("bad argument(s) (pImg %d, pParams %d)", pImg != NULL,
+		       pParams != NULL);
+		return ERROR;
+	}
+
+    if(pParams->clkIn.used) {
+    	pImg->r0a.fields.enBuff = 0x1;
+        if(pParams->clkIn.term100Ohm)
+        	pImg->r0a.fields.inBufMod |= 0x0;
+        if(pParams->clkIn.acCoupled)
+        	pImg->r0a.fields.inBufMod |= 0x1;
+        if(pParams->clkIn.lvpecl)
+        	pImg->r0a.fields.inBufMod |= 0x2;
+        if(pParams->clkIn.highZ)
+        	pImg->r0a.fields.inBufMod |= 0x3;
+    } else { //TBD need to check if this should be in else or separate if
+    	pImg->r0a.fields.enBuff = 0x0;
+    	if(pParams->syncIn.used){
+    		pImg->r0b.fields.enBuff = 0x1;
+    		if(pParams->syncIn.term100Ohm)
+    			pImg->r0b.fields.inBufMod |= 0x0;
+            if(pParams->clkIn.acCoupled)
+            	pImg->r0b.fields.inBufMod |= 0x1;
+            if(pParams->clkIn.lvpecl)
+            	pImg->r0b.fields.inBufMod |= 0x2;
+            if(pParams->clkIn.highZ)
+            	pImg->r0b.fields.inBufMod |= 0x3;
+        }
+    	else
+        	pImg->r0b.fields.enBuff = 0x0;
+    }
+
+	return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043CfgSdataMode
+*
+* - title: Configure SDATA mode for a particular device.
+*
+* - input: pImg     - pointer to the register image to set up
+*          pParams  - pointer to device setup parameters
+*
+* - output: *pImg
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above
+*******************************************************************************/
+LOCAL STATUS hmc7043CfgSdataMode(Hmc7043_reg_image *pImg,
+		                         const Hmc7043_app_dev_params *pParams)
+{
+
+	if (!pImg || !pParams) {
+		sysLog("bad argument(s) (pImg %d, pParams %d)", pImg != NULL,
+		       pParams != NULL);
+		return ERROR;
+	}
+
+	switch(pParams->sdataMode) {
+		case HMC7043_OM_OD: {
+			pImg->r54.fields.sdataMod = 0x0;
+			pImg->r54.fields.enSdata = 0x1;
+			break;
+		}
+		case HMC7032_OM_CMOS: {
+			pImg->r54.fields.sdataMod = 0x1;
+			pImg->r54.fields.enSdata = 0x1;
+			break;
+		}
+	}
+
+	return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043CfgGpio
+*
+* - title: Configure GPIO setup for a particular device.
+*
+* - input: pImg    - pointer to the register image to set up
+*          pParams - pointer to device setup parameters
+*
+* - output: *pImg
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above
+*******************************************************************************/
+LOCAL STATUS hmc7043CfgGpio(Hmc7043_reg_image *pImg,
+		                    const Hmc7043_app_dev_params *pParams)
+{
+
+	if (!pImg || !pParams) {
+		sysLog("bad argument(s) (pImg %d, pParams %d)", pImg != NULL,
+		       pParams != NULL);
+		return ERROR;
+	}
+
+	switch(pParams->gpiSup) {
+		case HMC7043_GPIS_NONE: {
+			/*  If application configures the GPI line to HMC7043_GPIS_NONE,
+			 *  software shall disable the GPI function in register 0x0046.
+			 *  Disabled  before switch case.
+			 */
+			break;
+		}
+		case HMC7043_GPIS_SLEEP: {
+			pImg->r46.fields.selGpi = 0x2;
+			pImg->r46.fields.enGpi = 0x1;
+			break;
+		}
+		case HMC7043_GPIS_MUTE: {
+			pImg->r46.fields.selGpi = 0x3;
+			pImg->r46.fields.enGpi = 0x1;
+			break;
+		}
+		case HMC7043_GPIS_PULSE_GEN: {
+			pImg->r46.fields.selGpi = 0x4;
+			pImg->r46.fields.enGpi = 0x1;
+			break;
+		}
+		case HMC7043_GPIS_RESEED: {
+			pImg->r46.fields.selGpi = 0x5;
+			pImg->r46.fields.enGpi = 0x1;
+			break;
+		}
+		case HMC7043_GPIS_RESTART: {
+			pImg->r46.fields.selGpi = 0x6;
+			pImg->r46.fields.enGpi = 0x1;
+			break;
+		}
+		case HMC7043_GPIS_SLIP: {
+			pImg->r46.fields.selGpi = 0x8;
+			pImg->r46.fields.enGpi = 0x1;
+		    break;
+		}
+		default: {
+			sysLog("Bad value ( GPI setup %d)", pParams->gpiSup);
+			return ERROR;
+		}
+	}
+
+	switch(pParams->gpoMode) {
+		case HMC7043_OM_OD: {
+			pImg->r50.fields.gpoMod = 0x0;
+			break;
+		}
+		case HMC7032_OM_CMOS: {
+			pImg->r50.fields.gpoMod = 0x1;
+			break;
+		}
+	}
+
+	switch(pParams->gpoSup) {
+		case HNC7043_GPOS_NONE: {
+			/*  If application configures the GPO line to HMC7043_GPOS_NONE,
+			 *  software shall disable the GPO function in register 0x0046.
+			 */
+			pImg->r50.fields.enGp0 = 0x0;
+			break;
+		}
+		case HMC7043_GPOS_ALARM: {
+			pImg->r50.fields.selGpo = 0x0;
+			pImg->r50.fields.enGp0 = 0x1;
+			break;
+		}
+		case HMC7043_GPOS_SDATA: {
+			pImg->r50.fields.selGpo = 0x1;
+			pImg->r50.fields.enGp0 = 0x1;
+			break;
+		}
+		case HMC7043_GPOS_SREF_NSYNC: {
+			pImg->r50.fields.selGpo = 0x2;
+			pImg->r50.fields.enGp0 = 0x1;
+			break;
+		}
+		case HMC7043_GPOS_CKOUTS_PHASE: {
+			pImg->r50.fields.selGpo = 0x3;
+			pImg->r50.fields.enGp0 = 0x1;
+			break;
+		}
+		case HMC7043_GPOS_SYNC_REQ_ST: {
+			pImg->r50.fields.selGpo = 0x4;
+			pImg->r50.fields.enGp0 = 0x1;
+			break;
+		}
+		case HMC7043_GPOS_CH_FSM_BUSY: {
+			pImg->r50.fields.selGpo = 0x5;
+			pImg->r50.fields.enGp0 = 0x1;
+			break;
+		}
+		case HMC7043_GPOS_SREF_FSM_ST0: {
+			pImg->r50.fields.selGpo = 0x6;
+			pImg->r50.fields.enGp0 = 0x1;
+			break;
+		}
+		case HMC7043_GPOS_SREF_FSM_ST1: {
+			pImg->r50.fields.selGpo = 0x7;
+			pImg->r50.fields.enGp0 = 0x1;
+			break;
+		}
+		case HMC7043_GPOS_SREF_FSM_ST2: {
+			pImg->r50.fields.selGpo = 0x8;
+			pImg->r50.fields.enGp0 = 0x1;
+			break;
+		}
+		case HMC7043_GPOS_SREF_FSM_ST3: {
+			pImg->r50.fields.selGpo = 0x9;
+			pImg->r50.fields.enGp0 = 0x1;
+			break;
+		}
+		case HMC7043_GPOS_FORCE_1: {
+			pImg->r50.fields.selGpo = 0xa;
+			pImg->r50.fields.enGp0 = 0x1;
+			break;
+		}
+		case HMC7043_GPOS_FORCE_0: {
+			pImg->r50.fields.selGpo = 0xb;
+			pImg->r50.fields.enGp0 = 0x1;
+			break;
+		}
+		case HMC7043_GPOS_PLS_GEN_REQ: {
+			pImg->r50.fields.selGpo = 0x19;
+			pImg->r50.fields.enGp0 = 0x1;
+			break;
+		}
+		default: {
+			sysLog("Bad value ( GPO setup %d)", pParams->gpoSup);
+			return ERROR;
+		}
+	}
+
+	return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043DisSync
+*
+* - title: Disables SYNC on all (used) output channels
+*
+* - input: dev - CLKDST device for which to perform the operation
+*          pParams - pointer to device setup parameters
+*
+* - output: hmc7043AppState.pDevState[dev]->regImage
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above
+*******************************************************************************/
+LOCAL STATUS hmc7043DisSync(CKDST_DEV dev, const Hmc7043_app_dev_params *pParams)
+{
+	HMC7043_CH_MASK chMask = 0;
+	unsigned ch;
+
+	if (!pParams) {
+		hmc7043Log("bad argument (dev %d, pParams %d)", dev, pParams != NULL);
+		return ERROR;
+	}
+
+	for (ch = 0; ch < HMC7043_OUT_NCHAN; ch++)
+		if(pParams->chSup[ch].chMode != HMC7043_CHM_UNUSED)
+			chMask |= 1 << ch;
+
+	return hmc7043AppChSyncDis(dev, chMask);
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AppChSyncDis
+*
+* - title: Disables SYNC on a set of output channels
+*
+* - input: dev    - CLKDST device for which to perform the operation
+*          chMask - output channels on which to disable SYNC
+*
+* - output: hmc7043AppState.pDevState[dev]->regImage
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above (only updating the register image)
+*******************************************************************************/
+LOCAL STATUS hmc7043AppChSyncDis(CKDST_DEV dev, HMC7043_CH_MASK chMask)
+{
+	Hmc7043_reg_image *pImg;
+	unsigned ch;
+
+	if (!hmc7043DevPresent(dev) ||
+	    chMask >= 1 << HMC7043_OUT_NCHAN) {
+		hmc7043Log("bad argument(s) (dev %d, chMask 0x%x)", dev, chMask);
+		return ERROR;
+	}
+
+	pImg = &hmc7043AppState.pDevState[dev]->regImage;
+
+	for (ch = 0; ch < HMC7043_OUT_NCHAN; ch++)
+		if (chMask & 1 << ch)
+			hmc7043AppChRegs(pImg, ch)->ctl.fields.syncEn = 0x0;
+
+	return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AppInitPgmPlGnMd
+*
+* - title: Program the Pulse Generator Mode
+*
+* - input: pImg    - pointer to the register image to set up
+*          pParams - pointer to device setup parameters
+*
+* - output: *pImg
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above
+*******************************************************************************/
+LOCAL STATUS hmc7043AppInitPgmPlGnMd(Hmc7043_reg_image *pImg,
+		                          const Hmc7043_app_dev_params *pParams)
+{
+
+	if (!pImg || !pParams) {
+		sysLog("bad argument(s) (pImg %d, pParams %d)", pImg != NULL,
+		       pParams != NULL);
+		return ERROR;
+	}
+
+	/* Set pulse generation mode */
+	switch(pParams->sysref.mode)
+	{
+		case HMC7043_SRM_CONTINUOUS: {
+			pImg->r5a.fields.pulseMode = 0x7;
+			break;
+		}
+		case HMC7043_SRM_LEVEL_CTL: {
+			pImg->r5a.fields.pulseMode = 0x0;
+			break;
+		}
+		case HMC7043_SRM_PULSED: {
+			switch(pParams->sysref.nPulses)
+			{
+				case HMC7043_SRNP_1: {
+					pImg->r5a.fields.pulseMode = 0x1;
+					break;
+				}
+				case HMC7043_SRNP_2: {
+					pImg->r5a.fields.pulseMode = 0x2;
+					break;
+				}
+				case HMC7043_SRNP_4: {
+					pImg->r5a.fields.pulseMode = 0x3;
+					break;
+				}
+				case HMC7043_SRNP_8: {
+					pImg->r5a.fields.pulseMode = 0x4;
+					break;
+				}
+				case HMC7043_SRNP_16: {
+					pImg->r5a.fields.pulseMode = 0x5;
+					break;
+				}
+				default: {
+					sysLog("Bad value ( pParams->sysref.nPulses %d)",
+							pParams->sysref.nPulses);
+					return ERROR;
+				}
+			}
+			break;
+		}
+		default:
+			sysLog("Bad value ( pParams->sysref.mode %d)",
+				   pParams->sysref.mode);
+			return ERROR;
+	}
+	return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AppBuildRegImage
+*
+* - title: convert device setup parameters to a register image
+*
+* - input: pParams - pointer to device setup parameters (already validated, ref.
+*                    hmc7043AppChkParams)
+*          pImg    - pointer to the register image to set up
+*
+* - output: *pImg
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: sets up all the registers maintained in the register image
+*                (steps 3 - 5 of the 'typical programming sequence', ref.
+*                hmc7043AppInitAppSup) without accessing any device
+*
+* - notes: also used for compiling configuration blobs (ref.
+*          hmc7043CompileParams)
+*******************************************************************************/
+LOCAL STATUS hmc7043AppBuildRegImage(const Hmc7043_app_dev_params *pParams,
+                                     Hmc7043_reg_image *pImg)
+{
+    Hmc7043_ch_timing chTiming[HMC7043_OUT_NCHAN];
+    unsigned i;
+    Bool r65Done = FALSE;
+
+    if (!pParams || !pImg) {
+        sysLog("bad argument(s) (pParams %d, pImg %d)", pParams != NULL,
+               pImg != NULL);
+        return ERROR;
+    }
+
+    /* (the channels' timing being derived in a single pass) */
+    if (hmc7043AppPlanTiming(pParams, chTiming) != OK)
+        return ERROR;
+
+    memset(pImg, 0, sizeof(*pImg));
+
+    /* Load configuration update to register as in Table-40 of data sheet */
+    if(hmc7043LoadConfigUpd(pImg) != OK)
+        return ERROR;
+
+    if(hmc7043AppInitReservedReg(pImg) != OK)
+        return ERROR;
+
+    if(hmc7043AppInitReservdFields(pImg) != OK)
+        return ERROR;
+
+    if(hmc7043CfgGpio(pImg, pParams) != OK)
+        return ERROR;
+
+    if(hmc7043CfgSdataMode(pImg, pParams) != OK)
+        return ERROR;
+
+    /* Set sysref timer */
+    if(hmc7043AppInitPgmSysrefTimer(pImg, pParams) != OK)
+        return ERROR;
+
+    /* Program Pulse generator mode */
+    if(hmc7043AppInitPgmPlGnMd(pImg, pParams) != OK)
+        return ERROR;
+
+    /* Program output channels */
+    if(hmc7043AppInitPgmOutCh(pImg, pParams, chTiming) != OK)
+        return ERROR;
+
+    /* Program Input CLK/RFSYNC */
+    if(hmc7043AppInitPgmInCh(pImg, pParams) != OK)
+        return ERROR;
+
+    /* Software shall set register 0x0064 bit 0 if
+     *  input clock frequency is < 1 GHz. */
+    if(pParams->clkInFreq < 1000000000LL) {
+        pImg->r64.fields.lfClkInp = 0;
+    }
+
+    /* Software shall set register 0x0065 bit 0 to 0,
+     * except if no output channel is using analog delay. */
+    for(i = 0; i < HMC7043_OUT_NCHAN; i++) {
+        if(pParams->chSup[i].aDlyPs > 0) {
+            pImg->r65.fields.aDelLowPowMo = 0;
+            r65Done = TRUE;
+            break;
+        }
+    }
+    if(!r65Done)
+        pImg->r65.fields.aDelLowPowMo = 1;
+
+    /* Software shall set register 0x0001 bit 6 (high performance
+     * distribution path) in all cases */
+    pImg->r01.fields.highPrfPath = 1;
+
+    return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043Crc32
+*
+* - title: calculate CRC-32 (IEEE 802.3, as used by zlib)
+*
+* - input: pData - pointer to the data
+*          size  - size of the data (bytes)
+*
+* - returns: the CRC
+*
+* - description: as above (bitwise, this only being used on configuration blobs)
+*******************************************************************************/
+LOCAL UINT32 hmc7043Crc32(const UINT8 *pData, unsigned size)
+{
+    UINT32 crc = 0xffffffff;
+    unsigned i, j;
+
+    for (i = 0; i < size; ++i) {
+        crc ^= pData[i];
+
+        for (j = 0; j < 8; ++j)
+            crc = crc >> 1 ^ (crc & 1 ? 0xedb88320 : 0);
+    }
+
+    return ~crc;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043CompileParams
+*
+* - title: compile device setup parameters to a configuration blob
+*
+* - input: pParams - pointer to device setup parameters
+*          pBlob   - where to return the blob
+*          maxSize - size of the pBlob buffer (bytes; HMC7043_CFG_BLOB_MAX_SIZE
+*                    is always sufficient)
+*          pSize   - where to return the actual size of the blob
+*
+* - output: *pBlob, *pSize
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: validates the parameters and converts them to the register
+*                image that a cold hmc7043InitDev would write to the device,
+*                returning both (with a version and checksum, ref.
+*                Hmc7043_cfg_blob_hdr) for use by hmc7043InitDevFromBlob
+*
+* - notes: 1) Does not access any device (nor requires hmc7043IfInit), so may be
+*             used offline as well (by the same build of this module).
+*          2) pBlob must be aligned as Hmc7043_app_dev_params would be.
+*******************************************************************************/
+EXPORT STATUS hmc7043CompileParams(const Hmc7043_app_dev_params *pParams,
+                                   void *pBlob, unsigned maxSize,
+                                   unsigned *pSize)
+{
+    Hmc7043_cfg_blob_hdr *pHdr = (Hmc7043_cfg_blob_hdr *) pBlob;
+    Hmc7043_reg_image image;
+    UINT8 *pReg;
+    unsigned i;
+
+    /* initialize */
+    if (!pParams || !pBlob || maxSize < HMC7043_CFG_BLOB_SIZE || !pSize) {
+        sysLog("bad argument(s) (pParams %d, pBlob %d, maxSize %u, pSize %d)",
+               pParams != NULL, pBlob != NULL, maxSize, pSize != NULL);
+        return ERROR;
+    }
+
+    if (hmc7043AppChkParams(pParams) != OK ||
+        hmc7043AppBuildRegImage(pParams, &image) != OK)
+        return ERROR;
+
+    /* set up the blob */
+    memcpy(pHdr + 1, pParams, sizeof(*pParams));
+
+    pReg = (UINT8 *) (pHdr + 1) + sizeof(*pParams);
+
+    for (i = 0; i < NELEMENTS(hmc7043AppRegDescs); ++i) {
+        const Hmc7043_reg_desc *pDesc = hmc7043AppRegDescs + i;
+
+        *pReg++ = HMC7043_LSB_BIT_VAL(pDesc->regInx);
+        *pReg++ = HMC7043_MSB_BIT_VAL(pDesc->regInx);
+        *pReg++ = ((const UINT8 *) &image)[pDesc->dataOffs];
+    }
+
+    pHdr->magic      = HMC7043_CFG_BLOB_MAGIC;
+    pHdr->version    = HMC7043_CFG_BLOB_VERSION;
+    pHdr->nRegs      = NELEMENTS(hmc7043AppRegDescs);
+    pHdr->paramsSize = sizeof(*pParams);
+    pHdr->crc        = hmc7043Crc32((const UINT8 *) (pHdr + 1),
+                                    HMC7043_CFG_BLOB_SIZE - sizeof(*pHdr));
+
+    *pSize = HMC7043_CFG_BLOB_SIZE;
+
+    return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AppChkBlob
+*
+* - title: verify a configuration blob
+*
+* - input: pBlob - pointer to the blob (ref. hmc7043CompileParams)
+*          size  - size of the blob (bytes)
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: verifies that the blob is complete, intact and compatible with
+*                this build (version, parameters size and set of registers)
+*******************************************************************************/
+LOCAL STATUS hmc7043AppChkBlob(const Hmc7043_cfg_blob_hdr *pBlob, unsigned size)
+{
+    if (!pBlob || size < sizeof(*pBlob)) {
+        sysLog("bad argument(s) (pBlob %d, size %u)", pBlob != NULL, size);
+        return ERROR;
+    }
+
+    if (pBlob->magic != HMC7043_CFG_BLOB_MAGIC ||
+        pBlob->version != HMC7043_CFG_BLOB_VERSION ||
+        pBlob->paramsSize != sizeof(Hmc7043_app_dev_params) ||
+        pBlob->nRegs != NELEMENTS(hmc7043AppRegDescs) || size != HMC7043_CFG_BLOB_SIZE) {
+        sysLog("incompatible blob (magic 0x%x, version %u, paramsSize %u, "
+               "nRegs %u, size %u)", pBlob->magic, pBlob->version,
+               pBlob->paramsSize, pBlob->nRegs, size);
+        return ERROR;
+    }
+
+    if (hmc7043Crc32((const UINT8 *) (pBlob + 1), size - sizeof(*pBlob)) !=
+        pBlob->crc) {
+        sysLog("blob CRC mismatch (crc 0x%x)", pBlob->crc);
+        return ERROR;
+    }
+
+    return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AppBlobRegImage
+*
+* - title: set up a register image from a configuration blob
+*
+* - input: pBlob - pointer to the blob (already verified, ref. hmc7043AppChkBlob)
+*          pImg  - pointer to the register image to set up
+*
+* - output: *pImg
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above
+*******************************************************************************/
+LOCAL STATUS hmc7043AppBlobRegImage(const Hmc7043_cfg_blob_hdr *pBlob,
+                                    Hmc7043_reg_image *pImg)
+{
+    const UINT8 *pReg;
+    unsigned i;
+
+    if (!pBlob || !pImg) {
+        sysLog("bad argument(s) (pBlob %d, pImg %d)", pBlob != NULL,
+               pImg != NULL);
+        return ERROR;
+    }
+
+    memset(pImg, 0, sizeof(*pImg));
+
+    pReg = (const UINT8 *) (pBlob + 1) + pBlob->paramsSize;
+
+    for (i = 0; i < pBlob->nRegs; ++i, pReg += HMC7043_CFG_BLOB_REG_SIZE) {
+        unsigned regInx = pReg[0] | pReg[1] << 8;
+        int iDesc = hmc7043AppRegDescInx(regInx);
+
+        if (iDesc < 0) {
+            sysLog("register not in register image (regInx 0x%x)", regInx);
+            return ERROR;
+        }
+
+        ((UINT8 *) pImg)[hmc7043AppRegDescs[iDesc].dataOffs] = pReg[2];
+    }
+
+    return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AppInitAppSup
+*
+* - title: initialize CLK device as per 'typical programming sequence'
+*          mentioned in data sheet.
+*
+* - input: dev - CLKDST device for which to perform the operation
+*
+* - output: *hmc7043AppState.pDevState[dev]
+*
+* - returns: OK or ERROR if detected an error
+*
+* - notes: Step 1&2: these are to be done on hardware, soft reset, GPIO, SDATA
+*                    setup will be done in this function
+*          Step 3: Load the configuration updates (provided by Analog
+*                  Devices, Inc.) to specific registers (see Table 40).
+*                  This is done in hmc7043LoadConfigUpd.
+*          Step 4: Program SYSREF timer, set divide ratio, set the pulse
+*                  generation mode configuration.
+*          Step 5: Program output channels.set divide ratio,channel start-up mode
+*                  coarse/analog delays and performance mode.
+*          Steps 3 - 5 are set up in the register image beforehand (ref.
+*          hmc7043AppBuildRegImage), the register image being written to the
+*          device here as a whole.
+*          Step 6: Ensure clock input signal is given to
+*                  CLKIN(to be done on hardware.
+*          Step 7: Issue a software restart to reset the system and initiate
+*                  calibration. Toggle the restart dividers/FSMs bit to 1 and
+*                  then back to 0.
+*          Steps 8 - 10 are done by hmc7043AppInitStartUp.
+*          Step 8: Send a sync request via the SPI (set the reseed request bit)
+*                  to align the divider phases and send any initial pulse
+*                  generator stream.
+*          Step 9: Wait 6 SYSREF periods.
+*          Step 10: Confirm that the outputs have all reached their phases by
+*                   checking that the clock outputs phases status bit = 1.*
+*          Step 11: Initialize other devices in the system. SYSREF channels can
+*                   be either on asynchronous/dynamic and may turn on for pulse
+*                   generation stream.
+*          Step 12: Slave JESD204B devices in the system must be configured
+*                   to monitor the input SYSREF signal exported from the HMC7043
+*          Step 13: When all JESD204B slaves are powered and ready, send a
+*                   pulse generator request to send out a pulse generator
+*                   chain on any SYSREF channels programmed for pulse
+*                   generator mode.
+*******************************************************************************/
+LOCAL STATUS hmc7043AppInitAppSup(CKDST_DEV dev)
+{
+	const Hmc7043_app_dev_ctl *pCtl;
+
+	if (!hmc7043DevPresent(dev)) {
+	    sysLog("bad argument (dev %d)", dev);
+	    return ERROR;
+	}
+
+	pCtl = hmc7043AppCtl.pDevCtl[dev];
+
+	if (!hmc7043AppDevReady(pCtl)) {
+	    sysLog("initialization not done yet (dev %d, init. done %d,%d,%d)", dev,
+	            hmc7043IfCtl.initDone, hmc7043AppCtl.initDone, pCtl->initDone);
+        return ERROR;
+    }
+	/* Issue software restart to reset system */
+	hmc7043ProfBegin(dev, HMC7043_IPH_SOFT_RESET);
+
+	if(hmc7043ToggleBit(dev,HMC7043_REG_IDX_SOFT_RESET, HMC7043_SFT_RST_BIT,
+					HMC7043_WOP_SOFT_RESET) != OK)
+		return ERROR;
+
+	hmc7043ProfEnd(dev, HMC7043_IPH_SOFT_RESET);
+
+    /* write the whole register image to the device registers */
+    hmc7043ProfBegin(dev, HMC7043_IPH_WRITE_IMAGE);
+
+    if (hmc7043AppInitWrRegs(dev) != OK)
+        return ERROR;
+
+    hmc7043ProfEnd(dev, HMC7043_IPH_WRITE_IMAGE);
+
+    hmc7043AppState.pDevState[dev]->regImage.initDone = TRUE;
+
+    /* Issue software restart to reset system and start calibration (the
+       soft reset is assumed to retain the register contents, so the device
+       image remains valid) */
+    hmc7043ProfBegin(dev, HMC7043_IPH_RESTART);
+
+    if(hmc7043ToggleBit(dev, HMC7043_REG_IDX_SOFT_RESET, HMC7043_SFT_RST_BIT,
+    		         HMC7043_WOP_SOFT_RESET) != OK)
+    	return ERROR;
+
+    /*Toggle the restart dividers/FSMs bit to 1 and then back to 0.*/
+    if(hmc7043ToggleBit(dev,HMC7043_REG_IDX_REQ_MOD, HMC7043_FSM_DIV_RESET_BIT,
+    		        HMC7043_WOP_RESTART) != OK)
+    	return ERROR;
+
+    hmc7043ProfEnd(dev, HMC7043_IPH_RESTART);
+
+    /* the rest of the sequence is done by hmc7043AppInitStartUp */
+
+    return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AppInitStartUp
+*
+* - title: complete CLK device initialization (steps 8 - 10 of the 'typical
+*          programming sequence', ref. hmc7043AppInitAppSup)
+*
+* - input: dev     - CLKDST device for which to perform the operation
+*          pParams - pointer to device setup parameters
+*
+* - output: hmc7043AppState.pDevState[dev]->regImage
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above
+*
+* - notes: kept separate so that concurrently initialized devices can be
+*          synchronized right before this step (ref. hmc7043InitDevMulti)
+*******************************************************************************/
+LOCAL STATUS hmc7043AppInitStartUp(CKDST_DEV dev,
+                                   const Hmc7043_app_dev_params *pParams)
+{
+	if (!hmc7043DevPresent(dev) || !pParams) {
+	    sysLog("bad argument(s) (dev %d, pParams %d)", dev, pParams != NULL);
+	    return ERROR;
+	}
+
+    /* Send a sync request via the SPI (set the reseed request bit) */
+    hmc7043ProfBegin(dev, HMC7043_IPH_RESEED);
+
+    if(hmc7043ToggleBit(dev, HMC7043_REG_IDX_REQ_MOD, HMC7043_RESEED_BIT,
+    		        HMC7043_WOP_RESEED) != OK)
+    	return ERROR;
+
+    /* Send any initial Pulse generator stream */
+    if(hmc7043ToggleBit(dev, HMC7043_REG_IDX_REQ_MOD, HMC7043_PULS_GEN_BIT,
+    		        HMC7043_WOP_PULSE_GEN) != OK)
+    	return ERROR;
+
+    hmc7043ProfEnd(dev, HMC7043_IPH_RESEED);
+
+    /* Wait for 6xSYSREF period */
+    hmc7043ProfBegin(dev, HMC7043_IPH_SYSREF_WAIT);
+
+    if(hmc7043WaitSysrefPeriod(dev, HMC7043_INIT_WAIT_TIMES) != OK)
+    	return ERROR;
+
+    hmc7043ProfEnd(dev, HMC7043_IPH_SYSREF_WAIT);
+
+    /* Wait for the clock output phase status to be set */
+    hmc7043ProfBegin(dev, HMC7043_IPH_PHASE_WAIT);
+
+    if(hmc7043AppWaitDone(dev, HMC7043_WOP_CKOUT_PHASE) != OK)
+    	return ERROR; // TBD : need to confirm what has to be done.
+
+    hmc7043ProfEnd(dev, HMC7043_IPH_PHASE_WAIT);
+
+    /* After completed the initialization sequence, software shall
+     * disable SYNC on all channels. */
+    hmc7043ProfBegin(dev, HMC7043_IPH_SYNC_DIS);
+
+    if(hmc7043DisSync(dev, pParams) != OK)
+    	return ERROR;
+
+    if (hmc7043AppFlushRegs(dev) != OK)
+        return ERROR;
+
+    hmc7043ProfEnd(dev, HMC7043_IPH_SYNC_DIS);
+
+    /* Application to call hmc7043SysrefSwPulseN when all slaves are ready */
+
+    return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AppParamsCanon
+*
+* - title: get the canonical representation of device setup parameters
+*
+* - input: pParams - pointer to device setup parameters
+*
+* - output: *pCanon
+*
+* - returns: N/A
+*
+* - description: copies the parameters field by field into a cleared structure,
+*                so that padding bytes are zero (i.e. parameters that are
+*                equal have the same representation, which can then be hashed
+*                or compared with memcmp)
+*
+* - notes: to be extended along with Hmc7043_app_dev_params
+*******************************************************************************/
+LOCAL void hmc7043AppParamsCanon(const Hmc7043_app_dev_params *pParams,
+                                 Hmc7043_app_dev_params *pCanon)
+{
+    unsigned ch;
+
+    memset(pCanon, 0, sizeof(*pCanon));
+
+#   define INSUP_COPY(in)                                                    \
+        do {                                                                 \
+            pCanon->in.used       = pParams->in.used;                        \
+            pCanon->in.term100Ohm = pParams->in.term100Ohm;                  \
+            pCanon->in.acCoupled  = pParams->in.acCoupled;                   \
+            pCanon->in.lvpecl     = pParams->in.lvpecl;                      \
+            pCanon->in.highZ      = pParams->in.highZ;                       \
+        } while (0)
+
+    pCanon->clkInFreq = pParams->clkInFreq;
+    pCanon->clkInDiv  = pParams->clkInDiv;
+    INSUP_COPY(clkIn);
+    INSUP_COPY(syncIn);
+    pCanon->gpiSup    = pParams->gpiSup;
+    pCanon->gpoSup    = pParams->gpoSup;
+    pCanon->gpoMode   = pParams->gpoMode;
+    pCanon->sdataMode = pParams->sdataMode;
+
+#   undef INSUP_COPY
+
+    pCanon->sysref.freq         = pParams->sysref.freq;
+    pCanon->sysref.mode         = pParams->sysref.mode;
+    pCanon->sysref.invertedSync = pParams->sysref.invertedSync;
+    pCanon->sysref.syncRetime   = pParams->sysref.syncRetime;
+    pCanon->sysref.nPulses      = pParams->sysref.nPulses;
+
+    pCanon->alarmsEn.syncReq  = pParams->alarmsEn.syncReq;
+    pCanon->alarmsEn.cksPhase = pParams->alarmsEn.cksPhase;
+    pCanon->alarmsEn.srefSync = pParams->alarmsEn.srefSync;
+
+    for (ch = 0; ch < HMC7043_OUT_NCHAN; ++ch) {
+        const Hmc7043_ch_sup *pSup = pParams->chSup + ch;
+        Hmc7043_ch_sup *pOut = pCanon->chSup + ch;
+
+        pOut->chMode        = pSup->chMode;
+        pOut->freq          = pSup->freq;
+        pOut->drvMode       = pSup->drvMode;
+        pOut->cmlTerm       = pSup->cmlTerm;
+        pOut->idle0         = pSup->idle0;
+        pOut->outSel        = pSup->outSel;
+        pOut->dDlyPs        = pSup->dDlyPs;
+        pOut->aDlyPs        = pSup->aDlyPs;
+        pOut->slipQuantumPs = pSup->slipQuantumPs;
+        pOut->highPerfMode  = pSup->highPerfMode;
+        pOut->dynDriverEn   = pSup->dynDriverEn;
+    }
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AppParamsHash
+*
+* - title: calculate the hash of device setup parameters
+*
+* - input: pParams - pointer to device setup parameters
+*
+* - returns: the hash
+*
+* - description: 64-bit FNV-1a over the parameters' canonical representation
+*                (ref. hmc7043AppParamsCanon)
+*******************************************************************************/
+LOCAL UINT64 hmc7043AppParamsHash(const Hmc7043_app_dev_params *pParams)
+{
+    Hmc7043_app_dev_params canon;
+    const UINT8 *pData = (const UINT8 *) &canon;
+    UINT64 hash = 0xcbf29ce484222325ULL;
+    unsigned i;
+
+    hmc7043AppParamsCanon(pParams, &canon);
+
+    for (i = 0; i < sizeof(canon); ++i)
+        hash = (hash ^ pData[i]) * 0x100000001b3ULL;
+
+    return hash;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AppCacheHit
+*
+* - title: check whether the cached register image of a device applies
+*
+* - input: dev     - CLKDST device for which to perform the operation
+*          pParams - pointer to device setup parameters
+*
+* - returns: TRUE if the cached register image was built from pParams, else FALSE
+*
+* - description: compares the parameters' hash first, and then the parameters
+*                themselves (so that a hash collision cannot result in a wrong
+*                register image), the cached ones being kept in canonical
+*                representation (ref. hmc7043AppParamsCanon)
+*******************************************************************************/
+LOCAL Bool hmc7043AppCacheHit(CKDST_DEV dev,
+                              const Hmc7043_app_dev_params *pParams)
+{
+    const Hmc7043_app_dev_ctl *pCtl = hmc7043AppCtl.pDevCtl[dev];
+    Hmc7043_app_dev_params canon;
+
+    if (!pCtl->imageCached ||
+        pCtl->paramsHash != hmc7043AppParamsHash(pParams))
+        return FALSE;
+
+    hmc7043AppParamsCanon(pParams, &canon);
+
+    return !memcmp(&hmc7043AppCache.pDevCache[dev]->params, &canon,
+                   sizeof(canon));
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AppPersistImage
+*
+* - title: persist the device register image of a device
+*
+* - input: dev - CLKDST device for which to perform the operation
+*
+* - output: hmc7043PersistCtl.pSeg->devRec[dev]
+*
+* - description: copies the device register image (including which registers
+*                it is known for) to the persistence segment (if any), such
+*                that a process restart in the middle leaves the copy invalid
+*
+* - notes: must be called within the associated critical section
+*******************************************************************************/
+LOCAL void hmc7043AppPersistImage(CKDST_DEV dev)
+{
+    const Hmc7043_app_dev_state *pState = hmc7043AppState.pDevState[dev];
+    Hmc7043_persist_dev *pRec;
+    UINT32 gen;
+
+    if (!hmc7043PersistCtl.pSeg)
+        return;
+
+    pRec = hmc7043PersistCtl.pSeg->devRec + dev;
+    gen = pRec->gen | 1;
+
+    sysAtomicStoreRelaxed(&pRec->gen, gen);
+    sysAtomicFenceRel();
+
+    pRec->paramsHash = pState->paramsHash;
+    pRec->devImage   = pState->devImage;
+    memcpy(pRec->devKnown, pState->devKnown, sizeof(pRec->devKnown));
+
+    sysAtomicStoreRel(&pRec->gen, gen + 1);
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AppRestoreImage
+*
+* - title: restore the register image of a device from its persisted copy
+*
+* - input: dev - CLKDST device for which to perform the operation
+*
+* - output: *hmc7043AppState.pDevState[dev]
+*
+* - returns: OK or ERROR if there is no usable persisted copy
+*
+* - description: takes the persisted copy if it is complete, was set up for the
+*                same parameters (ref. Hmc7043_app_dev_state.paramsHash) and
+*                matches the product id and the verification registers as read
+*                back from the device (ref. hmc7043SetPersistence)
+*
+* - notes: 1) Must be called within the associated critical section.
+*          2) *hmc7043AppState.pDevState[dev] is assumed to be cleared but for
+*             .paramsHash, as is left this way on error.
+*******************************************************************************/
+LOCAL STATUS hmc7043AppRestoreImage(CKDST_DEV dev)
+{
+    Hmc7043_app_dev_state *pState = hmc7043AppState.pDevState[dev];
+    const Hmc7043_persist_dev *pRec;
+    unsigned i;
+    UINT32 gen;
+
+    if (!hmc7043PersistCtl.pSeg)
+        return ERROR;
+
+    pRec = hmc7043PersistCtl.pSeg->devRec + dev;
+    gen = sysAtomicLoadAcq(&pRec->gen);
+
+    if (!gen || gen & 1 || pRec->paramsHash != pState->paramsHash) {
+        sysLogInfo("no usable persisted register image (dev %d, gen %u)", dev,
+                   gen);
+        return ERROR;
+    }
+
+    pState->devImage = pRec->devImage;
+    memcpy(pState->devKnown, pRec->devKnown, sizeof(pState->devKnown));
+
+    /* verify against the device */
+    if (hmc7043AppChkProdId(dev) != OK)
+        goto mismatch;
+
+    for (i = 0; i < hmc7043PersistCtl.nVerifyRegs; ++i) {
+        unsigned regInx = hmc7043PersistCtl.verifyRegs[i];
+        int iDesc = hmc7043AppRegDescInx(regInx);
+        HMC7043_REG data;
+
+        if (!(pState->devKnown[iDesc / 32] & 1U << iDesc % 32) ||
+            hmc7043LliRegReadInCs(dev, regInx, &data) != OK)
+            goto mismatch;
+
+        if (data != ((const UINT8 *) &pState->devImage)
+                    [hmc7043AppRegDescs[iDesc].dataOffs]) {
+            sysLogInfo("persisted register image mismatch (dev %d, regInx "
+                       "0x%02x, data 0x%02x)", dev, regInx, data);
+            goto mismatch;
+        }
+    }
+
+    pState->regImage = pState->devImage;
+    pState->regImage.initDone = TRUE;
+
+    return OK;
+
+mismatch:
+    memset(&pState->devImage, 0, sizeof(pState->devImage));
+    memset(pState->devKnown, 0, sizeof(pState->devKnown));
+
+    return ERROR;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043PersistDelete
+*
+* - title: delete the persistence segment (auto-delete resource function)
+*
+* - input: name - name of the shared memory object
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above
+*******************************************************************************/
+LOCAL STATUS hmc7043PersistDelete(const char *name)
+{
+    if (shm_unlink(name)) {
+        sysLogLong("shm_unlink failed (name %s)", name);
+        return ERROR;
+    }
+
+    return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AppInitDevAct
+*
+* - title: actually initialize a CLKDST device
+*
+* - input: dev     - CLKDST device for which to perform the operation
+*          pParams - pointer to device setup parameters
+*          pSync   - start-up synchronization data (NULL if not applicable)
+*          pBlob   - precompiled configuration (NULL if not applicable, ref.
+*                    hmc7043AppChkBlob)
+*          cached  - whether to use the cached register image (ref.
+*                    hmc7043AppCacheHit)
+*
+* - output: *hmc7043AppState.pDevState[dev], *hmc7043AppCache.pDevCache[dev],
+*           hmc7043AppCtl.pDevCtl[dev]->imageCached, .paramsHash, *pSync
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above, the register image being taken from the cache if
+*                applicable (in which case only the device programming sequence
+*                remains), else set up and then cached
+*
+* - notes: 1) This routine can be called more than once (for a device).
+*          2) It is assumed that *hmc7043AppCtl.pDevCtl[dev] has already been setup.
+*          3) Must be called within the associated critical section, taken
+*             once for the whole programming sequence (ref. hmc7043CsEnter).
+*******************************************************************************/
+LOCAL STATUS hmc7043AppInitDevAct(CKDST_DEV dev,
+                                  const Hmc7043_app_dev_params *pParams,
+                                  Hmc7043_start_sync *pSync,
+                                  const Hmc7043_cfg_blob_hdr *pBlob, Bool cached)
+{
+    Hmc7043_app_dev_ctl *pCtl;
+    Hmc7043_app_dev_state *pState;
+    STATUS status;
+
+    /* initialize */
+    if (!hmc7043DevPresent(dev) || !pParams) {
+        sysLog("bad argument(s) (dev %d, pParams %d)", dev, pParams != NULL);
+        return ERROR;
+    }
+
+    pCtl = hmc7043AppCtl.pDevCtl[dev];
+    pState = hmc7043AppState.pDevState[dev];
+
+    if (!hmc7043AppCtl.initDone) {
+        sysLog("control data initialization not done yet (dev %d)", dev);
+        return ERROR;
+    }
+
+    /* verify the expected device id(s) */
+    hmc7043ProfBegin(dev, HMC7043_IPH_PROD_ID);
+
+    if (hmc7043AppChkProdId(dev) != OK)
+        return ERROR;
+
+    hmc7043ProfEnd(dev, HMC7043_IPH_PROD_ID);
+
+    memset(pState, 0, sizeof(*pState));
+
+    hmc7043ProfBegin(dev, HMC7043_IPH_BUILD_IMAGE);
+
+    if (cached)
+        pState->regImage = hmc7043AppCache.pDevCache[dev]->regImage;
+    else {
+        pCtl->imageCached = FALSE;
+
+        /* set up the register image (either per the parameters or as
+           precompiled) */
+        if ((pBlob ? hmc7043AppBlobRegImage(pBlob, &pState->regImage) :
+                     hmc7043AppBuildRegImage(pParams, &pState->regImage)) != OK)
+            return ERROR;
+
+        hmc7043AppParamsCanon(pParams, &hmc7043AppCache.pDevCache[dev]->params);
+        hmc7043AppCache.pDevCache[dev]->regImage = pState->regImage;
+        pCtl->paramsHash  = hmc7043AppParamsHash(pParams);
+        pCtl->imageCached = TRUE;
+    }
+
+    hmc7043ProfEnd(dev, HMC7043_IPH_BUILD_IMAGE);
+
+    pState->paramsHash = pCtl->paramsHash;
+
+    status = hmc7043AppInitAppSup(dev);
+
+    /* wait for the other concurrently initialized devices (if any) */
+    if (pSync) {
+        hmc7043ProfBegin(dev, HMC7043_IPH_SYNC_WAIT);
+        hmc7043StartBarrierWait(pSync->pBarrier);
+        pSync->waited = TRUE;
+        hmc7043ProfEnd(dev, HMC7043_IPH_SYNC_WAIT);
+    }
+
+    if (status != OK || hmc7043AppInitStartUp(dev, pParams) != OK)
+        return ERROR;
+
+    return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AppInitDev
+*
+* - title: initialize a specific CLKDST device
+*
+* - input: dev      - CLKDST device for which to perform the operation
+*          pParams  - device setup parameters
+*          warmInit - if set, will skip actual device initialization
+*          pSync    - start-up synchronization data (NULL if not applicable)
+*          pBlob    - precompiled configuration (NULL if not applicable, else
+*                     pParams must be the blob's parameters, which are then not
+*                     validated again)
+*
+* - output: *hmc7043AppCtl.pDevCtl[dev] (indirectly), *hmc7043AppState.pDevState[dev],
+*           *pSync (indirectly)
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: sets up and initializes the PLL device per the application's
+*                requirements; if the (cold) initialization is repeated with
+*                the same parameters, the parameters are not validated nor
+*                converted to register settings again (the register image
+*                built the previous time being reused)
+*
+* - notes: 1) This routine can be called more than once (for a device).
+*          2) The operation is interlocked via the associated critical section.
+*******************************************************************************/
+STATUS hmc7043AppInitDev(CKDST_DEV dev, const Hmc7043_app_dev_params *pParams,
+		                       Bool warmInit, Hmc7043_start_sync *pSync,
+		                       const Hmc7043_cfg_blob_hdr *pBlob)
+{
+    STATUS status = OK;  /* initial assumption */
+    HMC7043_BUS_PRI pri;
+    Bool cached;
+
+    if (!hmc7043DevPresent(dev) || !pParams) {
+        sysLog("bad argument(s) (dev %d, pParams %d)", dev, pParams != NULL);
+        return ERROR;
+    }
+
+    if (!hmc7043IfCtl.initDone || !hmc7043AppCtl.initDone) {
+        sysLog("interface not initialized yet (dev %d, init. done %d,%d)", dev,
+               hmc7043IfCtl.initDone, hmc7043AppCtl.initDone);
+        return ERROR;
+    }
+
+    hmc7043CsEnter(dev, __FUNCTION__);
+
+    /* in particular this sets .nsecCmdAt, .freq to zeros */
+    memset(hmc7043AppState.pDevState[dev], 0,
+           sizeof(*hmc7043AppState.pDevState[dev]));
+
+    hmc7043AppState.pDevState[dev]->paramsHash = hmc7043AppParamsHash(pParams);
+
+    hmc7043ProfBegin(dev, HMC7043_IPH_SET_UP);
+
+    cached = !warmInit && hmc7043AppCacheHit(dev, pParams);
+
+    if (hmc7043AppSetUpDevCtl(dev, pParams, !pBlob && !cached) != OK)
+        status = ERROR;
+    else
+        hmc7043ProfEnd(dev, HMC7043_IPH_SET_UP);
+
+    if (!warmInit) {
+        if (hmc7043AppInitDevAct(dev, pParams, pSync, pBlob, cached) != OK)
+            status = ERROR;
+    } else {
+        /* only read all the registers back if there is no (matching)
+           persisted register image (a background sweep, as far as the
+           bus goes) */
+        pri = hmc7043CsSetBusPri(dev, HMC7043_BPRI_BACKGROUND);
+
+        hmc7043ProfBegin(dev, HMC7043_IPH_WARM_RESTORE);
+
+        if (hmc7043AppRestoreImage(dev) != OK &&
+            hmc7043AppInitRdRegs(dev) != OK)
+            status = ERROR;
+        else
+            hmc7043ProfEnd(dev, HMC7043_IPH_WARM_RESTORE);
+
+        hmc7043CsSetBusPri(dev, pri);
+    }
+
+    hmc7043CsExit(dev, __FUNCTION__);
+
+    return status;
+}
+
+
+
+
+/*#############################################################################*
+*                    A D D I T I O N A L    S E R V I C E S                    *
+*#############################################################################*/
+/*******************************************************************************
+* - name: hmc7043OutChEnDis
+*
+* - title: Enable/Disable a particular output channel for a particular device.
+*
+* - input: dev      - CLKDST device on which operation is performed.
+*          iCh      - channel to be enabled or disabled.
+*          enable   - True value enables channel, false value disables channel
+*
+* - output: hmc7043AppState.pDevState[dev]->regImage
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above (ref. hmc7043OutChEnDisMask)
+*
+* - notes: the operation is interlocked via the associated critical section
+*******************************************************************************/
+EXPORT STATUS hmc7043OutChEnDis(CKDST_DEV dev, unsigned iCh, Bool enable)
+{
+	if (iCh < HMC7043_CH_OUT_MIN || iCh > HMC7043_CH_OUT_MAX) {
+		hmc7043Log("bad argument(s) (dev %d), iCh %d", dev, iCh);
+		return ERROR;
+	}
+
+	return hmc7043OutChEnDisMask(dev, 1 << iCh, enable ? 1 << iCh : 0);
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043OutChEnDisMask
+*
+* - title: Enable/Disable a set of output channels for a particular device.
+*
+* - input: dev    - CLKDST device on which operation is performed.
+*          chMask - channels to be enabled or disabled.
+*          enMask - channels (out of chMask) to be enabled, the rest of chMask
+*                   being disabled
+*
+* - output: hmc7043AppState.pDevState[dev]->regImage
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: updates the register image and then writes all the affected
+*                registers in a single flush (unless deferred, ref.
+*                hmc7043SetDeferredCommit)
+*
+* - notes: the operation is interlocked via the associated critical section
+*******************************************************************************/
+EXPORT STATUS hmc7043OutChEnDisMask(CKDST_DEV dev, HMC7043_CH_MASK chMask,
+                                    HMC7043_CH_MASK enMask)
+{
+	const Hmc7043_app_dev_ctl *pCtl;
+	Hmc7043_reg_image *pImg;
+	STATUS status;
+	SYS_TIME_NS t0;
+	unsigned ch;
+
+	if (!hmc7043DevPresent(dev) || !chMask ||
+	    chMask >= 1 << HMC7043_OUT_NCHAN || enMask & ~chMask) {
+		hmc7043Log("bad argument(s) (dev %d, chMask 0x%x, enMask 0x%x)", dev,
+		       chMask, enMask);
+		return ERROR;
+	}
+
+	pCtl = hmc7043AppCtl.pDevCtl[dev];
+	pImg = &hmc7043AppState.pDevState[dev]->regImage;
+
+	if(!hmc7043AppDevReady(pCtl)) {
+		hmc7043Log("initialization not done yet (dev %d, init. done %d,%d,%d)",
+		        dev, hmc7043IfCtl.initDone, hmc7043AppCtl.initDone,
+				pCtl->initDone);
+		return ERROR;
+	}
+
+	t0 = sysTimeNsec();
+	hmc7043CsEnter(dev, __FUNCTION__);
+
+	for (ch = 0; ch < HMC7043_OUT_NCHAN; ch++)
+		if (chMask & 1 << ch)
+			hmc7043AppChRegs(pImg, ch)->ctl.fields.chEn =
+					enMask & 1 << ch ? 1 : 0;
+
+	status = hmc7043AppCommitRegs(dev, FALSE);
+
+	hmc7043CsExit(dev, __FUNCTION__);
+
+	hmc7043StatsOp(dev, HMC7043_SOP_OUT_CH_EN_DIS, t0, status);
+
+	return status;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043ChSyncDisMask
+*
+* - title: Disable SYNC on a set of output channels for a particular device.
+*
+* - input: dev    - CLKDST device on which operation is performed.
+*          chMask - channels on which to disable SYNC
+*
+* - output: hmc7043AppState.pDevState[dev]->regImage
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: updates the register image and then writes all the affected
+*                registers in a single flush (unless deferred, ref.
+*                hmc7043SetDeferredCommit)
+*
+* - notes: the operation is interlocked via the associated critical section
+*******************************************************************************/
+EXPORT STATUS hmc7043ChSyncDisMask(CKDST_DEV dev, HMC7043_CH_MASK chMask)
+{
+	const Hmc7043_app_dev_ctl *pCtl;
+	STATUS status;
+	SYS_TIME_NS t0;
+
+	if (!hmc7043DevPresent(dev) || !chMask) {
+		hmc7043Log("bad argument(s) (dev %d, chMask 0x%x)", dev, chMask);
+		return ERROR;
+	}
+
+	pCtl = hmc7043AppCtl.pDevCtl[dev];
+
+	if(!hmc7043AppDevReady(pCtl)) {
+		hmc7043Log("initialization not done yet (dev %d, init. done %d,%d,%d)",
+		        dev, hmc7043IfCtl.initDone, hmc7043AppCtl.initDone,
+				pCtl->initDone);
+		return ERROR;
+	}
+
+	t0 = sysTimeNsec();
+	hmc7043CsEnter(dev, __FUNCTION__);
+
+	status = hmc7043AppChSyncDis(dev, chMask);
+
+	if (status == OK)
+		status = hmc7043AppCommitRegs(dev, FALSE);
+
+	hmc7043CsExit(dev, __FUNCTION__);
+
+	hmc7043StatsOp(dev, HMC7043_SOP_CH_SYNC_DIS, t0, status);
+
+	return status;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AppChDiff
+*
+* - title: find the output channels whose setup parameters differ
+*
+* - input: pOld - pointer to the current device setup parameters
+*          pNew - pointer to the new device setup parameters
+*
+* - output: *pReseedMask - the differing channels that need their divider phase
+*                          (re)aligned, i.e. a reseed
+*
+* - returns: the differing channels
+*
+* - description: a channel needs a reseed if it gets used, or its mode,
+*                frequency (divider), output selection or digital / multislip
+*                delay changes; the rest of its parameters (driver setup,
+*                analog delay) take effect as soon as written
+*
+* - notes: both sets of parameters must be in canonical representation (ref.
+*          hmc7043AppParamsCanon), the channels' ones being compared with memcmp
+*******************************************************************************/
+LOCAL HMC7043_CH_MASK hmc7043AppChDiff(const Hmc7043_app_dev_params *pOld,
+                                       const Hmc7043_app_dev_params *pNew,
+                                       HMC7043_CH_MASK *pReseedMask)
+{
+    HMC7043_CH_MASK chMask = 0;
+    unsigned ch;
+
+    *pReseedMask = 0;
+
+    for (ch = 0; ch < HMC7043_OUT_NCHAN; ++ch) {
+        const Hmc7043_ch_sup *pO = pOld->chSup + ch, *pN = pNew->chSup + ch;
+
+        if (!memcmp(pO, pN, sizeof(*pN)))
+            continue;
+
+        chMask |= 1 << ch;
+
+        if (pN->chMode != HMC7043_CHM_UNUSED &&
+            (pO->chMode != pN->chMode || pO->freq != pN->freq ||
+             pO->outSel != pN->outSel || pO->dDlyPs != pN->dDlyPs ||
+             pO->slipQuantumPs != pN->slipQuantumPs))
+            *pReseedMask |= 1 << ch;
+    }
+
+    return chMask;
+}
+
+/*******************************************************************************
+* - name: hmc7043ReconfigDev
+*
+* - title: change the setup of an initialized device incrementally
+*
+* - input: dev        - CLKDST device on which operation is performed
+*          pNewParams - new application-level device setup parameters
+*
+* - output: *hmc7043AppCtl.pDevCtl[dev], hmc7043AppState.pDevState[dev]->regImage
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: if only output channel parameters differ from the current
+*                ones, rebuilds the register image off-line and takes over only
+*                the register groups of the differing channels (and the analog
+*                delay power mode, which depends on all of them), writes just
+*                the registers that changed, and reseeds only the channels that
+*                need it (ref. hmc7043AppChDiff) - the rest of the outputs
+*                keep running undisturbed. Otherwise (i.e. any of the device
+*                level parameters differs) this falls back to a full (cold)
+*                initialization.
+*
+* - notes: 1) The runtime state of the differing channels (e.g. as set by
+*             hmc7043OutChEnDis or hmc7043ChSyncDisMask) is replaced by their
+*             new setup.
+*          2) Any deferred register image changes are committed as well.
+*          3) The operation is interlocked via the associated critical section.
+*******************************************************************************/
+EXPORT STATUS hmc7043ReconfigDev(CKDST_DEV dev,
+                                 const Hmc7043_app_dev_params *pNewParams)
+{
+    Hmc7043_app_dev_ctl *pCtl;
+    Hmc7043_app_dev_params oldCanon, newCanon;
+    Hmc7043_reg_image newImage, *pImg;
+    HMC7043_CH_MASK chMask, reseedMask;
+    STATUS status = OK;  /* initial assumption */
+    SYS_TIME_NS t0;
+    unsigned ch;
+
+    if (!hmc7043DevPresent(dev) || !pNewParams) {
+        sysLog("bad argument(s) (dev %d, pNewParams %d)", dev,
+               pNewParams != NULL);
+        return ERROR;
+    }
+
+    pCtl = hmc7043AppCtl.pDevCtl[dev];
+
+    if (!hmc7043AppDevReady(pCtl)) {
+        sysLog("initialization not done yet (dev %d, init. done %d,%d,%d)",
+               dev, hmc7043IfCtl.initDone, hmc7043AppCtl.initDone,
+               pCtl->initDone);
+        return ERROR;
+    }
+
+    if (hmc7043AppChkParams(pNewParams) != OK) {
+        sysLog("bad device setup parameters (dev %d)", dev);
+        return ERROR;
+    }
+
+    t0 = sysTimeNsec();
+    hmc7043CsEnter(dev, __FUNCTION__);
+
+    pImg = &hmc7043AppState.pDevState[dev]->regImage;
+
+    /* (compared in canonical representation, the channels' parameters being
+       the last member) */
+    hmc7043AppParamsCanon(&pCtl->params, &oldCanon);
+    hmc7043AppParamsCanon(pNewParams, &newCanon);
+
+    if (memcmp(&oldCanon, &newCanon, offsetof(Hmc7043_app_dev_params, chSup))) {
+        sysLogInfo("device level parameters changed, reinitializing (dev %d)",
+                   dev);
+        hmc7043ProfStart(dev, FALSE);
+        status = hmc7043AppInitDev(dev, pNewParams, FALSE, NULL, NULL);
+        hmc7043ProfFinish(dev, status);
+    } else if ((chMask = hmc7043AppChDiff(&oldCanon, &newCanon,
+                                          &reseedMask)) != 0) {
+        /* take over the differing channels' registers from a new image */
+        status = hmc7043AppBuildRegImage(pNewParams, &newImage);
+
+        if (status == OK) {
+            for (ch = 0; ch < HMC7043_OUT_NCHAN; ++ch) {
+                if (!(chMask & 1 << ch))
+                    continue;
+
+                *hmc7043AppChRegs(pImg, ch) = *hmc7043AppChRegs(&newImage, ch);
+
+                /* (SYNC is left enabled only for those to be reseeded) */
+                if (!(reseedMask & 1 << ch))
+                    hmc7043AppChRegs(pImg, ch)->ctl.fields.syncEn = 0x0;
+            }
+
+            pImg->r65 = newImage.r65;
+
+            pCtl->params = *pNewParams;
+            hmc7043AppState.pDevState[dev]->paramsHash =
+                hmc7043AppParamsHash(pNewParams);
+
+            status = hmc7043AppCommitRegs(dev, TRUE);
+        }
+
+        /* align the new dividers' phases (as in hmc7043AppInitStartUp, but
+           only for the reseeded channels) */
+        if (status == OK && reseedMask &&
+            (hmc7043ToggleBit(dev, HMC7043_REG_IDX_REQ_MOD, HMC7043_RESEED_BIT,
+                              HMC7043_WOP_RESEED) != OK ||
+             hmc7043WaitSysrefPeriod(dev, HMC7043_INIT_WAIT_TIMES) != OK ||
+             hmc7043AppWaitDone(dev, HMC7043_WOP_CKOUT_PHASE) != OK ||
+             hmc7043AppChSyncDis(dev, reseedMask) != OK ||
+             hmc7043AppFlushRegs(dev) != OK))
+            status = ERROR;
+    }
+
+    hmc7043CsExit(dev, __FUNCTION__);
+
+    hmc7043StatsOp(dev, HMC7043_SOP_RECONFIG_DEV, t0, status);
+
+    return status;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043MonPublish
+*
+* - title: publish the alarm / status register snapshot of a device
+*
+* - input: dev  - CLKDST device for which to perform the operation
+*          data - register data (ref. Hmc7043_mon_snap.data)
+*
+* - output: *hmc7043MonCtl.pDevSnap[dev]
+*
+* - description: as above (ref. Hmc7043_mon_snap)
+*
+* - notes: must be called within the associated critical section (which makes
+*          this the only writer)
+*******************************************************************************/
+LOCAL void hmc7043MonPublish(CKDST_DEV dev, UINT32 data)
+{
+    Hmc7043_mon_snap *pSnap = hmc7043MonCtl.pDevSnap[dev];
+
+    UINT32 seq = sysAtomicLoadRelaxed(&pSnap->seq);
+
+    /* (the odd seq being visible before any of the data) */
+    sysAtomicStoreRelaxed(&pSnap->seq, seq + 1);
+    sysAtomicFenceRel();
+    sysAtomicStoreRelaxed(&pSnap->data, data);
+    sysAtomicStoreRelaxed(&pSnap->nsecAt, sysTimeNsec());
+    sysAtomicStoreRel(&pSnap->seq, seq + 2);
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043MonIter
+*
+* - title: background monitor iteration
+*
+* - output: *hmc7043MonCtl.pDevSnap[]
+*
+* - description: reads the alarm / status registers of each of the monitored
+*                devices (that is initialized) in a single burst and publishes
+*                these in the device's snapshot, scrubbing the device image
+*                every scrubPeriod iterations (ref. hmc7043SetRegScrub)
+*
+* - notes: called periodically on the monitor service thread
+*******************************************************************************/
+LOCAL void hmc7043MonIter(void)
+{
+    Bool scrub = hmc7043ShadowCtl.scrubPeriod &&
+                 ++hmc7043ShadowCtl.monIter % hmc7043ShadowCtl.scrubPeriod == 0;
+    CKDST_DEV dev;
+
+    CKDST_FOR_EACH_DEV(dev, hmc7043MonCtl.devMask) {
+        HMC7043_REG regs[HMC7043_MON_NREGS];
+        HMC7043_BUS_PRI pri;
+        UINT32 data = 0;
+        unsigned i;
+
+        if (!hmc7043AppDevReady(hmc7043AppCtl.pDevCtl[dev]))
+            continue;
+
+        hmc7043CsEnter(dev, __FUNCTION__);
+        pri = hmc7043CsSetBusPri(dev, HMC7043_BPRI_BACKGROUND);
+
+        if (hmc7043LliRegReadBurstInCs(dev, HMC7043_MON_REG_INX, regs,
+                                       HMC7043_MON_NREGS) == OK) {
+            for (i = 0; i < HMC7043_MON_NREGS; ++i)
+                data |= (UINT32) regs[i] << 8 * i;
+            data |= HMC7043_MON_DATA_OK;
+        }
+
+        hmc7043MonPublish(dev, data);
+
+        if (scrub)
+            hmc7043AppScrubRegs(dev);
+
+        hmc7043CsSetBusPri(dev, pri);
+        hmc7043CsExit(dev, __FUNCTION__);
+    }
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043MonGetSnap
+*
+* - title: get the latest monitor snapshot of a device
+*
+* - input: dev - CLKDST device for which to perform the operation
+*
+* - output: *pSeq    - number of snapshots published so far
+*           *pData   - register data (ref. Hmc7043_mon_snap.data)
+*           *pNsecAt - when the registers were read
+*
+* - returns: TRUE if a snapshot is available, else FALSE
+*
+* - description: as above, without any locking (ref. Hmc7043_mon_snap)
+*******************************************************************************/
+LOCAL Bool hmc7043MonGetSnap(CKDST_DEV dev, UINT32 *pSeq, UINT32 *pData,
+                             SYS_TIME_NS *pNsecAt)
+{
+    const Hmc7043_mon_snap *pSnap = hmc7043MonCtl.pDevSnap[dev];
+    UINT32 seq;
+
+    if (!(hmc7043MonCtl.devMask & CKDST_DEV_BIT(dev)))
+        return FALSE;
+
+    do {
+        while ((seq = sysAtomicLoadAcq(&pSnap->seq)) & 1)
+            ;
+        *pData   = sysAtomicLoadRelaxed(&pSnap->data);
+        *pNsecAt = sysAtomicLoadRelaxed(&pSnap->nsecAt);
+        /* (the data loads being done before re-checking seq) */
+        sysAtomicFenceAcq();
+    } while (sysAtomicLoadRelaxed(&pSnap->seq) != seq);
+
+    *pSeq = seq / 2;
+
+    return seq != 0;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043StartMonitor
+*
+* - title: start the background alarm monitor
+*
+* - input: devMask - specifies the CLKDST device(s) to be monitored
+*          period  - monitoring period (msec)
+*          thrCode - thread code for the monitor service thread
+*
+* - output: hmc7043MonCtl
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: starts a periodic service thread that reads the alarm / status
+*                registers (0x7b - 0x7d) of the devices in devMask, and
+*                publishes these in snapshots; hmc7043GetAlarm / GetAlarms for
+*                these devices then return the latest snapshot instead of
+*                accessing the device (ref. also hmc7043GetAlarmSnapshot)
+*
+* - notes: 1) To be called at most once (after hmc7043IfInit).
+*          2) Devices are only monitored once initialized, hmc7043GetAlarm(s)
+*             accessing the device until the first snapshot is available.
+*******************************************************************************/
+EXPORT STATUS hmc7043StartMonitor(CKDST_DEV_MASK devMask, SYS_TIME period,
+                                  unsigned thrCode)
+{
+    static const UINT32 STACK_SIZE = 0x10000;  /* more than enough */
+
+    Sys_thread_per_serv_args args = {(FUNCPTR) hmc7043MonIter, STACK_SIZE,
+                                     period, TRUE};
+
+    if (!devMask || devMask & ~hmc7043IfCtl.devMask || !period) {
+        sysLog("bad argument(s) (devMask 0x%08x%08x, period %u)", SL64(devMask),
+               (unsigned) period);
+        return ERROR;
+    }
+
+    if (!hmc7043IfCtl.initDone || hmc7043MonCtl.devMask) {
+        sysLog("interface not initialized yet / already started (init. done %d, "
+               "devMask 0x%08x%08x)", hmc7043IfCtl.initDone,
+               SL64(hmc7043MonCtl.devMask));
+        return ERROR;
+    }
+
+    hmc7043MonCtl.devMask = devMask;
+
+    if (sysThreadCreatePerServ(thrCode, 0, &args) != OK) {
+        sysLog("monitor thread creation failed (thrCode %u)", thrCode);
+        hmc7043MonCtl.devMask = 0;
+        return ERROR;
+    }
+
+    sysAtomicStoreRel(&hmc7043IfCtl.bgStarted, TRUE);
+
+    return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043GetAlarmSnapshot
+*
+* - title: get the latest background monitor snapshot of a device
+*
+* - input: dev   - CLKDST device for which to perform the operation
+*
+* - output: *pSnap
+*
+* - returns: OK or ERROR if detected an error (including no snapshot being
+*            available yet, or the latest monitor read having failed)
+*
+* - description: as above (without accessing the device nor locking)
+*******************************************************************************/
+EXPORT STATUS hmc7043GetAlarmSnapshot(CKDST_DEV dev,
+                                      Hmc7043_alarm_snapshot *pSnap)
+{
+    Hmc7043_reg_x007b r7b;
+    Hmc7043_reg_x007d r7d;
+    UINT32 data;
+
+    if (!hmc7043DevPresent(dev) || !pSnap) {
+        hmc7043Log("bad argument(s) (dev %d, pSnap %d)", dev, pSnap != NULL);
+        return ERROR;
+    }
+
+    if (!hmc7043MonGetSnap(dev, &pSnap->seq, &data, &pSnap->nsecAt) ||
+        !(data & HMC7043_MON_DATA_OK))
+        return ERROR;
+
+    r7b.all = data;
+    r7d.all = data >> 8 * (0x7d - HMC7043_MON_REG_INX);
+
+    pSnap->alarm           = r7b.fields.almSig;
+    pSnap->alarms.srefSync = r7d.fields.srSynSt;
+    pSnap->alarms.cksPhase = r7d.fields.ckOutPhSt;
+    pSnap->alarms.syncReq  = r7d.fields.synReqSt;
+
+    return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043SetAlarmHandler
+*
+* - title: register the alarm notification handler of a device
+*
+* - input: dev      - CLKDST device for which to perform the operation
+*          pHandler - handler to be called (NULL to deregister)
+*          arg      - argument to be passed to the handler
+*
+* - output: *hmc7043AlarmCtl.pDevCtl[dev]
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: the handler is called (by hmc7043AlarmEdge) on each edge of
+*                the device's GPO pin, which must be set up to signal alarms
+*                (HMC7043_GPOS_ALARM)
+*
+* - notes: 1) To be registered before the edge notification is enabled (ref.
+*             hmc7043AttachAlarmGpio).
+*          2) The handler and arg are set under the device critical section,
+*             from which hmc7043AlarmEdge picks them up, so that a handler is
+*             always passed its own arg.
+*******************************************************************************/
+EXPORT STATUS hmc7043SetAlarmHandler(CKDST_DEV dev,
+                                     HMC7043_ALARM_HANDLER *pHandler,
+                                     UINT64 arg)
+{
+	const Hmc7043_app_dev_ctl *pCtl;
+
+	if (!hmc7043DevPresent(dev)) {
+		sysLog("bad argument (dev %d)", dev);
+		return ERROR;
+	}
+
+	pCtl = hmc7043AppCtl.pDevCtl[dev];
+
+	if (pHandler && (!pCtl->initDone ||
+	                 pCtl->params.gpoSup != HMC7043_GPOS_ALARM)) {
+		sysLog("GPO not set up to signal alarms (dev %d, init. done %d, "
+		       "gpoSup %d)", dev, pCtl->initDone, pCtl->params.gpoSup);
+		return ERROR;
+	}
+
+	if (hmc7043CsEnter(dev, __FUNCTION__) != OK)
+		return ERROR;
+
+	hmc7043AlarmCtl.pDevCtl[dev]->arg      = arg;
+	hmc7043AlarmCtl.pDevCtl[dev]->pHandler = pHandler;
+
+	hmc7043CsExit(dev, __FUNCTION__);
+
+	return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AlarmEdge
+*
+* - title: handle an edge of the alarm (GPO) pin of a device
+*
+* - input: dev - CLKDST device for which to perform the operation
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: reads the alarm / status registers in a single burst, also
+*                publishing these as the monitor snapshot (ref.
+*                hmc7043GetAlarmSnapshot), and calls the registered handler
+*                (if any) with the decoded alarms
+*
+* - notes: 1) To be called by the board layer on each edge of the pin (in a
+*             thread context, as this accesses the device), unless using
+*             hmc7043AttachAlarmGpio.
+*          2) The handler is called outside the device critical section, so
+*             may call any of the services here.
+*******************************************************************************/
+EXPORT STATUS hmc7043AlarmEdge(CKDST_DEV dev)
+{
+	HMC7043_ALARM_HANDLER *pHandler;
+	UINT64 arg;
+	HMC7043_REG regs[HMC7043_MON_NREGS];
+	Hmc7043_dev_alarms alarms;
+	Hmc7043_reg_x007b r7b;
+	Hmc7043_reg_x007d r7d;
+	UINT32 data = 0;
+	STATUS status;
+	unsigned i;
+
+	if (!hmc7043DevPresent(dev)) {
+		hmc7043Log("bad argument (dev %d)", dev);
+		return ERROR;
+	}
+
+	if (!hmc7043AppDevReady(hmc7043AppCtl.pDevCtl[dev])) {
+		hmc7043Log("initialization not done yet (dev %d)", dev);
+		return ERROR;
+	}
+
+	hmc7043CsEnter(dev, __FUNCTION__);
+
+	status = hmc7043LliRegReadBurstInCs(dev, HMC7043_MON_REG_INX, regs,
+	                                    HMC7043_MON_NREGS);
+
+	if (status == OK) {
+		for (i = 0; i < HMC7043_MON_NREGS; ++i)
+			data |= (UINT32) regs[i] << 8 * i;
+		data |= HMC7043_MON_DATA_OK;
+	}
+
+	if (hmc7043MonCtl.devMask & CKDST_DEV_BIT(dev))
+		hmc7043MonPublish(dev, data);
+
+	pHandler = hmc7043AlarmCtl.pDevCtl[dev]->pHandler;
+	arg      = hmc7043AlarmCtl.pDevCtl[dev]->arg;
+
+	hmc7043CsExit(dev, __FUNCTION__);
+
+	if (status != OK)
+		return ERROR;
+
+	/* notify */
+	r7b.all = regs[0];
+	r7d.all = regs[0x7d - HMC7043_MON_REG_INX];
+
+	alarms.srefSync = r7d.fields.srSynSt;
+	alarms.cksPhase = r7d.fields.ckOutPhSt;
+	alarms.syncReq  = r7d.fields.synReqSt;
+
+	if (pHandler)
+		pHandler(dev, r7b.fields.almSig, &alarms, arg);
+
+	return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AlarmGpioThread
+*
+* - title: alarm (GPO) pin edge waiting thread
+*
+* - input: pArgs->arg1 - CLKDST device
+*          pArgs->arg2 - file descriptor of the pin's sysfs value attribute
+*          pArgs->arg3 - file descriptor of the stop pipe's read end
+*
+* - returns: OK if stopped (ref. hmc7043DetachAlarmGpio), else ERROR (if the
+*            pin can no longer be waited for)
+*
+* - description: waits for the edges of the pin (as set up in the pin's sysfs
+*                edge attribute) and handles each (ref. hmc7043AlarmEdge),
+*                until the stop pipe becomes readable
+*
+* - notes: the stop pipe is left to hmc7043DetachAlarmGpio to close
+*******************************************************************************/
+LOCAL UINT64 hmc7043AlarmGpioThread(const Sys_thread_args *pArgs)
+{
+	CKDST_DEV dev = (CKDST_DEV) pArgs->arg1;
+	struct pollfd pfds[2] = {
+		{(int) pArgs->arg2, POLLPRI | POLLERR, 0},
+		{(int) pArgs->arg3, POLLIN, 0}
+	};
+	STATUS status = ERROR;  /* initial assumption */
+	char value[4];
+
+	FOREVER {
+		/* (reading the value re-arms the edge detection) */
+		if (lseek(pfds[0].fd, 0, SEEK_SET) < 0 ||
+		    read(pfds[0].fd, value, sizeof(value)) < 0 ||
+		    poll(pfds, NELEMENTS(pfds), -1) < 0) {
+			hmc7043Log("GPIO wait failed (dev %d)", dev);
+			break;
+		}
+
+		if (pfds[1].revents) {
+			status = OK;
+			break;
+		}
+
+		hmc7043AlarmEdge(dev);
+	}
+
+	close(pfds[0].fd);
+
+	return (UINT64) status;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AttachAlarmGpio
+*
+* - title: handle the edges of the alarm (GPO) pin of a device via sysfs
+*
+* - input: dev       - CLKDST device for which to perform the operation
+*          valuePath - path of the pin's sysfs value attribute (e.g.
+*                      /sys/class/gpio/gpio<n>/value)
+*          thrCode   - thread code for the waiting thread (with the device as
+*                      the subcode)
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: starts a thread that calls hmc7043AlarmEdge on each edge of
+*                the pin, i.e. without any SPI access while there are no alarms
+*
+* - notes: 1) The pin must already be exported, as an input with its edge
+*             attribute set (normally "rising").
+*          2) Not to be called concurrently with hmc7043DetachAlarmGpio for
+*             the same device.
+*******************************************************************************/
+EXPORT STATUS hmc7043AttachAlarmGpio(CKDST_DEV dev, const char *valuePath,
+                                     unsigned thrCode)
+{
+	static const UINT32 STACK_SIZE = 0x10000;  /* more than enough */
+
+	Sys_thread_args args = {dev, 0, 0};
+	int fd, *stopFds;
+
+	if (!hmc7043DevPresent(dev) || !valuePath) {
+		sysLog("bad argument(s) (dev %d, valuePath %d)", dev,
+		       valuePath != NULL);
+		return ERROR;
+	}
+
+	if (hmc7043AlarmCtl.pDevCtl[dev]->gpioAttached) {
+		sysLog("already attached (dev %d)", dev);
+		return ERROR;
+	}
+
+	stopFds = hmc7043AlarmCtl.pDevCtl[dev]->stopFds;
+
+	if ((fd = open(valuePath, O_RDONLY)) < 0) {
+		sysLogLong("open failed (dev %ld, valuePath %s)", (long) dev,
+		           valuePath);
+		return ERROR;
+	}
+
+	if (pipe(stopFds) < 0) {
+		sysLog("stop pipe creation failed (dev %d)", dev);
+		close(fd);
+		return ERROR;
+	}
+
+	args.arg2 = (UINT64) fd;
+	args.arg3 = (UINT64) stopFds[0];
+
+	if (sysThreadCreateEx(thrCode, dev, hmc7043AlarmGpioThread, STACK_SIZE,
+	                      &args, SYS_THREAD_OPTS_WAITABLE) != OK) {
+		sysLog("GPIO thread creation failed (dev %d)", dev);
+		close(fd);
+		close(stopFds[0]);
+		close(stopFds[1]);
+		return ERROR;
+	}
+
+	hmc7043AlarmCtl.pDevCtl[dev]->gpioThrCode  = thrCode;
+	hmc7043AlarmCtl.pDevCtl[dev]->gpioAttached = TRUE;
+	sysAtomicStoreRel(&hmc7043IfCtl.bgStarted, TRUE);
+
+	return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043DetachAlarmGpio
+*
+* - title: stop handling the edges of the alarm (GPO) pin of a device via sysfs
+*
+* - input: dev - CLKDST device for which to perform the operation
+*
+* - returns: OK or ERROR if detected an error (including if the waiting thread
+*            had already failed)
+*
+* - description: signals the thread started by hmc7043AttachAlarmGpio to stop,
+*                and waits for it to exit (i.e. once this returns, no more
+*                edges are handled)
+*
+* - notes: 1) Not to be called from the alarm handler (which runs on that
+*             thread), nor concurrently with hmc7043AttachAlarmGpio for the
+*             same device.
+*          2) The pin may then be attached again.
+*******************************************************************************/
+EXPORT STATUS hmc7043DetachAlarmGpio(CKDST_DEV dev)
+{
+	const UINT8 stop = 0;
+	UINT64 exitCode = (UINT64) ERROR;
+	int *stopFds;
+	STATUS status = OK;  /* initial assumption */
+
+	if (!hmc7043DevPresent(dev)) {
+		sysLog("bad argument (dev %d)", dev);
+		return ERROR;
+	}
+
+	if (!hmc7043AlarmCtl.pDevCtl[dev]->gpioAttached) {
+		sysLog("not attached (dev %d)", dev);
+		return ERROR;
+	}
+
+	stopFds = hmc7043AlarmCtl.pDevCtl[dev]->stopFds;
+
+	/* (the read end is only closed here, so the write cannot fail on that) */
+	if (write(stopFds[1], &stop, sizeof(stop)) != sizeof(stop) ||
+	    sysThreadWait4Exit(hmc7043AlarmCtl.pDevCtl[dev]->gpioThrCode, dev,
+	                       SYS_TIME_INFINITE, &exitCode) != OK) {
+		sysLog("GPIO thread stop failed (dev %d)", dev);
+		return ERROR;
+	}
+
+	if ((STATUS) exitCode != OK) {
+		sysLog("GPIO thread had failed (dev %d)", dev);
+		status = ERROR;
+	}
+
+	close(stopFds[0]);
+	close(stopFds[1]);
+	hmc7043AlarmCtl.pDevCtl[dev]->gpioAttached = FALSE;
+
+	return status;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043GetAlarms
+*
+* - title: Retrieve all alarm status from alarm read back register 0x7d
+*
+* - input: dev      - CLKDST device on which operation is performed.
+*          pAlarms  - out parameter that has all alarm status
+*
+* - output: *pAlarms
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above.
+*******************************************************************************/
+EXPORT STATUS hmc7043GetAlarms(CKDST_DEV dev, Hmc7043_dev_alarms *pAlarms)
+{
+	const Hmc7043_app_dev_ctl *pCtl;
+	Hmc7043_alarm_snapshot snap;
+	Hmc7043_reg_x007d r7d;
+
+
+	if (!hmc7043DevPresent(dev) ||
+			!pAlarms) {
+		hmc7043Log("bad argument(s) (dev %d), pAlarms %d", dev, (pAlarms != NULL));
+		return ERROR;
+	}
+
+	pCtl = hmc7043AppCtl.pDevCtl[dev];
+
+	if(!hmc7043AppDevReady(pCtl)) {
+		hmc7043Log("initialization not done yet (dev %d, init. done %d,%d,%d)",
+				dev, hmc7043IfCtl.initDone, hmc7043AppCtl.initDone,
+				pCtl->initDone);
+		return ERROR;
+	}
+
+	/* take the background monitor snapshot if available */
+	if (hmc7043GetAlarmSnapshot(dev, &snap) == OK) {
+		*pAlarms = snap.alarms;
+		return OK;
+	}
+
+	if (hmc7043LliRegRead(dev, 0x7d, &r7d.all) != OK)
+	    return ERROR;
+
+	if(r7d.fields.srSynSt)
+	    pAlarms->srefSync = TRUE;
+	else
+		pAlarms->srefSync = FALSE;
+
+	if(r7d.fields.ckOutPhSt)
+		pAlarms->cksPhase = TRUE;
+	else
+		pAlarms->cksPhase = FALSE;
+
+	if(r7d.fields.synReqSt)
+	    pAlarms->syncReq = TRUE;
+	else
+		pAlarms->syncReq = FALSE;
+
+    return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043GetAlarm
+*
+* - title: Get alarm status for a particular device.
+*
+* - input: dev   - CLKDST device on which operation is performed.
+*          pAlarm - out parameter having alarm status written.
+*
+* - output: *pAlarm
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above
+*******************************************************************************/
+EXPORT STATUS hmc7043GetAlarm(CKDST_DEV dev, Bool *pAlarm)
+{
+	const Hmc7043_app_dev_ctl *pCtl;
+	Hmc7043_alarm_snapshot snap;
+	Hmc7043_reg_x007b r7b;
+
+
+	if (!hmc7043DevPresent(dev) ||
+			!pAlarm) {
+		hmc7043Log("bad argument(s) (dev %d), pAlarm %d", dev, (pAlarm != NULL));
+		return ERROR;
+	}
+
+	pCtl = hmc7043AppCtl.pDevCtl[dev];
+
+	if(!hmc7043AppDevReady(pCtl)) {
+		hmc7043Log("initialization not done yet (dev %d, init. done %d,%d,%d)",
+				dev, hmc7043IfCtl.initDone, hmc7043AppCtl.initDone,
+				pCtl->initDone);
+		return ERROR;
+	}
+
+	/* take the background monitor snapshot if available */
+	if (hmc7043GetAlarmSnapshot(dev, &snap) == OK) {
+		*pAlarm = snap.alarm;
+		return OK;
+	}
+
+	if (hmc7043LliRegRead(dev, 0x7b, &r7b.all) != OK)
+		return ERROR;
+
+	if(r7b.fields.almSig)
+	    *pAlarm = TRUE;
+	else
+		*pAlarm = FALSE;
+
+    return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AppGetStatus
+*
+* - title: read and decode the status registers of a device
+*
+* - input: dev - CLKDST device for which to perform the operation
+*
+* - output: *pSnap
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: reads all the readback / status registers in a single burst
+*                and decodes these, stamping the snapshot with the time the
+*                burst completed
+*
+* - notes: must be called within the associated critical section
+*******************************************************************************/
+LOCAL STATUS hmc7043AppGetStatus(CKDST_DEV dev, Hmc7043_status_snapshot *pSnap)
+{
+    const HMC7043_REG *pRegs = pSnap->regs;
+    Hmc7043_reg_x007b r7b;
+    Hmc7043_reg_x007d r7d;
+    Hmc7043_reg_x0091 r91;
+
+#   define SNAP_REG(reg)  pRegs[0x##reg - HMC7043_STATUS_REG_INX]
+
+    if (hmc7043LliRegReadBurstInCs(dev, HMC7043_STATUS_REG_INX, pSnap->regs,
+                                   HMC7043_STATUS_NREGS) != OK)
+        return ERROR;
+
+    pSnap->nsecAt = sysTimeNsec();
+    pSnap->prodId = SNAP_REG(78) | SNAP_REG(79) << 8 | SNAP_REG(7a) << 16;
+
+    r7b.all = SNAP_REG(7b);
+    r7d.all = SNAP_REG(7d);
+    r91.all = SNAP_REG(91);
+
+#   undef SNAP_REG
+
+    pSnap->alarm           = r7b.fields.almSig;
+    pSnap->alarms.srefSync = r7d.fields.srSynSt;
+    pSnap->alarms.cksPhase = r7d.fields.ckOutPhSt;
+    pSnap->alarms.syncReq  = r7d.fields.synReqSt;
+    pSnap->srefFsmState    = r91.fields.srFsmSt;
+    pSnap->chOutFsmBusy    = r91.fields.chOutFsmBusy;
+
+    return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043GetStatusSnapshot
+*
+* - title: get a coherent snapshot of the status of a device
+*
+* - input: dev - CLKDST device for which to perform the operation
+*
+* - output: *pSnap
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above (ref. hmc7043AppGetStatus), i.e. a single register
+*                transfer, rather than one per hmc7043GetAlarm / GetAlarms
+*
+* - notes: the operation is interlocked via the associated critical section
+*******************************************************************************/
+EXPORT STATUS hmc7043GetStatusSnapshot(CKDST_DEV dev,
+                                       Hmc7043_status_snapshot *pSnap)
+{
+    const Hmc7043_app_dev_ctl *pCtl;
+    STATUS status;
+
+    if (!hmc7043DevPresent(dev) || !pSnap) {
+        hmc7043Log("bad argument(s) (dev %d, pSnap %d)", dev, pSnap != NULL);
+        return ERROR;
+    }
+
+    pCtl = hmc7043AppCtl.pDevCtl[dev];
+
+    if (!hmc7043AppDevReady(pCtl)) {
+        hmc7043Log("initialization not done yet (dev %d, init. done %d,%d,%d)",
+                   dev, hmc7043IfCtl.initDone, hmc7043AppCtl.initDone,
+                   pCtl->initDone);
+        return ERROR;
+    }
+
+    hmc7043CsEnter(dev, __FUNCTION__);
+
+    status = hmc7043AppGetStatus(dev, pSnap);
+
+    hmc7043CsExit(dev, __FUNCTION__);
+
+    return status;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043GetStatusSnapshotMulti
+*
+* - title: get status snapshots of multiple devices
+*
+* - input: devMask - specifies the CLKDST devices
+*
+* - output: snaps[] - one entry per device in devMask, in device order (the
+*                     entries of devices whose read failed having nsecAt 0)
+*
+* - returns: OK or ERROR if detected an error (for any of the devices)
+*
+* - description: as hmc7043GetStatusSnapshot for each of the devices, back to
+*                back (taking one critical section at a time)
+*******************************************************************************/
+EXPORT STATUS hmc7043GetStatusSnapshotMulti(CKDST_DEV_MASK devMask,
+                                            Hmc7043_status_snapshot snaps[])
+{
+    Hmc7043_status_snapshot *pSnap = snaps;
+    STATUS status = OK;
+    CKDST_DEV dev;
+
+    if (!devMask || devMask & ~hmc7043IfCtl.devMask || !snaps) {
+        hmc7043Log("bad argument(s) (devMask 0x%08x%08x, snaps %d)",
+                   SL64(devMask), snaps != NULL);
+        return ERROR;
+    }
+
+    CKDST_FOR_EACH_DEV(dev, devMask) {
+        if (!hmc7043AppDevReady(hmc7043AppCtl.pDevCtl[dev])) {
+            hmc7043Log("initialization not done yet (dev %d)", dev);
+            return ERROR;
+        }
+    }
+
+    CKDST_FOR_EACH_DEV(dev, devMask) {
+        hmc7043CsEnter(dev, __FUNCTION__);
+
+        if (hmc7043AppGetStatus(dev, pSnap) != OK) {
+            pSnap->nsecAt = 0;
+            status = ERROR;
+        }
+
+        hmc7043CsExit(dev, __FUNCTION__);
+
+        ++pSnap;
+    }
+
+    return status;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043ClearAlarms
+*
+* - title: Clear alarms for a particular device.
+*
+* - input: dev   - CLKDST device on which operation is performed.
+*
+* - output: hmc7043AppState.pDevState[dev]->regImage,
+*           *hmc7043MonCtl.pDevSnap[dev] (if monitored)
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above, re-reading the alarm / status registers into the
+*                monitor snapshot (if monitored, ref. hmc7043StartMonitor)
+*
+* - notes: the operation is interlocked via the associated critical section
+*******************************************************************************/
+EXPORT STATUS hmc7043ClearAlarms(CKDST_DEV dev)
+{
+	const Hmc7043_app_dev_ctl *pCtl;
+	Hmc7043_reg_image *pImg;
+	STATUS status = OK;
+	SYS_TIME_NS t0;
+
+	if (!hmc7043DevPresent(dev)) {
+		hmc7043Log("bad argument(s) (dev %d)", dev);
+		return ERROR;
+	}
+
+	pCtl = hmc7043AppCtl.pDevCtl[dev];
+	pImg = &hmc7043AppState.pDevState[dev]->regImage;
+
+	if(!hmc7043AppDevReady(pCtl)) {
+		hmc7043Log("initialization not done yet (dev %d, init. done %d,%d,%d)",
+				dev, hmc7043IfCtl.initDone, hmc7043AppCtl.initDone,
+				pCtl->initDone);
+		return ERROR;
+	}
+
+	t0 = sysTimeNsec();
+	hmc7043CsEnter(dev, __FUNCTION__);
+
+	/* the write must take place even if the bit is already set in the image */
+	pImg->r06.fields.clrAlarms = 1;
+	status = hmc7043AppRegForceWr(dev, 0x06);
+	if (status == OK)
+		status = hmc7043AppCommitRegs(dev, TRUE);
+
+	/* refresh the monitor snapshot, for hmc7043GetAlarm(s) not to report the
+	   cleared alarms until the next monitor iteration */
+	if (status == OK && hmc7043MonCtl.devMask & CKDST_DEV_BIT(dev)) {
+		HMC7043_REG regs[HMC7043_MON_NREGS];
+		UINT32 data = 0;
+		unsigned i;
+
+		status = hmc7043LliRegReadBurstInCs(dev, HMC7043_MON_REG_INX, regs,
+		                                    HMC7043_MON_NREGS);
+
+		if (status == OK) {
+			for (i = 0; i < HMC7043_MON_NREGS; ++i)
+				data |= (UINT32) regs[i] << 8 * i;
+			data |= HMC7043_MON_DATA_OK;
+		}
+
+		hmc7043MonPublish(dev, data);
+	}
+
+	hmc7043CsExit(dev, __FUNCTION__);
+
+	hmc7043StatsOp(dev, HMC7043_SOP_CLEAR_ALARMS, t0, status);
+
+    return status;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043SetSysrefMode
+*
+* - title: Set SYSREF pulse generation mode for a particular device.
+*
+* - input: dev     - CLKDST device on which operation is performed.
+*          mode    - Type of pulse generator mode
+*          nPulses - Number of pulses to be generated in case of pulsed mode
+*
+* - output: hmc7043AppState.pDevState[dev]->regImage
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above
+*
+* - notes: the operation is interlocked via the associated critical section
+*******************************************************************************/
+EXPORT STATUS hmc7043SetSysrefMode(CKDST_DEV dev, HMC7043_SREF_MODE mode,
+                            HMC7043_SREF_NPULSES nPulses)
+{
+	const Hmc7043_app_dev_ctl *pCtl;
+	Hmc7043_reg_image *pImg;
+	HMC7043_BUS_PRI pri;
+	STATUS status = OK;
+	SYS_TIME_NS t0;
+
+	if (!hmc7043DevPresent(dev)) {
+		hmc7043Log("bad argument(s) (dev %d)", dev);
+		return ERROR;
+	}
+
+	pCtl = hmc7043AppCtl.pDevCtl[dev];
+	pImg = &hmc7043AppState.pDevState[dev]->regImage;
+
+	if(!hmc7043AppDevReady(pCtl)) {
+		hmc7043Log("initialization not done yet (dev %d, init. done %d,%d,%d)",
+				dev, hmc7043IfCtl.initDone, hmc7043AppCtl.initDone,
+				pCtl->initDone);
+		return ERROR;
+	}
+
+	t0 = sysTimeNsec();
+	hmc7043CsEnter(dev, __FUNCTION__);
+	pri = hmc7043CsSetBusPri(dev, HMC7043_BPRI_URGENT);
+	/* Set pulse generation mode */
+	switch(mode)
+	{
+		case HMC7043_SRM_CONTINUOUS: {
+			pImg->r5a.fields.pulseMode = 0x7;
+			break;
+		}
+		case HMC7043_SRM_LEVEL_CTL: {
+			pImg->r5a.fields.pulseMode = 0x0;
+			break;
+		}
+		case HMC7043_SRM_PULSED: {
+			switch(nPulses)
+			{
+				case HMC7043_SRNP_1: {
+					pImg->r5a.fields.pulseMode = 0x1;
+					break;
+				}
+				case HMC7043_SRNP_2: {
+					pImg->r5a.fields.pulseMode = 0x2;
+					break;
+				}
+				case HMC7043_SRNP_4: {
+					pImg->r5a.fields.pulseMode = 0x3;
+					break;
+				}
+				case HMC7043_SRNP_8: {
+					pImg->r5a.fields.pulseMode = 0x4;
+					break;
+				}
+				case HMC7043_SRNP_16: {
+					pImg->r5a.fields.pulseMode = 0x5;
+					break;
+				}
+				default: {
+					hmc7043Log("Bad value ( pParams->sysref.nPulses %d)",nPulses);
+					status = ERROR;
+					break;
+				}
+			}
+			break;
+		}
+		default:
+			hmc7043Log("Bad value ( pParams->sysref.mode %d)", mode);
+			status = ERROR;
+	}
+	if (status == OK)
+		status = hmc7043AppCommitRegs(dev, FALSE);
+
+	hmc7043CsSetBusPri(dev, pri);
+	hmc7043CsExit(dev, __FUNCTION__);
+
+	hmc7043StatsOp(dev, HMC7043_SOP_SET_SYSREF_MODE, t0, status);
+
+    return status;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043AppSlip
+*
+* - title: slip a set of output channels
+*
+* - input: dev    - CLKDST device for which to perform the operation
+*          chMask - output channels to slip
+*          nSlips - number of CLKIN cycles to slip (1 for a single slip, else
+*                   a multislip)
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: the slip request being global, arms just the channels in
+*                chMask (for a single slip or multislip, as requested) and
+*                disarms the rest, issues the request, and then restores the
+*                channels' slip setup (i.e. as per their parameters) - only
+*                the control registers that actually change being written
+*
+* - notes: must be called within the associated critical section
+*******************************************************************************/
+LOCAL STATUS hmc7043AppSlip(CKDST_DEV dev, HMC7043_CH_MASK chMask,
+                            unsigned nSlips)
+{
+    Hmc7043_ch_regs saved[HMC7043_OUT_NCHAN], *pChRegs;
+    Hmc7043_reg_image *pImg;
+    unsigned ch, msDelay;
+    STATUS status = OK;
+
+    if (!hmc7043DevPresent(dev) || !chMask ||
+        chMask >= 1 << HMC7043_OUT_NCHAN || !inEnumRange(nSlips - 1,
+                                                         HMC7043_MSLIP_MAX)) {
+        hmc7043Log("bad argument(s) (dev %d, chMask 0x%x, nSlips %u)", dev,
+                   chMask, nSlips);
+        return ERROR;
+    }
+
+    pImg = &hmc7043AppState.pDevState[dev]->regImage;
+
+    for (ch = 0; ch < HMC7043_OUT_NCHAN; ++ch) {
+        pChRegs = hmc7043AppChRegs(pImg, ch);
+        saved[ch] = *pChRegs;
+
+        pChRegs->ctl.fields.slipEn    = chMask & 1 << ch && nSlips == 1;
+        pChRegs->ctl.fields.multSlpEn = chMask & 1 << ch && nSlips > 1;
+
+        if (chMask & 1 << ch && nSlips > 1) {
+            /* (offset by half the divider, as set up per slipQuantumPs) */
+            msDelay = nSlips + (pChRegs->divLsb.fields.chDivLsb |
+                                pChRegs->divMsb.fields.chDivMsb << 8) / 2;
+            if (msDelay > HMC7043_MSLIP_MAX) {
+                hmc7043Log("multislip delay out of range (dev %d, ch %u, "
+                           "nSlips %u)", dev, ch, nSlips);
+                status = ERROR;
+            }
+            pChRegs->msDelayLsb.fields.msDelayLsb = HMC7043_LSB_BIT_VAL(msDelay);
+            pChRegs->msDelayMsb.fields.msDelayMsb = HMC7043_MSB_BIT_VAL(msDelay);
+        }
+    }
+
+    /* (any deferred changes being committed as well) */
+    if (status == OK)
+        status = hmc7043AppCommitRegs(dev, TRUE);
+
+    if (status == OK)
+        status = hmc7043ToggleBit(dev, HMC7043_REG_IDX_SLIP_REQ,
+                                  HMC7043_SLIP_REQ_BIT, HMC7043_WOP_SLIP);
+
+    for (ch = 0; ch < HMC7043_OUT_NCHAN; ++ch)
+        *hmc7043AppChRegs(pImg, ch) = saved[ch];
+
+    if (hmc7043AppFlushRegs(dev) != OK)
+        status = ERROR;
+
+    return status;
+}
+
+/*******************************************************************************
+* - name: hmc7043ChDoSlip
+*
+* - title: Generate slip event for a particular device.
+*
+* - input: dev     - CLKDST device on which operation is performed.
+*          chMask  - channel mask (only these channels being slipped)
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above (a single CLKIN cycle slip, ref. hmc7043AppSlip)
+*
+* - notes: the operation is interlocked via the associated critical section
+*******************************************************************************/
+EXPORT STATUS hmc7043ChDoSlip(CKDST_DEV dev, HMC7043_CH_MASK chMask)
+{
+	return hmc7043ChMultiSlip(dev, chMask, 1);
+}
+
+/*******************************************************************************
+* - name: hmc7043ChMultiSlip
+*
+* - title: slip a set of output channels by a number of CLKIN cycles
+*
+* - input: dev     - CLKDST device on which operation is performed
+*          chMask  - channel mask (only these channels being slipped)
+*          nSlips  - number of CLKIN cycles to slip (1 .. HMC7043_MSLIP_MAX)
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above (ref. hmc7043AppSlip), using the multislip delay for
+*                more than a single cycle
+*
+* - notes: the operation is interlocked via the associated critical section
+*******************************************************************************/
+EXPORT STATUS hmc7043ChMultiSlip(CKDST_DEV dev, HMC7043_CH_MASK chMask,
+                                 unsigned nSlips)
+{
+	const Hmc7043_app_dev_ctl *pCtl;
+	HMC7043_BUS_PRI pri;
+	STATUS status = OK;
+	SYS_TIME_NS t0;
+
+	if (!hmc7043DevPresent(dev)) {
+		hmc7043Log("bad argument(s) (dev %d)", dev);
+		return ERROR;
+	}
+
+	pCtl = hmc7043AppCtl.pDevCtl[dev];
+
+	if (!chMask || chMask >= 1 << NELEMENTS(pCtl->params.chSup) ||
+	    !inEnumRange(nSlips - 1, HMC7043_MSLIP_MAX)) {
+		hmc7043Log("bad argument(s) (chMask 0x%x, nSlips %u)", chMask, nSlips);
+		return ERROR;
+	}
+
+	if(!hmc7043AppDevReady(pCtl)) {
+		hmc7043Log("initialization not done yet (dev %d, init. done %d,%d,%d)",
+				dev, hmc7043IfCtl.initDone, hmc7043AppCtl.initDone,
+				pCtl->initDone);
+		return ERROR;
+	}
+
+	t0 = sysTimeNsec();
+	hmc7043CsEnter(dev, __FUNCTION__);
+	pri = hmc7043CsSetBusPri(dev, HMC7043_BPRI_URGENT);
+
+	status = hmc7043AppSlip(dev, chMask, nSlips);
+
+	hmc7043CsSetBusPri(dev, pri);
+	hmc7043CsExit(dev, __FUNCTION__);
+
+	hmc7043StatsOp(dev, HMC7043_SOP_CH_DO_SLIP, t0, status);
+
+	return status;
+}
+
+/*******************************************************************************
+* - name: hmc7043ChSetDelay
+*
+* - title: set the analog and digital delays of a set of output channels
+*
+* - input: dev     - CLKDST device on which operation is performed
+*          chMask  - output channels to set up (must be used ones)
+*          aDlyPs  - fine analog delay (a multiple of HMC7043_ADLY_STEP_SIZE up
+*                    to HMC7043_FADLY_MAX_STEPS steps)
+*          dDlyPs  - coarse digital delay (a multiple of half a CLKIN period up
+*                    to HMC7043_DDLY_MAX_STEPS steps)
+*
+* - output: hmc7043AppState.pDevState[dev]->regImage,
+*           hmc7043AppCtl.pDevCtl[dev]->params.chSup[]
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: only updates the channels' fine / coarse delay registers (and
+*                the analog delay power mode), the steps having been derived
+*                from the clock plan once by hmc7043AppSetUpDevCtl (ref.
+*                hmc7043AppTimingInit), and writes all of these in a single
+*                flush (unless deferred, ref. hmc7043SetDeferredCommit); the
+*                delays are recorded in the channels' parameters (ref.
+*                hmc7043ReconfigDev)
+*
+* - notes: 1) The analog delay only applies to channels with outSel
+*             HMC7043_COS_DIV_ADLY.
+*          2) The operation is interlocked via the associated critical section.
+*******************************************************************************/
+EXPORT STATUS hmc7043ChSetDelay(CKDST_DEV dev, HMC7043_CH_MASK chMask,
+                                double aDlyPs, double dDlyPs)
+{
+	Hmc7043_app_dev_ctl *pCtl;
+	Hmc7043_app_dev_state *pState;
+	Hmc7043_ch_regs *pChRegs;
+	unsigned aSteps, dSteps;
+	STATUS status = OK;
+	SYS_TIME_NS t0;
+	unsigned ch;
+	Bool aDlyUsed = FALSE;
+
+	if (!hmc7043DevPresent(dev) || !chMask ||
+	    chMask >= 1 << HMC7043_OUT_NCHAN) {
+		hmc7043Log("bad argument(s) (dev %d, chMask 0x%x)", dev, chMask);
+		return ERROR;
+	}
+
+	pCtl = hmc7043AppCtl.pDevCtl[dev];
+
+	if(!hmc7043AppDevReady(pCtl)) {
+		hmc7043Log("initialization not done yet (dev %d, init. done %d,%d,%d)",
+				dev, hmc7043IfCtl.initDone, hmc7043AppCtl.initDone,
+				pCtl->initDone);
+		return ERROR;
+	}
+
+	/* validate against the steps (integer arithmetic, no clock plan math) */
+	if (!hmc7043AppTimingSteps(&pCtl->timing.aDlyStep, aDlyPs,
+	                           min(HMC7043_ADLY_MAX_STEPS,
+	                               HMC7043_FADLY_MAX_STEPS), &aSteps) ||
+	    !hmc7043AppTimingSteps(&pCtl->timing.dDlyStep, dDlyPs,
+	                           HMC7043_DDLY_MAX_STEPS, &dSteps)) {
+		sysLogFpa("bad delay(s) (aDlyPs %.1f, dDlyPs %.1f, dDlyStepPs %.3f)",
+		          aDlyPs, dDlyPs, (double) pCtl->timing.dDlyStep.num /
+		          pCtl->timing.dDlyStep.den / HMC7043_FS_PER_PS);
+		return ERROR;
+	}
+
+	for (ch = 0; ch < HMC7043_OUT_NCHAN; ++ch)
+		if (chMask & 1 << ch &&
+		    pCtl->params.chSup[ch].chMode == HMC7043_CHM_UNUSED) {
+			hmc7043Log("unused channel (dev %d, ch %u)", dev, ch);
+			return ERROR;
+		}
+
+	t0 = sysTimeNsec();
+	hmc7043CsEnter(dev, __FUNCTION__);
+
+	pState = hmc7043AppState.pDevState[dev];
+
+	for (ch = 0; ch < HMC7043_OUT_NCHAN; ++ch) {
+		Hmc7043_ch_sup *pChSup = pCtl->params.chSup + ch;
+
+		if (chMask & 1 << ch) {
+			pChRegs = hmc7043AppChRegs(&pState->regImage, ch);
+			pChRegs->faDelay.fields.faDelay = aSteps;
+			pChRegs->cdDelay.fields.cdDelay = dSteps;
+
+			pChSup->aDlyPs = aDlyPs;
+			pChSup->dDlyPs = dDlyPs;
+		}
+
+		aDlyUsed |= pChSup->aDlyPs > 0;
+	}
+
+	/* (as per hmc7043AppBuildRegImage) */
+	pState->regImage.r65.fields.aDelLowPowMo = !aDlyUsed;
+	pState->paramsHash = hmc7043AppParamsHash(&pCtl->params);
+
+	status = hmc7043AppCommitRegs(dev, FALSE);
+
+	hmc7043CsExit(dev, __FUNCTION__);
+
+	hmc7043StatsOp(dev, HMC7043_SOP_CH_SET_DELAY, t0, status);
+
+	return status;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043SysrefSwPulseN
+*
+* - title: Generate N Pulses on SYSREF channels of a particular device.
+*
+* - input: dev     - CLKDST device on which operation is performed.
+*          chMask  - channel mask
+*          nPulses -
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above
+*
+* - notes: the operation is interlocked via the associated critical section
+*******************************************************************************/
+EXPORT STATUS hmc7043SysrefSwPulseN(CKDST_DEV dev, HMC7043_CH_MASK chMask,
+                              HMC7043_SREF_NPULSES nPulses)
+{
+	const Hmc7043_app_dev_ctl *pCtl;
+	Hmc7043_reg_image *pImg;
+	HMC7043_BUS_PRI pri;
+	STATUS status = OK;
+	SYS_TIME_NS t0;
+
+	if (!hmc7043DevPresent(dev)) {
+		hmc7043Log("bad argument(s) (dev %d)", dev);
+		return ERROR;
+	}
+
+	pCtl = hmc7043AppCtl.pDevCtl[dev];
+	pImg = &hmc7043AppState.pDevState[dev]->regImage;
+
+	if (!chMask || chMask >= 1 << NELEMENTS(pCtl->params.chSup)) {
+		hmc7043Log("bad argument (chMask 0x%x)", chMask);
+		return ERROR;
+	}
+
+	if(!hmc7043AppDevReady(pCtl)) {
+		hmc7043Log("initialization not done yet (dev %d, init. done %d,%d,%d)",
+				dev, hmc7043IfCtl.initDone, hmc7043AppCtl.initDone,
+				pCtl->initDone);
+		return ERROR;
+	}
+
+	t0 = sysTimeNsec();
+	hmc7043CsEnter(dev, __FUNCTION__);
+	pri = hmc7043CsSetBusPri(dev, HMC7043_BPRI_URGENT);
+
+	if(pImg->r5a.fields.pulseMode == 0x0 || pImg->r5a.fields.pulseMode == 0x7) {
+		hmc7043Log("Pulse mode is not pulsed (Pulse mode 0x%x)",
+				pImg->r5a.fields.pulseMode);
+		status = ERROR;
+		goto done;
+	}
+
+	switch(nPulses) {
+		case HMC7043_SRNP_1: {
+			pImg->r5a.fields.pulseMode = 0x1;
+			break;
+		}
+		case HMC7043_SRNP_2: {
+			pImg->r5a.fields.pulseMode = 0x2;
+			break;
+		}
+		case HMC7043_SRNP_4: {
+			pImg->r5a.fields.pulseMode = 0x3;
+			break;
+		}
+		case HMC7043_SRNP_8: {
+			pImg->r5a.fields.pulseMode = 0x4;
+			break;
+		}
+		case HMC7043_SRNP_16: {
+			pImg->r5a.fields.pulseMode = 0x5;
+			break;
+		}
+	}
+
+	/* (along with any deferred changes) */
+	status = hmc7043AppCommitRegs(dev, TRUE);
+	if(status == OK)
+		status = hmc7043ToggleBit(dev, HMC7043_REG_IDX_REQ_MOD,
+		                          HMC7043_PULS_GEN_BIT, HMC7043_WOP_PULSE_GEN);
+
+done:
+	hmc7043CsSetBusPri(dev, pri);
+	hmc7043CsExit(dev, __FUNCTION__);
+
+	hmc7043StatsOp(dev, HMC7043_SOP_SYSREF_SW_PULSE_N, t0, status);
+
+	return status;
+
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043SysrefSwPulseNMulti
+*
+* - title: Generate N Pulses on SYSREF channels of multiple devices with minimal
+*          skew.
+*
+* - input: devMask - specifies the CLKDST devices
+*          chMask  - channel mask (for all the devices)
+*          nPulses - number of pulses (as for hmc7043SysrefSwPulseN)
+*
+* - output: *pSkewNsec - time between the first and the last pulse generation
+*                        request write (may be NULL)
+*
+* - returns: OK or ERROR if detected an error (for any of the devices)
+*
+* - description: takes the critical sections of all the devices (in device
+*                order), then:
+*                1) stages the pulse mode on every device (committing any
+*                   deferred changes as well) and gets its request register
+*                   (from the device image if known), so that
+*                2) the pulse generation requests can be fired with a single
+*                   register write per device back-to-back, and only then
+*                   cleared and waited for
+*
+* - notes: 1) No pulse is requested unless staging succeeded on all devices.
+*          2) With the GPI set up as HMC7043_GPIS_PULSE_GEN the pulses could
+*             rather be requested via a shared GPI line, but driving that is up
+*             to the board layer.
+*******************************************************************************/
+EXPORT STATUS hmc7043SysrefSwPulseNMulti(CKDST_DEV_MASK devMask,
+                                         HMC7043_CH_MASK chMask,
+                                         HMC7043_SREF_NPULSES nPulses,
+                                         UINT64 *pSkewNsec)
+{
+    /* pulseMode per nPulses (ref. hmc7043SysrefSwPulseN) */
+    static const UINT8 PULSE_MODES[] = {0x1, 0x2, 0x3, 0x4, 0x5};
+
+    HMC7043_REG reqMode[CKDST_MAX_NDEV];
+    HMC7043_BUS_PRI pri[CKDST_MAX_NDEV];
+    SYS_TIME_NS t0, firstAt = 0, lastAt = 0;
+    CKDST_DEV_MASK csMask = 0;
+    STATUS status = OK;
+    CKDST_DEV dev;
+
+    if (!devMask || devMask & ~hmc7043IfCtl.devMask ||
+        !chMask || chMask >= 1 << HMC7043_OUT_NCHAN ||
+        !inEnumRange(nPulses, NELEMENTS(PULSE_MODES))) {
+        hmc7043Log("bad argument(s) (devMask 0x%08x%08x, chMask 0x%x, "
+                   "nPulses %d)", SL64(devMask), chMask, nPulses);
+        return ERROR;
+    }
+
+    CKDST_FOR_EACH_DEV(dev, devMask) {
+        if (!hmc7043AppDevReady(hmc7043AppCtl.pDevCtl[dev])) {
+            hmc7043Log("initialization not done yet (dev %d)", dev);
+            return ERROR;
+        }
+    }
+
+    t0 = sysTimeNsec();
+
+    /* take the critical sections and stage the pulse mode */
+    CKDST_FOR_EACH_DEV(dev, devMask) {
+        Hmc7043_reg_image *pImg = &hmc7043AppState.pDevState[dev]->regImage;
+
+        if (hmc7043CsEnter(dev, __FUNCTION__) != OK) {
+            status = ERROR;
+            break;
+        }
+
+        csMask |= CKDST_DEV_BIT(dev);
+        pri[dev] = hmc7043CsSetBusPri(dev, HMC7043_BPRI_URGENT);
+
+        if (pImg->r5a.fields.pulseMode == 0x0 ||
+            pImg->r5a.fields.pulseMode == 0x7) {
+            hmc7043Log("Pulse mode is not pulsed (dev %d, Pulse mode 0x%x)",
+                       dev, pImg->r5a.fields.pulseMode);
+            status = ERROR;
+            break;
+        }
+
+        pImg->r5a.fields.pulseMode = PULSE_MODES[nPulses];
+
+        if (hmc7043AppCommitRegs(dev, TRUE) != OK ||
+            (!hmc7043AppShadowRead(dev, HMC7043_REG_IDX_REQ_MOD, reqMode + dev,
+                                   1, TRUE) &&
+             hmc7043LliRegReadInCs(dev, HMC7043_REG_IDX_REQ_MOD,
+                                   reqMode + dev) != OK)) {
+            status = ERROR;
+            break;
+        }
+    }
+
+    /* fire the requests back-to-back, then clear these and wait */
+    if (status == OK) {
+        CKDST_FOR_EACH_DEV(dev, devMask) {
+            if (hmc7043LliRegWriteInCs(dev, HMC7043_REG_IDX_REQ_MOD,
+                                       reqMode[dev] |
+                                       1 << HMC7043_PULS_GEN_BIT) != OK)
+                status = ERROR;
+
+            lastAt = sysTimeNsec();
+            firstAt = firstAt ? firstAt : lastAt;
+        }
+
+        CKDST_FOR_EACH_DEV(dev, devMask) {
+            if (hmc7043LliRegWriteInCs(dev, HMC7043_REG_IDX_REQ_MOD,
+                                       reqMode[dev] &
+                                       ~(1 << HMC7043_PULS_GEN_BIT)) != OK ||
+                hmc7043AppWaitDone(dev, HMC7043_WOP_PULSE_GEN) != OK)
+                status = ERROR;
+        }
+    }
+
+    if (pSkewNsec)
+        *pSkewNsec = lastAt - firstAt;
+
+    /* release the critical sections (in reverse order) */
+    for (; csMask; csMask &= ~CKDST_DEV_BIT(dev)) {
+        dev = ckdstDevLast(csMask);
+
+        hmc7043CsSetBusPri(dev, pri[dev]);
+        hmc7043CsExit(dev, __FUNCTION__);
+        hmc7043StatsOp(dev, HMC7043_SOP_SYSREF_SW_PULSE_N, t0, status);
+    }
+
+    return status;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043CommitThread
+*
+* - title: deferred commit window expiry thread
+*
+* - input: pArgs->arg1 - CLKDST device
+*
+* - returns: ERROR (if the wake-up queue can no longer be read)
+*
+* - description: woken up when register image changes start being deferred
+*                (ref. hmc7043AppCommitRegs), commits these once the window
+*                expires, unless committed meanwhile
+*******************************************************************************/
+LOCAL UINT64 hmc7043CommitThread(const Sys_thread_args *pArgs)
+{
+    CKDST_DEV dev = (CKDST_DEV) pArgs->arg1;
+    Hmc7043_commit_dev_ctl *pCtl = hmc7043CommitCtl.pDevCtl[dev];
+    SYS_TIME_NS dueAt, nsec;
+    size_t nBytes;
+    UINT8 bell;
+
+    FOREVER {
+        nBytes = sizeof(bell);
+
+        if (utlQueueGet(pCtl->hBell, &bell, &nBytes, UTL_Q_TO_INFINITE,
+                        NULL) != OK)
+            break;
+
+        FOREVER {
+            hmc7043CsEnter(dev, __FUNCTION__);
+
+            dueAt = pCtl->pendingSince + pCtl->windowUsec * (SYS_TIME_NS) 1000;
+            nsec  = sysTimeNsec();
+
+            if (!pCtl->pendingSince || !pCtl->windowUsec) {
+                hmc7043CsExit(dev, __FUNCTION__);
+                break;
+            }
+
+            if (nsec >= dueAt) {
+                if (hmc7043AppCommitRegs(dev, TRUE) != OK)
+                    hmc7043Log("deferred commit failed (dev %d)", dev);
+
+                hmc7043CsExit(dev, __FUNCTION__);
+                break;
+            }
+
+            hmc7043CsExit(dev, __FUNCTION__);
+
+            sysDelayUsec((dueAt - nsec + 999) / 1000);
+        }
+    }
+
+    hmc7043Log("wake-up queue read failed (dev %d)", dev);
+
+    return (UINT64) ERROR;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043SetDeferredCommit
+*
+* - title: set the register commit mode of a device
+*
+* - input: dev        - CLKDST device for which to perform the operation
+*          enable     - if set, will defer the commits, otherwise commit
+*                       immediately (as by default)
+*          windowUsec - maximum time for which changes are deferred (0 for
+*                       explicit commits only)
+*          thrCode    - thread code for the window expiry thread (with the
+*                       device as the subcode; only used when first called with
+*                       a non-zero windowUsec)
+*
+* - output: *hmc7043CommitCtl.pDevCtl[dev]
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: in deferred commit mode the register image changes made by
+*                hmc7043OutChEnDis(Mask), hmc7043ChSyncDisMask and
+*                hmc7043SetSysrefMode are accumulated, each modified register
+*                being written just once when they are committed: explicitly
+*                (ref. hmc7043Commit), by the services that act on the device
+*                (hmc7043ChDoSlip, hmc7043SysrefSwPulseN, hmc7043ClearAlarms),
+*                or once windowUsec expires
+*
+* - notes: 1) Disabling commits any changes pending.
+*          2) To be called after hmc7043InitDev.
+*******************************************************************************/
+EXPORT STATUS hmc7043SetDeferredCommit(CKDST_DEV dev, Bool enable,
+                                       UINT32 windowUsec, unsigned thrCode)
+{
+    static const UINT32 STACK_SIZE = 0x10000;  /* more than enough */
+    static const unsigned N_BELLS = 4;         /* (one is enough really) */
+
+    Hmc7043_commit_dev_ctl *pCtl;
+    Sys_thread_args args = {dev, 0, 0};
+    STATUS status = OK;
+
+    if (!hmc7043DevPresent(dev)) {
+        sysLog("bad argument (dev %d)", dev);
+        return ERROR;
+    }
+
+    pCtl = hmc7043CommitCtl.pDevCtl[dev];
+
+    if (hmc7043CsEnter(dev, __FUNCTION__) != OK)
+        return ERROR;
+
+    /* start the window expiry thread (if first time here) */
+    if (enable && windowUsec && pCtl->hBell == UTL_QUEUE_BAD_HQUEUE) {
+        if ((pCtl->hBell = utlQueueCreate(N_BELLS, sizeof(UINT8), NULL)) ==
+            UTL_QUEUE_BAD_HQUEUE) {
+            sysLog("wake-up queue creation failed (dev %d)", dev);
+            status = ERROR;
+        } else if (sysThreadCreate(thrCode, dev, hmc7043CommitThread,
+                                   STACK_SIZE, &args) != OK) {
+            sysLog("window expiry thread creation failed (dev %d)", dev);
+            utlQueueDelete(pCtl->hBell, NULL);
+            pCtl->hBell = UTL_QUEUE_BAD_HQUEUE;  /* (for a retry to start it) */
+            status = ERROR;
+        } else
+            sysAtomicStoreRel(&hmc7043IfCtl.bgStarted, TRUE);
+    }
+
+    if (status == OK) {
+        if (!enable)
+            status = hmc7043AppCommitRegs(dev, TRUE);
+
+        pCtl->deferred   = enable;
+        pCtl->windowUsec = windowUsec;
+    }
+
+    hmc7043CsExit(dev, __FUNCTION__);
+
+    return status;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043Commit
+*
+* - title: commit the deferred register image changes of a device
+*
+* - input: dev - CLKDST device for which to perform the operation
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: writes the registers modified since the last commit, one
+*                burst per run of contiguous such registers (ref.
+*                hmc7043SetDeferredCommit)
+*
+* - notes: the operation is interlocked via the associated critical section
+*******************************************************************************/
+EXPORT STATUS hmc7043Commit(CKDST_DEV dev)
+{
+    const Hmc7043_app_dev_ctl *pCtl;
+    STATUS status;
+
+    if (!hmc7043DevPresent(dev)) {
+        hmc7043Log("bad argument (dev %d)", dev);
+        return ERROR;
+    }
+
+    pCtl = hmc7043AppCtl.pDevCtl[dev];
+
+    if (!hmc7043AppDevReady(pCtl)) {
+        hmc7043Log("initialization not done yet (dev %d, init. done %d,%d,%d)",
+                   dev, hmc7043IfCtl.initDone, hmc7043AppCtl.initDone,
+                   pCtl->initDone);
+        return ERROR;
+    }
+
+    hmc7043CsEnter(dev, __FUNCTION__);
+
+    status = hmc7043AppCommitRegs(dev, TRUE);
+
+    hmc7043CsExit(dev, __FUNCTION__);
+
+    return status;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043SetRegReadThrough
+*
+* - title: set the register read-through mode
+*
+* - input: readThrough - if set, all register reads go to the device
+*
+* - output: hmc7043ShadowCtl.readThrough
+*
+* - returns: OK
+*
+* - description: as above (applies to all devices), otherwise reads of known
+*                control registers being served from the device image (ref.
+*                hmc7043AppShadowRead)
+*
+* - notes: intended for debugging (e.g. to check the device against the
+*          image, ref. also hmc7043ScrubRegs)
+*******************************************************************************/
+EXPORT STATUS hmc7043SetRegReadThrough(Bool readThrough)
+{
+    hmc7043ShadowCtl.readThrough = readThrough;
+
+    return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043SetRegScrub
+*
+* - title: set the periodic device image scrubbing
+*
+* - input: scrubPeriod - in background monitor iterations (0 to disable)
+*
+* - output: hmc7043ShadowCtl.scrubPeriod
+*
+* - returns: OK
+*
+* - description: has the background monitor (ref. hmc7043StartMonitor) scrub
+*                the device image of each of the monitored devices every
+*                scrubPeriod iterations (ref. hmc7043AppScrubRegs)
+*******************************************************************************/
+EXPORT STATUS hmc7043SetRegScrub(unsigned scrubPeriod)
+{
+    hmc7043ShadowCtl.scrubPeriod = scrubPeriod;
+
+    return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043ScrubRegs
+*
+* - title: check the device image of a device against its registers
+*
+* - input: dev - CLKDST device for which to perform the operation
+*
+* - output: *pNMismatches - number of mismatching (rewritten) control registers
+*                           (may be NULL)
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above (ref. hmc7043AppScrubRegs)
+*
+* - notes: the operation is interlocked via the associated critical section
+*******************************************************************************/
+EXPORT STATUS hmc7043ScrubRegs(CKDST_DEV dev, unsigned *pNMismatches)
+{
+    const Hmc7043_app_dev_ctl *pCtl;
+    HMC7043_BUS_PRI pri;
+    int nMismatches;
+
+    if (!hmc7043DevPresent(dev)) {
+        hmc7043Log("bad argument (dev %d)", dev);
+        return ERROR;
+    }
+
+    pCtl = hmc7043AppCtl.pDevCtl[dev];
+
+    if (!hmc7043AppDevReady(pCtl)) {
+        hmc7043Log("initialization not done yet (dev %d, init. done %d,%d,%d)",
+                   dev, hmc7043IfCtl.initDone, hmc7043AppCtl.initDone,
+                   pCtl->initDone);
+        return ERROR;
+    }
+
+    hmc7043CsEnter(dev, __FUNCTION__);
+    pri = hmc7043CsSetBusPri(dev, HMC7043_BPRI_BACKGROUND);
+
+    nMismatches = hmc7043AppScrubRegs(dev);
+
+    hmc7043CsSetBusPri(dev, pri);
+    hmc7043CsExit(dev, __FUNCTION__);
+
+    if (pNMismatches)
+        *pNMismatches = nMismatches < 0 ? 0 : nMismatches;
+
+    return nMismatches < 0 ? ERROR : OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043SetWaitTimeout
+*
+* - title: set the completion wait timeout of a device operation
+*
+* - input: op          - the operation for which to set the timeout
+*          timeoutUsec - timeout (in microseconds)
+*
+* - output: hmc7043WaitCtl.timeoutUsec[op]
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above (applies to all devices)
+*
+* - notes: intended to be tuned per the statistics from hmc7043GetWaitStats
+*******************************************************************************/
+EXPORT STATUS hmc7043SetWaitTimeout(HMC7043_WAIT_OP op, UINT32 timeoutUsec)
+{
+	if (!inEnumRange(op, HMC7043_WOP_NOPS) || !timeoutUsec) {
+		sysLog("bad argument(s) (op %d, timeoutUsec %u)", op, timeoutUsec);
+		return ERROR;
+	}
+
+	hmc7043WaitCtl.timeoutUsec[op] = timeoutUsec;
+
+	return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043SetWaitSettle
+*
+* - title: set the settle time of a device operation
+*
+* - input: op         - the operation for which to set the settle time
+*          settleUsec - settle time (in microseconds, 0 for none)
+*
+* - output: hmc7043WaitCtl.settleUsec[op]
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above (applies to all devices), i.e. the minimum wait after
+*                issuing the operation before its completion is polled for
+*                (by default 200 usec for the soft reset, 20 usec for the
+*                operations polling for the FSMs being idle - to be raised
+*                for slow SYSREF timers - and none for the output phase wait)
+*
+* - notes: the settle time counts towards the timeout of the operation (its
+*          completion being polled for at least once regardless)
+*******************************************************************************/
+EXPORT STATUS hmc7043SetWaitSettle(HMC7043_WAIT_OP op, UINT32 settleUsec)
+{
+	if (!inEnumRange(op, HMC7043_WOP_NOPS)) {
+		sysLog("bad argument (op %d, settleUsec %u)", op, settleUsec);
+		return ERROR;
+	}
+
+	hmc7043WaitCtl.settleUsec[op] = settleUsec;
+
+	return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043GetWaitStats
+*
+* - title: get the completion wait statistics of a device operation
+*
+* - input: dev    - CLKDST device for which to perform the operation
+*          op     - the operation for which to get the statistics
+*          pStats - where to return the statistics
+*          clear  - whether to clear the statistics (once returned)
+*
+* - output: *pStats, hmc7043WaitCtl.pDevStats[dev][op] (if clear)
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above
+*
+* - notes: the operation is interlocked via the associated critical section
+*******************************************************************************/
+EXPORT STATUS hmc7043GetWaitStats(CKDST_DEV dev, HMC7043_WAIT_OP op,
+                                  Hmc7043_wait_stats *pStats, Bool clear)
+{
+	Hmc7043_wait_stats *pDevStats;
+
+	if (!hmc7043DevPresent(dev) || !inEnumRange(op, HMC7043_WOP_NOPS) ||
+	    !pStats) {
+		sysLog("bad argument(s) (dev %d, op %d, pStats %d)", dev, op,
+		       pStats != NULL);
+		return ERROR;
+	}
+
+	pDevStats = hmc7043WaitCtl.pDevStats[dev] + op;
+
+	if (hmc7043CsEnter(dev, __FUNCTION__) != OK)
+		return ERROR;
+
+	*pStats = *pDevStats;
+
+	if (clear)
+		memset(pDevStats, 0, sizeof(*pDevStats));
+
+	hmc7043CsExit(dev, __FUNCTION__);
+
+	return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043SetPersistence
+*
+* - title: set up persistence of the register images (for warm init)
+*
+* - input: shmName     - name of the POSIX shared memory object to be used
+*          verifyRegs  - registers to verify a persisted register image by
+*                        (NULL for a default set)
+*          nVerifyRegs - number of verifyRegs entries
+*
+* - output: hmc7043PersistCtl
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: maps the shared memory object (creating it if necessary), to
+*                which the device register images are copied whenever updated.
+*                Subsequently, a warm hmc7043InitDev (e.g. after a process
+*                restart) takes the persisted register image instead of
+*                reading all of the registers back, if the product id and
+*                verifyRegs as read back match it.
+*
+* - notes: 1) To be called (once) before hmc7043InitDev.
+*          2) The shared memory object is registered as an auto-delete
+*             resource, so only survives an abnormal process termination.
+*          3) verifyRegs must be ones kept in the register image (and not
+*             self-clearing).
+*******************************************************************************/
+EXPORT STATUS hmc7043SetPersistence(const char *shmName,
+                                    const unsigned verifyRegs[],
+                                    unsigned nVerifyRegs)
+{
+    Hmc7043_persist_seg *pSeg;
+    struct stat st;
+    unsigned i;
+    int fd;
+
+    /* initialize */
+    if (!verifyRegs) {
+        verifyRegs  = hmc7043PersistDfltVerifyRegs;
+        nVerifyRegs = NELEMENTS(hmc7043PersistDfltVerifyRegs);
+    }
+
+    if (!shmName || nVerifyRegs > HMC7043_PERSIST_MAX_VERIFY_REGS) {
+        sysLog("bad argument(s) (shmName %d, nVerifyRegs %u)", shmName != NULL,
+               nVerifyRegs);
+        return ERROR;
+    }
+
+    for (i = 0; i < nVerifyRegs; ++i)
+        if (hmc7043AppRegDescInx(verifyRegs[i]) < 0) {
+            sysLog("bad argument (verifyRegs[%u] 0x%x)", i, verifyRegs[i]);
+            return ERROR;
+        }
+
+    if (hmc7043PersistCtl.pSeg) {
+        sysLogLong("already set up (shmName %s)", shmName);
+        return ERROR;
+    }
+
+    /* map the shared memory object */
+    if ((fd = shm_open(shmName, O_RDWR | O_CREAT, 0600)) < 0) {
+        sysLogLong("shm_open failed (shmName %s)", shmName);
+        return ERROR;
+    }
+
+    if (fstat(fd, &st) || (st.st_size != sizeof(*pSeg) &&
+                           ftruncate(fd, sizeof(*pSeg)))) {
+        sysLogLong("shared memory object sizing failed (shmName %s)", shmName);
+        close(fd);
+        return ERROR;
+    }
+
+    pSeg = mmap(NULL, sizeof(*pSeg), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (pSeg == MAP_FAILED) {
+        sysLogLong("mmap failed (shmName %s)", shmName);
+        return ERROR;
+    }
+
+    if (sysRegisterAutoDelResource(shmName, FALSE, hmc7043PersistDelete) != OK)
+        sysLogLong("auto-delete registration failed (shmName %s)", shmName);
+
+    /* discard the contents if not set up by this version */
+    if (pSeg->magic != HMC7043_PERSIST_MAGIC ||
+        pSeg->version != HMC7043_PERSIST_VERSION ||
+        pSeg->size != sizeof(*pSeg)) {
+        memset(pSeg, 0, sizeof(*pSeg));
+        pSeg->magic   = HMC7043_PERSIST_MAGIC;
+        pSeg->version = HMC7043_PERSIST_VERSION;
+        pSeg->size    = sizeof(*pSeg);
+    }
+
+    memcpy(hmc7043PersistCtl.verifyRegs, verifyRegs,
+           nVerifyRegs * sizeof(verifyRegs[0]));
+    hmc7043PersistCtl.nVerifyRegs = nVerifyRegs;
+    hmc7043PersistCtl.pSeg        = pSeg;
+
+    return OK;
+}
 
-	return OK;
+
+
+
+/*#############################################################################*
+*               A S Y N C H R O N O U S    S E R V I C E S                     *
+*#############################################################################*/
+/*******************************************************************************
+* - name: hmc7043AsyncExec
+*
+* - title: perform an asynchronous service request
+*
+* - input: dev  - CLKDST device for which to perform the operation
+*          pReq - the request
+*
+* - output: *pAlarms (for HMC7043_AOP_GET_ALARMS)
+*
+* - returns: status returned from the respective service
+*******************************************************************************/
+LOCAL STATUS hmc7043AsyncExec(CKDST_DEV dev, const Hmc7043_async_req *pReq,
+                              Hmc7043_dev_alarms *pAlarms)
+{
+    switch (pReq->op) {
+    case HMC7043_AOP_SET_SYSREF_MODE:
+        return hmc7043SetSysrefMode(dev, pReq->mode, pReq->nPulses);
+    case HMC7043_AOP_SYSREF_SW_PULSE_N:
+        return hmc7043SysrefSwPulseN(dev, pReq->chMask, pReq->nPulses);
+    case HMC7043_AOP_CH_DO_SLIP:
+        return hmc7043ChDoSlip(dev, pReq->chMask);
+    case HMC7043_AOP_OUT_CH_EN_DIS:
+        return hmc7043OutChEnDisMask(dev, pReq->chMask, pReq->enMask);
+    case HMC7043_AOP_CH_SYNC_DIS:
+        return hmc7043ChSyncDisMask(dev, pReq->chMask);
+    case HMC7043_AOP_CLEAR_ALARMS:
+        return hmc7043ClearAlarms(dev);
+    case HMC7043_AOP_GET_ALARMS:
+        return hmc7043GetAlarms(dev, pAlarms);
+    default:
+        hmc7043Log("bad op (dev %d, op %d)", dev, pReq->op);
+        return ERROR;
+    }
 }
 
 
 
 
 /*******************************************************************************
-* - name: hmc7043DisSync
+* - name: hmc7043AsyncThread
 *
-* - title: Disables SYNC on all output channels
+* - title: asynchronous service request executor thread
 *
-* - input: dev - CLKDST device for which to perform the operation
+* - input: pArgs->arg1 - CLKDST device
 *
-* - output: hmc7043AppState.devState[dev].regImage
+* - returns: ERROR (if the request queues can no longer be read)
 *
-* - returns: OK or ERROR if detected an error
+* - description: per doorbell message, performs the first urgent request
+*                pending, or else the first normal one, and reports its
+*                completion (token first, then callback)
 *
-* - description: as above
+* - notes: The request rings being filled in by the posters, a doorbell may
+*          come ahead of the commit of its request (by a concurrent poster of
+*          an earlier one), which is then waited for.
 *******************************************************************************/
-LOCAL STATUS hmc7043DisSync(CKDST_DEV dev, const Hmc7043_app_dev_params *pParams)
+LOCAL UINT64 hmc7043AsyncThread(const Sys_thread_args *pArgs)
 {
-	Hmc7043_reg_image *pImg;
-	unsigned ch;
+    CKDST_DEV dev = (CKDST_DEV) pArgs->arg1;
+    Hmc7043_async_dev_ctl *pCtl = hmc7043AsyncCtl.pDevCtl[dev];
+    Hmc7043_async_msg msg;
+    const Hmc7043_async_msg *pMsg;
+    Utl_ring *pRing;
+    Hmc7043_dev_alarms alarms;
+    size_t nBytes;
+    UINT8 bell;
+    STATUS status;
 
-	if (!inEnumRange(dev, NELEMENTS(hmc7043AppState.devState)) || !pParams) {
-		sysLog("bad argument(s) (dev %d, pParams %d)", dev, pParams != NULL);
-		return ERROR;
-	}
+    if (pCtl->hBell == UTL_QUEUE_BAD_HQUEUE)  /* start rolled back */
+        return (UINT64) OK;
 
-	pImg = &hmc7043AppState.devState[dev].regImage;
+    FOREVER {
+        nBytes = sizeof(bell);
 
-	for (ch = 0; ch < HMC7043_OUT_NCHAN; ch++) {
-		if(pParams->chSup[ch].chMode != HMC7043_CHM_UNUSED) {
-			switch(ch){
-				case 0: {
-					pImg->rc8.fields.syncEn_0= 0x0;
-					break;
-				}
-				case 1: {
-					pImg->rd2.fields.syncEn_1 = 0x0;
-					break;
-				}
-				case 2: {
-					pImg->rdc.fields.syncEn_2 = 0x0;
-					break;
-				}
-				case 3: {
-					pImg->re6.fields.syncEn_3 = 0x0;
-					break;
-				}
-				case 4: {
-					pImg->rf0.fields.syncEn_4 = 0x0;
-					break;
-				}
-				case 5: {
-					pImg->rfa.fields.syncEn_5 = 0x0;
-					break;
-				}
-				case 6: {
-					pImg->r104.fields.syncEn_6 = 0x0;
-					break;
-				}
-				case 7: {
-					pImg->r10e.fields.syncEn_7 = 0x0;
-					break;
-				}
-				case 8: {
-					pImg->r118.fields.syncEn_8 = 0x0;
-					break;
-				}
-				case 9: {
-					pImg->r122.fields.syncEn_9 = 0x0;
-					break;
-				}
-				case 10: {
-					pImg->r12c.fields.syncEn_10 = 0x0;
-					break;
-				}
-				case 11: {
-					pImg->r136.fields.syncEn_11 = 0x0;
-					break;
-				}
-				case 12: {
-					pImg->r140.fields.syncEn_12 = 0x0;
-					break;
-				}
-				case 13: {
-					pImg->r14a.fields.syncEn_13 = 0x0;
-					break;
-				}
-			}
-		}
-	}
-	return OK;
+        if (utlQueueGet(pCtl->hBell, &bell, &nBytes, UTL_Q_TO_INFINITE,
+                        NULL) != OK)
+            break;
+
+        FOREVER {
+            pRing = &pCtl->urgent;
+
+            if ((pMsg = utlRingPeek(pRing)) != NULL)
+                break;
+
+            pRing = &pCtl->normal;
+
+            if ((pMsg = utlRingPeek(pRing)) != NULL ||
+                !(utlRingCount(&pCtl->urgent) + utlRingCount(&pCtl->normal)))
+                break;
+
+            /* (first request of a ring reserved but not yet committed) */
+            sysDelayUsec(1);
+        }
+
+        if (!pMsg) {
+            sysCodeError(CODE_ERR_STATE, hmc7043AsyncThread, dev, 0, 0);
+            continue;
+        }
+
+        /* (the slot is released right away, for posters not to wait for the
+           request's completion) */
+        msg = *pMsg;
+        utlRingRelease(pRing);
+
+        memset(&alarms, 0, sizeof(alarms));
+        status = hmc7043AsyncExec(dev, &msg.req, &alarms);
+
+        if (msg.pToken) {
+            msg.pToken->status = status;
+            msg.pToken->alarms = alarms;
+            sysAtomicStoreRel(&msg.pToken->done, TRUE);
+        }
+
+        if (msg.pDone)
+            msg.pDone(dev, &msg.req, status, &alarms, msg.arg);
+    }
+
+    hmc7043Log("request queue read failed (dev %d)", dev);
+
+    return (UINT64) ERROR;
 }
 
 
 
 
 /*******************************************************************************
-* - name: hmc7043AppInitPgmPlGnMd
-*
-* - title: Program the Pulse Generator Mode
+* - name: hmc7043StartAsync
 *
-* - input: dev - CLKDST device for which to perform the operation
-*          pParams - pointer to device setup parameters
+* - title: start the asynchronous service request executors
 *
-* - output: hmc7043AppState.devState[dev].regImage
+* - input: devMask - specifies the CLKDST device(s)
+*          maxReqs - maximum number of requests pending per device and
+*                    priority class (rounded up to a power of 2)
+*          thrCode - thread code for the executor threads (must support
+*                    multiple threads, with the device as the subcode)
 *
 * - returns: OK or ERROR if detected an error
 *
-* - description: as above
+* - description: sets up the request rings and doorbell queue and creates the
+*                executor thread of each of the devices (ref. hmc7043PostAsync)
+*
+* - notes: 1) To be called at most once (after hmc7043IfInit), but for
+*             retrying after failing (nothing then being left started).
+*          2) The executor threads' priority should be set by the application
+*             as required (e.g. above that of any background threads posting
+*             normal requests).
 *******************************************************************************/
-LOCAL STATUS hmc7043AppInitPgmPlGnMd(CKDST_DEV dev,
-		                          const Hmc7043_app_dev_params *pParams)
+EXPORT STATUS hmc7043StartAsync(CKDST_DEV_MASK devMask, unsigned maxReqs,
+                                unsigned thrCode)
 {
-	Hmc7043_reg_image *pImg;
+    static const UINT32 STACK_SIZE = 0x10000;  /* more than enough */
 
-	if (!inEnumRange(dev, NELEMENTS(hmc7043AppState.devState)) || !pParams) {
-		sysLog("bad argument(s) (dev %d, pParams %d)", dev, pParams != NULL);
-		return ERROR;
-	}
+    CKDST_DEV_MASK setUpMask = 0, thrMask = 0;
+    STATUS status = OK;  /* initial assumption */
+    CKDST_DEV dev;
+    UINT32 nSlots;
+    size_t memSize;
+
+    if (!devMask || devMask & ~hmc7043IfCtl.devMask || !maxReqs ||
+        maxReqs > 0x10000) {
+        sysLog("bad argument(s) (devMask 0x%08x%08x, maxReqs %u)",
+               SL64(devMask), maxReqs);
+        return ERROR;
+    }
 
-	pImg = &hmc7043AppState.devState[dev].regImage;
+    if (!hmc7043IfCtl.initDone) {
+        sysLog("interface not initialized yet");
+        return ERROR;
+    }
 
-	/* Set pulse generation mode */
-	switch(pParams->sysref.mode)
-	{
-		case HMC7043_SRM_CONTINUOUS: {
-			pImg->r5a.fields.pulseMode = 0x7;
-			break;
-		}
-		case HMC7043_SRM_LEVEL_CTL: {
-			pImg->r5a.fields.pulseMode = 0x0;
-			break;
-		}
-		case HMC7043_SRM_PULSED: {
-			switch(pParams->sysref.nPulses)
-			{
-				case HMC7043_SRNP_1: {
-					pImg->r5a.fields.pulseMode = 0x1;
-					break;
-				}
-				case HMC7043_SRNP_2: {
-					pImg->r5a.fields.pulseMode = 0x2;
-					break;
-				}
-				case HMC7043_SRNP_4: {
-					pImg->r5a.fields.pulseMode = 0x3;
-					break;
-				}
-				case HMC7043_SRNP_8: {
-					pImg->r5a.fields.pulseMode = 0x4;
-					break;
-				}
-				case HMC7043_SRNP_16: {
-					pImg->r5a.fields.pulseMode = 0x5;
-					break;
-				}
-				default: {
-					sysLog("Bad value ( pParams->sysref.nPulses %d)",
-							pParams->sysref.nPulses);
-					return ERROR;
-				}
-			}
-			break;
-		}
-		default:
-			sysLog("Bad value ( pParams->sysref.mode %d)",
-				   pParams->sysref.mode);
-			return ERROR;
-	}
-	return OK;
+    CKDST_FOR_EACH_DEV(dev, devMask)
+        if (hmc7043AsyncCtl.pDevCtl[dev]->hBell != UTL_QUEUE_BAD_HQUEUE) {
+            sysLog("already started (dev %d)", dev);
+            return ERROR;
+        }
+
+    for (nSlots = 2; nSlots < maxReqs; nSlots *= 2)
+        ;
+
+    /* (multiple of the alignment, as required by aligned_alloc) */
+    memSize = (UTL_RING_MEM_SIZE(nSlots, sizeof(Hmc7043_async_msg)) +
+               UTL_RING_CACHE_LINE - 1) & ~(size_t) (UTL_RING_CACHE_LINE - 1);
+
+    /* set up the request rings and doorbell queues and create the executor
+       threads (initially suspended, so that all of this can be rolled back
+       if failing for any of the devices) */
+    CKDST_FOR_EACH_DEV(dev, devMask) {
+        Hmc7043_async_dev_ctl *pCtl = hmc7043AsyncCtl.pDevCtl[dev];
+        Sys_thread_args args = {dev, 0, 0};
+        void *pUrgentMem, *pNormalMem;
+        HUTL_QUEUE hBell;
+
+        pUrgentMem = aligned_alloc(UTL_RING_CACHE_LINE, memSize);
+        pNormalMem = aligned_alloc(UTL_RING_CACHE_LINE, memSize);
+
+        /* (the doorbell queue never fills up before the request rings do) */
+        if (utlRingInit(&pCtl->urgent, pUrgentMem, nSlots,
+                        sizeof(Hmc7043_async_msg), TRUE) != OK ||
+            utlRingInit(&pCtl->normal, pNormalMem, nSlots,
+                        sizeof(Hmc7043_async_msg), TRUE) != OK ||
+            (hBell = utlQueueCreate(2 * nSlots, sizeof(UINT8), NULL)) ==
+            UTL_QUEUE_BAD_HQUEUE) {
+            sysLog("request ring / queue creation failed (dev %d)", dev);
+            memset(&pCtl->urgent, 0, sizeof(pCtl->urgent));
+            memset(&pCtl->normal, 0, sizeof(pCtl->normal));
+            free(pUrgentMem);
+            free(pNormalMem);
+            status = ERROR;
+            break;
+        }
+
+        pCtl->hBell = hBell;
+        setUpMask |= CKDST_DEV_BIT(dev);
+
+        if (sysThreadCreateEx(thrCode, dev, hmc7043AsyncThread, STACK_SIZE,
+                              &args, SYS_THREAD_OPTS_WAITABLE |
+                              SYS_THREAD_OPTS_SUSPENDED) != OK) {
+            sysLog("executor thread creation failed (dev %d)", dev);
+            status = ERROR;
+            break;
+        }
+
+        thrMask |= CKDST_DEV_BIT(dev);
+    }
+
+    /* roll back on failure: any thread created exits at once on being run
+       with its doorbell queue reset (ref. hmc7043AsyncThread) */
+    if (status != OK) {
+        CKDST_FOR_EACH_DEV(dev, setUpMask) {
+            Hmc7043_async_dev_ctl *pCtl = hmc7043AsyncCtl.pDevCtl[dev];
+            HUTL_QUEUE hBell = pCtl->hBell;
+            UINT64 exitCode;
+
+            pCtl->hBell = UTL_QUEUE_BAD_HQUEUE;
+
+            if (thrMask & CKDST_DEV_BIT(dev) &&
+                (sysThreadStart(thrCode, dev) != OK ||
+                 sysThreadWait4Exit(thrCode, dev, SYS_TIME_INFINITE,
+                                    &exitCode) != OK)) {
+                /* can only happen due to a code error: leaving the rings and
+                   queue to the thread */
+                sysCodeError(CODE_ERR_STATE, hmc7043StartAsync, thrCode, dev,
+                             -1);
+                continue;
+            }
+
+            utlQueueDelete(hBell, NULL);
+            free(pCtl->urgent.pSlots);
+            free(pCtl->normal.pSlots);
+            memset(&pCtl->urgent, 0, sizeof(pCtl->urgent));
+            memset(&pCtl->normal, 0, sizeof(pCtl->normal));
+        }
+
+        return ERROR;
+    }
+
+    CKDST_FOR_EACH_DEV(dev, devMask)
+        if (sysThreadStart(thrCode, dev) != OK) {
+            /* can only happen due to a code error: no way to recover */
+            sysCodeError(CODE_ERR_STATE, hmc7043StartAsync, thrCode, dev, -1);
+            return ERROR;
+        }
+
+    sysAtomicStoreRel(&hmc7043IfCtl.bgStarted, TRUE);
+
+    return OK;
 }
 
 
 
 
 /*******************************************************************************
-* - name: hmc7043AppInitAppSup
+* - name: hmc7043PostAsync
 *
-* - title: initialize CLK device as per 'typical programming sequence'
-*          mentioned in data sheet.
+* - title: post an asynchronous service request
 *
-* - input: dev     - CLKDST device for which to perform the operation
-*          pParams - pointer to device setup parameters
+* - input: dev    - CLKDST device for which to perform the operation
+*          pReq   - the request (copied)
+*          pDone  - completion callback (NULL if none)
+*          arg    - passed to pDone
+*          pToken - completion token (NULL if none)
 *
-* - output: hmc7043AppState.devState[dev].regImage
+* - output: *pToken (reset on posting, set on completion)
 *
-* - returns: OK or ERROR if detected an error
+* - returns: OK or ERROR if detected an error (e.g. too many requests pending)
 *
-* - notes: Step 1&2: these are to be done on hardware, soft reset, GPIO, SDATA
-*                    setup will be done in this function
-*          Step 3: Load the configuration updates (provided by Analog
-*                  Devices, Inc.) to specific registers (see Table 40).
-*                  This is done in hmc7043LoadConfigUpd.
-*          Step 4: Program SYSREF timer, set divide ratio, set the pulse
-*                  generation mode configuration.
-*          Step 5: Program output channels.set divide ratio,channel start-up mode
-*                  coarse/analog delays and performance mode.
-*          Step 6: Ensure clock input signal is given to
-*                  CLKIN(to be done on hardware.
-*          Step 7: Issue a software restart to reset the system and initiate
-*                  calibration. Toggle the restart dividers/FSMs bit to 1 and
-*                  then back to 0.
-*          Step 8: Send a sync request via the SPI (set the reseed request bit)
-*                  to align the divider phases and send any initial pulse
-*                  generator stream.
-*          Step 9: Wait 6 SYSREF periods.
-*          Step 10: Confirm that the outputs have all reached their phases by
-*                   checking that the clock outputs phases status bit = 1.*
-*          Step 11: Initialize other devices in the system. SYSREF channels can
-*                   be either on asynchronous/dynamic and may turn on for pulse
-*                   generation stream.
-*          Step 12: Slave JESD204B devices in the system must be configured
-*                   to monitor the input SYSREF signal exported from the HMC7043
-*          Step 13: When all JESD204B slaves are powered and ready, send a
-*                   pulse generator request to send out a pulse generator
-*                   chain on any SYSREF channels programmed for pulse
-*                   generator mode.
+* - description: queues the request for the device's executor thread, urgent
+*                requests (SYSREF and slip ones, ref. HMC7043_ASYNC_OP) being
+*                performed ahead of any normal ones, and each class in order
+*
+* - notes: 1) Does not block, i.e. may be called from real-time threads.
+*          2) Requests of different classes that depend on each other should
+*             only be posted after the completion of the former.
+*          3) *pToken must remain valid until completion.
 *******************************************************************************/
-LOCAL STATUS hmc7043AppInitAppSup(CKDST_DEV dev,
-                                  const Hmc7043_app_dev_params *pParams)
+EXPORT STATUS hmc7043PostAsync(CKDST_DEV dev, const Hmc7043_async_req *pReq,
+                               HMC7043_ASYNC_DONE *pDone, UINT64 arg,
+                               Hmc7043_async_token *pToken)
 {
-	const Hmc7043_app_dev_ctl *pCtl;
-	Hmc7043_reg_image *pImg;
-	unsigned i;
-	Bool r65Done = FALSE, clkOutPhase = FALSE;
+    Hmc7043_async_dev_ctl *pCtl;
+    Utl_ring *pRing;
+    Hmc7043_async_msg *pMsg;
+    const UINT8 bell = 0;
+    UINT32 pos;
+    UTL_Q_STAT stat;
+
+    if (!hmc7043DevPresent(dev) || !pReq ||
+        !inEnumRange(pReq->op, HMC7043_AOP_NOPS)) {
+        hmc7043Log("bad argument(s) (dev %d, pReq %d, op %d)", dev,
+                   pReq != NULL, pReq ? (int) pReq->op : -1);
+        return ERROR;
+    }
 
-	if (!inEnumRange(dev, NELEMENTS(hmc7043AppState.devState)) || !pParams) {
-	    sysLog("bad argument(s) (dev %d, pParams %d)", dev, pParams != NULL);
-	    return ERROR;
-	}
+    pCtl = hmc7043AsyncCtl.pDevCtl[dev];
 
-	pCtl = hmc7043AppCtl.devCtl + dev;
+    if (pCtl->hBell == UTL_QUEUE_BAD_HQUEUE) {
+        hmc7043Log("asynchronous mode not started (dev %d)", dev);
+        return ERROR;
+    }
 
-	pImg = &hmc7043AppState.devState[dev].regImage;
+    pRing = pReq->op < HMC7043_AOP_OUT_CH_EN_DIS ? &pCtl->urgent :
+                                                   &pCtl->normal;
 
-	if (!hmc7043IfCtl.initDone || !hmc7043AppCtl.initDone || !pCtl->initDone) {
-	    sysLog("initialization not done yet (dev %d, init. done %d,%d,%d)", dev,
-	            hmc7043IfCtl.initDone, hmc7043AppCtl.initDone, pCtl->initDone);
+    if ((pMsg = utlRingReserve(pRing, &pos)) == NULL) {
+        hmc7043Log("too many requests pending (dev %d, op %d)", dev, pReq->op);
         return ERROR;
     }
-	/* Issue software restart to reset system */
-	if(hmc7043ToggleBit(dev,HMC7043_REG_IDX_SOFT_RESET, HMC7043_SFT_RST_BIT,
-					200) != OK)
-		return ERROR;
 
-	if(hmc7043CfgGpio(dev, pParams) != OK)
-		return ERROR;
+    pMsg->req    = *pReq;
+    pMsg->pDone  = pDone;
+    pMsg->arg    = arg;
+    pMsg->pToken = pToken;
 
-	if(hmc7043CfgSdataMode(dev, pParams) != OK)
-		return ERROR;
+    if (pToken) {
+        pToken->status = ERROR;
+        /* (ordered with respect to the executor by the commit) */
+        sysAtomicStoreRelaxed(&pToken->done, FALSE);
+    }
 
-	/* Set sysref timer */
-	if(hmc7043AppInitPgmSysrefTimer(dev, pParams) != OK)
-		return ERROR;
+    utlRingCommit(pRing, pos);
 
-	/* Program Pulse generator mode */
-    if(hmc7043AppInitPgmPlGnMd(dev, pParams) != OK)
-    	return ERROR;
+    if (utlQueuePut(pCtl->hBell, &bell, sizeof(bell), &stat) != OK) {
+        sysCodeError(CODE_ERR_STATE, hmc7043PostAsync, dev, pReq->op, stat);
+        return ERROR;
+    }
 
-    /* Program output channels */
-    if(hmc7043AppInitPgmOutCh(dev, pParams) != OK)
-    	return ERROR;
+    return OK;
+}
 
-    /* Program Input CLK/RFSYNC */
-    if(hmc7043AppInitPgmInCh(dev, pParams) != OK)
-    	return ERROR;
 
-    /* Software shall set register 0x0064 bit 0 if
-     *  input clock frequency is < 1 GHz. */
-    if(pParams->clkInFreq < 1000000000LL) {
-    	pImg->r64.fields.lfClkInp = 0;
-    }
 
-    /* Software shall set register 0x0065 bit 0 to 0,
-     * except if no output channel is using analog delay. */
-    for(i = 0; i < HMC7043_OUT_NCHAN; i++) {
-    	if(pParams->chSup[i].aDlyPs > 0) {
-    		pImg->r65.fields.aDelLowPowMo = 0;
-    		r65Done = TRUE;
-    		break;
-    	}
-    }
-    if(!r65Done)
-    	pImg->r65.fields.aDelLowPowMo = 1;
 
-    /* Software shall set register 0x0001 bit 6 (high performance
-     * distribution path) in all cases */
-    pImg->r01.fields.highPrfPath = 1;
+/*******************************************************************************
+* - name: hmc7043AsyncDone
+*
+* - title: poll an asynchronous service request's completion
+*
+* - input: pToken - completion token passed to hmc7043PostAsync
+*
+* - output: *pStatus (if completed; may be NULL)
+*
+* - returns: TRUE if the request has been completed, otherwise FALSE
+*******************************************************************************/
+EXPORT Bool hmc7043AsyncDone(const Hmc7043_async_token *pToken,
+                             STATUS *pStatus)
+{
+    if (!pToken || !sysAtomicLoadAcq(&pToken->done))
+        return FALSE;
+
+    if (pStatus)
+        *pStatus = pToken->status;
+
+    return TRUE;
+}
+
+
+
+
+/*#############################################################################*
+*                           S T A T I S T I C S                                *
+*#############################################################################*/
+/*******************************************************************************
+* - name: hmc7043StatsOp
+*
+* - title: account for a completed service call
+*
+* - input: dev    - CLKDST device the service was called for
+*          op     - the service
+*          t0     - sysTimeNsec when the service started
+*          status - status returned from the service
+*
+* - output: hmc7043StatsCtl.pDevStats[dev]->ops[op]
+*
+* - description: as above, the latency histogram bin being the number of
+*                significant bits of the latency in usec (ref.
+*                HMC7043_STATS_NBINS)
+*******************************************************************************/
+LOCAL void hmc7043StatsOp(CKDST_DEV dev, HMC7043_SERV_OP op, SYS_TIME_NS t0,
+                          STATUS status)
+{
+    Hmc7043_op_stats_ctl *pStats;
+    UINT64 nsec = sysTimeNsec() - t0, usec = nsec / 1000;
+    unsigned bin = usec ? 64 - __builtin_clzll(usec) : 0;
 
-    /* Write the changes to registers */
-    if (hmc7043AppInitWrRegs(dev) != OK)
-        return ERROR;
+    if (!hmc7043DevPresent(dev) || !inEnumRange(op, HMC7043_SOP_NOPS))
+        return;
 
-    /* Issue software restart to reset system and start calibration */
-    if(hmc7043ToggleBit(dev, HMC7043_REG_IDX_SOFT_RESET, HMC7043_SFT_RST_BIT,
-    		         200) != OK)
-    	return ERROR;
+    pStats = hmc7043StatsCtl.pDevStats[dev]->ops + op;
 
-    /*Toggle the restart dividers/FSMs bit to 1 and then back to 0.*/
-    if(hmc7043ToggleBit(dev,HMC7043_REG_IDX_REQ_MOD, HMC7043_FSM_DIV_RESET_BIT,
-    		        100) != OK)
-    	return ERROR;
+    sysAtomicAddRelaxed(&pStats->nCalls, 1);
+    if (status != OK)
+        sysAtomicAddRelaxed(&pStats->nErrors, 1);
+    sysAtomicAddRelaxed(&pStats->totalNsec, nsec);
+    hmc7043StatsMax(&pStats->maxNsec, nsec);
+    sysAtomicAddRelaxed(&pStats->hist[min(bin, HMC7043_STATS_NBINS - 1)], 1);
+}
 
-    /* Send a sync request via the SPI (set the reseed request bit) */
-    if(hmc7043ToggleBit(dev, HMC7043_REG_IDX_REQ_MOD, HMC7043_RESEED_BIT, 100)
-    		!= OK)
-    	return ERROR;
 
-    /* Send any initial Pulse generator stream */
-    if(hmc7043ToggleBit(dev, HMC7043_REG_IDX_REQ_MOD, HMC7043_PULS_GEN_BIT, 100)
-    		             != OK)
-    	return ERROR;
 
-    /* Wait for 6xSYSREF period */
-    if(hmc7043WaitSysrefPeriod(dev, HMC7043_INIT_WAIT_TIMES) != OK)
-    	return ERROR;
 
-    /* Check if clock output phase is set*/
-    if(hmc7043GetClkOutPhase(dev, clkOutPhase) != OK)
-    	return ERROR;
+/*******************************************************************************
+* - name: hmc7043GetStats
+*
+* - title: get the driver statistics of a device
+*
+* - input: dev - CLKDST device for which to perform the operation
+*
+* - output: *pStats
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above (each counter being read atomically, though not all
+*                of these together)
+*******************************************************************************/
+EXPORT STATUS hmc7043GetStats(CKDST_DEV dev, Hmc7043_dev_stats *pStats)
+{
+    const UINT64_ATOMIC *pSrc;
+    UINT64 *pDst = (UINT64 *) pStats;
+    unsigned i;
 
-    if(!clkOutPhase)
-    	return ERROR; // TBD : need to confirm what has to be done.
+    if (!hmc7043DevPresent(dev) || !pStats) {
+        sysLog("bad argument(s) (dev %d, pStats %d)", dev, pStats != NULL);
+        return ERROR;
+    }
 
-    /* After completed the initialization sequence, software shall
-     * disable SYNC on all channels. */
-    if(hmc7043DisSync(dev, pParams) != OK)
-    	return ERROR;
+    /* (relying on both being arrays of UINT64 counters, ref.
+       Hmc7043_dev_stats_chk) */
+    pSrc = (const UINT64_ATOMIC *) hmc7043StatsCtl.pDevStats[dev];
 
-    /* Application to call hmc7043SysrefSwPulseN when all slaves are ready */
+    for (i = 0; i < sizeof(*pStats) / sizeof(UINT64); ++i)
+        pDst[i] = sysAtomicLoadRelaxed(pSrc + i);
 
     return OK;
 }
@@ -4468,68 +9598,151 @@ LOCAL STATUS hmc7043AppInitAppSup(CKDST_DEV dev,
 
 
 /*******************************************************************************
-* - name: hmc7043AppInitDevAct
+* - name: hmc7043ResetStats
 *
-* - title: actually initialize a CLKDST device
+* - title: reset the driver statistics of a device
 *
-* - input: dev     - CLKDST device for which to perform the operation
-*          pParams - pointer to device setup parameters
+* - input: dev - CLKDST device for which to perform the operation
 *
-* - output: hmc7043AppState.devState[dev]
+* - output: *hmc7043StatsCtl.pDevStats[dev]
 *
 * - returns: OK or ERROR if detected an error
 *
 * - description: as above
-*
-* - notes: 1) This routine can be called more than once (for a device).
-*          2) It is assumed that hmc7043AppCtl.devCtl[dev] has already been setup.
-*          3) Not attempting to interlock the programming sequence here - if such
-*             interlocking is necessary, it must be provided by the caller.
 *******************************************************************************/
-LOCAL STATUS hmc7043AppInitDevAct(CKDST_DEV dev,
-                                  const Hmc7043_app_dev_params *pParams)
+EXPORT STATUS hmc7043ResetStats(CKDST_DEV dev)
 {
-    Hmc7043_app_dev_state *pState;
+    UINT64_ATOMIC *pCnt;
+    unsigned i;
 
-    /* initialize */
-    if (!inEnumRange(dev, NELEMENTS(hmc7043AppCtl.devCtl)) || !pParams) {
-        sysLog("bad argument(s) (dev %d, pParams %d)", dev, pParams != NULL);
+    if (!hmc7043DevPresent(dev)) {
+        sysLog("bad argument (dev %d)", dev);
         return ERROR;
     }
 
-    pState = hmc7043AppState.devState + dev;
+    pCnt = (UINT64_ATOMIC *) hmc7043StatsCtl.pDevStats[dev];
 
-    if (!hmc7043AppCtl.initDone) {
-        sysLog("control data initialization not done yet (dev %d)", dev);
-        return ERROR;
-    }
+    for (i = 0; i < sizeof(Hmc7043_dev_stats) / sizeof(UINT64); ++i)
+        sysAtomicStoreRelaxed(pCnt + i, 0);
 
-    /* verify the expected device id(s) */
-    if (hmc7043AppChkProdId(dev) != OK)
-        return ERROR;
+    return OK;
+}
 
-    memset(pState, 0, sizeof(*pState));
 
-    /* Load configuration update to register as in Table-40 of data sheet */
-    if(hmc7043LoadConfigUpd(dev) != OK)
-    	return ERROR;
 
-    if(hmc7043AppInitReservedReg(dev) != OK)
-    	return ERROR;
 
-   if(hmc7043AppInitReservdFields(dev) != OK)
-    	return ERROR;
+/*******************************************************************************
+* - name: hmc7043StatsDump
+*
+* - title: log the driver statistics of all devices
+*
+* - description: logs (via sysLogInfo) the utilization and grant waits of each
+*                of the arbitrated buses and the statistics of each of the
+*                devices in use, omitting services that have not been called
+*
+* - notes: used as the periodic dump iteration (ref. hmc7043StartStatsDump)
+*******************************************************************************/
+LOCAL void hmc7043StatsDump(void)
+{
+    static const char *const OP_NAMES[HMC7043_SOP_NOPS] = {
+        "InitDev", "OutChEnDis", "ChSyncDis", "SetSysrefMode",
+        "SysrefSwPulseN", "ChDoSlip", "ClearAlarms", "ReconfigDev",
+        "ChSetDelay"
+    };
+
+    Hmc7043_dev_stats stats;
+    Hmc7043_bus_stats busStats;
+    CKDST_DEV dev;
+    CKDST_BUS bus;
+    unsigned op;
+
+    for (bus = 0; bus < NELEMENTS(hmc7043BusCtl.busCtl); ++bus) {
+        const UINT64 *pWait = busStats.maxWaitNsec;
+
+        if (!sysAtomicLoadRelaxed(&hmc7043BusCtl.busCtl[bus].enabled) ||
+            hmc7043GetBusStats(bus, &busStats) != OK)
+            continue;
+
+        sysLogLongInfo("bus %ld: utilization %ld ppm, grants %lu/%lu/%lu, "
+                       "max wait %lu/%lu/%lu usec", (long) bus,
+                       (long) (busStats.busyNsec * 1000000.0 /
+                               max(busStats.atNsec - busStats.sinceNsec, 1)),
+                       busStats.nGrants[HMC7043_BPRI_URGENT],
+                       busStats.nGrants[HMC7043_BPRI_NORMAL],
+                       busStats.nGrants[HMC7043_BPRI_BACKGROUND],
+                       pWait[HMC7043_BPRI_URGENT] / 1000,
+                       pWait[HMC7043_BPRI_NORMAL] / 1000,
+                       pWait[HMC7043_BPRI_BACKGROUND] / 1000);
+    }
+
+    CKDST_FOR_EACH_DEV(dev, hmc7043IfCtl.devMask) {
+        if (hmc7043GetStats(dev, &stats) != OK)
+            continue;
+
+        sysLogLongInfo("dev %ld: xfers %lu/%lu, regs %lu/%lu, errors %lu",
+                       (long) dev, stats.nReads, stats.nWrites, stats.nRegsRead,
+                       stats.nRegsWritten, stats.nXferErrors);
+        sysLogLongInfo("dev %ld: xfer %lu usec, CS %lu (wait %lu/%lu usec)",
+                       (long) dev, stats.xferNsec / 1000, stats.nCsEnters,
+                       stats.csWaitNsec / 1000, stats.csMaxWaitNsec / 1000);
+        sysLogLongInfo("dev %ld: shadow reads %lu, scrub mismatches %lu",
+                       (long) dev, stats.nShadowReads, stats.nScrubMismatches);
+
+        for (op = 0; op < HMC7043_SOP_NOPS; ++op) {
+            const Hmc7043_op_stats *pOp = stats.ops + op;
+
+            if (!pOp->nCalls)
+                continue;
+
+            sysLogLongInfo("dev %ld: %s %lu (errors %lu, avg/max %lu/%lu usec)",
+                           (long) dev, OP_NAMES[op], pOp->nCalls, pOp->nErrors,
+                           pOp->totalNsec / pOp->nCalls / 1000,
+                           pOp->maxNsec / 1000);
+        }
+    }
+}
 
 
 
-    /* write initialization image to device registers */
-    if (hmc7043AppInitWrRegs(dev) != OK)
+
+/*******************************************************************************
+* - name: hmc7043StartStatsDump
+*
+* - title: start periodic logging of the driver statistics
+*
+* - input: period  - logging period (msec)
+*          thrCode - thread code for the dump service thread
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: starts a periodic service thread that logs the statistics of
+*                all devices (ref. hmc7043StatsDump)
+*
+* - notes: to be called at most once (after hmc7043IfInit)
+*******************************************************************************/
+EXPORT STATUS hmc7043StartStatsDump(SYS_TIME period, unsigned thrCode)
+{
+    static const UINT32 STACK_SIZE = 0x10000;  /* more than enough */
+
+    Sys_thread_per_serv_args args = {(FUNCPTR) hmc7043StatsDump, STACK_SIZE,
+                                     period, TRUE};
+
+    if (!period) {
+        sysLog("bad argument (period %u)", (unsigned) period);
         return ERROR;
+    }
 
-    pState->regImage.initDone = TRUE;
+    if (!hmc7043IfCtl.initDone) {
+        sysLog("interface not initialized yet");
+        return ERROR;
+    }
 
-    if (hmc7043AppInitAppSup(dev, pParams) != OK)
+    if (sysThreadCreatePerServ(thrCode, 0, &args) != OK) {
+        sysLog("statistics dump thread creation failed (thrCode %u)", thrCode);
         return ERROR;
+    }
+
+    sysAtomicStoreRel(&hmc7043IfCtl.bgStarted, TRUE);
 
     return OK;
 }
@@ -4537,185 +9750,118 @@ LOCAL STATUS hmc7043AppInitDevAct(CKDST_DEV dev,
 
 
 
+/*#############################################################################*
+*                    R E G I S T E R    A C C E S S    T R A C E               *
+*#############################################################################*/
 /*******************************************************************************
-* - name: hmc7043AppInitDev
+* - name: hmc7043GetTrace
 *
-* - title: initialize a specific CLKDST device
+* - title: get the latest register transfers of a device
 *
-* - input: dev      - CLKDST device for which to perform the operation
-*          pParams  - device setup parameters
-*          warmInit - if set, will skip actual device initialization
+* - input: dev        - CLKDST device for which to perform the operation
+*          maxEntries - maximum number of entries to return
 *
-* - output: hmc7043AppCtl.devCtl[dev] (indirectly), hmc7043AppState.devState[dev]
+* - output: entries[0 .. *pNentries - 1] (oldest first), *pNentries
 *
 * - returns: OK or ERROR if detected an error
 *
-* - description: sets up and initializes the PLL device per the application's
-*                requirements
+* - description: copies the entries out of the device's trace ring without
+*                locking, then drops any of these that the owner of the
+*                device's critical section may have been overwriting meanwhile
+*                (i.e. fewer than maxEntries may be returned for a busy device)
 *
-* - notes: 1) This routine can be called more than once (for a device).
-*          2) The operation is interlocked via the associated critical section.
+* - notes: may be called from any context, also while a service is stuck
+*          holding the critical section
 *******************************************************************************/
-STATUS hmc7043AppInitDev(CKDST_DEV dev, const Hmc7043_app_dev_params *pParams,
-		                       Bool warmInit)
+EXPORT STATUS hmc7043GetTrace(CKDST_DEV dev, Hmc7043_trace_entry entries[],
+                              unsigned maxEntries, unsigned *pNentries)
 {
-    STATUS status = OK;  /* initial assumption */
-
-    if (!inEnumRange(dev, NELEMENTS(hmc7043AppCtl.devCtl)) || !pParams) {
-        sysLog("bad argument(s) (dev %d, pParams %d)", dev, pParams != NULL);
+    const Hmc7043_trace_ring *pRing;
+    UINT32 head, first, nLost;
+    unsigned i, n;
+
+    if (!hmc7043DevPresent(dev) || !entries ||
+        !pNentries) {
+        sysLog("bad argument(s) (dev %d, entries %d, pNentries %d)", dev,
+               entries != NULL, pNentries != NULL);
         return ERROR;
     }
 
-    if (!hmc7043IfCtl.initDone || !hmc7043AppCtl.initDone) {
-        sysLog("interface not initialized yet (dev %d, init. done %d,%d)", dev,
-               hmc7043IfCtl.initDone, hmc7043AppCtl.initDone);
-        return ERROR;
-    }
+    pRing = hmc7043TraceCtl.pDevRing[dev];
 
-    hmc7043CsEnter(dev, __FUNCTION__);
+    head  = sysAtomicLoadAcq(&pRing->head);
+    n     = min(min(maxEntries, HMC7043_TRACE_NENTRIES), head);
+    first = head - n;
 
-    /* in particular this sets .nsecCmdAt, .freq to zeros */
-    memset(&hmc7043AppState.devState[dev], 0,
-           sizeof(hmc7043AppState.devState[dev]));
+    for (i = 0; i < n; ++i)
+        entries[i] = pRing->entries[(first + i) & (HMC7043_TRACE_NENTRIES - 1)];
 
-    if (hmc7043AppSetUpDevCtl(dev, pParams) != OK)
-        status = ERROR;
+    /* entries from first up to (as of now) the one being written may have
+       been overwritten */
+    sysAtomicFenceAcq();
+    head = sysAtomicLoadRelaxed(&pRing->head);
 
-    if (!warmInit) {
-        if (hmc7043AppInitDevAct(dev, pParams) != OK)
-            status = ERROR;
-    } else {
-        if (hmc7043AppInitRdRegs(dev) != OK)
-            status = ERROR;
-    }
+    nLost = head - first > HMC7043_TRACE_NENTRIES - 1 ?
+            head - first - (HMC7043_TRACE_NENTRIES - 1) : 0;
 
-    hmc7043CsExit(dev, __FUNCTION__);
+    if (nLost >= n)
+        n = 0;
+    else if (nLost) {
+        n -= nLost;
+        memmove(entries, entries + nLost, n * sizeof(entries[0]));
+    }
 
-    return status;
+    *pNentries = n;
+    return OK;
 }
 
 
 
 
-/*#############################################################################*
-*                    A D D I T I O N A L    S E R V I C E S                    *
-*#############################################################################*/
 /*******************************************************************************
-* - name: hmc7043OutChEnDis
-*
-* - title: Enable/Disable a particular output channel for a particular device.
+* - name: hmc7043TraceDump
 *
-* - input: dev      - CLKDST device on which operation is performed.
-*          iCh      - channel to be enabled or disabled.
-*          enable   - True value enables channel, false value disables channel
+* - title: log the latest register transfers of a device
 *
-* - output: hmc7043AppState.devState[dev].regImage
+* - input: dev      - CLKDST device for which to perform the operation
+*          nEntries - maximum number of entries to log
+*          raw      - if set, will dump the entries as they are (via utlByteDump)
 *
 * - returns: OK or ERROR if detected an error
 *
-* - description: as above
+* - description: logs (unconditionally) the entries returned by hmc7043GetTrace,
+*                oldest first, each with its age relative to the latest one
 *
-* - notes: the operation is interlocked via the associated critical section
+* - notes: to be called on demand, e.g. via the debug server (ref.
+*          sysDbgSrvInit)
 *******************************************************************************/
-EXPORT STATUS hmc7043OutChEnDis(CKDST_DEV dev, unsigned iCh, Bool enable)
+EXPORT STATUS hmc7043TraceDump(CKDST_DEV dev, unsigned nEntries, Bool raw)
 {
-	const Hmc7043_app_dev_ctl *pCtl;
-	Hmc7043_reg_image *pImg;
-	STATUS status;
+    Hmc7043_trace_entry entries[HMC7043_TRACE_NENTRIES];
+    unsigned i, n;
 
-	if (!inEnumRange(dev, NELEMENTS(hmc7043AppCtl.devCtl)) ||
-			iCh < HMC7043_CH_OUT_MIN || iCh > HMC7043_CH_OUT_MAX) {
-		sysLog("bad argument(s) (dev %d), iCh %d", dev, iCh);
-		return ERROR;
-	}
+    if (hmc7043GetTrace(dev, entries, nEntries, &n) != OK)
+        return ERROR;
 
-	pCtl = hmc7043AppCtl.devCtl + dev;
-	pImg = &hmc7043AppState.devState[dev].regImage;
+    sysLog("dev %d: %u register transfer(s)", dev, n);
 
-	if(!hmc7043IfCtl.initDone || !hmc7043AppCtl.initDone || !pCtl->initDone) {
-		sysLog("initialization not done yet (dev %d, init. done %d,%d,%d)",
-		        dev, hmc7043IfCtl.initDone, hmc7043AppCtl.initDone,
-				pCtl->initDone);
-		return ERROR;
-	}
+    if (raw)
+        return n ? utlByteDump(entries, n * sizeof(entries[0]),
+                               sizeof(entries[0])) : OK;
 
-	hmc7043CsEnter(dev, __FUNCTION__);
-    switch(iCh) {
-		case 0: {
-			pImg->rc8.fields.chEn_0 = enable ? 1 : 0;
-			status = hmc7043LliRegWrite(dev, 0xca, pImg->rca.all);
-			break;
-		}
-		case 1: {
-			pImg->rd2.fields.chEn_1 = enable ? 1 : 0;
-			status = hmc7043LliRegWrite(dev, 0xd2, pImg->rd2.all);
-			break;
-		}
-		case 2: {
-			pImg->rdc.fields.chEn_2 = enable ? 1 : 0;
-			status = hmc7043LliRegWrite(dev, 0xdc, pImg->rdc.all);
-			break;
-		}
-		case 3: {
-			pImg->re6.fields.chEn_3 = enable ? 1 : 0;
-			status = hmc7043LliRegWrite(dev, 0xe6, pImg->re6.all);
-			break;
-		}
-		case 4: {
-			pImg->rf0.fields.chEn_4 = enable ? 1 : 0;
-			status = hmc7043LliRegWrite(dev, 0xf0, pImg->rf0.all);
-			break;
-		}
-		case 5: {
-			pImg->rfa.fields.chEn_5 = enable ? 1 : 0;
-			status = hmc7043LliRegWrite(dev, 0xfa, pImg->rfa.all);
-			break;
-		}
-		case 6: {
-			pImg->r104.fields.chEn_6 = enable ? 1 : 0;
-			status = hmc7043LliRegWrite(dev, 0x104, pImg->r104.all);
-			break;
-		}
-		case 7: {
-			pImg->r10e.fields.chEn_7 = enable ? 1 : 0;
-			status = hmc7043LliRegWrite(dev, 0x10e, pImg->r10e.all);
-			break;
-		}
-		case 8: {
-			pImg->r118.fields.chEn_8 = enable ? 1 : 0;
-			status = hmc7043LliRegWrite(dev, 0x118, pImg->r118.all);
-			break;
-		}
-		case 9: {
-			pImg->r122.fields.chEn_9 = enable ? 1 : 0;
-			status = hmc7043LliRegWrite(dev, 0x122, pImg->r122.all);
-			break;
-		}
-		case 10: {
-			pImg->r12c.fields.chEn_10 = enable ? 1 : 0;
-			status = hmc7043LliRegWrite(dev, 0x12c, pImg->r12c.all);
-			break;
-		}
-		case 11: {
-			pImg->r136.fields.chEn_11 = enable ? 1 : 0;
-			status = hmc7043LliRegWrite(dev, 0x136, pImg->r136.all);
-			break;
-		}
-		case 12: {
-			pImg->r140.fields.chEn_12 = enable ? 1 : 0;
-			status = hmc7043LliRegWrite(dev, 0x140, pImg->r140.all);
-			break;
-		}
-		case 13: {
-			pImg->r14a.fields.chEn_13 = enable ? 1 : 0;
-			status = hmc7043LliRegWrite(dev, 0x14a, pImg->r14a.all);
-			break;
-		}
-    }
-    hmc7043CsExit(dev, __FUNCTION__);
+    for (i = 0; i < n; ++i) {
+        const Hmc7043_trace_entry *pEntry = entries + i;
+        char op[16];
 
-	if (status != OK)
-		return ERROR;
+        snprintf(op, sizeof(op), "%s x%u%s",
+                 pEntry->flags & HMC7043_TRF_READ ? "rd" : "wr", pEntry->nRegs,
+                 pEntry->flags & HMC7043_TRF_ERROR ? " FAILED" : "");
+
+        sysLogLong("%4ld: -%ld nsec %s 0x%03lx (0x%02lx) from %s", (long) i,
+                   (long) (entries[n - 1].nsecAt - pEntry->nsecAt), op,
+                   (long) pEntry->regInx, (long) pEntry->data,
+                   pEntry->context ? pEntry->context : "???");
+    }
 
     return OK;
 }
@@ -4724,402 +9870,538 @@ EXPORT STATUS hmc7043OutChEnDis(CKDST_DEV dev, unsigned iCh, Bool enable)
 
 
 /*******************************************************************************
-* - name: hmc7043GetAlarms
+* - name: hmc7043TraceDumpAll
 *
-* - title: Retrieve all alarm status from alarm read back register 0x7d
+* - title: log the latest register transfers of all devices
 *
-* - input: dev      - CLKDST device on which operation is performed.
-*          pAlarms  - out parameter that has all alarm status
+* - input: nEntries - maximum number of entries to log per device
 *
-* - output: *pAlarms
+* - description: hmc7043TraceDump for each of the devices in use that has been
+*                accessed at all
+*******************************************************************************/
+EXPORT void hmc7043TraceDumpAll(unsigned nEntries)
+{
+    CKDST_DEV dev;
+
+    CKDST_FOR_EACH_DEV(dev, hmc7043IfCtl.devMask) {
+        if (sysAtomicLoadRelaxed(&hmc7043TraceCtl.pDevRing[dev]->head))
+            hmc7043TraceDump(dev, nEntries, FALSE);
+    }
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043TraceCodeErrHook
 *
-* - returns: OK or ERROR if detected an error
+* - title: sysCodeErr hook dumping the register access traces
 *
-* - description: as above.
+* - input: errorId, pFunc, funcName, auxData1 .. auxData3 - as passed to
+*          sysCodeErr
+*
+* - description: as above (ref. hmc7043TraceHookCodeErr)
 *******************************************************************************/
-EXPORT STATUS hmc7043GetAlarms(CKDST_DEV dev, Hmc7043_dev_alarms *pAlarms)
+LOCAL void hmc7043TraceCodeErrHook(CODE_ERROR_ID errorId, FUNCPTR,
+                                   const char *funcName, UINT64, UINT64, UINT64)
 {
-	const Hmc7043_app_dev_ctl *pCtl;
-	Hmc7043_reg_x007d r7d;
+    static const unsigned N_ENTRIES = 32;  /* the latest transfers only */
 
+    sysLogLong("code error %ld in %s, register access traces follow",
+               (long) errorId, funcName ? funcName : "???");
 
-	if (!inEnumRange(dev, NELEMENTS(hmc7043AppCtl.devCtl)) ||
-			!pAlarms) {
-		sysLog("bad argument(s) (dev %d), pAlarms %d", dev, (pAlarms != NULL));
-		return ERROR;
-	}
+    hmc7043TraceDumpAll(N_ENTRIES);
+}
 
-	pCtl = hmc7043AppCtl.devCtl + dev;
 
-	if(!hmc7043IfCtl.initDone || !hmc7043AppCtl.initDone || !pCtl->initDone) {
-		sysLog("initialization not done yet (dev %d, init. done %d,%d,%d)",
-				dev, hmc7043IfCtl.initDone, hmc7043AppCtl.initDone,
-				pCtl->initDone);
-		return ERROR;
-	}
 
-	if (hmc7043LliRegRead(dev, 0x7d, &r7d.all) != OK)
-	    return ERROR;
 
-	if(r7d.fields.srSynSt)
-	    pAlarms->srefSync = TRUE;
-	else
-		pAlarms->srefSync = FALSE;
+/*******************************************************************************
+* - name: hmc7043TraceHookCodeErr
+*
+* - title: have the register access traces dumped on code errors
+*
+* - returns: OK
+*
+* - description: installs hmc7043TraceCodeErrHook as the sysCodeErr application
+*                hook
+*
+* - notes: an application having a hook of its own should rather call
+*          hmc7043TraceDumpAll from that one
+*******************************************************************************/
+EXPORT STATUS hmc7043TraceHookCodeErr(void)
+{
+    sysCodeErrSetAppHook(hmc7043TraceCodeErrHook);
+    return OK;
+}
 
-	if(r7d.fields.ckOutPhSt)
-		pAlarms->cksPhase = TRUE;
-	else
-		pAlarms->cksPhase = FALSE;
 
-	if(r7d.fields.synReqSt)
-	    pAlarms->syncReq = TRUE;
-	else
-		pAlarms->syncReq = FALSE;
 
-    return OK;
+
+/*#############################################################################*
+*                 I N I T I A L I Z A T I O N    P R O F I L E                 *
+*#############################################################################*/
+/* output buffer of hmc7043InitProfileJson */
+typedef struct {
+    char *buf;
+    size_t size, len;  /* len - as if it all fitted */
+} Hmc7043_json_out;
+
+/*******************************************************************************
+* - name: hmc7043InitPhaseName
+*
+* - title: get the name of an initialization phase
+*
+* - input: phase - the phase
+*
+* - returns: the name (as used in the hmc7043InitProfileJson timeline), "???"
+*            if phase is invalid
+*******************************************************************************/
+EXPORT const char *hmc7043InitPhaseName(HMC7043_INIT_PHASE phase)
+{
+    static const char *const PHASE_NAMES[HMC7043_IPH_NPHASES] = {
+        "lli_init", "set_up", "prod_id", "build_image", "soft_reset",
+        "write_image", "restart", "sync_wait", "reseed", "sysref_wait",
+        "phase_wait", "sync_dis", "warm_restore"
+    };
+
+    return inEnumRange(phase, HMC7043_IPH_NPHASES) ? PHASE_NAMES[phase] : "???";
 }
 
 
 
 
 /*******************************************************************************
-* - name: hmc7043GetAlarm
+* - name: hmc7043GetInitProfile
 *
-* - title: Get alarm status for a particular device.
+* - title: get the profile of a device's latest (re)initialization
 *
-* - input: dev   - CLKDST device on which operation is performed.
-*          pAlarm - out parameter having alarm status written.
+* - input: dev - CLKDST device for which to perform the operation
 *
-* - output: *pAlarm
+* - output: *pProf
 *
-* - returns: OK or ERROR if detected an error
+* - returns: OK or ERROR if detected an error (in particular if the device has
+*            not been initialized yet)
 *
-* - description: as above
+* - description: returns the start and end time and the number of register
+*                transfers of each of the initialization phases (ref.
+*                HMC7043_INIT_PHASE) the latest hmc7043InitDev* (or
+*                hmc7043ReconfigDev reinitializing the device) went through;
+*                the phases not reached have all zeros, a failed one has
+*                startNsec set only
+*
+* - notes: the operation is interlocked via the associated critical section,
+*          i.e. waits for an initialization in progress
 *******************************************************************************/
-EXPORT STATUS hmc7043GetAlarm(CKDST_DEV dev, Bool *pAlarm)
+EXPORT STATUS hmc7043GetInitProfile(CKDST_DEV dev, Hmc7043_init_profile *pProf)
 {
-	const Hmc7043_app_dev_ctl *pCtl;
-	Hmc7043_reg_x007b r7b;
+    if (!hmc7043DevPresent(dev) || !pProf) {
+        sysLog("bad argument(s) (dev %d, pProf %d)", dev, pProf != NULL);
+        return ERROR;
+    }
 
+    if (!hmc7043IfCtl.devCtl[dev].initDone) {
+        sysLog("device not initialized yet (dev %d)", dev);
+        return ERROR;
+    }
 
-	if (!inEnumRange(dev, NELEMENTS(hmc7043AppCtl.devCtl)) ||
-			!pAlarm) {
-		sysLog("bad argument(s) (dev %d), pAlarm %d", dev, (pAlarm != NULL));
-		return ERROR;
-	}
+    if (hmc7043CsEnter(dev, __FUNCTION__) != OK)
+        return ERROR;
 
-	pCtl = hmc7043AppCtl.devCtl + dev;
+    *pProf = hmc7043ProfCtl.pDevProf[dev]->prof;
 
-	if(!hmc7043IfCtl.initDone || !hmc7043AppCtl.initDone || !pCtl->initDone) {
-		sysLog("initialization not done yet (dev %d, init. done %d,%d,%d)",
-				dev, hmc7043IfCtl.initDone, hmc7043AppCtl.initDone,
-				pCtl->initDone);
-		return ERROR;
-	}
+    hmc7043CsExit(dev, __FUNCTION__);
 
-	if (hmc7043LliRegRead(dev, 0x7b, &r7b.all) != OK)
-		return ERROR;
+    return pProf->startNsec ? OK : ERROR;
+}
 
-	if(r7b.fields.almSig)
-	    *pAlarm = TRUE;
-	else
-		*pAlarm = FALSE;
 
-    return OK;
+
+
+/*******************************************************************************
+* - name: hmc7043JsonPut
+*
+* - title: append formatted text to a JSON output buffer
+*
+* - input: pOut   - the buffer
+*          format - printf format, followed by its arguments
+*
+* - output: *pOut
+*
+* - description: as above, the text being truncated (and the buffer kept NUL
+*                terminated) once the buffer is full, while pOut->len still
+*                accounts for all of it
+*******************************************************************************/
+LOCAL void hmc7043JsonPut(Hmc7043_json_out *pOut, const char *format, ...)
+{
+    Bool room = pOut->len < pOut->size;
+    va_list args;
+    int n;
+
+    va_start(args, format);
+    n = vsnprintf(room ? pOut->buf + pOut->len : NULL,
+                  room ? pOut->size - pOut->len : 0, format, args);
+    va_end(args);
+
+    if (n > 0)
+        pOut->len += n;
 }
 
 
 
 
 /*******************************************************************************
-* - name: hmc7043ClearAlarms
+* - name: hmc7043InitProfileJson
 *
-* - title: Clear alarms for a particular device.
+* - title: format the initialization profiles of devices as a Chrome trace
 *
-* - input: dev   - CLKDST device on which operation is performed.
+* - input: devMask - CLKDST devices to include (those not initialized yet being
+*                    skipped)
+*          size    - size of buf (bytes)
 *
-* - output: hmc7043AppState.devState[dev].regImage
+* - output: buf[0 .. size - 1] (NUL terminated if size is not 0), *pLen
 *
 * - returns: OK or ERROR if detected an error
 *
-* - description: as above
-*
-* - notes: the operation is interlocked via the associated critical section
+* - description: formats the hmc7043GetInitProfile profiles in the Trace Event
+*                format (as loaded by chrome://tracing or Perfetto): a
+*                timeline (thread) per device, holding a complete event for
+*                the whole initialization and one for each phase gone through
+*                (with its transfer counts and - if not completed - "failed"
+*                in the event arguments), the timestamps being in usec since
+*                the earliest of the initializations included; as for
+*                snprintf, *pLen is set to the full length of the trace
+*                (without the NUL), i.e. it has been truncated if *pLen >= size
+*
+* - notes: the phases overlapping across the devices show where concurrent
+*          initialization (ref. hmc7043InitDevMulti) actually is concurrent
 *******************************************************************************/
-EXPORT STATUS hmc7043ClearAlarms(CKDST_DEV dev)
+EXPORT STATUS hmc7043InitProfileJson(CKDST_DEV_MASK devMask, char *buf,
+                                     size_t size, size_t *pLen)
 {
-	const Hmc7043_app_dev_ctl *pCtl;
-	Hmc7043_reg_image *pImg;
-	STATUS status = OK;
-
-	if (!inEnumRange(dev, NELEMENTS(hmc7043AppCtl.devCtl))) {
-		sysLog("bad argument(s) (dev %d)", dev);
-		return ERROR;
-	}
+    Hmc7043_init_profile profs[CKDST_MAX_NDEV];
+    Hmc7043_json_out out = {buf, size, 0};
+    CKDST_DEV_MASK profMask = 0;
+    UINT64 baseNsec = UINT64_MAX;
+    const char *sep = "";
+    CKDST_DEV dev;
+    unsigned phase;
+
+    if ((!buf && size) || !pLen) {
+        sysLog("bad argument(s) (buf %d, size %u, pLen %d)", buf != NULL,
+               (unsigned) size, pLen != NULL);
+        return ERROR;
+    }
 
-	pCtl = hmc7043AppCtl.devCtl + dev;
-	pImg = &hmc7043AppState.devState[dev].regImage;
+    if (size)
+        buf[0] = '\0';
 
-	if(!hmc7043IfCtl.initDone || !hmc7043AppCtl.initDone || !pCtl->initDone) {
-		sysLog("initialization not done yet (dev %d, init. done %d,%d,%d)",
-				dev, hmc7043IfCtl.initDone, hmc7043AppCtl.initDone,
-				pCtl->initDone);
-		return ERROR;
-	}
+    CKDST_FOR_EACH_DEV(dev, devMask & hmc7043IfCtl.devMask) {
+        if (!hmc7043IfCtl.devCtl[dev].initDone ||
+            hmc7043GetInitProfile(dev, profs + dev) != OK)
+            continue;
 
-	hmc7043CsEnter(dev, __FUNCTION__);
+        profMask |= CKDST_DEV_BIT(dev);
+        baseNsec = min(baseNsec, profs[dev].startNsec);
+    }
 
-	pImg->r06.fields.clrAlarms = 1;
-	status = hmc7043LliRegWrite(dev, 0x06, pImg->r06.all);
+    hmc7043JsonPut(&out, "{\"traceEvents\": [");
+
+    CKDST_FOR_EACH_DEV(dev, profMask) {
+        const Hmc7043_init_profile *pProf = profs + dev;
+
+        hmc7043JsonPut(&out, "%s\n{\"name\": \"thread_name\", \"ph\": \"M\", "
+                       "\"pid\": 0, \"tid\": %u, \"args\": {\"name\": "
+                       "\"hmc7043 dev %u\"}}", sep, dev, dev);
+        hmc7043JsonPut(&out, ",\n{\"name\": \"%s\", \"cat\": \"hmc7043\", "
+                       "\"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, "
+                       "\"pid\": 0, \"tid\": %u, \"args\": {\"status\": %d}}",
+                       pProf->warmInit ? "warm_init" : "init",
+                       (pProf->startNsec - baseNsec) / 1e3,
+                       (pProf->endNsec - pProf->startNsec) / 1e3, dev,
+                       pProf->status);
+        sep = ",";
+
+        for (phase = 0; phase < HMC7043_IPH_NPHASES; ++phase) {
+            const Hmc7043_init_phase_prof *pPhase = pProf->phases + phase;
+            UINT64 endNsec = pPhase->endNsec ? pPhase->endNsec : pProf->endNsec;
+
+            if (!pPhase->startNsec)
+                continue;
+
+            hmc7043JsonPut(&out, ",\n{\"name\": \"%s\", \"cat\": \"hmc7043\", "
+                           "\"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, "
+                           "\"pid\": 0, \"tid\": %u, \"args\": {\"xfers\": %u, "
+                           "\"regs\": %u%s}}", hmc7043InitPhaseName(phase),
+                           (pPhase->startNsec - baseNsec) / 1e3,
+                           (endNsec - pPhase->startNsec) / 1e3, dev,
+                           pPhase->nXfers, pPhase->nRegs,
+                           pPhase->endNsec ? "" : ", \"failed\": true");
+        }
+    }
 
-	hmc7043CsExit(dev, __FUNCTION__);
+    hmc7043JsonPut(&out, "\n]}\n");
 
-    return status;
+    *pLen = out.len;
+    return OK;
 }
 
 
 
 
+/*#############################################################################*
+*                             L O G G I N G                                    *
+*#############################################################################*/
+
 /*******************************************************************************
-* - name: hmc7043SetSysrefMode
+* - name: hmc7043LogOut
 *
-* - title: Set SYSREF pulse generation mode for a particular device.
+* - title: format a driver log message
 *
-* - input: dev     - CLKDST device on which operation is performed.
-*          mode    - Type of pulse generator mode
-*          nPulses - Number of pulses to be generated in case of pulsed mode
+* - input: pSite       - the message's call site
+*          args        - the message's arguments
+*          nSuppressed - number of the site's messages suppressed before
+*
+* - description: passes the message on to sysLogIntFun / sysLogLongFun
+*                (preceded by a note on the messages suppressed, if any)
+*******************************************************************************/
+LOCAL void hmc7043LogOut(const Hmc7043_log_site *pSite, const long args[],
+                         UINT32 nSuppressed)
+{
+    if (nSuppressed)
+        sysLogIntFun(pSite->level, pSite->context,
+                     "(%u more such messages suppressed)", nSuppressed);
+
+    if (pSite->isLong)
+        sysLogLongFun(pSite->level, pSite->context, pSite->format, args[0],
+                      args[1], args[2], args[3], args[4], args[5]);
+    else
+        sysLogIntFun(pSite->level, pSite->context, pSite->format,
+                     (int) args[0], (int) args[1], (int) args[2],
+                     (int) args[3], (int) args[4], (int) args[5]);
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043LogPost
 *
-* - output: hmc7043AppState.devState[dev].regImage
+* - title: log a driver message (ref. HMC7043_LOG_SITE)
 *
-* - returns: OK or ERROR if detected an error
+* - input: pSite - the message's call site
+*          nArgs - number of arguments (up to SYS_LOG_MAX_NARGS) following,
+*                  int-sized ones or, for long sites, long-sized ones
 *
-* - description: as above
+* - description: drops the message if the site exceeds the rate limit
+*                (counting it), else formats it right away, or records it for
+*                the log drain thread if in deferred mode
 *
-* - notes: the operation is interlocked via the associated critical section
+* - notes: Never blocks in deferred mode (a message not fitting in the ring
+*          being dropped and counted), i.e. costs a handful of atomic
+*          operations only.
 *******************************************************************************/
-EXPORT STATUS hmc7043SetSysrefMode(CKDST_DEV dev, HMC7043_SREF_MODE mode,
-                            HMC7043_SREF_NPULSES nPulses)
+LOCAL void hmc7043LogPost(Hmc7043_log_site *pSite, unsigned nArgs, ...)
 {
-	const Hmc7043_app_dev_ctl *pCtl;
-	Hmc7043_reg_image *pImg;
-	STATUS status = OK;
+    UINT32 maxPerSec = sysAtomicLoadRelaxed(&hmc7043LogCtl.maxPerSec);
+    long args[SYS_LOG_MAX_NARGS] = {0};
+    UINT32 nSuppressed = 0, pos;
+    Hmc7043_log_rec *pRec;
+    unsigned i;
+    va_list ap;
 
-	if (!inEnumRange(dev, NELEMENTS(hmc7043AppCtl.devCtl))) {
-		sysLog("bad argument(s) (dev %d)", dev);
-		return ERROR;
-	}
+    if (maxPerSec) {
+        SYS_TIME_NS now = sysTimeNsec();
+        UINT64 start = sysAtomicLoadRelaxed(&pSite->windowStart);
 
-	pCtl = hmc7043AppCtl.devCtl + dev;
-	pImg = &hmc7043AppState.devState[dev].regImage;
+        if (now - start >= HMC7043_LOG_RATE_NSEC &&
+            sysAtomicCasRelaxed((UINT64 *) &pSite->windowStart, &start, now))
+            sysAtomicStoreRelaxed(&pSite->nInWindow, 0);
 
-	if(!hmc7043IfCtl.initDone || !hmc7043AppCtl.initDone || !pCtl->initDone) {
-		sysLog("initialization not done yet (dev %d, init. done %d,%d,%d)",
-				dev, hmc7043IfCtl.initDone, hmc7043AppCtl.initDone,
-				pCtl->initDone);
-		return ERROR;
-	}
+        if (sysAtomicAddRelaxed(&pSite->nInWindow, 1) >= maxPerSec) {
+            sysAtomicAddRelaxed(&pSite->nSuppressed, 1);
+            return;
+        }
+    }
 
-	hmc7043CsEnter(dev, __FUNCTION__);
-	/* Set pulse generation mode */
-	switch(mode)
-	{
-		case HMC7043_SRM_CONTINUOUS: {
-			pImg->r5a.fields.pulseMode = 0x7;
-			break;
-		}
-		case HMC7043_SRM_LEVEL_CTL: {
-			pImg->r5a.fields.pulseMode = 0x0;
-			break;
-		}
-		case HMC7043_SRM_PULSED: {
-			switch(nPulses)
-			{
-				case HMC7043_SRNP_1: {
-					pImg->r5a.fields.pulseMode = 0x1;
-					break;
-				}
-				case HMC7043_SRNP_2: {
-					pImg->r5a.fields.pulseMode = 0x2;
-					break;
-				}
-				case HMC7043_SRNP_4: {
-					pImg->r5a.fields.pulseMode = 0x3;
-					break;
-				}
-				case HMC7043_SRNP_8: {
-					pImg->r5a.fields.pulseMode = 0x4;
-					break;
-				}
-				case HMC7043_SRNP_16: {
-					pImg->r5a.fields.pulseMode = 0x5;
-					break;
-				}
-				default: {
-					sysLog("Bad value ( pParams->sysref.nPulses %d)",nPulses);
-					return ERROR;
-				}
-			}
-			break;
-		}
-		default:
-			sysLog("Bad value ( pParams->sysref.mode %d)", mode);
-			return ERROR;
-	}
-	status = hmc7043LliRegWrite(dev, 0x5a, pImg->r5a.all);
+    if (sysAtomicLoadRelaxed(&pSite->nSuppressed))
+        nSuppressed = sysAtomicGetAndClear(&pSite->nSuppressed);
 
-	hmc7043CsExit(dev, __FUNCTION__);
+    va_start(ap, nArgs);
 
-    return status;
+    for (i = 0; i < min(nArgs, SYS_LOG_MAX_NARGS); ++i)
+        args[i] = pSite->isLong ? va_arg(ap, long) : va_arg(ap, int);
+
+    va_end(ap);
+
+    if (!sysAtomicLoadAcq(&hmc7043LogCtl.deferred)) {
+        hmc7043LogOut(pSite, args, nSuppressed);
+        return;
+    }
+
+    if ((pRec = utlRingReserve(&hmc7043LogCtl.ring, &pos)) == NULL) {
+        sysAtomicAddRelaxed(&hmc7043LogCtl.nDropped, 1);
+        /* (to be reported with the site's next message) */
+        sysAtomicAddRelaxed(&pSite->nSuppressed, nSuppressed);
+        return;
+    }
+
+    pRec->pSite       = pSite;
+    pRec->nSuppressed = nSuppressed;
+    memcpy(pRec->args, args, sizeof(pRec->args));
+
+    utlRingCommit(&hmc7043LogCtl.ring, pos);
 }
 
 
 
 
 /*******************************************************************************
-* - name: hmc7043ChDoSlip
+* - name: hmc7043LogThread
 *
-* - title: Generate slip event for a particular device.
-*
-* - input: dev     - CLKDST device on which operation is performed.
-*          chMask  - channel mask
+* - title: log drain thread
 *
-* - returns: OK or ERROR if detected an error
+* - returns: never
 *
-* - description: as above
+* - description: every periodUsec, formats the messages recorded since,
+*                oldest first, and reports the number of those dropped
 *
-* - notes: the operation is interlocked via the associated critical section
+* - notes: logs via sysLog*Fun directly (i.e. not through the ring it drains)
 *******************************************************************************/
-EXPORT STATUS hmc7043ChDoSlip(CKDST_DEV dev, HMC7043_CH_MASK chMask)
+LOCAL UINT64 hmc7043LogThread(const Sys_thread_args *)
 {
-	const Hmc7043_app_dev_ctl *pCtl;
-	STATUS status = OK;
-
-	if (!inEnumRange(dev, NELEMENTS(hmc7043AppCtl.devCtl))) {
-		sysLog("bad argument(s) (dev %d)", dev);
-		return ERROR;
-	}
+    const Hmc7043_log_rec *pRec;
+    UINT32 nDropped;
 
-	pCtl = hmc7043AppCtl.devCtl + dev;
+    FOREVER {
+        while ((pRec = utlRingPeek(&hmc7043LogCtl.ring)) != NULL) {
+            hmc7043LogOut(pRec->pSite, pRec->args, pRec->nSuppressed);
+            utlRingRelease(&hmc7043LogCtl.ring);
+        }
 
-	if (!chMask || chMask >= 1 << NELEMENTS(pCtl->params.chSup)) {
-		sysLog("bad argument (chMask 0x%x)", chMask);
-		return ERROR;
-	}
+        if (sysAtomicLoadRelaxed(&hmc7043LogCtl.nDropped) &&
+            (nDropped = sysAtomicGetAndClear(&hmc7043LogCtl.nDropped)) != 0)
+            sysLogIntFun(SYS_LOG_LEVEL_UNCOND, __FUNCTION__,
+                         "%u deferred messages dropped (ring full)", nDropped);
 
-	if(!hmc7043IfCtl.initDone || !hmc7043AppCtl.initDone || !pCtl->initDone) {
-		sysLog("initialization not done yet (dev %d, init. done %d,%d,%d)",
-				dev, hmc7043IfCtl.initDone, hmc7043AppCtl.initDone,
-				pCtl->initDone);
-		return ERROR;
-	}
+        sysDelayUsec(hmc7043LogCtl.periodUsec);
+    }
 
-	hmc7043CsEnter(dev, __FUNCTION__);
+    return (UINT64) OK;
+}
 
-	status = hmc7043ToggleBit(dev, HMC7043_REG_IDX_SLIP_REQ,
-			                  HMC7043_SLIP_REQ_BIT, 200);
 
-	hmc7043CsExit(dev, __FUNCTION__);
 
-	return status;
 
+/*******************************************************************************
+* - name: hmc7043SetLogRateLimit
+*
+* - title: limit the rate of the driver's log messages
+*
+* - input: maxPerSec - maximum number of messages per call site and second
+*                      (0 for no limit, the default)
+*
+* - returns: OK
+*
+* - description: messages beyond the limit are dropped, their number being
+*                logged with the site's next message let through
+*
+* - notes: may be called at any time
+*******************************************************************************/
+EXPORT STATUS hmc7043SetLogRateLimit(unsigned maxPerSec)
+{
+    sysAtomicStoreRelaxed(&hmc7043LogCtl.maxPerSec, maxPerSec);
+    return OK;
 }
 
 
 
 
 /*******************************************************************************
-* - name: hmc7043SysrefSwPulseN
+* - name: hmc7043StartDeferredLog
 *
-* - title: Generate N Pulses on SYSREF channels of a particular device.
+* - title: switch the driver's log messages to deferred formatting
 *
-* - input: dev     - CLKDST device on which operation is performed.
-*          chMask  - channel mask
-*          nPulses -
+* - input: maxMsgs    - maximum number of messages pending (rounded up to a
+*                       power of 2)
+*          periodUsec - log drain thread period
+*          thrCode    - thread code for the log drain thread
 *
 * - returns: OK or ERROR if detected an error
 *
-* - description: as above
-*
-* - notes: the operation is interlocked via the associated critical section
+* - description: sets up the message ring and creates the log drain thread,
+*                the driver then recording the call site and arguments of
+*                its hot paths' messages (rather than formatting them on
+*                the calling thread), the drain thread formatting these via
+*                sysLog*Fun
+*
+* - notes: 1) To be called at most once (not concurrently with driver
+*             services, e.g. before hmc7043IfInit).
+*          2) The messages are time stamped when formatted, i.e. up to a drain
+*             period late.
+*          3) The drain thread's priority should be set by the application as
+*             required (below that of the real-time threads using the driver).
 *******************************************************************************/
-EXPORT STATUS hmc7043SysrefSwPulseN(CKDST_DEV dev, HMC7043_CH_MASK chMask,
-                              HMC7043_SREF_NPULSES nPulses)
+EXPORT STATUS hmc7043StartDeferredLog(unsigned maxMsgs, UINT32 periodUsec,
+                                      unsigned thrCode)
 {
-	const Hmc7043_app_dev_ctl *pCtl;
-	Hmc7043_reg_x005a r5a;
-	STATUS status = OK;
-
-	if (!inEnumRange(dev, NELEMENTS(hmc7043AppCtl.devCtl))) {
-		sysLog("bad argument(s) (dev %d)", dev);
-		return ERROR;
-	}
+    static const UINT32 STACK_SIZE = 0x10000;  /* more than enough */
 
-	pCtl = hmc7043AppCtl.devCtl + dev;
-
-	if (!chMask || chMask >= 1 << NELEMENTS(pCtl->params.chSup)) {
-		sysLog("bad argument (chMask 0x%x)", chMask);
-		return ERROR;
-	}
+    Sys_thread_args args = {0, 0, 0};
+    UINT32 nSlots;
+    size_t memSize;
+    void *pMem;
 
-	if(!hmc7043IfCtl.initDone || !hmc7043AppCtl.initDone || !pCtl->initDone) {
-		sysLog("initialization not done yet (dev %d, init. done %d,%d,%d)",
-				dev, hmc7043IfCtl.initDone, hmc7043AppCtl.initDone,
-				pCtl->initDone);
-		return ERROR;
-	}
+    if (!maxMsgs || maxMsgs > 0x10000 || !periodUsec) {
+        sysLog("bad argument(s) (maxMsgs %u, periodUsec %u)", maxMsgs,
+               periodUsec);
+        return ERROR;
+    }
 
-	if (hmc7043LliRegRead(dev, 0x5a, &r5a.all) != OK)
-		return ERROR;
+    if (hmc7043LogCtl.ring.pSlots) {
+        sysLog("already started");
+        return ERROR;
+    }
 
-	if(r5a.fields.pulseMode == 0x0 || r5a.fields.pulseMode == 0x7) {
-		sysLog("Pulse mode is not pulsed (Pulse mode 0x%x)",
-				r5a.fields.pulseMode);
-		return ERROR;
-	}
+    for (nSlots = 2; nSlots < maxMsgs; nSlots *= 2)
+        ;
 
-	hmc7043CsEnter(dev, __FUNCTION__);
-	switch(nPulses) {
-		case HMC7043_SRNP_1: {
-			r5a.fields.pulseMode = 0x1;
-			break;
-		}
-		case HMC7043_SRNP_2: {
-			r5a.fields.pulseMode = 0x2;
-			break;
-		}
-		case HMC7043_SRNP_4: {
-			r5a.fields.pulseMode = 0x3;
-			break;
-		}
-		case HMC7043_SRNP_8: {
-			r5a.fields.pulseMode = 0x4;
-			break;
-		}
-		case HMC7043_SRNP_16: {
-			r5a.fields.pulseMode = 0x5;
-			break;
-		}
-	}
+    /* (multiple of the alignment, as required by aligned_alloc) */
+    memSize = (UTL_RING_MEM_SIZE(nSlots, sizeof(Hmc7043_log_rec)) +
+               UTL_RING_CACHE_LINE - 1) & ~(size_t) (UTL_RING_CACHE_LINE - 1);
 
-	status = hmc7043LliRegWrite(dev, 0x5a, r5a.all);
-	if(status != OK) {
-		hmc7043CsExit(dev, __FUNCTION__);
-		return ERROR;
-	}
+    if ((pMem = aligned_alloc(UTL_RING_CACHE_LINE, memSize)) == NULL ||
+        utlRingInit(&hmc7043LogCtl.ring, pMem, nSlots, sizeof(Hmc7043_log_rec),
+                    TRUE) != OK) {
+        sysLog("message ring allocation failed (nSlots %u)", nSlots);
+        memset(&hmc7043LogCtl.ring, 0, sizeof(hmc7043LogCtl.ring));
+        free(pMem);
+        return ERROR;
+    }
 
-	status = hmc7043ToggleBit(dev, HMC7043_REG_IDX_REQ_MOD, HMC7043_PULS_GEN_BIT,
-						 200);
+    hmc7043LogCtl.periodUsec = periodUsec;
 
-	hmc7043CsExit(dev, __FUNCTION__);
+    /* (on failure, the ring is released so that this can be retried) */
+    if (sysThreadCreate(thrCode, 0, hmc7043LogThread, STACK_SIZE,
+                        &args) != OK) {
+        sysLog("log drain thread creation failed");
+        memset(&hmc7043LogCtl.ring, 0, sizeof(hmc7043LogCtl.ring));
+        free(pMem);
+        return ERROR;
+    }
 
-	return status;
+    /* (ring set up before any poster sees deferred mode) */
+    sysAtomicStoreRel(&hmc7043LogCtl.deferred, TRUE);
 
+    return OK;
 }
 
 
 
 
+#ifndef HMC7043_BENCH
 int main()
 {
    return 0;
 }
+#endif
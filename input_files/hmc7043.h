@@ -21,9 +21,19 @@ typedef STATUS HMC7043_REG_READ(CKDST_DEV dev, unsigned regInx,
                HMC7043_REG_WRITE(CKDST_DEV dev, unsigned regInx,
                                  HMC7043_REG regData);
 
+/* burst (auto-increment) access to nRegs registers starting at regInx */
+typedef STATUS HMC7043_REG_READ_BURST(CKDST_DEV dev, unsigned regInx,
+                                      HMC7043_REG *pData, unsigned nRegs),
+               HMC7043_REG_WRITE_BURST(CKDST_DEV dev, unsigned regInx,
+                                       const HMC7043_REG *pData, unsigned nRegs);
+
 typedef struct {
     HMC7043_REG_READ *pRegRead;
     HMC7043_REG_WRITE *pRegWrite;
+    /* optional (NULL if not supported by the backend) */
+    HMC7043_REG_READ_BURST *pRegReadBurst;
+    HMC7043_REG_WRITE_BURST *pRegWriteBurst;
+    CKDST_BUS bus;  /* SPI bus the device is on (ref. hmc7043GetDevMask) */
 } Hmc7043_dev_io_if;
 
 typedef enum {HMC7043_CID_1, HMC7043_CID_2} HMC7043_DEV_CLKIN_DIV;
@@ -61,6 +71,131 @@ typedef struct {
     Bool syncReq, cksPhase, srefSync;
 } Hmc7043_dev_alarms;
 
+typedef enum {  /* services for which statistics are kept */
+    HMC7043_SOP_INIT_DEV,         HMC7043_SOP_OUT_CH_EN_DIS,
+    HMC7043_SOP_CH_SYNC_DIS,      HMC7043_SOP_SET_SYSREF_MODE,
+    HMC7043_SOP_SYSREF_SW_PULSE_N, HMC7043_SOP_CH_DO_SLIP,
+    HMC7043_SOP_CLEAR_ALARMS,     HMC7043_SOP_RECONFIG_DEV,
+    HMC7043_SOP_CH_SET_DELAY,     HMC7043_SOP_NOPS
+} HMC7043_SERV_OP;
+
+/* latency histogram bins: bin 0 for < 1 usec, bin i for [2^(i-1), 2^i) usec,
+   the last bin also counting anything longer */
+#define HMC7043_STATS_NBINS  24
+
+typedef struct {  /* per device and service (completed calls only) */
+    UINT64 nCalls, nErrors, totalNsec, maxNsec;
+    UINT64 hist[HMC7043_STATS_NBINS];
+} Hmc7043_op_stats;
+
+typedef struct {  /* per device (all counters being UINT64) */
+    UINT64 nReads, nWrites;           /* register transfers (bursts or single) */
+    UINT64 nRegsRead, nRegsWritten;   /* i.e. data bytes */
+    UINT64 nXferErrors, xferNsec;     /* failed transfers, total transfer time */
+    UINT64 nCsEnters, csWaitNsec, csMaxWaitNsec;  /* device mutex waits */
+    UINT64 nShadowReads, nScrubMismatches;  /* ref. hmc7043SetRegReadThrough */
+    Hmc7043_op_stats ops[HMC7043_SOP_NOPS];
+} Hmc7043_dev_stats;
+
+/* register access trace entries (ref. hmc7043GetTrace) */
+#define HMC7043_TRACE_NENTRIES  256  /* per device (a power of 2) */
+
+#define HMC7043_TRF_READ   0x01  /* otherwise a write */
+#define HMC7043_TRF_ERROR  0x02  /* the transfer failed */
+
+typedef struct {
+    UINT64 nsecAt;        /* transfer completion (ref. sysTimeNsec) */
+    const char *context;  /* calling service (outermost critical section) */
+    UINT16 regInx;        /* first register */
+    UINT8 nRegs;          /* saturated at 0xff */
+    HMC7043_REG data;     /* of the first register */
+    UINT8 flags;          /* HMC7043_TRF_* */
+} Hmc7043_trace_entry;
+
+/* shared SPI bus priority classes (ref. hmc7043SetBusArbitration), highest
+   first */
+typedef enum {
+    HMC7043_BPRI_URGENT,      /* SYSREF pulses and mode changes, slips */
+    HMC7043_BPRI_NORMAL,      /* the other services */
+    HMC7043_BPRI_BACKGROUND,  /* warm init read back, monitor, scrubbing */
+    HMC7043_BPRI_NPRIS
+} HMC7043_BUS_PRI;
+
+typedef struct {  /* per arbitrated bus (ref. hmc7043GetBusStats) */
+    UINT64 sinceNsec, atNsec;  /* arbitration enabled, statistics taken */
+    UINT64 busyNsec;           /* bus granted (up to the latest release) */
+    UINT64 nGrants[HMC7043_BPRI_NPRIS];
+    UINT64 waitNsec[HMC7043_BPRI_NPRIS], maxWaitNsec[HMC7043_BPRI_NPRIS];
+} Hmc7043_bus_stats;
+
+/* device initialization phases (ref. hmc7043GetInitProfile), in their order */
+typedef enum {
+    HMC7043_IPH_LLI_INIT,      /* low-level interface set-up */
+    HMC7043_IPH_SET_UP,        /* parameters validation, control data set-up */
+    HMC7043_IPH_PROD_ID,       /* product id check */
+    HMC7043_IPH_BUILD_IMAGE,   /* register image (built, precompiled or cached) */
+    HMC7043_IPH_SOFT_RESET,
+    HMC7043_IPH_WRITE_IMAGE,   /* the whole image: GPIO/SDATA, SYSREF timer and
+                                  pulse generator, input and output channels */
+    HMC7043_IPH_RESTART,       /* soft reset, dividers/FSMs restart */
+    HMC7043_IPH_SYNC_WAIT,     /* for the concurrently initialized devices */
+    HMC7043_IPH_RESEED,        /* reseed, initial pulse generator stream */
+    HMC7043_IPH_SYSREF_WAIT,   /* 6 SYSREF periods */
+    HMC7043_IPH_PHASE_WAIT,    /* clock outputs phase status */
+    HMC7043_IPH_SYNC_DIS,      /* SYNC disable, register image flush */
+    HMC7043_IPH_WARM_RESTORE,  /* warm init: image restore or read back */
+    HMC7043_IPH_NPHASES
+} HMC7043_INIT_PHASE;
+
+typedef struct {
+    UINT64 startNsec, endNsec;  /* sysTimeNsec, 0 if not started / completed */
+    UINT32 nXfers, nRegs;       /* register transfers, registers (either way) */
+} Hmc7043_init_phase_prof;
+
+typedef struct {  /* of the latest (re)initialization of a device */
+    UINT64 startNsec, endNsec;  /* the whole of it */
+    STATUS status;
+    Bool warmInit;
+    Hmc7043_init_phase_prof phases[HMC7043_IPH_NPHASES];
+} Hmc7043_init_profile;
+
+typedef struct {  /* ref. hmc7043StartMonitor */
+    UINT32 seq;     /* number of monitor reads so far */
+    UINT64 nsecAt;  /* when read (ref. sysTimeNsec) */
+    Bool alarm;     /* as per hmc7043GetAlarm */
+    Hmc7043_dev_alarms alarms;
+} Hmc7043_alarm_snapshot;
+
+/* a device's readback / status registers (0x78 - 0x91), as read in a single
+   burst (ref. hmc7043GetStatusSnapshot) */
+#define HMC7043_STATUS_REG_INX  0x78
+#define HMC7043_STATUS_NREGS    (0x91 - HMC7043_STATUS_REG_INX + 1)
+
+typedef struct {
+    UINT64 nsecAt;                 /* when read (ref. sysTimeNsec) */
+    UINT32 prodId;                 /* 0x78 - 0x7a */
+    Bool alarm;                    /* as per hmc7043GetAlarm */
+    Hmc7043_dev_alarms alarms;     /* as per hmc7043GetAlarms */
+    unsigned srefFsmState;         /* SYSREF FSM state (0x91) */
+    Bool chOutFsmBusy;             /* channel output FSMs busy (0x91) */
+    HMC7043_REG regs[HMC7043_STATUS_NREGS];  /* raw */
+} Hmc7043_status_snapshot;
+
+/* alarm notification (ref. hmc7043SetAlarmHandler) */
+typedef void HMC7043_ALARM_HANDLER(CKDST_DEV dev, Bool alarm,
+                                   const Hmc7043_dev_alarms *pAlarms, UINT64 arg);
+
+typedef enum {  /* device operations whose completion is waited for */
+    HMC7043_WOP_SOFT_RESET, HMC7043_WOP_RESTART,   HMC7043_WOP_RESEED,
+    HMC7043_WOP_PULSE_GEN,  HMC7043_WOP_SLIP,      HMC7043_WOP_CKOUT_PHASE,
+    HMC7043_WOP_NOPS
+} HMC7043_WAIT_OP;
+
+typedef struct {  /* per device and operation */
+    UINT32 nWaits, nTimeouts;
+    UINT64 lastNsec, maxNsec, totalNsec;  /* actual wait durations */
+} Hmc7043_wait_stats;
+
 typedef enum {
     HMC7043_CHM_UNUSED, HMC7043_CHM_CLK, HMC7043_CHM_SYSREF
 } HMC7043_CH_MODE;
@@ -116,15 +251,89 @@ typedef struct {
     Hmc7043_ch_sup chSup[HMC7043_OUT_NCHAN];
 } Hmc7043_app_dev_params;
 
+/* asynchronous service requests (ref. hmc7043PostAsync) */
+typedef enum {
+    /* urgent requests (served ahead of any normal ones) */
+    HMC7043_AOP_SET_SYSREF_MODE, HMC7043_AOP_SYSREF_SW_PULSE_N,
+    HMC7043_AOP_CH_DO_SLIP,
+    /* normal requests */
+    HMC7043_AOP_OUT_CH_EN_DIS,   HMC7043_AOP_CH_SYNC_DIS,
+    HMC7043_AOP_CLEAR_ALARMS,    HMC7043_AOP_GET_ALARMS,
+    HMC7043_AOP_NOPS
+} HMC7043_ASYNC_OP;
+
+typedef struct {  /* the arguments of the respective service */
+    HMC7043_ASYNC_OP op;
+    HMC7043_CH_MASK chMask;        /* all but _SET_SYSREF_MODE and _*_ALARMS */
+    HMC7043_CH_MASK enMask;        /* _OUT_CH_EN_DIS (as for the mask version) */
+    HMC7043_SREF_MODE mode;        /* _SET_SYSREF_MODE */
+    HMC7043_SREF_NPULSES nPulses;  /* _SET_SYSREF_MODE, _SYSREF_SW_PULSE_N */
+} Hmc7043_async_req;
+
+typedef struct {  /* completion token, to be polled (ref. hmc7043AsyncDone) */
+    UINT32_ATOMIC done;
+    STATUS status;
+    Hmc7043_dev_alarms alarms;  /* for HMC7043_AOP_GET_ALARMS */
+} Hmc7043_async_token;
+
+/* completion callback, called on the executor thread (pAlarms only being
+   valid for HMC7043_AOP_GET_ALARMS) */
+typedef void HMC7043_ASYNC_DONE(CKDST_DEV dev, const Hmc7043_async_req *pReq,
+                                STATUS status, const Hmc7043_dev_alarms *pAlarms,
+                                UINT64 arg);
+
+/* precompiled configuration blob (ref. hmc7043CompileParams), its contents
+   being private to the driver */
+#define HMC7043_CFG_BLOB_MAX_SIZE  (16 + sizeof(Hmc7043_app_dev_params) + 3 * 192)
+
 /* services */
 STATUS hmc7043IfInit(CKDST_DEV_MASK devMask);
+
+/* devices initialized (on the bus, or on any bus for CKDST_BUS_ANY) */
+#define CKDST_BUS_ANY  ((CKDST_BUS) -1)
+
+CKDST_DEV_MASK hmc7043GetDevMask(CKDST_BUS bus);
+
 STATUS hmc7043InitDev(CKDST_DEV dev, const Hmc7043_dev_io_if *pIf,
                       const Hmc7043_app_dev_params *pParams, Bool warmInit);
 
+/* concurrent hmc7043InitDev of all devices in devMask (ifs[], params[] and
+   devStatus[] being indexed by device), on worker threads with thrCode */
+STATUS hmc7043InitDevMulti(CKDST_DEV_MASK devMask, const Hmc7043_dev_io_if ifs[],
+                           const Hmc7043_app_dev_params params[], Bool warmInit,
+                           unsigned thrCode, STATUS devStatus[]);
+
+/* offline conversion of pParams to a register image blob (checksummed and
+   versioned), and cold hmc7043InitDev using such a blob */
+STATUS hmc7043CompileParams(const Hmc7043_app_dev_params *pParams, void *pBlob,
+                            unsigned maxSize, unsigned *pSize);
+STATUS hmc7043InitDevFromBlob(CKDST_DEV dev, const Hmc7043_dev_io_if *pIf,
+                              const void *pBlob, unsigned size);
+
+/* incremental setup change of an initialized device: only the registers of the
+   output channels whose parameters differ are rewritten, and only those
+   channels reseeded (falling back to a full hmc7043InitDev if any of the device
+   level parameters differs) */
+STATUS hmc7043ReconfigDev(CKDST_DEV dev, const Hmc7043_app_dev_params *pNewParams);
+
 STATUS hmc7043OutChEnDis(CKDST_DEV dev, unsigned iCh, Bool enable);
 
+/* batch versions (channels in chMask & enMask are enabled, the rest of chMask
+   disabled), each committed to the device in a single flush */
+STATUS hmc7043OutChEnDisMask(CKDST_DEV dev, HMC7043_CH_MASK chMask,
+                             HMC7043_CH_MASK enMask);
+STATUS hmc7043ChSyncDisMask(CKDST_DEV dev, HMC7043_CH_MASK chMask);
+
 STATUS hmc7043ChDoSlip(CKDST_DEV dev, HMC7043_CH_MASK chMask);
 
+/* runtime phase adjustment of the channels in chMask only: slip by nSlips
+   CLKIN cycles (hmc7043ChDoSlip being a single one), fine analog / coarse
+   digital delays (committed in a single flush) */
+STATUS hmc7043ChMultiSlip(CKDST_DEV dev, HMC7043_CH_MASK chMask,
+                          unsigned nSlips);
+STATUS hmc7043ChSetDelay(CKDST_DEV dev, HMC7043_CH_MASK chMask, double aDlyPs,
+                         double dDlyPs);
+
 /* nPulses argument here is only relevant for HMC7043_SRM_PULSED mode */
 STATUS hmc7043SetSysrefMode(CKDST_DEV dev, HMC7043_SREF_MODE mode,
                             HMC7043_SREF_NPULSES nPulses);
@@ -132,13 +341,134 @@ STATUS hmc7043SetSysrefMode(CKDST_DEV dev, HMC7043_SREF_MODE mode,
 STATUS hmc7043SysrefSwPulseN(CKDST_DEV dev, HMC7043_CH_MASK chMask,
                               HMC7043_SREF_NPULSES nPulses);
 
+/* the same for all devices in devMask, the pulse generation requests being
+   fired back-to-back once staged, *pSkewNsec (may be NULL) returning the time
+   between the first and the last one */
+STATUS hmc7043SysrefSwPulseNMulti(CKDST_DEV_MASK devMask, HMC7043_CH_MASK chMask,
+                                  HMC7043_SREF_NPULSES nPulses,
+                                  UINT64 *pSkewNsec);
+
 STATUS hmc7043GetAlarm(CKDST_DEV dev, Bool *pAlarm);
 STATUS hmc7043GetAlarms(CKDST_DEV dev, Hmc7043_dev_alarms *pAlarms);
 STATUS hmc7043ClearAlarms(CKDST_DEV dev);
 
+/* all the alarm / readback / FSM status of a device as of a single register
+   transfer (the multi-device variant filling snaps[] in device order) */
+STATUS hmc7043GetStatusSnapshot(CKDST_DEV dev, Hmc7043_status_snapshot *pSnap);
+STATUS hmc7043GetStatusSnapshotMulti(CKDST_DEV_MASK devMask,
+                                     Hmc7043_status_snapshot snaps[]);
+
+/* background monitoring of the alarm / status registers every period msec,
+   hmc7043GetAlarm(s) then returning the latest snapshot (without accessing
+   the device) */
+STATUS hmc7043StartMonitor(CKDST_DEV_MASK devMask, UINT64 period,
+                           unsigned thrCode);
+STATUS hmc7043GetAlarmSnapshot(CKDST_DEV dev, Hmc7043_alarm_snapshot *pSnap);
+
+/* alarm notification on the edges of the GPO pin set up as HMC7043_GPOS_ALARM:
+   the edges are either signaled by the board layer via hmc7043AlarmEdge or
+   waited for on sysfs (hmc7043AttachAlarmGpio, until hmc7043DetachAlarmGpio) */
+STATUS hmc7043SetAlarmHandler(CKDST_DEV dev, HMC7043_ALARM_HANDLER *pHandler,
+                              UINT64 arg);
+STATUS hmc7043AlarmEdge(CKDST_DEV dev);
+STATUS hmc7043AttachAlarmGpio(CKDST_DEV dev, const char *valuePath,
+                              unsigned thrCode);
+STATUS hmc7043DetachAlarmGpio(CKDST_DEV dev);
+
+/* deferred commit mode: register image changes are accumulated until
+   hmc7043Commit, the next service acting on the device, or the expiry of
+   windowUsec (if not 0), each modified register being written once per commit */
+STATUS hmc7043SetDeferredCommit(CKDST_DEV dev, Bool enable, UINT32 windowUsec,
+                                unsigned thrCode);
+STATUS hmc7043Commit(CKDST_DEV dev);
+
+/* asynchronous mode: requests posted to a per-device executor thread (up to
+   maxReqs pending per priority class), completion being reported via pDone
+   and / or pToken (either may be NULL) */
+STATUS hmc7043StartAsync(CKDST_DEV_MASK devMask, unsigned maxReqs,
+                         unsigned thrCode);
+STATUS hmc7043PostAsync(CKDST_DEV dev, const Hmc7043_async_req *pReq,
+                        HMC7043_ASYNC_DONE *pDone, UINT64 arg,
+                        Hmc7043_async_token *pToken);
+Bool hmc7043AsyncDone(const Hmc7043_async_token *pToken, STATUS *pStatus);
+
+/* register reads: reads of control registers whose device value is known to
+   the driver are served from its image of the device (status / self-clearing
+   registers always being read from the device), unless in read-through mode;
+   hmc7043ScrubRegs reads back the control registers, rewriting any that
+   differ, as the background monitor does every scrubPeriod iterations (if not
+   0) */
+STATUS hmc7043SetRegReadThrough(Bool readThrough);
+STATUS hmc7043SetRegScrub(unsigned scrubPeriod);
+STATUS hmc7043ScrubRegs(CKDST_DEV dev, unsigned *pNMismatches);
+
+/* upper bound on the completion wait of op, and minimum wait before polling
+   for its completion (for all devices) */
+STATUS hmc7043SetWaitTimeout(HMC7043_WAIT_OP op, UINT32 timeoutUsec);
+STATUS hmc7043SetWaitSettle(HMC7043_WAIT_OP op, UINT32 settleUsec);
+STATUS hmc7043GetWaitStats(CKDST_DEV dev, HMC7043_WAIT_OP op,
+                           Hmc7043_wait_stats *pStats, Bool clear);
+
+/* persistence of the register images in POSIX shared memory object shmName,
+   letting a warm hmc7043InitDev verify the persisted image by reading back
+   verifyRegs (NULL for a default set) rather than reading all registers */
+#define HMC7043_PERSIST_MAX_VERIFY_REGS  16
+
+STATUS hmc7043SetPersistence(const char *shmName, const unsigned verifyRegs[],
+                             unsigned nVerifyRegs);
+
+/* driver statistics, optionally logged every period msec */
+STATUS hmc7043GetStats(CKDST_DEV dev, Hmc7043_dev_stats *pStats);
+STATUS hmc7043ResetStats(CKDST_DEV dev);
+STATUS hmc7043StartStatsDump(UINT64 period, unsigned thrCode);
+
+/* always-on register access trace: hmc7043GetTrace returns the latest (up to
+   maxEntries) register transfers of the device oldest first, hmc7043TraceDump
+   logs them (raw - via utlByteDump), and hmc7043TraceDumpAll does that for all
+   the devices (e.g. from the application's sysCodeErr hook, or from the one
+   installed by hmc7043TraceHookCodeErr) */
+STATUS hmc7043GetTrace(CKDST_DEV dev, Hmc7043_trace_entry entries[],
+                       unsigned maxEntries, unsigned *pNentries);
+STATUS hmc7043TraceDump(CKDST_DEV dev, unsigned nEntries, Bool raw);
+void hmc7043TraceDumpAll(unsigned nEntries);
+STATUS hmc7043TraceHookCodeErr(void);
+
+/* always-on initialization profile: hmc7043GetInitProfile returns the phases
+   of the device's latest (re)initialization, hmc7043InitProfileJson formats
+   those of the devices in devMask as a Chrome trace (one timeline per device,
+   *pLen being set to the full length, as for snprintf, even if that does not
+   fit into the buffer) */
+STATUS hmc7043GetInitProfile(CKDST_DEV dev, Hmc7043_init_profile *pProf);
+const char *hmc7043InitPhaseName(HMC7043_INIT_PHASE phase);
+STATUS hmc7043InitProfileJson(CKDST_DEV_MASK devMask, char *buf, size_t size,
+                              size_t *pLen);
+
+/* driver log messages of the hot paths (register access, critical sections
+   and the run-time services): optionally rate limited to maxPerSec per call
+   site, and - once hmc7043StartDeferredLog has been called - recorded in
+   binary form (up to maxMsgs pending, any beyond being dropped and counted)
+   and formatted by the log drain thread every periodUsec; building with
+   HMC7043_LOG_LEVEL_MAX defined (by default as SYS_LOG_LEVEL_INFO, e.g. as
+   SYS_LOG_LEVEL_WARNING) compiles out the call sites of any level above */
+STATUS hmc7043SetLogRateLimit(unsigned maxPerSec);
+STATUS hmc7043StartDeferredLog(unsigned maxMsgs, UINT32 periodUsec,
+                               unsigned thrCode);
+
+/* shared SPI bus arbitration: once enabled for a bus, the transfers of its
+   devices are granted the bus one at a time, highest priority class first
+   (longer bursts being split, so that an urgent transfer only waits for the
+   chunk in progress), and the bus utilization (busyNsec over atNsec -
+   sinceNsec) and per class grant waits are accounted for */
+STATUS hmc7043SetBusArbitration(CKDST_BUS bus, Bool enable);
+STATUS hmc7043GetBusStats(CKDST_BUS bus, Hmc7043_bus_stats *pStats);
+
 /* these routines are provided for low-level debugging */
 STATUS hmc7043RegRead(CKDST_DEV dev, unsigned regInx, HMC7043_REG *pData),
-       hmc7043RegWrite(CKDST_DEV dev, unsigned regInx, HMC7043_REG regData);
+       hmc7043RegWrite(CKDST_DEV dev, unsigned regInx, HMC7043_REG regData),
+       hmc7043RegReadBurst(CKDST_DEV dev, unsigned regInx, HMC7043_REG *pData,
+                           unsigned nRegs),
+       hmc7043RegWriteBurst(CKDST_DEV dev, unsigned regInx,
+                            const HMC7043_REG *pData, unsigned nRegs);
 
 
 #endif /* _hmc7043_h_ */
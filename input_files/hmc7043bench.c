@@ -0,0 +1,1046 @@
+/*******************************************************************************
+* hmc7043bench.c - benchmark harness for the HMC7043 driver, running it against *
+*                  simulated register files                                    *
+********************************************************************************
+* modification history:                                                        *
+*   14.10.26 , created                                                         *
+********************************************************************************
+* build: gcc -std=gnu2x -Wall -O2 -DHMC7043_BENCH hmc7043.c hmc7043bench.c     *
+*            -o hmc7043bench -lm -lpthread                                     *
+*                                                                              *
+* usage: hmc7043bench [-n maxNdev] [-i iters] [-o xferNsec] [-r regNsec]       *
+*                     [-j jitterNsec] [-s] [-z] [-p shmName] [-l] [-L maxRate] *
+*                     [-t traceFile] [-a] [-c] [-v]                            *
+*                                                                              *
+*   -n  measure for 1, 2, 4 .. maxNdev devices (default CKDST_MAX_NDEV)        *
+*   -i  iterations per device and measurement (default 200)                    *
+*   -o  simulated per-transaction (chip select) overhead (default 2000 nsec)   *
+*   -r  simulated per-register (24-bit frame) time (default 1000 nsec)         *
+*   -j  uniformly distributed extra per-transaction latency (default 0 nsec)   *
+*   -s  single-register backend (no burst callbacks)                           *
+*   -z  skip the driver's programming delays (sysDelayUsec*), i.e. measure the *
+*       driver itself and the simulated bus only                               *
+*   -p  enable register image persistence in POSIX shm object shmName          *
+*   -l  deferred driver logging (formatted by the driver's log drain thread)   *
+*   -L  limit the driver's log messages to maxRate per call site and second    *
+*   -t  write the init_multi (maxNdev devices) initialization profile to       *
+*       traceFile, as a Chrome trace (ref. hmc7043InitProfileJson)             *
+*   -a  arbitrate the (simulated, shared) SPI bus, its statistics being output *
+*       at the end (to stderr)                                                 *
+*   -c  CSV output (default one JSON object per line)                          *
+*   -v  also output the driver's log messages (to stderr)                      *
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include "sysutil.h"
+#include "hmc7043.h"
+
+
+/* Constants and Types */
+#define BENCH_SIM_NREGS        0x153
+#define BENCH_DEF_ITERS        200
+#define BENCH_DEF_XFER_NSEC    2000
+#define BENCH_DEF_REG_NSEC     1000
+#define BENCH_MAX_NTHREADS     (3 * CKDST_MAX_NDEV)
+#define BENCH_THR_INIT         1  /* thread codes */
+#define BENCH_THR_ASYNC        2
+#define BENCH_THR_LOG          3
+#define BENCH_LOG_MAX_MSGS     256
+#define BENCH_LOG_PERIOD_USEC  10000
+#define BENCH_ASYNC_MAX_REQS   16
+#define BENCH_SREF_CH_MASK     0x2aaa  /* odd channels */
+#define BENCH_SIM_PRD_ID       0x301651  /* product id, as checked by the driver */
+
+typedef struct {  /* simulated device */
+    HMC7043_REG regs[BENCH_SIM_NREGS];
+    UINT64 rand;                /* jitter generator state */
+    UINT64 nXfers, nRegs;       /* transfers so far, registers moved */
+} Bench_sim_dev;
+
+typedef struct utl_mutex {
+    pthread_mutex_t mutex;
+} Bench_mutex;
+
+typedef struct utl_queue {  /* copying FIFO of up to maxMsgs messages */
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    size_t maxMsgs, maxMsgSize, head, count;
+    UINT8 *pBuff;  /* maxMsgs slots of size_t nBytes followed by the data */
+} Bench_queue;
+
+typedef struct {  /* sys threads, per thrCode and subCode */
+    Bool used, started;
+    unsigned thrCode, subCode;
+    SYS_THREAD_FUNC *pEntry;
+    Sys_thread_args args;
+    Sys_thread_per_serv_args perServ;
+    pthread_t hThread;
+} Bench_thread;
+
+typedef enum {
+    BENCH_OP_COLD_INIT,   BENCH_OP_COLD_INIT_CACHED, BENCH_OP_INIT_MULTI,
+    BENCH_OP_WARM_INIT,   BENCH_OP_OUT_CH_TOGGLE,    BENCH_OP_SREF_PULSE,
+    BENCH_OP_SREF_PULSE_MULTI, BENCH_OP_GET_ALARMS,  BENCH_OP_ASYNC_TOGGLE,
+    BENCH_OP_RECONFIG_DRV,     BENCH_OP_RECONFIG_FREQ,
+    BENCH_OP_CH_SET_DELAY,     BENCH_OP_CH_MULTI_SLIP,
+    BENCH_OP_STATUS_SNAP,      BENCH_OP_BAD_ARG,
+    BENCH_OP_NOPS
+} BENCH_OP;
+
+typedef struct {  /* per measurement thread (i.e. device) */
+    BENCH_OP op;
+    CKDST_DEV dev;
+    CKDST_DEV_MASK devMask;     /* for the *_MULTI ops */
+    unsigned iters, nErrors;
+    SYS_TIME_NS *pNsec;         /* iters latencies */
+} Bench_job;
+
+
+/* Control Data */
+LOCAL const char *const benchOpNames[BENCH_OP_NOPS] = {
+    [BENCH_OP_COLD_INIT]        = "cold_init",
+    [BENCH_OP_COLD_INIT_CACHED] = "cold_init_cached",
+    [BENCH_OP_INIT_MULTI]       = "init_multi",
+    [BENCH_OP_WARM_INIT]        = "warm_init",
+    [BENCH_OP_OUT_CH_TOGGLE]    = "out_ch_toggle",
+    [BENCH_OP_SREF_PULSE]       = "sysref_pulse",
+    [BENCH_OP_SREF_PULSE_MULTI] = "sysref_pulse_multi",
+    [BENCH_OP_GET_ALARMS]       = "get_alarms",
+    [BENCH_OP_ASYNC_TOGGLE]     = "async_out_ch_toggle",
+    [BENCH_OP_RECONFIG_DRV]     = "reconfig_ch_drv",
+    [BENCH_OP_RECONFIG_FREQ]    = "reconfig_ch_freq",
+    [BENCH_OP_CH_SET_DELAY]     = "ch_set_delay",
+    [BENCH_OP_CH_MULTI_SLIP]    = "ch_multi_slip",
+    [BENCH_OP_STATUS_SNAP]      = "status_snapshot",
+    [BENCH_OP_BAD_ARG]          = "bad_arg"
+};
+
+LOCAL struct {
+    unsigned maxNdev, iters;
+    UINT32 xferNsec, regNsec, jitterNsec;
+    Bool noBurst, noDelays, csv, verbose, deferredLog, arbitrate;
+    unsigned logRate;
+    const char *shmName, *traceFile;
+} benchCfg = {
+    CKDST_MAX_NDEV, BENCH_DEF_ITERS, BENCH_DEF_XFER_NSEC, BENCH_DEF_REG_NSEC,
+    0, FALSE, FALSE, FALSE, FALSE, FALSE, FALSE, 0, NULL, NULL
+};
+
+LOCAL Bench_sim_dev benchSimDevs[CKDST_MAX_NDEV];
+
+LOCAL struct {
+    pthread_mutex_t mutex;
+    Bench_thread threads[BENCH_MAX_NTHREADS];
+} benchThrCtl = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+
+/* set for the driver's background threads, their periods being real even
+   with -z (which only skips its programming delays) */
+LOCAL __thread Bool benchRealDelays;
+
+LOCAL Hmc7043_app_dev_params benchParams[2];  /* alternated to defeat caching */
+LOCAL Hmc7043_dev_io_if benchIfs[CKDST_MAX_NDEV];
+
+
+/*#############################################################################*
+*                 S I M U L A T E D    P L A T F O R M                         *
+*#############################################################################*/
+
+/* logging (to stderr, if enabled) */
+LOCAL void benchLogV(const char *context, const char *format, va_list ap)
+{
+    if (!benchCfg.verbose)
+        return;
+
+    if (context)
+        fprintf(stderr, "%s: ", context);
+
+    vfprintf(stderr, format, ap);
+
+    if (context)
+        fputc('\n', stderr);
+}
+
+STATUS sysLogIntFun(unsigned, const char *context, const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    benchLogV(context, format, ap);
+    va_end(ap);
+    return OK;
+}
+
+STATUS sysLogLongFun(unsigned, const char *context, const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    benchLogV(context, format, ap);
+    va_end(ap);
+    return OK;
+}
+
+STATUS sysLogFpaFun(unsigned, const char *context, const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    benchLogV(context, format, ap);
+    va_end(ap);
+    return OK;
+}
+
+LOCAL SYS_CODE_ERR_APP_HOOK *benchCodeErrHook;
+
+void sysCodeErrSetAppHook(SYS_CODE_ERR_APP_HOOK *pHook)
+{
+    benchCodeErrHook = pHook;
+}
+
+void sysCodeErr(CODE_ERROR_ID errorId, FUNCPTR pFunc, const char *funcName,
+                UINT64 auxData1, UINT64 auxData2, UINT64 auxData3)
+{
+    fprintf(stderr, "code error %d in %s (0x%lx, 0x%lx, 0x%lx)\n", errorId,
+            funcName, auxData1, auxData2, auxData3);
+
+    if (benchCodeErrHook)
+        benchCodeErrHook(errorId, pFunc, funcName, auxData1, auxData2, auxData3);
+}
+
+STATUS utlByteDump(const void *buff, size_t nBytes, unsigned bytesPerLine)
+{
+    const UINT8 *pByte = buff;
+    size_t i;
+
+    for (i = 0; i < nBytes; ++i)
+        fprintf(stderr, "%02x%c", pByte[i],
+                (i + 1) % bytesPerLine && i + 1 < nBytes ? ' ' : '\n');
+    return OK;
+}
+
+/* time and delays */
+SYS_TIME_NS sysTimeNsec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * (SYS_TIME_NS) 1000000000 + ts.tv_nsec;
+}
+
+LOCAL void benchSpinNsec(UINT64 nsec)
+{
+    SYS_TIME_NS until = sysTimeNsec() + nsec;
+
+    while (sysTimeNsec() < until)
+        ;
+}
+
+void sysDelayUsec(UINT64 delayUsec)
+{
+    struct timespec ts = {delayUsec / 1000000, delayUsec % 1000000 * 1000};
+
+    if (!benchCfg.noDelays || benchRealDelays)
+        nanosleep(&ts, NULL);
+}
+
+void sysDelayUsecBusy(unsigned delayUsec)
+{
+    if (!benchCfg.noDelays)
+        benchSpinNsec(delayUsec * (UINT64) 1000);
+}
+
+/* mutexes (recursive, as are the utl ones) */
+HUTL_MUTEX utlMutexCreate(SYS_TIME)
+{
+    Bench_mutex *pMutex = malloc(sizeof(*pMutex));
+    pthread_mutexattr_t attr;
+
+    if (!pMutex)
+        return UTL_MUTEX_BAD_HMUTEX;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&pMutex->mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    return pMutex;
+}
+
+STATUS utlMutexTake(HUTL_MUTEX hMutex, const char *)
+{
+    return pthread_mutex_lock(&hMutex->mutex) ? ERROR : OK;
+}
+
+STATUS utlMutexRelease(HUTL_MUTEX hMutex, const char *)
+{
+    return pthread_mutex_unlock(&hMutex->mutex) ? ERROR : OK;
+}
+
+/* message queues */
+HUTL_QUEUE utlQueueCreate(size_t maxMsgs, size_t maxMsgSize, UTL_Q_STAT *pStat)
+{
+    Bench_queue *pQueue = calloc(1, sizeof(*pQueue));
+
+    if (!pQueue ||
+        !(pQueue->pBuff = malloc(maxMsgs * (sizeof(size_t) + maxMsgSize)))) {
+        free(pQueue);
+        if (pStat)
+            *pStat = UTL_QST_NO_RESOURCES;
+        return UTL_QUEUE_BAD_HQUEUE;
+    }
+
+    pthread_mutex_init(&pQueue->mutex, NULL);
+    pthread_cond_init(&pQueue->cond, NULL);
+    pQueue->maxMsgs    = maxMsgs;
+    pQueue->maxMsgSize = maxMsgSize;
+
+    if (pStat)
+        *pStat = UTL_QST_OK;
+    return pQueue;
+}
+
+/* (no thread being left waiting on the queue here) */
+STATUS utlQueueDelete(HUTL_QUEUE hQueue, UTL_Q_STAT *pStat)
+{
+    pthread_cond_destroy(&hQueue->cond);
+    pthread_mutex_destroy(&hQueue->mutex);
+    free(hQueue->pBuff);
+    free(hQueue);
+
+    if (pStat)
+        *pStat = UTL_QST_OK;
+    return OK;
+}
+
+LOCAL STATUS benchQueuePut(HUTL_QUEUE hQueue, const void *buff, size_t nBytes,
+                           Bool urgent, UTL_Q_STAT *pStat)
+{
+    UTL_Q_STAT stat = UTL_QST_OK;
+    size_t slot;
+    UINT8 *pSlot;
+
+    pthread_mutex_lock(&hQueue->mutex);
+
+    if (nBytes > hQueue->maxMsgSize)
+        stat = UTL_QST_BAD_ARGUMENT;
+    else if (hQueue->count == hQueue->maxMsgs)
+        stat = UTL_QST_FULL;
+    else {
+        if (urgent)
+            slot = hQueue->head = (hQueue->head + hQueue->maxMsgs - 1) %
+                                  hQueue->maxMsgs;
+        else
+            slot = (hQueue->head + hQueue->count) % hQueue->maxMsgs;
+
+        pSlot = hQueue->pBuff + slot * (sizeof(size_t) + hQueue->maxMsgSize);
+        memcpy(pSlot, &nBytes, sizeof(size_t));
+        memcpy(pSlot + sizeof(size_t), buff, nBytes);
+        ++hQueue->count;
+        pthread_cond_signal(&hQueue->cond);
+    }
+
+    pthread_mutex_unlock(&hQueue->mutex);
+
+    if (pStat)
+        *pStat = stat;
+    return stat == UTL_QST_OK ? OK : ERROR;
+}
+
+STATUS utlQueuePut(HUTL_QUEUE hQueue, const void *buff, size_t nBytes,
+                   UTL_Q_STAT *pStat)
+{
+    return benchQueuePut(hQueue, buff, nBytes, FALSE, pStat);
+}
+
+STATUS utlQueuePutUrgent(HUTL_QUEUE hQueue, const void *buff, size_t nBytes,
+                         UTL_Q_STAT *pStat)
+{
+    return benchQueuePut(hQueue, buff, nBytes, TRUE, pStat);
+}
+
+/* (the timeout is either UTL_Q_TO_NO_WAIT or UTL_Q_TO_INFINITE here) */
+STATUS utlQueueGet(HUTL_QUEUE hQueue, void *buff, size_t *pNbytes,
+                   SYS_TIME timeout, UTL_Q_STAT *pStat)
+{
+    UTL_Q_STAT stat = UTL_QST_OK;
+    const UINT8 *pSlot;
+    size_t nBytes;
+
+    pthread_mutex_lock(&hQueue->mutex);
+
+    while (!hQueue->count && timeout != UTL_Q_TO_NO_WAIT)
+        pthread_cond_wait(&hQueue->cond, &hQueue->mutex);
+
+    if (!hQueue->count)
+        stat = UTL_QST_EMPTY;
+    else {
+        pSlot = hQueue->pBuff +
+                hQueue->head * (sizeof(size_t) + hQueue->maxMsgSize);
+        memcpy(&nBytes, pSlot, sizeof(size_t));
+
+        if (nBytes > *pNbytes)
+            stat = UTL_QST_BAD_ARGUMENT;
+        else {
+            memcpy(buff, pSlot + sizeof(size_t), nBytes);
+            *pNbytes = nBytes;
+            hQueue->head = (hQueue->head + 1) % hQueue->maxMsgs;
+            --hQueue->count;
+        }
+    }
+
+    pthread_mutex_unlock(&hQueue->mutex);
+
+    if (pStat)
+        *pStat = stat;
+    return stat == UTL_QST_OK ? OK : ERROR;
+}
+
+/* threads */
+LOCAL Bench_thread *benchThrFind(unsigned thrCode, unsigned subCode, Bool alloc)
+{
+    Bench_thread *pThr, *pFree = NULL;
+
+    for (pThr = benchThrCtl.threads;
+         pThr < benchThrCtl.threads + NELEMENTS(benchThrCtl.threads); ++pThr) {
+        if (!pThr->used) {
+            if (!pFree)
+                pFree = pThr;
+        } else if (pThr->thrCode == thrCode && pThr->subCode == subCode)
+            return alloc ? NULL : pThr;  /* (already exists) */
+    }
+
+    if (!alloc || !pFree)
+        return NULL;
+
+    memset(pFree, 0, sizeof(*pFree));
+    pFree->used    = TRUE;
+    pFree->thrCode = thrCode;
+    pFree->subCode = subCode;
+    return pFree;
+}
+
+LOCAL void *benchThrEntry(void *arg)
+{
+    Bench_thread *pThr = arg;
+
+    benchRealDelays = pThr->thrCode == BENCH_THR_LOG;
+    return (void *) pThr->pEntry(&pThr->args);
+}
+
+LOCAL void *benchThrPerServEntry(void *arg)
+{
+    Bench_thread *pThr = arg;
+
+    benchRealDelays = TRUE;
+
+    FOREVER {
+        sysDelayUsec(pThr->perServ.period * 1000);
+        pThr->perServ.pIterProcess();
+    }
+
+    return NULL;
+}
+
+LOCAL STATUS benchThrLaunch(Bench_thread *pThr, void *(*pEntry)(void *))
+{
+    pThr->started = TRUE;
+
+    if (pthread_create(&pThr->hThread, NULL, pEntry, pThr) != 0) {
+        pThr->used = FALSE;
+        return ERROR;
+    }
+    return OK;
+}
+
+STATUS sysThreadCreateEx(unsigned thrCode, unsigned subCode,
+                         SYS_THREAD_FUNC *pEntry, UINT32,
+                         const Sys_thread_args *pArgs, SYS_THREAD_OPTS opts)
+{
+    Bench_thread *pThr;
+    STATUS status = OK;
+
+    pthread_mutex_lock(&benchThrCtl.mutex);
+
+    if (!(pThr = benchThrFind(thrCode, subCode, TRUE)))
+        status = ERROR;
+    else {
+        pThr->pEntry = pEntry;
+        pThr->args   = *pArgs;
+
+        if (!(opts & SYS_THREAD_OPTS_SUSPENDED))
+            status = benchThrLaunch(pThr, benchThrEntry);
+
+        if (status == OK && !(opts & SYS_THREAD_OPTS_WAITABLE))
+            pthread_detach(pThr->hThread);
+    }
+
+    pthread_mutex_unlock(&benchThrCtl.mutex);
+    return status;
+}
+
+STATUS sysThreadCreate(unsigned thrCode, unsigned subCode, SYS_THREAD_FUNC *pEntry,
+                       UINT32 stackSize, const Sys_thread_args *pArgs)
+{
+    return sysThreadCreateEx(thrCode, subCode, pEntry, stackSize, pArgs,
+                             SYS_THREAD_OPTS_NORMAL);
+}
+
+STATUS sysThreadCreatePerServ(unsigned thrCode, unsigned subCode,
+                              const Sys_thread_per_serv_args *pArgs)
+{
+    Bench_thread *pThr;
+    STATUS status = ERROR;
+
+    pthread_mutex_lock(&benchThrCtl.mutex);
+
+    if ((pThr = benchThrFind(thrCode, subCode, TRUE))) {
+        pThr->perServ = *pArgs;
+
+        if ((status = benchThrLaunch(pThr, benchThrPerServEntry)) == OK)
+            pthread_detach(pThr->hThread);
+    }
+
+    pthread_mutex_unlock(&benchThrCtl.mutex);
+    return status;
+}
+
+STATUS sysThreadStart(unsigned thrCode, unsigned subCode)
+{
+    Bench_thread *pThr;
+    STATUS status = ERROR;
+
+    pthread_mutex_lock(&benchThrCtl.mutex);
+
+    if ((pThr = benchThrFind(thrCode, subCode, FALSE)) && !pThr->started)
+        status = benchThrLaunch(pThr, benchThrEntry);
+
+    pthread_mutex_unlock(&benchThrCtl.mutex);
+    return status;
+}
+
+/* (waiting always being unbounded here) */
+STATUS sysThreadWait4Exit(unsigned thrCode, unsigned subCode, SYS_TIME,
+                          UINT64 *pExitCode)
+{
+    Bench_thread *pThr;
+    void *exitCode;
+
+    pthread_mutex_lock(&benchThrCtl.mutex);
+    pThr = benchThrFind(thrCode, subCode, FALSE);
+    pthread_mutex_unlock(&benchThrCtl.mutex);
+
+    if (!pThr || !pThr->started || pthread_join(pThr->hThread, &exitCode) != 0)
+        return ERROR;
+
+    if (pExitCode)
+        *pExitCode = (UINT64) exitCode;
+
+    pThr->used = FALSE;
+    return OK;
+}
+
+/* resources are left to the OS (the harness being a short-lived process) */
+STATUS sysRegisterAutoDelResource(const char *, Bool, SYS_RESOURCE_DELETE_FUNC *)
+{
+    return OK;
+}
+
+
+
+/*#############################################################################*
+*            S I M U L A T E D    R E G I S T E R    F I L E S                 *
+*#############################################################################*/
+
+/*******************************************************************************
+* - name: benchSimXfer
+*
+* - title: account for (and take the time of) a simulated SPI transaction
+*
+* - input: dev   - specifies the simulated device
+*          nRegs - number of registers transferred
+*
+* - returns: pointer to the simulated device
+*
+* - description: busy-waits for the configured transaction overhead, per
+*                register time and random jitter, i.e. models a spidev-like
+*                backend blocking the calling thread.
+*******************************************************************************/
+LOCAL Bench_sim_dev *benchSimXfer(CKDST_DEV dev, unsigned nRegs)
+{
+    Bench_sim_dev *pSim = benchSimDevs + dev;
+    UINT64 nsec = benchCfg.xferNsec + nRegs * (UINT64) benchCfg.regNsec;
+
+    if (benchCfg.jitterNsec) {  /* xorshift64 */
+        pSim->rand ^= pSim->rand << 13;
+        pSim->rand ^= pSim->rand >> 7;
+        pSim->rand ^= pSim->rand << 17;
+        nsec += pSim->rand % benchCfg.jitterNsec;
+    }
+
+    ++pSim->nXfers;
+    pSim->nRegs += nRegs;
+
+    benchSpinNsec(nsec);
+    return pSim;
+}
+
+/* the register contents as read, i.e. with the status registers reporting a
+   healthy, idle device */
+LOCAL HMC7043_REG benchSimRegGet(const Bench_sim_dev *pSim, unsigned regInx)
+{
+    switch (regInx) {
+    case 0x78: return BENCH_SIM_PRD_ID & 0xff;
+    case 0x79: return (BENCH_SIM_PRD_ID >> 8) & 0xff;
+    case 0x7a: return BENCH_SIM_PRD_ID >> 16;
+    case 0x7b: case 0x7c: return 0x00;            /* no alarms */
+    case 0x7d: return pSim->regs[regInx] | 0x04;  /* outputs phased */
+    case 0x91: return pSim->regs[regInx] & ~0x08; /* channel FSMs idle */
+    default:   return pSim->regs[regInx];
+    }
+}
+
+LOCAL STATUS benchSimRegReadBurst(CKDST_DEV dev, unsigned regInx,
+                                  HMC7043_REG *pData, unsigned nRegs)
+{
+    Bench_sim_dev *pSim;
+    unsigned i;
+
+    if (dev >= NELEMENTS(benchSimDevs) || regInx + nRegs > BENCH_SIM_NREGS)
+        return ERROR;
+
+    pSim = benchSimXfer(dev, nRegs);
+
+    for (i = 0; i < nRegs; ++i)
+        pData[i] = benchSimRegGet(pSim, regInx + i);
+
+    return OK;
+}
+
+LOCAL STATUS benchSimRegWriteBurst(CKDST_DEV dev, unsigned regInx,
+                                   const HMC7043_REG *pData, unsigned nRegs)
+{
+    Bench_sim_dev *pSim;
+
+    if (dev >= NELEMENTS(benchSimDevs) || regInx + nRegs > BENCH_SIM_NREGS)
+        return ERROR;
+
+    pSim = benchSimXfer(dev, nRegs);
+    memcpy(pSim->regs + regInx, pData, nRegs);
+    return OK;
+}
+
+LOCAL STATUS benchSimRegRead(CKDST_DEV dev, unsigned regInx, HMC7043_REG *pData)
+{
+    return benchSimRegReadBurst(dev, regInx, pData, 1);
+}
+
+LOCAL STATUS benchSimRegWrite(CKDST_DEV dev, unsigned regInx, HMC7043_REG regData)
+{
+    return benchSimRegWriteBurst(dev, regInx, &regData, 1);
+}
+
+
+
+/*#############################################################################*
+*                        M E A S U R E M E N T S                               *
+*#############################################################################*/
+
+/* 2.4 GHz CLKIN, even channels 100 MHz device clocks, odd channels 1 MHz
+   SYSREF (pulsed, with the dynamic driver on) */
+LOCAL void benchSetUpParams(Hmc7043_app_dev_params *pParams, Bool variant)
+{
+    unsigned i;
+
+    memset(pParams, 0, sizeof(*pParams));
+
+    pParams->clkInFreq = 2400000000ull;
+    pParams->clkInDiv  = HMC7043_CID_1;
+    pParams->clkIn.used = TRUE;
+    pParams->clkIn.term100Ohm = TRUE;
+    pParams->clkIn.acCoupled  = TRUE;
+    pParams->gpiSup  = HMC7043_GPIS_NONE;
+    pParams->gpoSup  = HNC7043_GPOS_NONE;
+    pParams->sysref.freq    = 1000000;
+    pParams->sysref.mode    = HMC7043_SRM_PULSED;
+    pParams->sysref.nPulses = HMC7043_SRNP_1;
+    pParams->alarmsEn.syncReq = TRUE;
+
+    for (i = 0; i < HMC7043_OUT_NCHAN; ++i) {
+        Hmc7043_ch_sup *pCh = pParams->chSup + i;
+        Bool sref = BENCH_SREF_CH_MASK >> i & 1;
+
+        pCh->chMode  = sref ? HMC7043_CHM_SYSREF : HMC7043_CHM_CLK;
+        pCh->freq    = sref ? pParams->sysref.freq : 100000000;
+        pCh->drvMode = HMC7043_CDM_LVDS;
+        pCh->outSel  = HMC7043_COS_DIVIDER;
+        pCh->highPerfMode = variant && !sref;  /* (a different image) */
+        pCh->dynDriverEn  = sref;
+    }
+}
+
+LOCAL int benchCmpNsec(const void *p1, const void *p2)
+{
+    SYS_TIME_NS t1 = *(const SYS_TIME_NS *) p1, t2 = *(const SYS_TIME_NS *) p2;
+
+    return (t1 > t2) - (t1 < t2);
+}
+
+/* a single iteration of op */
+LOCAL STATUS benchDoOp(Bench_job *pJob, unsigned iter)
+{
+    CKDST_DEV dev = pJob->dev;
+
+    switch (pJob->op) {
+    case BENCH_OP_COLD_INIT:
+        return hmc7043InitDev(dev, benchIfs + dev, benchParams + (iter & 1), FALSE);
+    case BENCH_OP_COLD_INIT_CACHED:
+        return hmc7043InitDev(dev, benchIfs + dev, benchParams, FALSE);
+    case BENCH_OP_INIT_MULTI: {
+        static Hmc7043_app_dev_params params[CKDST_MAX_NDEV];
+        unsigned i;
+
+        for (i = 0; i < NELEMENTS(params); ++i)
+            params[i] = benchParams[0];
+
+        return hmc7043InitDevMulti(pJob->devMask, benchIfs, params, FALSE,
+                                   BENCH_THR_INIT, NULL);
+    }
+    case BENCH_OP_WARM_INIT:
+        return hmc7043InitDev(dev, benchIfs + dev, benchParams, TRUE);
+    case BENCH_OP_OUT_CH_TOGGLE:
+        return hmc7043OutChEnDis(dev, 0, iter & 1);
+    case BENCH_OP_SREF_PULSE:
+        return hmc7043SysrefSwPulseN(dev, BENCH_SREF_CH_MASK, HMC7043_SRNP_1);
+    case BENCH_OP_SREF_PULSE_MULTI:
+        return hmc7043SysrefSwPulseNMulti(pJob->devMask, BENCH_SREF_CH_MASK,
+                                          HMC7043_SRNP_1, NULL);
+    case BENCH_OP_GET_ALARMS: {
+        Hmc7043_dev_alarms alarms;
+
+        return hmc7043GetAlarms(dev, &alarms);
+    }
+    case BENCH_OP_STATUS_SNAP: {
+        Hmc7043_status_snapshot snap;
+
+        return hmc7043GetStatusSnapshot(dev, &snap);
+    }
+    case BENCH_OP_ASYNC_TOGGLE: {  /* posting and polling for completion */
+        Hmc7043_async_req req = {.op = HMC7043_AOP_OUT_CH_EN_DIS, .chMask = 0x1,
+                                 .enMask = iter & 1};
+        Hmc7043_async_token token;
+        STATUS status;
+
+        if (hmc7043PostAsync(dev, &req, NULL, 0, &token) != OK)
+            return ERROR;
+
+        while (!hmc7043AsyncDone(&token, &status))
+            sched_yield();
+
+        return status;
+    }
+    case BENCH_OP_RECONFIG_DRV:   /* channel 0 driver mode (no reseed) */
+    case BENCH_OP_RECONFIG_FREQ: {  /* channel 0 divider (reseeded) */
+        Hmc7043_app_dev_params params = benchParams[0];
+
+        if (pJob->op == BENCH_OP_RECONFIG_DRV)
+            params.chSup[0].drvMode = iter & 1 ? HMC7043_CDM_CML :
+                                                 HMC7043_CDM_LVDS;
+        else
+            params.chSup[0].freq = iter & 1 ? 50000000 : 100000000;
+
+        return hmc7043ReconfigDev(dev, &params);
+    }
+    case BENCH_OP_CH_SET_DELAY:   /* channels 0, 2 (a step of each delay) */
+        return hmc7043ChSetDelay(dev, 0x5, iter & 1 ? 25 : 0,
+                                 iter & 1 ? 0.5e12 / benchParams[0].clkInFreq :
+                                            0);
+    case BENCH_OP_CH_MULTI_SLIP:  /* channel 2 */
+        return hmc7043ChMultiSlip(dev, 0x4, 1 + iter % 8);
+    case BENCH_OP_BAD_ARG:  /* rejected by the parameter check (logging) */
+        return hmc7043OutChEnDis(dev, HMC7043_OUT_NCHAN, TRUE) == ERROR ? OK : ERROR;
+    default:
+        return ERROR;
+    }
+}
+
+LOCAL void *benchJobThread(void *arg)
+{
+    Bench_job *pJob = arg;
+    unsigned i;
+
+    for (i = 0; i < pJob->iters; ++i) {
+        SYS_TIME_NS t0 = sysTimeNsec();
+
+        if (benchDoOp(pJob, i) != OK)
+            ++pJob->nErrors;
+
+        pJob->pNsec[i] = sysTimeNsec() - t0;
+    }
+    return NULL;
+}
+
+/*******************************************************************************
+* - name: benchRun
+*
+* - title: measure op on ndev devices concurrently and output the results
+*
+* - input: op   - specifies the operation
+*          ndev - number of devices (0 .. ndev - 1), each driven by its own
+*                 thread (a single thread for the *_MULTI ops)
+*
+* - returns: OK or ERROR if any of the operations failed
+*
+* - description: outputs the aggregate throughput, latency statistics (over all
+*                the threads' iterations) and the simulated bus traffic per
+*                operation.
+*******************************************************************************/
+LOCAL STATUS benchRun(BENCH_OP op, unsigned ndev)
+{
+    Bench_job jobs[CKDST_MAX_NDEV];
+    pthread_t threads[CKDST_MAX_NDEV];
+    unsigned nJobs = op == BENCH_OP_INIT_MULTI ||
+                     op == BENCH_OP_SREF_PULSE_MULTI ? 1 : ndev;
+    unsigned i, nOps, nErrors = 0;
+    SYS_TIME_NS *pNsec, t0, wallNsec, totalNsec = 0;
+    UINT64 nXfers = 0, nRegs = 0;
+
+    if (!(pNsec = calloc(nJobs * benchCfg.iters, sizeof(*pNsec))))
+        return ERROR;
+
+    for (i = 0; i < ndev; ++i) {
+        nXfers -= benchSimDevs[i].nXfers;
+        nRegs  -= benchSimDevs[i].nRegs;
+    }
+
+    /* run the jobs */
+    t0 = sysTimeNsec();
+
+    for (i = 0; i < nJobs; ++i) {
+        Bench_job *pJob = jobs + i;
+
+        pJob->op      = op;
+        pJob->dev     = i;
+        pJob->devMask = CKDST_DEV_MASK_OF(ndev);
+        pJob->iters   = benchCfg.iters;
+        pJob->nErrors = 0;
+        pJob->pNsec   = pNsec + i * benchCfg.iters;
+
+        pthread_create(threads + i, NULL, benchJobThread, pJob);
+    }
+
+    for (i = 0; i < nJobs; ++i) {
+        pthread_join(threads[i], NULL);
+        nErrors += jobs[i].nErrors;
+    }
+
+    wallNsec = sysTimeNsec() - t0;
+
+    /* output the results */
+    for (i = 0; i < ndev; ++i) {
+        nXfers += benchSimDevs[i].nXfers;
+        nRegs  += benchSimDevs[i].nRegs;
+    }
+
+    nOps = nJobs * benchCfg.iters;
+    qsort(pNsec, nOps, sizeof(*pNsec), benchCmpNsec);
+
+    for (i = 0; i < nOps; ++i)
+        totalNsec += pNsec[i];
+
+    printf(benchCfg.csv ?
+           "%s,%u,%u,%u,%.1f,%.2f,%.2f,%.2f,%.2f,%.1f,%.1f\n" :
+           "{\"bench\": \"%s\", \"ndev\": %u, \"ops\": %u, \"errors\": %u, "
+           "\"ops_per_sec\": %.1f, \"mean_us\": %.2f, \"p50_us\": %.2f, "
+           "\"p99_us\": %.2f, \"max_us\": %.2f, \"xfers_per_op\": %.1f, "
+           "\"regs_per_op\": %.1f}\n",
+           benchOpNames[op], ndev, nOps, nErrors,
+           nOps * 1e9 / (wallNsec ? wallNsec : 1), totalNsec / 1e3 / nOps,
+           pNsec[nOps / 2] / 1e3, pNsec[nOps * 99 / 100] / 1e3,
+           pNsec[nOps - 1] / 1e3, (double) nXfers / nOps, (double) nRegs / nOps);
+
+    free(pNsec);
+    return nErrors ? ERROR : OK;
+}
+
+/*******************************************************************************
+* - name: benchWriteInitTrace
+*
+* - title: write the latest initialization profile of ndev devices to a file
+*
+* - input: ndev - number of devices (0 .. ndev - 1)
+*          path - output file
+*
+* - returns: OK or ERROR if detected an error
+*******************************************************************************/
+LOCAL STATUS benchWriteInitTrace(unsigned ndev, const char *path)
+{
+    char *buf = NULL;
+    size_t size = 0, len;
+    FILE *pFile;
+    STATUS status;
+
+    /* (sized by a first pass) */
+    for (;;) {
+        if (hmc7043InitProfileJson(CKDST_DEV_MASK_OF(ndev), buf, size, &len)
+            != OK) {
+            free(buf);
+            return ERROR;
+        }
+
+        if (len < size)
+            break;
+
+        free(buf);
+        if (!(buf = malloc(size = len + 1)))
+            return ERROR;
+    }
+
+    if (!(pFile = fopen(path, "w"))) {
+        free(buf);
+        return ERROR;
+    }
+
+    status = fwrite(buf, 1, len, pFile) == len ? OK : ERROR;
+    if (fclose(pFile))
+        status = ERROR;
+
+    free(buf);
+    return status;
+}
+
+LOCAL void benchUsage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-n maxNdev] [-i iters] [-o xferNsec] "
+            "[-r regNsec] [-j jitterNsec] [-s] [-z] [-p shmName] [-l] "
+            "[-L maxRate] [-t traceFile] [-a] [-c] [-v]\n", prog);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned ndev, i;
+    STATUS status = OK;
+    int opt;
+    BENCH_OP op;
+
+    while ((opt = getopt(argc, argv, "n:i:o:r:j:szp:lL:t:acv")) != -1) {
+        switch (opt) {
+        case 'n': benchCfg.maxNdev    = strtoul(optarg, NULL, 0); break;
+        case 'i': benchCfg.iters      = strtoul(optarg, NULL, 0); break;
+        case 'o': benchCfg.xferNsec   = strtoul(optarg, NULL, 0); break;
+        case 'r': benchCfg.regNsec    = strtoul(optarg, NULL, 0); break;
+        case 'j': benchCfg.jitterNsec = strtoul(optarg, NULL, 0); break;
+        case 's': benchCfg.noBurst    = TRUE;   break;
+        case 'z': benchCfg.noDelays   = TRUE;   break;
+        case 'p': benchCfg.shmName    = optarg; break;
+        case 'l': benchCfg.deferredLog = TRUE;  break;
+        case 'L': benchCfg.logRate    = strtoul(optarg, NULL, 0); break;
+        case 't': benchCfg.traceFile  = optarg; break;
+        case 'a': benchCfg.arbitrate  = TRUE;   break;
+        case 'c': benchCfg.csv        = TRUE;   break;
+        case 'v': benchCfg.verbose    = TRUE;   break;
+        default:
+            benchUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!inEnumRange(benchCfg.maxNdev - 1, CKDST_MAX_NDEV) || !benchCfg.iters) {
+        benchUsage(argv[0]);
+        return 1;
+    }
+
+    /* set up the simulated devices and the driver */
+    for (i = 0; i < CKDST_MAX_NDEV; ++i) {
+        Hmc7043_dev_io_if *pIf = benchIfs + i;
+
+        benchSimDevs[i].rand = 0x9e3779b97f4a7c15ull * (i + 1);
+
+        pIf->pRegRead  = benchSimRegRead;
+        pIf->pRegWrite = benchSimRegWrite;
+
+        if (!benchCfg.noBurst) {
+            pIf->pRegReadBurst  = benchSimRegReadBurst;
+            pIf->pRegWriteBurst = benchSimRegWriteBurst;
+        }
+    }
+
+    benchSetUpParams(benchParams, FALSE);
+    benchSetUpParams(benchParams + 1, TRUE);
+
+    if ((benchCfg.deferredLog &&
+         hmc7043StartDeferredLog(BENCH_LOG_MAX_MSGS, BENCH_LOG_PERIOD_USEC,
+                                 BENCH_THR_LOG) != OK) ||
+        hmc7043SetLogRateLimit(benchCfg.logRate) != OK) {
+        fprintf(stderr, "driver logging set-up failed\n");
+        return 1;
+    }
+
+    if (benchCfg.shmName &&
+        hmc7043SetPersistence(benchCfg.shmName, NULL, 0) != OK) {
+        fprintf(stderr, "persistence set-up failed (%s)\n", benchCfg.shmName);
+        return 1;
+    }
+
+    /* (only the devices measured for being allocated driver state) */
+    if (hmc7043IfInit(CKDST_DEV_MASK_OF(benchCfg.maxNdev)) != OK ||
+        hmc7043StartAsync(CKDST_DEV_MASK_OF(benchCfg.maxNdev),
+                          BENCH_ASYNC_MAX_REQS, BENCH_THR_ASYNC) != OK) {
+        fprintf(stderr, "driver interface initialization failed\n");
+        return 1;
+    }
+
+    /* (all the simulated devices being on bus 0) */
+    if (benchCfg.arbitrate && hmc7043SetBusArbitration(0, TRUE) != OK) {
+        fprintf(stderr, "bus arbitration set-up failed\n");
+        return 1;
+    }
+
+    if (benchCfg.csv)
+        printf("bench,ndev,ops,errors,ops_per_sec,mean_us,p50_us,p99_us,"
+               "max_us,xfers_per_op,regs_per_op\n");
+
+    /* measure for 1, 2, 4 .. maxNdev devices */
+    for (ndev = 1;; ndev = min(2 * ndev, benchCfg.maxNdev)) {
+        for (op = 0; op < BENCH_OP_NOPS; ++op) {
+            if (benchRun(op, ndev) != OK)
+                status = ERROR;
+
+            if (op == BENCH_OP_INIT_MULTI && ndev == benchCfg.maxNdev &&
+                benchCfg.traceFile &&
+                benchWriteInitTrace(ndev, benchCfg.traceFile) != OK) {
+                fprintf(stderr, "writing %s failed\n", benchCfg.traceFile);
+                status = ERROR;
+            }
+        }
+
+        if (ndev == benchCfg.maxNdev)
+            break;
+    }
+
+    if (benchCfg.arbitrate) {
+        Hmc7043_bus_stats bus;
+
+        if (hmc7043GetBusStats(0, &bus) == OK)
+            fprintf(stderr, "bus 0: utilization %.1f%%, grants (urgent/normal/"
+                    "background) %llu/%llu/%llu, max wait %.1f/%.1f/%.1f usec\n",
+                    100.0 * bus.busyNsec / (bus.atNsec - bus.sinceNsec),
+                    (unsigned long long) bus.nGrants[HMC7043_BPRI_URGENT],
+                    (unsigned long long) bus.nGrants[HMC7043_BPRI_NORMAL],
+                    (unsigned long long) bus.nGrants[HMC7043_BPRI_BACKGROUND],
+                    bus.maxWaitNsec[HMC7043_BPRI_URGENT] / 1e3,
+                    bus.maxWaitNsec[HMC7043_BPRI_NORMAL] / 1e3,
+                    bus.maxWaitNsec[HMC7043_BPRI_BACKGROUND] / 1e3);
+    }
+
+    if (benchCfg.shmName)
+        shm_unlink(benchCfg.shmName);
+
+    return status == OK ? 0 : 2;
+}
@@ -0,0 +1,364 @@
+/*******************************************************************************
+* hmc7043mmspi.c - HMC7043 register access backend for the memory-mapped       *
+*                  (FPGA) SPI command FIFO engine                              *
+********************************************************************************
+* modification history:                                                        *
+*   14.10.26 , created                                                         *
+*******************************************************************************/
+
+#include <string.h>
+#include "sysutil.h"
+#include "hmc7043mmspi.h"
+
+
+/* Constants and Types */
+#define HMC7043_MMSPI_REG_ID        (0x00 / 4)  /* register (word) offsets */
+#define HMC7043_MMSPI_REG_CTRL      (0x04 / 4)
+#define HMC7043_MMSPI_REG_STATUS    (0x08 / 4)
+#define HMC7043_MMSPI_REG_DOORBELL  (0x0c / 4)
+#define HMC7043_MMSPI_REG_CMD_FIFO  (0x10 / 4)
+#define HMC7043_MMSPI_REG_RX_FIFO   (0x14 / 4)
+
+#define HMC7043_MMSPI_CTRL_ENABLE   0x00000001
+#define HMC7043_MMSPI_CTRL_FLUSH    0x00000002
+
+#define HMC7043_MMSPI_ST_BUSY       0x00000001
+#define HMC7043_MMSPI_ST_ERROR      0x00000002
+#define HMC7043_MMSPI_ST_NFREE(st)  ((st) >> 16)
+
+#define HMC7043_MMSPI_CMD_READ      0x80000000
+#define HMC7043_MMSPI_CMD(doRead, chipSel, regInx, data)                      \
+    ((doRead ? HMC7043_MMSPI_CMD_READ : 0) | (chipSel) << 24 |               \
+     ((regInx) & 0x1fff) << 8 | (data))
+
+#define HMC7043_MMSPI_RX_VALID      0x80000000
+
+#define HMC7043_MMSPI_MAX_CHIP_SEL  15
+
+
+/* Control Data */
+LOCAL struct {
+    Bool initDone;  /* relying on static initialization of this to FALSE */
+    Hmc7043_mmspi_params params;
+    void *pMap;
+    UINT64 mapSize;
+    volatile UINT32 *pRegs;
+    HUTL_MUTEX hMutex;  /* the engine being shared by all the devices */
+    CKDST_DEV_MASK devMask;  /* attached devices */
+    unsigned chipSel[CKDST_MAX_NDEV];
+} hmc7043MmspiCtl;
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043MmspiWait
+*
+* - title: wait for the SPI engine
+*
+* - input: nFree - minimum number of free command FIFO entries to wait for, or 0
+*                  to wait for all the queued commands to complete
+*
+* - returns: OK or ERROR if detected an error (engine error or timeout)
+*
+* - description: polls the engine status (back-to-back, the expected waits
+*                being in the usec range), an engine error being cleared along
+*                with the FIFO contents
+*
+* - notes: must be called with hmc7043MmspiCtl.hMutex taken
+*******************************************************************************/
+LOCAL STATUS hmc7043MmspiWait(unsigned nFree)
+{
+    volatile UINT32 *pRegs = hmc7043MmspiCtl.pRegs;
+    SYS_TIME_NS startAt = sysTimeNsec();
+    UINT32 st;
+
+    FOREVER {
+        st = READ_REG32(pRegs + HMC7043_MMSPI_REG_STATUS);
+
+        if (st & HMC7043_MMSPI_ST_ERROR) {
+            sysLog("SPI engine error (status 0x%08x)", st);
+            WRITE_REG32(pRegs + HMC7043_MMSPI_REG_CTRL,
+                        HMC7043_MMSPI_CTRL_ENABLE | HMC7043_MMSPI_CTRL_FLUSH);
+            return ERROR;
+        }
+
+        if (nFree ? HMC7043_MMSPI_ST_NFREE(st) >= nFree :
+                    !(st & HMC7043_MMSPI_ST_BUSY))
+            return OK;
+
+        if (sysTimeNsec() - startAt >
+            hmc7043MmspiCtl.params.timeoutUsec * (SYS_TIME_NS) 1000) {
+            sysLog("SPI engine timeout (status 0x%08x, nFree %u)", st, nFree);
+            return ERROR;
+        }
+    }
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043MmspiXfer
+*
+* - title: read/write a run of contiguous device registers via the SPI engine
+*
+* - input: doRead - TRUE / FALSE to perform read / write, respectively
+*          dev    - CLKDST device for which to perform the operation
+*          regInx - first CLKDST register to read / write
+*          pData  - pointer to register data (nRegs entries)
+*          nRegs  - number of registers to read / write
+*
+* - output: pData[0 .. nRegs - 1] (only for a read operation)
+*
+* - returns: OK or ERROR if detected an error (in which case pData is unusable)
+*
+* - description: pushes the command words straight from pData into the
+*                command FIFO (in chunks of up to the FIFO depth), ringing the
+*                doorbell per chunk. Only waits for FIFO space between the
+*                chunks of a write, and for completion at its end (unless
+*                posted, ref. Hmc7043_mmspi_params), and for each chunk of a
+*                read to complete before draining its data from the rx FIFO.
+*
+* - notes: interlocked via hmc7043MmspiCtl.hMutex (the whole run)
+*******************************************************************************/
+LOCAL STATUS hmc7043MmspiXfer(Bool doRead, CKDST_DEV dev, unsigned regInx,
+                              HMC7043_REG *pData, unsigned nRegs)
+{
+    volatile UINT32 *pRegs = hmc7043MmspiCtl.pRegs;
+    STATUS status = OK;  /* initial assumption */
+    unsigned chipSel, i, n;
+    UINT32 rx;
+
+    if (!inEnumRange(dev, NELEMENTS(hmc7043MmspiCtl.chipSel)) ||
+        !(hmc7043MmspiCtl.devMask & CKDST_DEV_BIT(dev)) || !pData || !nRegs) {
+        sysLog("bad argument(s) (dev %d, pData %d, nRegs %u)", dev,
+               pData != NULL, nRegs);
+        return ERROR;
+    }
+
+    chipSel = hmc7043MmspiCtl.chipSel[dev];
+
+    if (utlMutexTake(hmc7043MmspiCtl.hMutex, __FUNCTION__) != OK)
+        return ERROR;
+
+    for (; nRegs && status == OK; regInx += n, pData += n, nRegs -= n) {
+        n = min(nRegs, hmc7043MmspiCtl.params.fifoDepth);
+
+        /* queue the chunk (a read only once the previous commands completed,
+           the rx FIFO then being known to be empty) */
+        if (hmc7043MmspiWait(doRead ? 0 : n) != OK) {
+            status = ERROR;
+            break;
+        }
+
+        for (i = 0; i < n; ++i)
+            WRITE_REG32(pRegs + HMC7043_MMSPI_REG_CMD_FIFO,
+                        HMC7043_MMSPI_CMD(doRead, chipSel, regInx + i,
+                                          doRead ? 0 : pData[i]));
+
+        WRITE_REG32(pRegs + HMC7043_MMSPI_REG_DOORBELL, 1);
+
+        if (!doRead)
+            continue;
+
+        /* drain the read data */
+        if (hmc7043MmspiWait(0) != OK) {
+            status = ERROR;
+            break;
+        }
+
+        for (i = 0; i < n; ++i) {
+            rx = READ_REG32(pRegs + HMC7043_MMSPI_REG_RX_FIFO);
+
+            if (!(rx & HMC7043_MMSPI_RX_VALID)) {
+                sysLog("rx FIFO underrun (dev %d, regInx 0x%03x)", dev,
+                       regInx + i);
+                status = ERROR;
+                break;
+            }
+
+            pData[i] = rx & 0xff;
+        }
+    }
+
+    if (status == OK && !doRead && !hmc7043MmspiCtl.params.postedWrites)
+        status = hmc7043MmspiWait(0);
+
+    utlMutexRelease(hmc7043MmspiCtl.hMutex, __FUNCTION__);
+
+    return status;
+}
+
+
+
+
+/* Hmc7043_dev_io_if callbacks */
+LOCAL STATUS hmc7043MmspiRegRead(CKDST_DEV dev, unsigned regInx,
+                                 HMC7043_REG *pData)
+{
+    return hmc7043MmspiXfer(TRUE, dev, regInx, pData, 1);
+}
+
+
+
+
+LOCAL STATUS hmc7043MmspiRegWrite(CKDST_DEV dev, unsigned regInx,
+                                  HMC7043_REG regData)
+{
+    return hmc7043MmspiXfer(FALSE, dev, regInx, &regData, 1);
+}
+
+
+
+
+LOCAL STATUS hmc7043MmspiRegReadBurst(CKDST_DEV dev, unsigned regInx,
+                                      HMC7043_REG *pData, unsigned nRegs)
+{
+    return hmc7043MmspiXfer(TRUE, dev, regInx, pData, nRegs);
+}
+
+
+
+
+/* (the data only being read) */
+LOCAL STATUS hmc7043MmspiRegWriteBurst(CKDST_DEV dev, unsigned regInx,
+                                       const HMC7043_REG *pData, unsigned nRegs)
+{
+    return hmc7043MmspiXfer(FALSE, dev, regInx, (HMC7043_REG *) pData, nRegs);
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043MmspiInit
+*
+* - title: initialize the memory-mapped SPI engine backend
+*
+* - input: pParams - engine parameters
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: maps the engine registers (ref. sysMemMap4Mmio), then enables
+*                the engine with its FIFOs flushed
+*
+* - notes: to be called once, before hmc7043MmspiAttach
+*******************************************************************************/
+EXPORT STATUS hmc7043MmspiInit(const Hmc7043_mmspi_params *pParams)
+{
+    volatile UINT32 *pRegs;
+
+    if (!pParams || !pParams->fifoDepth || !pParams->timeoutUsec) {
+        sysLog("bad argument(s) (pParams %d, fifoDepth %u, timeoutUsec %u)",
+               pParams != NULL, pParams ? pParams->fifoDepth : 0,
+               pParams ? pParams->timeoutUsec : 0);
+        return ERROR;
+    }
+
+    if (hmc7043MmspiCtl.initDone) {
+        sysLog("already initialized");
+        return ERROR;
+    }
+
+    if (sysMemMap4Mmio(pParams->physAddr, HMC7043_MMSPI_MAP_SIZE,
+                       &hmc7043MmspiCtl.pMap, &hmc7043MmspiCtl.mapSize) != OK) {
+        sysLog("SPI engine mapping failed (physAddr 0x%lx)",
+               (unsigned long) pParams->physAddr);
+        return ERROR;
+    }
+
+    if ((hmc7043MmspiCtl.hMutex = utlMutexCreate(SYS_TIME_INFINITE)) ==
+        UTL_MUTEX_BAD_HMUTEX) {
+        sysLog("mutex creation failed");
+        sysMemUnmap(hmc7043MmspiCtl.pMap, hmc7043MmspiCtl.mapSize);
+        return ERROR;
+    }
+
+    hmc7043MmspiCtl.params = *pParams;
+    hmc7043MmspiCtl.pRegs  = pRegs = hmc7043MmspiCtl.pMap;
+
+    WRITE_REG32(pRegs + HMC7043_MMSPI_REG_CTRL,
+                HMC7043_MMSPI_CTRL_ENABLE | HMC7043_MMSPI_CTRL_FLUSH);
+
+    sysLog("SPI engine id 0x%08x", READ_REG32(pRegs + HMC7043_MMSPI_REG_ID));
+
+    hmc7043MmspiCtl.initDone = TRUE;
+
+    return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043MmspiAttach
+*
+* - title: set up a device to be accessed via the SPI engine
+*
+* - input: dev     - CLKDST device
+*          chipSel - the device's engine chip select
+*
+* - output: *pIf - callbacks to pass to hmc7043InitDev
+*
+* - returns: OK or ERROR if detected an error
+*
+* - description: as above, the burst callbacks included
+*******************************************************************************/
+EXPORT STATUS hmc7043MmspiAttach(CKDST_DEV dev, unsigned chipSel,
+                                 Hmc7043_dev_io_if *pIf)
+{
+    if (!inEnumRange(dev, NELEMENTS(hmc7043MmspiCtl.chipSel)) ||
+        chipSel > HMC7043_MMSPI_MAX_CHIP_SEL || !pIf) {
+        sysLog("bad argument(s) (dev %d, chipSel %u, pIf %d)", dev, chipSel,
+               pIf != NULL);
+        return ERROR;
+    }
+
+    if (!hmc7043MmspiCtl.initDone) {
+        sysLog("backend not initialized yet (dev %d)", dev);
+        return ERROR;
+    }
+
+    hmc7043MmspiCtl.chipSel[dev] = chipSel;
+    hmc7043MmspiCtl.devMask     |= CKDST_DEV_BIT(dev);
+
+    pIf->pRegRead       = hmc7043MmspiRegRead;
+    pIf->pRegWrite      = hmc7043MmspiRegWrite;
+    pIf->pRegReadBurst  = hmc7043MmspiRegReadBurst;
+    pIf->pRegWriteBurst = hmc7043MmspiRegWriteBurst;
+
+    return OK;
+}
+
+
+
+
+/*******************************************************************************
+* - name: hmc7043MmspiSync
+*
+* - title: wait for all the queued SPI engine commands to complete
+*
+* - returns: OK or ERROR if detected an error (including one of a posted write)
+*
+* - description: as above (only needed with posted writes, ref.
+*                Hmc7043_mmspi_params)
+*******************************************************************************/
+EXPORT STATUS hmc7043MmspiSync(void)
+{
+    STATUS status;
+
+    if (!hmc7043MmspiCtl.initDone) {
+        sysLog("backend not initialized yet");
+        return ERROR;
+    }
+
+    if (utlMutexTake(hmc7043MmspiCtl.hMutex, __FUNCTION__) != OK)
+        return ERROR;
+
+    status = hmc7043MmspiWait(0);
+
+    utlMutexRelease(hmc7043MmspiCtl.hMutex, __FUNCTION__);
+
+    return status;
+}
@@ -0,0 +1,49 @@
+/*******************************************************************************
+* hmc7043mmspi.h - HMC7043 register access backend for the memory-mapped       *
+*                  (FPGA) SPI command FIFO engine                              *
+********************************************************************************
+* modification history:                                                        *
+*   14.10.26 , created                                                         *
+*******************************************************************************/
+
+#ifndef _hmc7043mmspi_h_
+#define _hmc7043mmspi_h_
+
+#include "sysbase.h"
+#include "ckdstif.h"
+#include "hmc7043.h"
+
+
+/*
+* SPI engine register map (32-bit registers, offsets from the base address):
+*   0x00 ID        - engine id / version (read only)
+*   0x04 CTRL      - bit 0: enable, bit 1: flush FIFOs and clear errors (self
+*                    clearing)
+*   0x08 STATUS    - bit 0: busy (commands pending or in progress), bit 1:
+*                    error (sticky), bits 16..31: command FIFO free entries
+*   0x0c DOORBELL  - any write starts executing the queued commands
+*   0x10 CMD_FIFO  - command words (write only): bit 31: read, bits 24..27: chip
+*                    select, bits 8..20: register index, bits 0..7: write data
+*   0x14 RX_FIFO   - read data (read only), one word per read command, in order
+*                    (bits 0..7: data, bit 31: valid)
+*/
+#define HMC7043_MMSPI_MAP_SIZE  0x1000
+
+typedef struct {
+    UINT64 physAddr;      /* engine base address */
+    UINT32 fifoDepth;     /* command / rx FIFO depth (entries) */
+    UINT32 timeoutUsec;   /* upper bound on waiting for the engine */
+    /* if set, a write returns once its commands are queued (i.e. does not wait
+       for these to complete), engine errors then being reported by the next
+       read or hmc7043MmspiSync */
+    Bool postedWrites;
+} Hmc7043_mmspi_params;
+
+/* services */
+STATUS hmc7043MmspiInit(const Hmc7043_mmspi_params *pParams);
+STATUS hmc7043MmspiAttach(CKDST_DEV dev, unsigned chipSel,
+                          Hmc7043_dev_io_if *pIf);
+STATUS hmc7043MmspiSync(void);
+
+
+#endif /* _hmc7043mmspi_h_ */
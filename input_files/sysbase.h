@@ -89,9 +89,47 @@ typedef UINT64 volatile UINT64_ATOMIC;
 #define sysAtomicXor(  pVar, mask)                                   \
     atomic_fetch_xor_explicit((pVar), (mask),  memory_order_seq_cst)
 
+#define sysAtomicCas(  pVar, pExpected, value)                       \
+    atomic_compare_exchange_weak_explicit((pVar), (pExpected), (value), \
+                                          memory_order_seq_cst,         \
+                                          memory_order_seq_cst)
+
 #define sysAtomicGet(pVar)          sysAtomicLoad(pVar)
 #define sysAtomicGetAndClear(pVar)  sysAtomicSet((pVar), 0)
 
+/*
+* Weaker ordered variants, for where sequential consistency is not needed (each
+* seq_cst operation being a full barrier on AArch64):
+* - relaxed: atomicity only, e.g. for statistics counters
+* - acquire loads / release stores: for publishing data via a flag or counter
+*   (the data written before the release store being visible to whoever sees
+*   the stored value via an acquire load)
+* - fences: for ordering relaxed operations, e.g. in sequence locks
+*/
+#define sysAtomicLoadRelaxed( pVar)                                  \
+    atomic_load_explicit     ((pVar),          memory_order_relaxed)
+#define sysAtomicLoadAcq(     pVar)                                  \
+    atomic_load_explicit     ((pVar),          memory_order_acquire)
+#define sysAtomicStoreRelaxed(pVar, value)                           \
+    atomic_store_explicit    ((pVar), (value), memory_order_relaxed)
+#define sysAtomicStoreRel(    pVar, value)                           \
+    atomic_store_explicit    ((pVar), (value), memory_order_release)
+#define sysAtomicAddRelaxed(  pVar, value)                           \
+    atomic_fetch_add_explicit((pVar), (value), memory_order_relaxed)
+#define sysAtomicSubRelaxed(  pVar, value)                           \
+    atomic_fetch_sub_explicit((pVar), (value), memory_order_relaxed)
+#define sysAtomicAndRelaxed(  pVar, mask)                            \
+    atomic_fetch_and_explicit((pVar), (mask),  memory_order_relaxed)
+#define sysAtomicOrRelaxed(   pVar, mask)                            \
+    atomic_fetch_or_explicit ((pVar), (mask),  memory_order_relaxed)
+#define sysAtomicCasRelaxed(  pVar, pExpected, value)                \
+    atomic_compare_exchange_weak_explicit((pVar), (pExpected), (value), \
+                                          memory_order_relaxed,         \
+                                          memory_order_relaxed)
+
+#define sysAtomicFenceAcq()  atomic_thread_fence(memory_order_acquire)
+#define sysAtomicFenceRel()  atomic_thread_fence(memory_order_release)
+
 /* compiler directives */
 #define INLINE    static inline  /* for some reason static is a must here */
 #define ALIGN(x)  __attribute__((aligned(x)))
@@ -184,6 +222,53 @@ INLINE void WRITE_REG64(volatile UINT64 *address, UINT64 value)
     atomic_store_explicit(address, value, memory_order_seq_cst);
 }
 
+/*
+* Relaxed variants of the above, for memory-mapped data in normal (i.e. not
+* device) memory - e.g. descriptors / status words shared with an FPGA via
+* cacheable memory - where the accesses need not be ordered with respect to
+* other memory accesses (any required ordering being up to the caller, ref.
+* sysAtomicFenceAcq / sysAtomicFenceRel).
+*/
+INLINE UINT8 READ_REG8_RELAXED(volatile const UINT8 *address)
+{
+    return atomic_load_explicit(address, memory_order_relaxed);
+}
+
+INLINE UINT16 READ_REG16_RELAXED(volatile const UINT16 *address)
+{
+    return atomic_load_explicit(address, memory_order_relaxed);
+}
+
+INLINE UINT32 READ_REG32_RELAXED(volatile const UINT32 *address)
+{
+    return atomic_load_explicit(address, memory_order_relaxed);
+}
+
+INLINE UINT64 READ_REG64_RELAXED(volatile const UINT64 *address)
+{
+    return atomic_load_explicit(address, memory_order_relaxed);
+}
+
+INLINE void WRITE_REG8_RELAXED(volatile UINT8 *address, UINT8 value)
+{
+    atomic_store_explicit(address, value, memory_order_relaxed);
+}
+
+INLINE void WRITE_REG16_RELAXED(volatile UINT16 *address, UINT16 value)
+{
+    atomic_store_explicit(address, value, memory_order_relaxed);
+}
+
+INLINE void WRITE_REG32_RELAXED(volatile UINT32 *address, UINT32 value)
+{
+    atomic_store_explicit(address, value, memory_order_relaxed);
+}
+
+INLINE void WRITE_REG64_RELAXED(volatile UINT64 *address, UINT64 value)
+{
+    atomic_store_explicit(address, value, memory_order_relaxed);
+}
+
 
 #endif /* _sysbase_h_ */
 
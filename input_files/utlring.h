@@ -0,0 +1,277 @@
+/*******************************************************************************
+* utlring.h - lock-free fixed-capacity message rings (single consumer, single  *
+*             or multiple producers)                                           *
+********************************************************************************
+* modification history:                                                        *
+*   14.10.26 , created                                                         *
+*******************************************************************************/
+
+#ifndef _utlring_h_
+#define _utlring_h_
+
+#include <stddef.h>
+#include <string.h>
+#include "sysbase.h"
+
+
+/*
+* Unlike the (copying, mutex-protected) utl queues, these rings do not lock
+* nor copy: a producer reserves a slot, builds its message in place and commits
+* it, the consumer peeks at the oldest committed message and releases it when
+* done with it. There is no blocking either, i.e. a consumer wishing to wait
+* needs some other means to be woken up (e.g. a utl queue of doorbells).
+*
+* Each slot carries a sequence number telling whether it is free for the
+* producer reserving it or committed for the consumer, so the producers and
+* the consumer only share the slot they hand over. The multiple producer
+* flavour differs only in reserving slots via compare and swap. The consumer
+* takes the messages in reservation order, i.e. a reserved but not yet
+* committed slot holds back the ones behind it (reservations are meant to be
+* short: reserve, fill in, commit).
+*
+* The slot storage is provided by the user (UTL_RING_MEM_SIZE bytes, 8-byte
+* aligned, preferably cache line aligned).
+*/
+#define UTL_RING_CACHE_LINE  64
+#define UTL_RING_SLOT_HDR    8  /* sequence number, padded for alignment */
+
+#define UTL_RING_SLOT_STRIDE(slotSize)                                   \
+    (UTL_RING_SLOT_HDR + (((slotSize) + 7) & ~(size_t) 7))
+#define UTL_RING_MEM_SIZE(nSlots, slotSize)                              \
+    ((size_t) (nSlots) * UTL_RING_SLOT_STRIDE(slotSize))
+
+typedef struct {
+    /* producer side: next position to reserve */
+    UINT32_ATOMIC head ALIGN(UTL_RING_CACHE_LINE);
+    /* consumer side: next position to take */
+    UINT32_ATOMIC tail ALIGN(UTL_RING_CACHE_LINE);
+    /* set up by utlRingInit, read only afterwards */
+    UINT8 *pSlots ALIGN(UTL_RING_CACHE_LINE);
+    UINT32 mask;     /* number of slots - 1 */
+    UINT32 stride;   /* slot size in bytes, header included */
+    Bool multiProd;  /* set if slots may be reserved concurrently */
+} Utl_ring;
+
+
+
+/*******************************************************************************
+* - name: utlRingSlotSeq
+*
+* - title: get a slot's sequence number
+*******************************************************************************/
+INLINE UINT32_ATOMIC *utlRingSlotSeq(const Utl_ring *pRing, UINT32 pos)
+{
+    return (UINT32_ATOMIC *) (pRing->pSlots + (size_t) (pos & pRing->mask)
+                                              * pRing->stride);
+}
+
+
+
+/*******************************************************************************
+* - name: utlRingInit
+*
+* - title: set up a ring
+*
+* - input: pRing     - ring to set up
+*          pMem      - slot storage (UTL_RING_MEM_SIZE(nSlots, slotSize) bytes)
+*          nSlots    - ring capacity, a power of 2
+*          slotSize  - maximum message size (bytes)
+*          multiProd - if set, slots may be reserved by concurrent producers
+*
+* - returns: OK or ERROR if the arguments are invalid
+*
+* - notes: must not be used concurrently with other operations on the ring
+*******************************************************************************/
+INLINE STATUS utlRingInit(Utl_ring *pRing, void *pMem, UINT32 nSlots,
+                          size_t slotSize, Bool multiProd)
+{
+    UINT32 pos;
+
+    if (!pMem || ((size_t) pMem & 7) || nSlots < 2 || (nSlots & (nSlots - 1))
+        || !slotSize || UTL_RING_SLOT_STRIDE(slotSize) > UINT32_MAX / nSlots)
+        return ERROR;
+
+    pRing->pSlots    = pMem;
+    pRing->mask      = nSlots - 1;
+    pRing->stride    = (UINT32) UTL_RING_SLOT_STRIDE(slotSize);
+    pRing->multiProd = multiProd;
+
+    /* slot i is free for position i */
+    for (pos = 0; pos < nSlots; pos++)
+        sysAtomicStoreRelaxed(utlRingSlotSeq(pRing, pos), pos);
+    sysAtomicStoreRelaxed(&pRing->head, 0);
+    sysAtomicStoreRelaxed(&pRing->tail, 0);
+    sysAtomicFenceRel();
+    return OK;
+}
+
+
+
+/*******************************************************************************
+* - name: utlRingReserve
+*
+* - title: reserve a slot for a message to be built in place
+*
+* - input: pRing - ring to reserve in
+*
+* - output: *pPos - the slot's position, to be passed to utlRingCommit
+*
+* - returns: the message buffer (slotSize bytes, 8-byte aligned) or NULL if the
+*            ring is full
+*
+* - notes: every successful reservation must be committed (soon)
+*******************************************************************************/
+INLINE void *utlRingReserve(Utl_ring *pRing, UINT32 *pPos)
+{
+    UINT32 pos = sysAtomicLoadRelaxed(&pRing->head), seq;
+    INT32 dif;
+
+    for (;;) {
+        seq = sysAtomicLoadAcq(utlRingSlotSeq(pRing, pos));
+        dif = (INT32) (seq - pos);
+        if (dif < 0)
+            /* slot still holds the message of the previous round */
+            return NULL;
+        if (dif > 0) {
+            /* another producer took this position */
+            pos = sysAtomicLoadRelaxed(&pRing->head);
+            continue;
+        }
+        if (!pRing->multiProd) {
+            sysAtomicStoreRelaxed(&pRing->head, pos + 1);
+            break;
+        }
+        /* on failure pos gets the current head */
+        if (sysAtomicCasRelaxed(&pRing->head, &pos, pos + 1))
+            break;
+    }
+    *pPos = pos;
+    return (UINT8 *) utlRingSlotSeq(pRing, pos) + UTL_RING_SLOT_HDR;
+}
+
+
+
+/*******************************************************************************
+* - name: utlRingCommit
+*
+* - title: hand a reserved slot's message over to the consumer
+*
+* - input: pRing - ring reserved in
+*          pos   - position returned by utlRingReserve
+*******************************************************************************/
+INLINE void utlRingCommit(Utl_ring *pRing, UINT32 pos)
+{
+    sysAtomicStoreRel(utlRingSlotSeq(pRing, pos), pos + 1);
+}
+
+
+
+/*******************************************************************************
+* - name: utlRingPeek
+*
+* - title: get the oldest message (consumer side)
+*
+* - input: pRing - ring to take from
+*
+* - returns: the message buffer or NULL if there is none or the oldest slot is
+*            reserved but not yet committed
+*
+* - notes: the message stays in the ring until utlRingRelease
+*******************************************************************************/
+INLINE void *utlRingPeek(Utl_ring *pRing)
+{
+    UINT32 pos = sysAtomicLoadRelaxed(&pRing->tail);
+    UINT32_ATOMIC *pSeq = utlRingSlotSeq(pRing, pos);
+
+    if (sysAtomicLoadAcq(pSeq) != pos + 1)
+        return NULL;
+    return (UINT8 *) pSeq + UTL_RING_SLOT_HDR;
+}
+
+
+
+/*******************************************************************************
+* - name: utlRingRelease
+*
+* - title: free the slot of the message got via utlRingPeek (consumer side)
+*
+* - input: pRing - ring taken from
+*******************************************************************************/
+INLINE void utlRingRelease(Utl_ring *pRing)
+{
+    UINT32 pos = sysAtomicLoadRelaxed(&pRing->tail);
+
+    /* free for the producer of the next round */
+    sysAtomicStoreRel(utlRingSlotSeq(pRing, pos), pos + pRing->mask + 1);
+    sysAtomicStoreRelaxed(&pRing->tail, pos + 1);
+}
+
+
+
+/*******************************************************************************
+* - name: utlRingCount
+*
+* - title: get the number of messages in a ring, reserved ones included
+*
+* - input: pRing - ring in question
+*
+* - returns: the number of messages (a snapshot, if used concurrently)
+*******************************************************************************/
+INLINE UINT32 utlRingCount(Utl_ring *pRing)
+{
+    UINT32 tail = sysAtomicLoadRelaxed(&pRing->tail);
+
+    return sysAtomicLoadRelaxed(&pRing->head) - tail;
+}
+
+
+
+/*******************************************************************************
+* - name: utlRingPut
+*
+* - title: copy a message into a ring (producer side)
+*
+* - input: pRing  - ring to put into
+*          pMsg   - message
+*          nBytes - message size (at most the slot size)
+*
+* - returns: OK or ERROR if the ring is full
+*******************************************************************************/
+INLINE STATUS utlRingPut(Utl_ring *pRing, const void *pMsg, size_t nBytes)
+{
+    UINT32 pos;
+    void *pSlot = utlRingReserve(pRing, &pos);
+
+    if (!pSlot)
+        return ERROR;
+    memcpy(pSlot, pMsg, nBytes);
+    utlRingCommit(pRing, pos);
+    return OK;
+}
+
+
+
+/*******************************************************************************
+* - name: utlRingGet
+*
+* - title: copy the oldest message out of a ring (consumer side)
+*
+* - input: pRing  - ring to take from
+*          nBytes - message size (at most the slot size)
+*
+* - output: pMsg - message
+*
+* - returns: OK or ERROR if there is no (committed) message
+*******************************************************************************/
+INLINE STATUS utlRingGet(Utl_ring *pRing, void *pMsg, size_t nBytes)
+{
+    void *pSlot = utlRingPeek(pRing);
+
+    if (!pSlot)
+        return ERROR;
+    memcpy(pMsg, pSlot, nBytes);
+    utlRingRelease(pRing);
+    return OK;
+}
+
+#endif /* _utlring_h_ */